@@ -0,0 +1,3 @@
+# Required thread library for std::thread
+
+find_package(Threads REQUIRED)
@@ -2,3 +2,4 @@
 
 include( kwiver-depends-Eigen )
 include( kwiver-depends-log4cxx )
+include( kwiver-depends-Threads )
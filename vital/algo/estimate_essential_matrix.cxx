@@ -35,6 +35,7 @@
 
 #include <vital/algo/estimate_essential_matrix.h>
 #include <vital/algo/algorithm.txx>
+#include <vital/types/columnar_feature_set.h>
 #include <vital/vital_foreach.h>
 
 /// \cond DoxygenSuppress
@@ -65,15 +66,17 @@ estimate_essential_matrix
            std::vector<bool>& inliers,
            double inlier_scale) const
 {
-  std::vector<feature_sptr> vf1 = feat1->features();
-  std::vector<feature_sptr> vf2 = feat2->features();
-  std::vector<match> mset = matches->matches();
+  const feature_location_view vf1( feat1 );
+  const feature_location_view vf2( feat2 );
+  const match_set::matches_view_t mset = matches->matches_view();
   std::vector<vector_2d> vv1, vv2;
+  vv1.reserve(mset.size());
+  vv2.reserve(mset.size());
 
-  VITAL_FOREACH( match m, mset)
+  VITAL_FOREACH( match const& m, mset)
   {
-    vv1.push_back(vf1[m.first]->loc());
-    vv2.push_back(vf2[m.second]->loc());
+    vv1.push_back(vf1[m.first]);
+    vv2.push_back(vf2[m.second]);
   }
   return this->estimate(vv1, vv2, cal1, cal2, inliers, inlier_scale);
 }
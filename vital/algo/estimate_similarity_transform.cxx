@@ -156,10 +156,10 @@ estimate_similarity_transform
 {
   // determine point pairings based on shared frame IDs
   std::vector<vector_3d> from_pts, to_pts;
-  camera_map::map_camera_t from_map = from->cameras(),
-                           to_map = to->cameras();
+  const camera_map::cameras_view_t from_map = from->cameras_view(),
+                                   to_map = to->cameras_view();
   map_to_pts< camera_map::map_camera_t, &camera::center >
-    (from_map, to_map, from_pts, to_pts);
+    (from_map.container(), to_map.container(), from_pts, to_pts);
   return this->estimate_transform(from_pts, to_pts);
 }
 
@@ -173,10 +173,10 @@ estimate_similarity_transform
 {
   // determine point pairings based on shared frame IDs
   std::vector<vector_3d> from_pts, to_pts;
-  landmark_map::map_landmark_t from_map = from->landmarks(),
-                               to_map = to->landmarks();
+  const landmark_map::landmarks_view_t from_map = from->landmarks_view(),
+                                       to_map = to->landmarks_view();
   map_to_pts< landmark_map::map_landmark_t, &landmark::loc >
-    (from_map, to_map, from_pts, to_pts);
+    (from_map.container(), to_map.container(), from_pts, to_pts);
   return this->estimate_transform(from_pts, to_pts);
 }
 
@@ -65,7 +65,7 @@ filter_features
 ::filter( feature_set_sptr feat, descriptor_set_sptr descr) const
 {
   std::vector<unsigned int> indices;
-  const std::vector<descriptor_sptr> &descr_vec = descr->descriptors();
+  const descriptor_set::descriptors_view_t descr_vec = descr->descriptors_view();
 
   feature_set_sptr filt_feat = filter(feat, indices);
   std::vector<descriptor_sptr> filtered_descr;
@@ -81,6 +81,24 @@ video_input
 }
 
 
+// ------------------------------------------------------------------
+void
+video_input
+::set_frame_memory_pool( image_memory_pool_sptr const& pool )
+{
+  m_frame_memory_pool = pool;
+}
+
+
+// ------------------------------------------------------------------
+image_memory_pool_sptr const&
+video_input
+::frame_memory_pool() const
+{
+  return m_frame_memory_pool;
+}
+
+
 } } } // end namespace
 
 /// \cond DoxygenSuppress
@@ -43,6 +43,7 @@
 
 #include <vital/algo/algorithm.h>
 #include <vital/types/image_container.h>
+#include <vital/types/image_memory_pool.h>
 #include <vital/types/timestamp.h>
 #include <vital/video_metadata/video_metadata.h>
 
@@ -286,6 +287,30 @@ public:
   algorithm_capabilities const& get_implementation_capabilities() const;
 
 
+  /**
+   * \brief Set the pool frame images are allocated from.
+   *
+   * Implementations that allocate a new image for each frame take the
+   * memory from this pool, so that the buffers of frames that are no
+   * longer referenced are recycled instead of being freed and allocated
+   * again.  A null pool, the default, allocates each frame separately.
+   *
+   * \param pool The pool to allocate frame memory from, or null.
+   */
+  void set_frame_memory_pool( image_memory_pool_sptr const& pool );
+
+
+  /**
+   * \brief Return the pool frame images are allocated from.
+   *
+   * Implementations should pass this to the image constructor when
+   * allocating frames.
+   *
+   * \return The pool, or null if frames are allocated separately.
+   */
+  image_memory_pool_sptr const& frame_memory_pool() const;
+
+
 protected:
   video_input(); // CTOR
 
@@ -293,6 +318,7 @@ protected:
 
 private:
   algorithm_capabilities m_capabilities;
+  image_memory_pool_sptr m_frame_memory_pool;
 };
 
 /// Shared pointer type for generic video_input definition type.
@@ -0,0 +1,236 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the built-in channel and layout convert_image algorithm
+ */
+
+#include "convert_image_pixels.h"
+
+#include <vital/types/image_conversion.h>
+#include <vital/util/tokenize.h>
+#include <vital/vital_foreach.h>
+
+#include <sstream>
+
+namespace kwiver {
+namespace vital {
+namespace algorithms {
+
+namespace {
+
+// ------------------------------------------------------------------
+// Parse a comma or space separated list of channel indices
+bool
+parse_channels( std::string const& str, std::vector< unsigned >& channels )
+{
+  std::vector< std::string > tokens;
+  tokenize( str, tokens, ", ", true );
+  channels.clear();
+  VITAL_FOREACH( std::string const& t, tokens )
+  {
+    std::istringstream ss( t );
+    unsigned c;
+    if ( ! ( ss >> c ) || ! ss.eof() )
+    {
+      return false;
+    }
+    channels.push_back( c );
+  }
+  return true;
+}
+
+
+// Check if the rows of an image have interleaved channels
+bool
+is_interleaved( image const& img )
+{
+  return img.depth() > 1 && img.d_step() == 1 &&
+         img.w_step() == static_cast< ptrdiff_t >( img.depth() );
+}
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+class convert_image_pixels::priv
+{
+public:
+  /// Constructor
+  priv()
+    : grayscale( false ),
+    layout( "keep" ),
+    num_threads( 0 )
+  {
+  }
+
+  /// The channels of the output, all if empty
+  std::vector< unsigned > channels;
+  /// Whether to convert color to luma
+  bool grayscale;
+  /// The output layout: "keep", "interleaved" or "planar"
+  std::string layout;
+  /// The maximum number of threads to use, all available if zero
+  unsigned num_threads;
+};
+
+
+// ------------------------------------------------------------------
+convert_image_pixels
+::convert_image_pixels()
+  : d_( new priv )
+{
+  attach_logger( "convert_image_pixels" );
+}
+
+
+convert_image_pixels
+::convert_image_pixels( const convert_image_pixels& other )
+  : d_( new priv( *other.d_ ) )
+{
+  attach_logger( "convert_image_pixels" );
+}
+
+
+convert_image_pixels
+::~convert_image_pixels()
+{
+}
+
+
+// ------------------------------------------------------------------
+vital::config_block_sptr
+convert_image_pixels
+::get_configuration() const
+{
+  vital::config_block_sptr config = vital::algorithm::get_configuration();
+
+  std::ostringstream channels;
+  for ( size_t k = 0; k < d_->channels.size(); ++k )
+  {
+    channels << ( k ? "," : "" ) << d_->channels[k];
+  }
+  config->set_value( "channels", channels.str(),
+                     "Comma separated input channels, in output order.  "
+                     "For example \"2,1,0\" swaps RGB and BGR and \"3\" "
+                     "extracts alpha.  Empty keeps all channels." );
+  config->set_value( "grayscale", d_->grayscale,
+                     "Convert to a single channel of luma.  The first three "
+                     "entries of \"channels\" are the red, green and blue "
+                     "channels, by default 0, 1 and 2.  Images of fewer "
+                     "than three channels keep their first channel." );
+  config->set_value( "layout", d_->layout,
+                     "The pixel layout of the output: \"interleaved\", "
+                     "\"planar\" or \"keep\" for the layout of the input." );
+  config->set_value( "num_threads", d_->num_threads,
+                     "The maximum number of threads used for conversion.  "
+                     "Zero uses all threads of the shared thread pool." );
+
+  return config;
+}
+
+
+// ------------------------------------------------------------------
+void
+convert_image_pixels
+::set_configuration( vital::config_block_sptr in_config )
+{
+  vital::config_block_sptr config = this->get_configuration();
+  config->merge_config( in_config );
+
+  parse_channels( config->get_value< std::string >( "channels" ), d_->channels );
+  d_->grayscale   = config->get_value< bool >( "grayscale" );
+  d_->layout      = config->get_value< std::string >( "layout" );
+  d_->num_threads = config->get_value< unsigned >( "num_threads" );
+}
+
+
+// ------------------------------------------------------------------
+bool
+convert_image_pixels
+::check_configuration( vital::config_block_sptr config ) const
+{
+  std::vector< unsigned > channels;
+  if ( ! parse_channels( config->get_value< std::string >( "channels", "" ), channels ) )
+  {
+    LOG_ERROR( m_logger, "channels must be a list of channel indices" );
+    return false;
+  }
+  if ( config->get_value< bool >( "grayscale", d_->grayscale ) &&
+       ! channels.empty() && channels.size() < 3 )
+  {
+    LOG_ERROR( m_logger, "grayscale conversion needs the red, green and "
+               "blue channels, or an empty channel list" );
+    return false;
+  }
+  const std::string layout = config->get_value< std::string >( "layout", d_->layout );
+  if ( layout != "keep" && layout != "interleaved" && layout != "planar" )
+  {
+    LOG_ERROR( m_logger, "layout \"" << layout
+               << "\" is not one of \"keep\", \"interleaved\" or \"planar\"" );
+    return false;
+  }
+  return true;
+}
+
+
+// ------------------------------------------------------------------
+vital::image_container_sptr
+convert_image_pixels
+::convert( vital::image_container_sptr img ) const
+{
+  if ( ! img )
+  {
+    return img;
+  }
+  const image src = img->get_image();
+
+  if ( d_->grayscale )
+  {
+    const std::vector< unsigned >& c = d_->channels;
+    const image gray = c.size() < 3
+      ? convert_to_gray( src, 0, 1, 2, d_->num_threads )
+      : convert_to_gray( src, c[0], c[1], c[2], d_->num_threads );
+    return std::make_shared< simple_image_container >( gray );
+  }
+
+  const bool interleave = d_->layout == "keep" ? is_interleaved( src )
+                                               : d_->layout == "interleaved";
+  if ( d_->channels.empty() &&
+       ( d_->layout == "keep" || src.depth() < 2 || interleave == is_interleaved( src ) ) )
+  {
+    return img;
+  }
+  return std::make_shared< simple_image_container >(
+    reorder_channels( src, d_->channels, interleave, d_->num_threads ) );
+}
+
+} } } // end namespace
@@ -0,0 +1,113 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for the built-in channel and layout convert_image implementation
+ */
+
+#ifndef VITAL_ALGORITHMS_CONVERT_IMAGE_PIXELS_H_
+#define VITAL_ALGORITHMS_CONVERT_IMAGE_PIXELS_H_
+
+#include <vital/algorithms/vital_algorithms_export.h>
+
+#include <vital/algo/convert_image.h>
+
+#include <memory>
+
+namespace kwiver {
+namespace vital {
+namespace algorithms {
+
+/// Select, reorder or combine image channels and change the pixel layout
+/**
+ * The conversions are those every image source needs in some form:
+ *
+ * - \c channels selects and orders the channels of the output, for
+ *   example "2,1,0" to swap RGB and BGR or "3" to extract alpha.  It is
+ *   empty to keep all channels.
+ * - \c grayscale combines the red, green and blue channels into luma.
+ *   The first three entries of \c channels name them, so "2,1,0" reads
+ *   BGR input.
+ * - \c layout is "interleaved", "planar" or "keep" for the layout of
+ *   the input.
+ *
+ * Images are converted with convert_to_gray() and reorder_channels(),
+ * using the vectorized pixel kernels on the shared thread pool.  An
+ * image needing no conversion is returned as is.
+ */
+class VITAL_ALGORITHMS_EXPORT convert_image_pixels
+  : public vital::algorithm_impl< convert_image_pixels, vital::algo::convert_image >
+{
+public:
+  /// Constructor
+  convert_image_pixels();
+
+  /// Copy Constructor
+  convert_image_pixels( const convert_image_pixels& other );
+
+  /// Destructor
+  virtual ~convert_image_pixels();
+
+  /// Return the name of this implementation
+  virtual std::string impl_name() const { return "pixels"; }
+
+  /// Return a description of this implementation
+  virtual std::string description() const
+  {
+    return "Convert images to grayscale, select or reorder their channels, "
+           "and convert between planar and interleaved pixels.";
+  }
+
+  /// Get this algorithm's \link vital::config_block configuration block \endlink
+  virtual vital::config_block_sptr get_configuration() const;
+  /// Set this algorithm's properties via a config block
+  virtual void set_configuration( vital::config_block_sptr config );
+  /// Check that the algorithm's currently configuration is valid
+  virtual bool check_configuration( vital::config_block_sptr config ) const;
+
+  /// Convert the channels and layout of an image
+  /**
+   * \throws std::out_of_range if a configured channel is not in \a img
+   * \throws image_type_mismatch_exception for grayscale conversion of
+   *         pixels other than bytes
+   */
+  virtual vital::image_container_sptr convert( vital::image_container_sptr img ) const;
+
+
+private:
+  /// private implementation class
+  class priv;
+  const std::unique_ptr< priv > d_;
+};
+
+} } } // end namespace
+
+#endif // VITAL_ALGORITHMS_CONVERT_IMAGE_PIXELS_H_
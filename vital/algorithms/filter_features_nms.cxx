@@ -0,0 +1,646 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the non-maximal suppression filter_features algorithm
+ */
+
+#include "filter_features_nms.h"
+
+#include <vital/types/columnar_feature_set.h>
+#include <vital/util/thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace kwiver {
+namespace vital {
+namespace algorithms {
+
+namespace {
+
+/// Locations and magnitudes of the features being filtered
+struct feature_points
+{
+  std::vector< double > x;
+  std::vector< double > y;
+  std::vector< double > mag;
+
+  size_t size() const { return mag.size(); }
+};
+
+
+// ------------------------------------------------------------------
+// Read the locations and magnitudes, directly from the columns if possible
+feature_points
+read_points( feature_set_sptr const& feat )
+{
+  feature_points pts;
+  const size_t n = feat->size();
+  pts.x.resize( n );
+  pts.y.resize( n );
+  pts.mag.resize( n );
+
+  columnar_feature_set_d const* cd = dynamic_cast< columnar_feature_set_d const* >( feat.get() );
+  columnar_feature_set_f const* cf = dynamic_cast< columnar_feature_set_f const* >( feat.get() );
+  if ( cd || cf )
+  {
+    for ( size_t i = 0; i < n; ++i )
+    {
+      pts.x[i] = cd ? cd->locations()[2 * i] : cf->locations()[2 * i];
+      pts.y[i] = cd ? cd->locations()[2 * i + 1] : cf->locations()[2 * i + 1];
+      pts.mag[i] = cd ? cd->magnitudes()[i] : cf->magnitudes()[i];
+    }
+    return pts;
+  }
+
+  const feature_set::features_view_t feats = feat->features_view();
+  for ( size_t i = 0; i < n; ++i )
+  {
+    if ( feats[i] )
+    {
+      const vector_2d loc = feats[i]->loc();
+      pts.x[i] = loc[0];
+      pts.y[i] = loc[1];
+      pts.mag[i] = feats[i]->magnitude();
+    }
+    else
+    {
+      pts.x[i] = pts.y[i] = 0.0;
+      pts.mag[i] = -std::numeric_limits< double >::infinity();
+    }
+  }
+  return pts;
+}
+
+
+/// Orders feature indices by decreasing magnitude, then increasing index
+struct stronger
+{
+  explicit stronger( std::vector< double > const& m ) : mag( m ) { }
+
+  bool operator()( unsigned a, unsigned b ) const
+  {
+    return mag[a] > mag[b] || ( ! ( mag[b] > mag[a] ) && a < b );
+  }
+
+  std::vector< double > const& mag;
+};
+
+
+// ------------------------------------------------------------------
+// Return the k strongest of the candidate features, strongest first.
+//
+// Chunks of the candidates are reduced to their own k strongest in
+// parallel before the final selection, so the serial part of the work
+// is proportional to k times the number of chunks.
+std::vector< unsigned >
+strongest( std::vector< double > const& mag, std::vector< unsigned > candidates,
+           size_t k, unsigned num_threads )
+{
+  const stronger cmp( mag );
+  if ( k < candidates.size() )
+  {
+    const size_t grain = std::max< size_t >( 2 * k, 16384 );
+    const size_t num_chunks = ( candidates.size() + grain - 1 ) / grain;
+    if ( num_chunks > 1 )
+    {
+      std::vector< std::vector< unsigned > > partial( num_chunks );
+      parallel_for( 0, candidates.size(), [&] ( size_t b, size_t e )
+      {
+        std::vector< unsigned > chunk( candidates.begin() + b, candidates.begin() + e );
+        // the last chunk may already hold k or fewer candidates
+        if ( chunk.size() > k )
+        {
+          std::nth_element( chunk.begin(), chunk.begin() + k, chunk.end(), cmp );
+          chunk.resize( k );
+        }
+        partial[b / grain].swap( chunk );
+      }, grain, num_threads );
+
+      candidates.clear();
+      for ( size_t c = 0; c < num_chunks; ++c )
+      {
+        candidates.insert( candidates.end(), partial[c].begin(), partial[c].end() );
+      }
+    }
+    std::nth_element( candidates.begin(), candidates.begin() + k, candidates.end(), cmp );
+    candidates.resize( k );
+  }
+  std::sort( candidates.begin(), candidates.end(), cmp );
+  return candidates;
+}
+
+
+// ------------------------------------------------------------------
+// A uniform grid of feature indices over the feature bounding box
+class point_grid
+{
+public:
+  point_grid( feature_points const& pts, double cell_size )
+    : min_x( 0 ), min_y( 0 ), cell( cell_size ), nx( 1 ), ny( 1 )
+  {
+    double max_x = 0, max_y = 0;
+    for ( size_t i = 0; i < pts.size(); ++i )
+    {
+      if ( i == 0 || pts.x[i] < min_x ) { min_x = pts.x[i]; }
+      if ( i == 0 || pts.y[i] < min_y ) { min_y = pts.y[i]; }
+      if ( i == 0 || pts.x[i] > max_x ) { max_x = pts.x[i]; }
+      if ( i == 0 || pts.y[i] > max_y ) { max_y = pts.y[i]; }
+    }
+    width = max_x - min_x;
+    height = max_y - min_y;
+    if ( ! ( cell > 0.0 ) )
+    {
+      cell = std::max( std::max( width, height ), 1.0 );
+    }
+    // bound the grid size for tiny cells
+    const double max_cells = std::max( 4.0 * pts.size(), 1024.0 );
+    const double cells = ( width / cell + 1 ) * ( height / cell + 1 );
+    if ( cells > max_cells )
+    {
+      cell *= std::sqrt( cells / max_cells ) * 1.01;
+    }
+    nx = static_cast< int >( width / cell ) + 1;
+    ny = static_cast< int >( height / cell ) + 1;
+  }
+
+  /// Bucket the given points by cell, keeping the given order within cells
+  void fill( feature_points const& pts, std::vector< unsigned > const& order )
+  {
+    start.assign( static_cast< size_t >( nx ) * ny + 1, 0 );
+    std::vector< size_t > cell_of( order.size() );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+      cell_of[i] = cell_index( pts.x[order[i]], pts.y[order[i]] );
+      ++start[cell_of[i] + 1];
+    }
+    for ( size_t c = 1; c < start.size(); ++c )
+    {
+      start[c] += start[c - 1];
+    }
+    items.resize( order.size() );
+    std::vector< size_t > pos( start.begin(), start.end() - 1 );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+      items[pos[cell_of[i]]++] = order[i];
+    }
+  }
+
+  int coord( double v, double origin ) const
+  {
+    const double c = std::floor( ( v - origin ) / cell );
+    return static_cast< int >( std::max( -1.0e9, std::min( 1.0e9, c ) ) );
+  }
+
+  size_t cell_index( double x, double y ) const
+  {
+    const int cx = std::max( 0, std::min( nx - 1, coord( x, min_x ) ) );
+    const int cy = std::max( 0, std::min( ny - 1, coord( y, min_y ) ) );
+    return static_cast< size_t >( cy ) * nx + cx;
+  }
+
+  size_t num_cells() const { return start.size() - 1; }
+
+  double min_x;
+  double min_y;
+  double width;
+  double height;
+  double cell;
+  int nx;
+  int ny;
+  std::vector< size_t > start;
+  std::vector< unsigned > items;
+};
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+/// Private implementation class
+class filter_features_nms::priv
+{
+public:
+  /// Constructor
+  priv()
+    : method( "anms" ),
+    max_features( 1000 ),
+    robustness( 0.9 ),
+    grid_cells( 8 ),
+    num_threads( 0 )
+  {
+  }
+
+  /// Select by magnitude only
+  std::vector< unsigned > select_magnitude( feature_points const& pts ) const
+  {
+    std::vector< unsigned > all( pts.size() );
+    for ( size_t i = 0; i < all.size(); ++i )
+    {
+      all[i] = static_cast< unsigned >( i );
+    }
+    return strongest( pts.mag, all, max_features, num_threads );
+  }
+
+  /// Select an equal share of the strongest features from each grid cell
+  std::vector< unsigned > select_grid( feature_points const& pts ) const
+  {
+    std::vector< unsigned > all( pts.size() );
+    for ( size_t i = 0; i < all.size(); ++i )
+    {
+      all[i] = static_cast< unsigned >( i );
+    }
+
+    point_grid grid( pts, 0.0 );
+    grid.cell = std::max( std::max( grid.width, grid.height ) / std::max( 1u, grid_cells ), 1e-9 );
+    grid.nx = static_cast< int >( grid.width / grid.cell ) + 1;
+    grid.ny = static_cast< int >( grid.height / grid.cell ) + 1;
+    grid.fill( pts, all );
+
+    size_t occupied = 0;
+    for ( size_t c = 0; c < grid.num_cells(); ++c )
+    {
+      occupied += grid.start[c + 1] > grid.start[c] ? 1 : 0;
+    }
+    const size_t quota = ( max_features + occupied - 1 ) / occupied;
+
+    // move the strongest features of each cell to the front of the cell
+    const stronger cmp( pts.mag );
+    std::vector< char > chosen( pts.size(), 0 );
+    parallel_for( 0, grid.num_cells(), [&] ( size_t b, size_t e )
+    {
+      for ( size_t c = b; c < e; ++c )
+      {
+        std::vector< unsigned >::iterator first = grid.items.begin() + grid.start[c];
+        std::vector< unsigned >::iterator last = grid.items.begin() + grid.start[c + 1];
+        std::vector< unsigned >::iterator keep = first + std::min< size_t >( quota, last - first );
+        std::nth_element( first, keep, last, cmp );
+        for ( ; first != keep; ++first )
+        {
+          chosen[*first] = 1;
+        }
+      }
+    }, 0, num_threads );
+
+    std::vector< unsigned > selected, rest;
+    for ( size_t i = 0; i < pts.size(); ++i )
+    {
+      ( chosen[i] ? selected : rest ).push_back( static_cast< unsigned >( i ) );
+    }
+    if ( selected.size() >= max_features )
+    {
+      return strongest( pts.mag, selected, max_features, num_threads );
+    }
+
+    // some cells had fewer features than their share
+    std::vector< unsigned > extra =
+      strongest( pts.mag, rest, max_features - selected.size(), num_threads );
+    selected.insert( selected.end(), extra.begin(), extra.end() );
+    return selected;
+  }
+
+  /// Select the features with the largest suppression radii
+  std::vector< unsigned > select_anms( feature_points const& pts ) const
+  {
+    const size_t n = pts.size();
+    const stronger cmp( pts.mag );
+
+    // order[r] is the feature of strength rank r
+    std::vector< unsigned > order( n );
+    for ( size_t i = 0; i < n; ++i )
+    {
+      order[i] = static_cast< unsigned >( i );
+    }
+    std::sort( order.begin(), order.end(), cmp );
+
+    // a feature of rank r may only be suppressed by the features of rank
+    // below limit[r], those with robustness * magnitude larger than its own
+    std::vector< unsigned > rank( n );
+    std::vector< unsigned > limit( n );
+    size_t l = 0;
+    for ( size_t r = 0; r < n; ++r )
+    {
+      rank[order[r]] = static_cast< unsigned >( r );
+      while ( l < n && robustness * pts.mag[order[l]] > pts.mag[order[r]] )
+      {
+        ++l;
+      }
+      limit[r] = static_cast< unsigned >( l );
+    }
+
+    // about four features per cell; items within a cell are in rank order
+    // so that a search can stop at the first feature too weak to suppress
+    point_grid grid( pts, 0.0 );
+    const double area = std::max( grid.width * grid.height, 1.0 );
+    grid = point_grid( pts, std::sqrt( 4.0 * area / n ) );
+    grid.fill( pts, order );
+
+    const double inf = std::numeric_limits< double >::infinity();
+    std::vector< double > radius( n, inf );
+
+    // Radii are first computed only up to a cap proportional to the
+    // expected spacing of the selected features.  If more than
+    // max_features features reach the cap their radii are refined with
+    // a doubled cap, which keeps the searches local.
+    double cap = std::sqrt( area / max_features );
+    const double diagonal = std::sqrt( grid.width * grid.width + grid.height * grid.height );
+    std::vector< unsigned > pending( order );
+    for (;;)
+    {
+      parallel_for( 0, pending.size(), [&] ( size_t b, size_t e )
+      {
+        for ( size_t p = b; p < e; ++p )
+        {
+          const unsigned i = pending[p];
+          radius[i] = suppression_radius( pts, grid, i, limit[rank[i]], rank, cap );
+        }
+      }, 0, num_threads );
+
+      std::vector< unsigned > capped;
+      VITAL_FOREACH( unsigned i, pending )
+      {
+        if ( radius[i] == inf )
+        {
+          capped.push_back( i );
+        }
+      }
+      if ( capped.size() <= max_features || cap > diagonal )
+      {
+        break;
+      }
+      pending.swap( capped );
+      cap *= 2.0;
+    }
+
+    // largest radius first; radii still unbounded are ranked by strength
+    std::vector< unsigned > selected( order );
+    std::vector< unsigned >::iterator keep = selected.begin() + max_features;
+    auto larger_radius = [&] ( unsigned a, unsigned b )
+    {
+      return radius[a] > radius[b] || ( ! ( radius[b] > radius[a] ) && rank[a] < rank[b] );
+    };
+    std::nth_element( selected.begin(), keep, selected.end(), larger_radius );
+    selected.erase( keep, selected.end() );
+    std::sort( selected.begin(), selected.end(), larger_radius );
+    return selected;
+  }
+
+  /// Distance from feature \a i to the nearest feature of rank below \a lim
+  /**
+   * Returns infinity if there is none within \a cap.
+   */
+  static double suppression_radius( feature_points const& pts, point_grid const& grid,
+                                    unsigned i, unsigned lim,
+                                    std::vector< unsigned > const& rank, double cap )
+  {
+    if ( lim == 0 )
+    {
+      return std::numeric_limits< double >::infinity();
+    }
+
+    const double px = pts.x[i];
+    const double py = pts.y[i];
+    const int qx = grid.coord( px, grid.min_x );
+    const int qy = grid.coord( py, grid.min_y );
+    const int r_max = static_cast< int >( std::ceil( cap / grid.cell ) ) + 1;
+    double best = cap * cap;
+    bool found = false;
+
+    for ( int r = 0; r <= r_max; ++r )
+    {
+      const double bound = std::max( 0, r - 1 ) * grid.cell;
+      if ( bound * bound > best )
+      {
+        break;
+      }
+      for ( int y = std::max( 0, qy - r ); y <= std::min( grid.ny - 1, qy + r ); ++y )
+      {
+        const bool edge = ( y == qy - r || y == qy + r );
+        const int step = edge ? 1 : 2 * r;
+        for ( int x = qx - r; x <= qx + r; x += std::max( step, 1 ) )
+        {
+          if ( x < 0 || x >= grid.nx )
+          {
+            continue;
+          }
+          const size_t c = static_cast< size_t >( y ) * grid.nx + x;
+          for ( size_t k = grid.start[c]; k < grid.start[c + 1]; ++k )
+          {
+            const unsigned j = grid.items[k];
+            if ( rank[j] >= lim )
+            {
+              break;
+            }
+            const double dx = pts.x[j] - px;
+            const double dy = pts.y[j] - py;
+            const double d2 = dx * dx + dy * dy;
+            if ( d2 <= best )
+            {
+              best = d2;
+              found = true;
+            }
+          }
+        }
+      }
+    }
+    return found ? std::sqrt( best ) : std::numeric_limits< double >::infinity();
+  }
+
+  /// The selection method: "anms", "grid" or "magnitude"
+  std::string method;
+  /// The maximum number of features to keep
+  unsigned max_features;
+  /// A feature is only suppressed by features this much stronger
+  double robustness;
+  /// The number of grid cells along the longer side of the image
+  unsigned grid_cells;
+  /// The maximum number of threads to use, all available if zero
+  unsigned num_threads;
+};
+
+
+// ------------------------------------------------------------------
+filter_features_nms
+::filter_features_nms()
+  : d_( new priv )
+{
+  attach_logger( "filter_features_nms" );
+}
+
+
+filter_features_nms
+::filter_features_nms( const filter_features_nms& other )
+  : d_( new priv( *other.d_ ) )
+{
+  attach_logger( "filter_features_nms" );
+}
+
+
+filter_features_nms
+::~filter_features_nms()
+{
+}
+
+
+// ------------------------------------------------------------------
+vital::config_block_sptr
+filter_features_nms
+::get_configuration() const
+{
+  vital::config_block_sptr config = vital::algorithm::get_configuration();
+
+  config->set_value( "method", d_->method,
+                     "How features are selected: \"magnitude\" keeps the "
+                     "strongest features, \"grid\" keeps the strongest "
+                     "features of each grid cell, and \"anms\" uses adaptive "
+                     "non-maximal suppression." );
+  config->set_value( "max_features", d_->max_features,
+                     "The maximum number of features to keep." );
+  config->set_value( "robustness", d_->robustness,
+                     "For \"anms\", a feature is only suppressed by features "
+                     "whose magnitude multiplied by this factor is larger "
+                     "than its own.  Must be in (0, 1]." );
+  config->set_value( "grid_cells", d_->grid_cells,
+                     "For \"grid\", the number of cells along the longer side "
+                     "of the feature bounding box." );
+  config->set_value( "num_threads", d_->num_threads,
+                     "The maximum number of threads used for filtering.  "
+                     "Zero uses all threads of the shared thread pool." );
+
+  return config;
+}
+
+
+// ------------------------------------------------------------------
+void
+filter_features_nms
+::set_configuration( vital::config_block_sptr in_config )
+{
+  vital::config_block_sptr config = this->get_configuration();
+  config->merge_config( in_config );
+
+  d_->method       = config->get_value< std::string >( "method" );
+  d_->max_features = config->get_value< unsigned >( "max_features" );
+  d_->robustness   = config->get_value< double >( "robustness" );
+  d_->grid_cells   = config->get_value< unsigned >( "grid_cells" );
+  d_->num_threads  = config->get_value< unsigned >( "num_threads" );
+}
+
+
+// ------------------------------------------------------------------
+bool
+filter_features_nms
+::check_configuration( vital::config_block_sptr config ) const
+{
+  const std::string method = config->get_value< std::string >( "method", d_->method );
+  if ( method != "anms" && method != "grid" && method != "magnitude" )
+  {
+    LOG_ERROR( m_logger, "method \"" << method
+               << "\" is not one of \"anms\", \"grid\" or \"magnitude\"" );
+    return false;
+  }
+  const double robustness = config->get_value< double >( "robustness", d_->robustness );
+  if ( ! ( robustness > 0.0 && robustness <= 1.0 ) )
+  {
+    LOG_ERROR( m_logger, "robustness must be in (0, 1]" );
+    return false;
+  }
+  if ( config->get_value< unsigned >( "grid_cells", d_->grid_cells ) < 1 )
+  {
+    LOG_ERROR( m_logger, "grid_cells must be at least 1" );
+    return false;
+  }
+  return true;
+}
+
+
+// ------------------------------------------------------------------
+vital::feature_set_sptr
+filter_features_nms
+::filter( vital::feature_set_sptr feat, std::vector< unsigned int >& indices ) const
+{
+  indices.clear();
+  if ( ! feat || feat->size() == 0 )
+  {
+    return std::make_shared< simple_feature_set >();
+  }
+
+  const size_t n = feat->size();
+  if ( n <= d_->max_features )
+  {
+    for ( size_t i = 0; i < n; ++i )
+    {
+      indices.push_back( static_cast< unsigned >( i ) );
+    }
+  }
+  else if ( d_->max_features > 0 )
+  {
+    const feature_points pts = read_points( feat );
+    if ( d_->method == "magnitude" )
+    {
+      indices = d_->select_magnitude( pts );
+    }
+    else if ( d_->method == "grid" )
+    {
+      indices = d_->select_grid( pts );
+    }
+    else
+    {
+      indices = d_->select_anms( pts );
+    }
+    std::sort( indices.begin(), indices.end() );
+  }
+
+  std::vector< feature_sptr > filtered;
+  filtered.reserve( indices.size() );
+  columnar_feature_set_d const* cd = dynamic_cast< columnar_feature_set_d const* >( feat.get() );
+  columnar_feature_set_f const* cf = dynamic_cast< columnar_feature_set_f const* >( feat.get() );
+  if ( cd || cf )
+  {
+    // only create the features that are kept
+    VITAL_FOREACH( unsigned i, indices )
+    {
+      filtered.push_back( cd ? cd->at( i ) : cf->at( i ) );
+    }
+  }
+  else
+  {
+    const feature_set::features_view_t feats = feat->features_view();
+    VITAL_FOREACH( unsigned i, indices )
+    {
+      filtered.push_back( feats[i] );
+    }
+  }
+  return std::make_shared< simple_feature_set >( filtered );
+}
+
+} } } // end namespace
@@ -0,0 +1,119 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for the non-maximal suppression filter_features implementation
+ */
+
+#ifndef VITAL_ALGORITHMS_FILTER_FEATURES_NMS_H_
+#define VITAL_ALGORITHMS_FILTER_FEATURES_NMS_H_
+
+#include <vital/algorithms/vital_algorithms_export.h>
+
+#include <vital/algo/filter_features.h>
+
+#include <memory>
+
+namespace kwiver {
+namespace vital {
+namespace algorithms {
+
+/// Reduce a feature set to a spatially well distributed subset
+/**
+ * At most \c max_features features are kept, chosen by one of three
+ * methods:
+ *
+ * - \c magnitude keeps the features of largest magnitude.
+ * - \c grid divides the image into square cells and keeps an equal share
+ *   of the strongest features from each cell, topping up with the
+ *   strongest remaining features if some cells run short.
+ * - \c anms (adaptive non-maximal suppression) gives each feature a
+ *   suppression radius, the distance to the nearest feature that is
+ *   significantly stronger, and keeps the features with largest radii.
+ *
+ * Features are bucketed in a uniform grid so that all methods run in
+ * O(N log N) time or better.  Selection of the strongest features and the
+ * radius computation are split across the shared thread pool.
+ */
+class VITAL_ALGORITHMS_EXPORT filter_features_nms
+  : public vital::algorithm_impl< filter_features_nms, vital::algo::filter_features >
+{
+public:
+  /// Constructor
+  filter_features_nms();
+
+  /// Copy Constructor
+  filter_features_nms( const filter_features_nms& other );
+
+  /// Destructor
+  virtual ~filter_features_nms();
+
+  /// Return the name of this implementation
+  virtual std::string impl_name() const { return "nms"; }
+
+  /// Return a description of this implementation
+  virtual std::string description() const
+  {
+    return "Keep the strongest features, optionally spread over the image by "
+           "grid bucketing or adaptive non-maximal suppression.";
+  }
+
+  /// Get this algorithm's \link vital::config_block configuration block \endlink
+  virtual vital::config_block_sptr get_configuration() const;
+  /// Set this algorithm's properties via a config block
+  virtual void set_configuration( vital::config_block_sptr config );
+  /// Check that the algorithm's currently configuration is valid
+  virtual bool check_configuration( vital::config_block_sptr config ) const;
+
+  using vital::algo::filter_features::filter;
+
+
+protected:
+  /// Filter a feature set and return a new feature set with a subset of features
+  /**
+   * \param [in] feat The input feature set
+   * \param [in,out] indices The indices into \p feat of the features
+   *                 retained, in increasing order
+   * \return a new feature set containing the subset of features noted by \p indices
+   */
+  virtual vital::feature_set_sptr
+  filter( vital::feature_set_sptr feat, std::vector< unsigned int >& indices ) const;
+
+
+private:
+  /// private implementation class
+  class priv;
+  const std::unique_ptr< priv > d_;
+};
+
+} } } // end namespace
+
+#endif // VITAL_ALGORITHMS_FILTER_FEATURES_NMS_H_
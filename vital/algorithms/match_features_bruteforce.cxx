@@ -0,0 +1,493 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the brute-force match_features algorithm
+ */
+
+#include "match_features_bruteforce.h"
+
+#include <vital/exceptions/base.h>
+#include <vital/types/descriptor_matrix_set.h>
+#include <vital/util/distance_kernels.h>
+#include <vital/util/thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace kwiver {
+namespace vital {
+namespace algorithms {
+
+namespace {
+
+/// Index used for empty neighbor slots
+const unsigned invalid_index = std::numeric_limits< unsigned >::max();
+
+/// The element types for which matching is implemented
+enum element_t
+{
+  ELEMENT_BYTE,
+  ELEMENT_FLOAT,
+  ELEMENT_DOUBLE
+};
+
+
+// ------------------------------------------------------------------
+// Determine the element type of a descriptor set from its first descriptor
+element_t
+element_type( descriptor_set_sptr const& ds )
+{
+  if ( std::dynamic_pointer_cast< descriptor_matrix_set< unsigned char > >( ds ) )
+  {
+    return ELEMENT_BYTE;
+  }
+  if ( std::dynamic_pointer_cast< descriptor_matrix_set< float > >( ds ) )
+  {
+    return ELEMENT_FLOAT;
+  }
+  if ( std::dynamic_pointer_cast< descriptor_matrix_set< double > >( ds ) )
+  {
+    return ELEMENT_DOUBLE;
+  }
+
+  std::vector< descriptor_sptr > const descs = ds->descriptors();
+  VITAL_FOREACH( descriptor_sptr const& d, descs )
+  {
+    if ( ! d )
+    {
+      continue;
+    }
+    if ( dynamic_cast< descriptor_array_of< unsigned char > const* >( d.get() ) )
+    {
+      return ELEMENT_BYTE;
+    }
+    if ( dynamic_cast< descriptor_array_of< float > const* >( d.get() ) )
+    {
+      return ELEMENT_FLOAT;
+    }
+    break;
+  }
+  return ELEMENT_DOUBLE;
+}
+
+
+// ------------------------------------------------------------------
+// Return the descriptors as a contiguous matrix, copying only if needed
+template < typename T >
+std::shared_ptr< descriptor_matrix_set< T > const >
+as_matrix( descriptor_set_sptr const& ds )
+{
+  std::shared_ptr< descriptor_matrix_set< T > const > m =
+    std::dynamic_pointer_cast< descriptor_matrix_set< T > const >( ds );
+  if ( m )
+  {
+    return m;
+  }
+  return std::make_shared< descriptor_matrix_set< T > >( ds->descriptors() );
+}
+
+
+// ------------------------------------------------------------------
+// Block distance functions with a common signature for each element type
+void
+block_l2( float const* a, size_t na, size_t sa,
+          float const* b, size_t nb, size_t sb, size_t dim, float* out )
+{
+  l2_squared_many_to_many( a, na, sa, b, nb, sb, dim, out );
+}
+
+
+void
+block_l2( double const* a, size_t na, size_t sa,
+          double const* b, size_t nb, size_t sb, size_t dim, double* out )
+{
+  l2_squared_many_to_many( a, na, sa, b, nb, sb, dim, out );
+}
+
+
+void
+block_l2( unsigned char const* a, size_t na, size_t sa,
+          unsigned char const* b, size_t nb, size_t sb, size_t dim, unsigned* out )
+{
+  hamming_distance_many_to_many( a, na, sa, b, nb, sb, dim, out );
+}
+
+
+/// Distance types produced by the block functions for each element type
+template < typename T > struct distance_of { typedef T type; };
+template <> struct distance_of< unsigned char > { typedef unsigned type; };
+
+
+/// Convert a block distance to a reported distance
+inline double
+true_distance( float d ) { return std::sqrt( static_cast< double >( d ) ); }
+inline double
+true_distance( double d ) { return std::sqrt( d ); }
+inline double
+true_distance( unsigned d ) { return static_cast< double >( d ); }
+
+
+// ------------------------------------------------------------------
+// Find the k nearest rows of \a train for each row of \a query.
+//
+// Results are written to k consecutive slots per query, sorted by
+// increasing distance.  Unused slots hold invalid_index.  Query rows are
+// split into tiles processed in parallel, and each query tile is compared
+// against one tile of training rows at a time so the training tile stays
+// in cache.
+template < typename T >
+void
+knn_search( descriptor_matrix_set< T > const& query,
+            descriptor_matrix_set< T > const& train,
+            size_t k, size_t tile, size_t num_threads,
+            std::vector< typename distance_of< T >::type >& dist,
+            std::vector< unsigned >& index )
+{
+  typedef typename distance_of< T >::type dist_t;
+
+  const size_t nq = query.size();
+  const size_t nt = train.size();
+  const size_t dim = query.dim();
+  dist.assign( nq * k, std::numeric_limits< dist_t >::max() );
+  index.assign( nq * k, invalid_index );
+
+  parallel_for( 0, nq, [&] ( size_t qb, size_t qe )
+  {
+    const size_t rows = qe - qb;
+    std::vector< dist_t > block( rows * std::min( tile, nt ) );
+    for ( size_t tb = 0; tb < nt; tb += tile )
+    {
+      const size_t cols = std::min( nt, tb + tile ) - tb;
+      block_l2( query.row( qb ), rows, query.stride(),
+                train.row( tb ), cols, train.stride(), dim, &block[0] );
+
+      for ( size_t r = 0; r < rows; ++r )
+      {
+        dist_t const* brow = &block[r * cols];
+        dist_t* best_d = &dist[( qb + r ) * k];
+        unsigned* best_i = &index[( qb + r ) * k];
+        for ( size_t c = 0; c < cols; ++c )
+        {
+          const dist_t d = brow[c];
+          if ( ! ( d < best_d[k - 1] ) )
+          {
+            continue;
+          }
+          // insertion into the short sorted list; strict comparison keeps
+          // the lowest index first among equal distances
+          size_t s = k - 1;
+          while ( s > 0 && d < best_d[s - 1] )
+          {
+            best_d[s] = best_d[s - 1];
+            best_i[s] = best_i[s - 1];
+            --s;
+          }
+          best_d[s] = d;
+          best_i[s] = static_cast< unsigned >( tb + c );
+        }
+      }
+    }
+  }, tile, num_threads );
+}
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+/// Private implementation class
+class match_features_bruteforce::priv
+{
+public:
+  /// Constructor
+  priv()
+    : distance_metric( "auto" ),
+    k( 1 ),
+    ratio_threshold( 0.0 ),
+    max_distance( -1.0 ),
+    cross_check( false ),
+    tile_size( 256 ),
+    num_threads( 0 )
+  {
+  }
+
+  /// Match two descriptor matrices of the same element type
+  template < typename T >
+  match_set_sptr
+  match( descriptor_set_sptr const& desc1, descriptor_set_sptr const& desc2,
+         std::vector< double >& distances ) const
+  {
+    typedef typename distance_of< T >::type dist_t;
+
+    std::shared_ptr< descriptor_matrix_set< T > const > m1 = as_matrix< T >( desc1 );
+    std::shared_ptr< descriptor_matrix_set< T > const > m2 = as_matrix< T >( desc2 );
+    if ( m1->dim() != m2->dim() )
+    {
+      std::stringstream msg;
+      msg << "can not match descriptors of length " << m1->dim()
+          << " to descriptors of length " << m2->dim();
+      throw invalid_value( msg.str() );
+    }
+
+    // the ratio test needs the two nearest neighbors
+    const bool use_ratio = ratio_threshold > 0.0;
+    const size_t kk = std::max< size_t >( k, use_ratio ? 2 : 1 );
+    const size_t tile = std::max< size_t >( 1, tile_size );
+
+    std::vector< dist_t > dist;
+    std::vector< unsigned > index;
+    knn_search( *m1, *m2, kk, tile, num_threads, dist, index );
+
+    std::vector< dist_t > rev_dist;
+    std::vector< unsigned > rev_index;
+    if ( cross_check )
+    {
+      knn_search( *m2, *m1, 1, tile, num_threads, rev_dist, rev_index );
+    }
+
+    std::vector< vital::match > matches;
+    matches.reserve( m1->size() * k );
+    for ( size_t i = 0; i < m1->size(); ++i )
+    {
+      unsigned const* nn = &index[i * kk];
+      dist_t const* nd = &dist[i * kk];
+      if ( nn[0] == invalid_index )
+      {
+        continue;
+      }
+      if ( use_ratio && nn[1] != invalid_index &&
+           ! ( true_distance( nd[0] ) < ratio_threshold * true_distance( nd[1] ) ) )
+      {
+        continue;
+      }
+
+      for ( size_t n = 0; n < k && nn[n] != invalid_index; ++n )
+      {
+        const double d = true_distance( nd[n] );
+        if ( max_distance >= 0.0 && d > max_distance )
+        {
+          break;
+        }
+        if ( cross_check && rev_index[nn[n]] != i )
+        {
+          continue;
+        }
+        matches.push_back( vital::match( static_cast< unsigned >( i ), nn[n] ) );
+        distances.push_back( d );
+      }
+    }
+
+    return std::make_shared< simple_match_set >( matches );
+  }
+
+  /// The distance metric: "auto", "l2" or "hamming"
+  std::string distance_metric;
+  /// The maximum number of matches for each query descriptor
+  unsigned k;
+  /// Lowe's ratio threshold, disabled if not positive
+  double ratio_threshold;
+  /// The maximum distance of a match, disabled if negative
+  double max_distance;
+  /// Only keep matches that are mutual nearest neighbors
+  bool cross_check;
+  /// The number of descriptors in each block of the distance computation
+  unsigned tile_size;
+  /// The maximum number of threads to use, all available if zero
+  unsigned num_threads;
+};
+
+
+// ------------------------------------------------------------------
+match_features_bruteforce
+::match_features_bruteforce()
+  : d_( new priv )
+{
+  attach_logger( "match_features_bruteforce" );
+}
+
+
+match_features_bruteforce
+::match_features_bruteforce( const match_features_bruteforce& other )
+  : d_( new priv( *other.d_ ) )
+{
+  attach_logger( "match_features_bruteforce" );
+}
+
+
+match_features_bruteforce
+::~match_features_bruteforce()
+{
+}
+
+
+// ------------------------------------------------------------------
+vital::config_block_sptr
+match_features_bruteforce
+::get_configuration() const
+{
+  vital::config_block_sptr config = vital::algorithm::get_configuration();
+
+  config->set_value( "distance_metric", d_->distance_metric,
+                     "The distance used to compare descriptors: \"l2\" for "
+                     "Euclidean distance, \"hamming\" for binary descriptors "
+                     "of unsigned char elements, or \"auto\" to use Hamming "
+                     "distance for unsigned char descriptors and Euclidean "
+                     "distance otherwise." );
+  config->set_value( "k", d_->k,
+                     "The maximum number of matches reported for each "
+                     "descriptor in the first set, in order of increasing "
+                     "distance." );
+  config->set_value( "ratio_threshold", d_->ratio_threshold,
+                     "Lowe's ratio test threshold.  A descriptor is only "
+                     "matched if the distance to its nearest neighbor is less "
+                     "than this fraction of the distance to the second "
+                     "nearest neighbor.  Disabled if zero." );
+  config->set_value( "max_distance", d_->max_distance,
+                     "Matches with a distance larger than this are rejected.  "
+                     "Disabled if negative." );
+  config->set_value( "cross_check", d_->cross_check,
+                     "If true, only keep a match if the descriptor in the first "
+                     "set is also the nearest neighbor of the matched "
+                     "descriptor in the second set." );
+  config->set_value( "tile_size", d_->tile_size,
+                     "The number of descriptors from each set compared in one "
+                     "block.  Blocks of the first set are also the unit of "
+                     "parallel work." );
+  config->set_value( "num_threads", d_->num_threads,
+                     "The maximum number of threads used for matching.  "
+                     "Zero uses all threads of the shared thread pool." );
+
+  return config;
+}
+
+
+// ------------------------------------------------------------------
+void
+match_features_bruteforce
+::set_configuration( vital::config_block_sptr in_config )
+{
+  vital::config_block_sptr config = this->get_configuration();
+  config->merge_config( in_config );
+
+  d_->distance_metric = config->get_value< std::string >( "distance_metric" );
+  d_->k               = config->get_value< unsigned >( "k" );
+  d_->ratio_threshold = config->get_value< double >( "ratio_threshold" );
+  d_->max_distance    = config->get_value< double >( "max_distance" );
+  d_->cross_check     = config->get_value< bool >( "cross_check" );
+  d_->tile_size       = config->get_value< unsigned >( "tile_size" );
+  d_->num_threads     = config->get_value< unsigned >( "num_threads" );
+}
+
+
+// ------------------------------------------------------------------
+bool
+match_features_bruteforce
+::check_configuration( vital::config_block_sptr config ) const
+{
+  const std::string metric = config->get_value< std::string >( "distance_metric",
+                                                                d_->distance_metric );
+  if ( metric != "auto" && metric != "l2" && metric != "hamming" )
+  {
+    LOG_ERROR( m_logger, "distance_metric \"" << metric
+               << "\" is not one of \"auto\", \"l2\" or \"hamming\"" );
+    return false;
+  }
+  if ( config->get_value< unsigned >( "k", d_->k ) < 1 )
+  {
+    LOG_ERROR( m_logger, "k must be at least 1" );
+    return false;
+  }
+  if ( config->get_value< double >( "ratio_threshold", d_->ratio_threshold ) >= 1.0 )
+  {
+    LOG_ERROR( m_logger, "ratio_threshold must be less than 1" );
+    return false;
+  }
+  if ( config->get_value< unsigned >( "tile_size", d_->tile_size ) < 1 )
+  {
+    LOG_ERROR( m_logger, "tile_size must be at least 1" );
+    return false;
+  }
+  return true;
+}
+
+
+// ------------------------------------------------------------------
+vital::match_set_sptr
+match_features_bruteforce
+::match( VITAL_UNUSED vital::feature_set_sptr feat1, vital::descriptor_set_sptr desc1,
+         VITAL_UNUSED vital::feature_set_sptr feat2, vital::descriptor_set_sptr desc2 ) const
+{
+  std::vector< double > distances;
+  return this->match_descriptors( desc1, desc2, distances );
+}
+
+
+// ------------------------------------------------------------------
+vital::match_set_sptr
+match_features_bruteforce
+::match_descriptors( vital::descriptor_set_sptr desc1,
+                     vital::descriptor_set_sptr desc2,
+                     std::vector< double >& distances ) const
+{
+  distances.clear();
+  if ( ! desc1 || ! desc2 || desc1->size() == 0 || desc2->size() == 0 )
+  {
+    return std::make_shared< simple_match_set >();
+  }
+
+  // sets of different element types are compared as the wider type
+  element_t type = std::max( element_type( desc1 ), element_type( desc2 ) );
+  if ( d_->distance_metric == "hamming" )
+  {
+    if ( type != ELEMENT_BYTE )
+    {
+      throw invalid_value( "Hamming distance requires unsigned char descriptors" );
+    }
+  }
+  else if ( d_->distance_metric == "l2" && type == ELEMENT_BYTE )
+  {
+    type = ELEMENT_FLOAT;
+  }
+
+  switch ( type )
+  {
+    case ELEMENT_BYTE:
+      return d_->match< unsigned char >( desc1, desc2, distances );
+    case ELEMENT_FLOAT:
+      return d_->match< float >( desc1, desc2, distances );
+    default:
+      return d_->match< double >( desc1, desc2, distances );
+  }
+}
+
+} } } // end namespace
@@ -0,0 +1,139 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for the brute-force match_features implementation
+ */
+
+#ifndef VITAL_ALGORITHMS_MATCH_FEATURES_BRUTEFORCE_H_
+#define VITAL_ALGORITHMS_MATCH_FEATURES_BRUTEFORCE_H_
+
+#include <vital/algorithms/vital_algorithms_export.h>
+
+#include <vital/algo/match_features.h>
+
+#include <memory>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+namespace algorithms {
+
+/// Exhaustive descriptor matcher used as a reference implementation
+/**
+ * Every descriptor in the first set is compared against every descriptor
+ * in the second set.  Descriptors are packed into contiguous matrices
+ * (see descriptor_matrix_set) and distances are computed block by block
+ * with the vectorized distance kernels so that each block of the second
+ * set is reused from cache across many queries.  Blocks of queries are
+ * processed in parallel on the shared thread pool.
+ *
+ * Binary descriptors (unsigned char elements) are compared with the
+ * Hamming distance and all others with the Euclidean distance unless
+ * configured otherwise.  Descriptor sets of different element types are
+ * compared after converting both to the wider type.  Matches may be
+ * filtered by Lowe's ratio test, a maximum distance and a cross (mutual
+ * nearest neighbor) check, and up to \c k matches may be reported for
+ * each feature in the first set.
+ */
+class VITAL_ALGORITHMS_EXPORT match_features_bruteforce
+  : public vital::algorithm_impl< match_features_bruteforce, vital::algo::match_features >
+{
+public:
+  /// Constructor
+  match_features_bruteforce();
+
+  /// Copy Constructor
+  match_features_bruteforce( const match_features_bruteforce& other );
+
+  /// Destructor
+  virtual ~match_features_bruteforce();
+
+  /// Return the name of this implementation
+  virtual std::string impl_name() const { return "bruteforce"; }
+
+  /// Return a description of this implementation
+  virtual std::string description() const
+  {
+    return "Exhaustive tiled and parallel descriptor matching with optional "
+           "ratio test and cross check.";
+  }
+
+  /// Get this algorithm's \link vital::config_block configuration block \endlink
+  virtual vital::config_block_sptr get_configuration() const;
+  /// Set this algorithm's properties via a config block
+  virtual void set_configuration( vital::config_block_sptr config );
+  /// Check that the algorithm's currently configuration is valid
+  virtual bool check_configuration( vital::config_block_sptr config ) const;
+
+  /// Match one set of features and corresponding descriptors to another
+  /**
+   * The features are not used; matching is based only on descriptors.
+   *
+   * \param feat1 the first set of features to match
+   * \param desc1 the descriptors corresponding to \a feat1
+   * \param feat2 the second set fof features to match
+   * \param desc2 the descriptors corresponding to \a feat2
+   * \returns a set of matching indices from \a feat1 to \a feat2
+   */
+  virtual vital::match_set_sptr
+  match( vital::feature_set_sptr feat1, vital::descriptor_set_sptr desc1,
+         vital::feature_set_sptr feat2, vital::descriptor_set_sptr desc2 ) const;
+
+  /// Match two descriptor sets and report the distance of each match
+  /**
+   * Matches are ordered by index into \a desc1 and, for each descriptor
+   * of \a desc1, by increasing distance.  Euclidean distances are
+   * reported as true (not squared) distances and Hamming distances as the
+   * number of differing bits.
+   *
+   * \param desc1     the query descriptors
+   * \param desc2     the descriptors searched for each query
+   * \param distances output distance of each returned match
+   * \returns a set of matching indices from \a desc1 to \a desc2
+   * \throws invalid_value if the descriptors can not be compared with the
+   *         configured distance metric
+   */
+  vital::match_set_sptr
+  match_descriptors( vital::descriptor_set_sptr desc1,
+                     vital::descriptor_set_sptr desc2,
+                     std::vector< double >& distances ) const;
+
+
+private:
+  /// private implementation class
+  class priv;
+  const std::unique_ptr< priv > d_;
+};
+
+} } } // end namespace
+
+#endif // VITAL_ALGORITHMS_MATCH_FEATURES_BRUTEFORCE_H_
@@ -0,0 +1,70 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Plugin module interface for the built-in algorithm implementations
+ */
+
+#include <vital/algorithms/vital_algorithms_plugin_export.h>
+#include <vital/algorithms/register_algorithms.h>
+#include <vital/logger/logger.h>
+
+#include <exception>
+
+
+extern "C"
+{
+
+// Always export this function
+VITAL_ALGORITHMS_PLUGIN_EXPORT
+int private_register_algo_impls( kwiver::vital::registrar& reg )
+{
+  kwiver::vital::logger_handle_t logger =
+    kwiver::vital::get_logger( "vital.algorithms.plugin" );
+
+  try
+  {
+    LOG_DEBUG( logger, "Registering algorithm implementations from module "
+               "'vital_algorithms_plugin'" );
+    return kwiver::vital::algorithms::register_algorithms( reg );
+  }
+  catch ( std::exception const& e )
+  {
+    LOG_ERROR( logger, "Caught exception: " << e.what() );
+  }
+  catch ( ... )
+  {
+    LOG_ERROR( logger, "Caught other exception." );
+  }
+  return -1;
+}
+
+}
@@ -0,0 +1,164 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief tests for the built-in channel and layout convert_image implementation
+ */
+
+#include <test_common.h>
+
+#include <vital/algorithms/convert_image_pixels.h>
+
+#include <iostream>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+using namespace kwiver::vital;
+
+namespace {
+
+// Make an image container of w by h pixels of d channels
+image_container_sptr
+make_test_image( size_t w, size_t h, size_t d, bool interleave )
+{
+  image img( w, h, d, interleave );
+  for ( unsigned k = 0; k < d; ++k )
+  {
+    for ( unsigned j = 0; j < h; ++j )
+    {
+      for ( unsigned i = 0; i < w; ++i )
+      {
+        img( i, j, k ) = static_cast< image::byte >( ( 7 * i + 3 * j + 50 * k ) % 256 );
+      }
+    }
+  }
+  return std::make_shared< simple_image_container >( img );
+}
+
+
+// Configure the converter from a key and value pair
+void
+configure( algorithms::convert_image_pixels& c,
+           std::string const& key, std::string const& value )
+{
+  config_block_sptr config = c.get_configuration();
+  config->set_value( key, value );
+  if ( ! c.check_configuration( config ) )
+  {
+    TEST_ERROR( "configuration " << key << " = " << value << " rejected" );
+  }
+  c.set_configuration( config );
+}
+
+} // end anonymous namespace
+
+
+IMPLEMENT_TEST(passthrough)
+{
+  algorithms::convert_image_pixels c;
+  image_container_sptr in = make_test_image( 32, 16, 3, true );
+  TEST_EQUAL( "Default configuration returns the input", c.convert( in ) == in, true );
+
+  configure( c, "layout", "interleaved" );
+  TEST_EQUAL( "Matching layout returns the input", c.convert( in ) == in, true );
+  TEST_EQUAL( "Null input", c.convert( image_container_sptr() ) == nullptr, true );
+}
+
+
+IMPLEMENT_TEST(channels)
+{
+  algorithms::convert_image_pixels c;
+  configure( c, "channels", "2,1,0" );
+  configure( c, "layout", "planar" );
+  TEST_EQUAL( "Channels round trip through config",
+              c.get_configuration()->get_value< std::string >( "channels" ), "2,1,0" );
+
+  image_container_sptr in = make_test_image( 40, 30, 3, true );
+  const image src = in->get_image();
+  const image out = c.convert( in )->get_image();
+  TEST_EQUAL( "Output is planar", out.w_step(), 1 );
+  TEST_EQUAL( "Channel 0 is blue", out( 5, 7, 0 ), src( 5, 7, 2 ) );
+  TEST_EQUAL( "Channel 2 is red", out( 5, 7, 2 ), src( 5, 7, 0 ) );
+
+  configure( c, "channels", "1" );
+  const image green = c.convert( in )->get_image();
+  TEST_EQUAL( "Extracted depth", green.depth(), 1 );
+  TEST_EQUAL( "Extracted value", green( 9, 3 ), src( 9, 3, 1 ) );
+
+  configure( c, "channels", "5" );
+  EXPECT_EXCEPTION( std::out_of_range, c.convert( in ), "extracting a missing channel" );
+}
+
+
+IMPLEMENT_TEST(grayscale)
+{
+  algorithms::convert_image_pixels c;
+  configure( c, "grayscale", "true" );
+  configure( c, "channels", "2 1 0" );
+
+  image_container_sptr in = make_test_image( 40, 30, 4, false );
+  const image src = in->get_image();
+  const image gray = c.convert( in )->get_image();
+  TEST_EQUAL( "Gray depth", gray.depth(), 1 );
+  const unsigned y = ( 77 * src( 3, 4, 2 ) + 150 * src( 3, 4, 1 ) + 29 * src( 3, 4, 0 ) + 128 ) / 256;
+  TEST_EQUAL( "Gray value of BGR input", gray( 3, 4 ), y );
+}
+
+
+IMPLEMENT_TEST(bad_config)
+{
+  algorithms::convert_image_pixels c;
+  config_block_sptr config = c.get_configuration();
+  config->set_value( "layout", "diagonal" );
+  TEST_EQUAL( "unknown layout rejected", c.check_configuration( config ), false );
+
+  config = c.get_configuration();
+  config->set_value( "channels", "0,x" );
+  TEST_EQUAL( "bad channel rejected", c.check_configuration( config ), false );
+
+  config = c.get_configuration();
+  config->set_value( "grayscale", "true" );
+  config->set_value( "channels", "0,1" );
+  TEST_EQUAL( "two gray channels rejected", c.check_configuration( config ), false );
+}
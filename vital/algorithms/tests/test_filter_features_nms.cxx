@@ -0,0 +1,314 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief tests for the non-maximal suppression filter_features implementation
+ */
+
+#include <test_common.h>
+
+#include <vital/algorithms/filter_features_nms.h>
+#include <vital/types/columnar_feature_set.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <vector>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+using namespace kwiver::vital;
+
+namespace {
+
+// Make features with random locations inside a size by size square and random magnitudes
+feature_set_sptr
+random_features( size_t num, double size )
+{
+  std::vector< feature_sptr > feats;
+  for ( size_t i = 0; i < num; ++i )
+  {
+    const double x = size * ( std::rand() / ( RAND_MAX + 1.0 ) );
+    const double y = size * ( std::rand() / ( RAND_MAX + 1.0 ) );
+    const double m = std::rand() / ( RAND_MAX + 1.0 );
+    feats.push_back( std::make_shared< feature_d >( vector_2d( x, y ), m ) );
+  }
+  return std::make_shared< simple_feature_set >( feats );
+}
+
+
+// Configure the filter from a key and value pair
+void
+configure( algorithms::filter_features_nms& f,
+           std::string const& key, std::string const& value )
+{
+  config_block_sptr config = f.get_configuration();
+  config->set_value( key, value );
+  if ( ! f.check_configuration( config ) )
+  {
+    TEST_ERROR( "configuration " << key << " = " << value << " rejected" );
+  }
+  f.set_configuration( config );
+}
+
+
+// Brute force adaptive non-maximal suppression
+std::set< feature_sptr >
+brute_force_anms( feature_set_sptr feat, size_t k, double robustness )
+{
+  const std::vector< feature_sptr > feats = feat->features();
+  const size_t n = feats.size();
+  std::vector< double > radius( n, std::numeric_limits< double >::infinity() );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    for ( size_t j = 0; j < n; ++j )
+    {
+      if ( robustness * feats[j]->magnitude() > feats[i]->magnitude() )
+      {
+        radius[i] = std::min( radius[i], ( feats[j]->loc() - feats[i]->loc() ).norm() );
+      }
+    }
+  }
+  std::vector< size_t > order( n );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    order[i] = i;
+  }
+  std::sort( order.begin(), order.end(), [&] ( size_t a, size_t b )
+  {
+    if ( radius[a] != radius[b] )
+    {
+      return radius[a] > radius[b];
+    }
+    return feats[a]->magnitude() > feats[b]->magnitude();
+  } );
+  std::set< feature_sptr > result;
+  for ( size_t i = 0; i < k; ++i )
+  {
+    result.insert( feats[order[i]] );
+  }
+  return result;
+}
+
+} // end anonymous namespace
+
+
+IMPLEMENT_TEST(keep_all)
+{
+  feature_set_sptr feat = random_features( 10, 100.0 );
+  algorithms::filter_features_nms f;
+  configure( f, "max_features", "20" );
+
+  feature_set_sptr out = f.filter( feat );
+  TEST_EQUAL( "all features kept", out->size(), 10 );
+  TEST_EQUAL( "features in order", out->features()[3] == feat->features()[3], true );
+}
+
+
+IMPLEMENT_TEST(magnitude)
+{
+  std::srand( 1 );
+  // large enough to be reduced in several parallel chunks
+  feature_set_sptr feat = random_features( 50000, 1000.0 );
+  algorithms::filter_features_nms f;
+  configure( f, "method", "magnitude" );
+  configure( f, "max_features", "100" );
+
+  std::vector< double > mags;
+  VITAL_FOREACH( feature_sptr const& ft, feat->features() )
+  {
+    mags.push_back( ft->magnitude() );
+  }
+  std::sort( mags.begin(), mags.end() );
+  const double threshold = mags[mags.size() - 100];
+
+  feature_set_sptr out = f.filter( feat );
+  TEST_EQUAL( "number of features", out->size(), 100 );
+  size_t num_weak = 0;
+  VITAL_FOREACH( feature_sptr const& ft, out->features() )
+  {
+    num_weak += ft->magnitude() < threshold ? 1 : 0;
+  }
+  TEST_EQUAL( "only the strongest features kept", num_weak, 0 );
+}
+
+
+IMPLEMENT_TEST(magnitude_short_last_chunk)
+{
+  std::srand( 4 );
+  // one more feature than the parallel chunk size, so the last chunk
+  // holds fewer features than are kept
+  std::vector< feature_sptr > feats = random_features( 16385, 1000.0 )->features();
+  feats[0] = std::make_shared< feature_d >( vector_2d( 1, 1 ), 2.0 );
+  feature_set_sptr feat = std::make_shared< simple_feature_set >( feats );
+  algorithms::filter_features_nms f;
+  configure( f, "method", "magnitude" );
+  configure( f, "max_features", "1000" );
+
+  feature_set_sptr out = f.filter( feat );
+  TEST_EQUAL( "number of features", out->size(), 1000 );
+  const std::vector< feature_sptr > kept = out->features();
+  const std::set< feature_sptr > unique( kept.begin(), kept.end() );
+  TEST_EQUAL( "no feature repeated", unique.size(), 1000 );
+  TEST_EQUAL( "strongest feature first", kept[0] == feats[0], true );
+}
+
+
+IMPLEMENT_TEST(grid)
+{
+  std::srand( 2 );
+  // strong features packed in one corner, weak features everywhere
+  std::vector< feature_sptr > feats;
+  for ( size_t i = 0; i < 500; ++i )
+  {
+    const double x = 10.0 * ( std::rand() / ( RAND_MAX + 1.0 ) );
+    const double y = 10.0 * ( std::rand() / ( RAND_MAX + 1.0 ) );
+    feats.push_back( std::make_shared< feature_d >( vector_2d( x, y ), 10.0 + i ) );
+  }
+  for ( size_t i = 0; i < 500; ++i )
+  {
+    const double x = 400.0 * ( std::rand() / ( RAND_MAX + 1.0 ) );
+    const double y = 400.0 * ( std::rand() / ( RAND_MAX + 1.0 ) );
+    feats.push_back( std::make_shared< feature_d >( vector_2d( x, y ), 1.0 ) );
+  }
+  feature_set_sptr feat = std::make_shared< simple_feature_set >( feats );
+
+  algorithms::filter_features_nms f;
+  configure( f, "method", "grid" );
+  configure( f, "grid_cells", "4" );
+  configure( f, "max_features", "64" );
+
+  feature_set_sptr out = f.filter( feat );
+  TEST_EQUAL( "number of features", out->size(), 64 );
+  std::set< int > cells;
+  size_t num_strong = 0;
+  VITAL_FOREACH( feature_sptr const& ft, out->features() )
+  {
+    const int cx = std::min( 3, static_cast< int >( ft->loc()[0] / 100.0 ) );
+    const int cy = std::min( 3, static_cast< int >( ft->loc()[1] / 100.0 ) );
+    cells.insert( cy * 4 + cx );
+    num_strong += ft->magnitude() > 1.0 ? 1 : 0;
+  }
+  TEST_EQUAL( "all cells covered", cells.size(), 16 );
+  if ( num_strong > 16 )
+  {
+    TEST_ERROR( "corner cell kept " << num_strong << " features" );
+  }
+}
+
+
+IMPLEMENT_TEST(anms)
+{
+  std::srand( 3 );
+  feature_set_sptr feat = random_features( 2000, 640.0 );
+  algorithms::filter_features_nms f;
+  configure( f, "max_features", "100" );
+  configure( f, "robustness", "0.9" );
+
+  const std::set< feature_sptr > expected = brute_force_anms( feat, 100, 0.9 );
+  feature_set_sptr out = f.filter( feat );
+  TEST_EQUAL( "number of features", out->size(), 100 );
+  size_t num_missing = 0;
+  VITAL_FOREACH( feature_sptr const& ft, out->features() )
+  {
+    num_missing += expected.count( ft ) ? 0 : 1;
+  }
+  TEST_EQUAL( "same features as brute force", num_missing, 0 );
+}
+
+
+IMPLEMENT_TEST(columnar)
+{
+  std::srand( 4 );
+  feature_set_sptr feat = random_features( 3000, 500.0 );
+  std::shared_ptr< columnar_feature_set_d > cols =
+    std::make_shared< columnar_feature_set_d >( feat->features() );
+
+  algorithms::filter_features_nms f;
+  configure( f, "max_features", "200" );
+
+  // the descriptor overload returns the features at the kept indices
+  std::vector< descriptor_sptr > descs;
+  for ( size_t i = 0; i < feat->size(); ++i )
+  {
+    std::shared_ptr< descriptor_fixed< double, 1 > > d( new descriptor_fixed< double, 1 > );
+    d->raw_data()[0] = static_cast< double >( i );
+    descs.push_back( d );
+  }
+  descriptor_set_sptr descr = std::make_shared< simple_descriptor_set >( descs );
+
+  std::pair< feature_set_sptr, descriptor_set_sptr > a = f.filter( feat, descr );
+  std::pair< feature_set_sptr, descriptor_set_sptr > b = f.filter( cols, descr );
+  TEST_EQUAL( "number of features", a.first->size(), 200 );
+  TEST_EQUAL( "number of columnar features", b.first->size(), 200 );
+  TEST_EQUAL( "number of descriptors", b.second->size(), 200 );
+
+  const std::vector< feature_sptr > fa = a.first->features();
+  const std::vector< feature_sptr > fb = b.first->features();
+  const std::vector< descriptor_sptr > db = b.second->descriptors();
+  size_t num_different = 0;
+  for ( size_t i = 0; i < fa.size(); ++i )
+  {
+    const size_t index = static_cast< size_t >( db[i]->as_double()[0] );
+    num_different += ( fa[i]->loc() - fb[i]->loc() ).norm() > 1e-12 ? 1 : 0;
+    num_different += fb[i]->magnitude() != feat->features()[index]->magnitude() ? 1 : 0;
+  }
+  TEST_EQUAL( "columnar input gives the same features", num_different, 0 );
+}
+
+
+IMPLEMENT_TEST(bad_configuration)
+{
+  algorithms::filter_features_nms f;
+  config_block_sptr config = f.get_configuration();
+  config->set_value( "method", "fastest" );
+  TEST_EQUAL( "unknown method rejected", f.check_configuration( config ), false );
+
+  config = f.get_configuration();
+  config->set_value( "robustness", "1.5" );
+  TEST_EQUAL( "robustness above one rejected", f.check_configuration( config ), false );
+}
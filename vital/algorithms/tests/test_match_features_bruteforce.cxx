@@ -0,0 +1,320 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief tests for the brute-force match_features implementation
+ */
+
+#include <test_common.h>
+
+#include <vital/algorithms/match_features_bruteforce.h>
+#include <vital/algorithms/register_algorithms.h>
+#include <vital/types/descriptor_matrix_set.h>
+
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+using namespace kwiver::vital;
+
+namespace {
+
+// Make a set of pseudo-random float descriptors
+descriptor_set_sptr
+random_float_descriptors( size_t num, size_t dim )
+{
+  std::vector< descriptor_sptr > descs;
+  for ( size_t i = 0; i < num; ++i )
+  {
+    std::shared_ptr< descriptor_dynamic< float > >
+      d( new descriptor_dynamic< float >( dim ) );
+    for ( size_t j = 0; j < dim; ++j )
+    {
+      d->raw_data()[j] = static_cast< float >( std::rand() % 1000 ) / 100.0f;
+    }
+    descs.push_back( d );
+  }
+  return std::make_shared< simple_descriptor_set >( descs );
+}
+
+
+// Euclidean distance between two descriptors
+double
+distance( descriptor_sptr a, descriptor_sptr b )
+{
+  std::vector< double > va = a->as_double();
+  std::vector< double > vb = b->as_double();
+  double sum = 0.0;
+  for ( size_t i = 0; i < va.size(); ++i )
+  {
+    sum += ( va[i] - vb[i] ) * ( va[i] - vb[i] );
+  }
+  return std::sqrt( sum );
+}
+
+
+// Configure the matcher from a list of key and value pairs
+void
+configure( algorithms::match_features_bruteforce& m,
+           std::string const& key, std::string const& value )
+{
+  config_block_sptr config = m.get_configuration();
+  config->set_value( key, value );
+  if ( ! m.check_configuration( config ) )
+  {
+    TEST_ERROR( "configuration " << key << " = " << value << " rejected" );
+  }
+  m.set_configuration( config );
+}
+
+} // end anonymous namespace
+
+
+IMPLEMENT_TEST(nearest_neighbor)
+{
+  std::srand( 42 );
+  descriptor_set_sptr d1 = random_float_descriptors( 150, 20 );
+  descriptor_set_sptr d2 = random_float_descriptors( 230, 20 );
+  std::vector< descriptor_sptr > v1 = d1->descriptors();
+  std::vector< descriptor_sptr > v2 = d2->descriptors();
+
+  algorithms::match_features_bruteforce matcher;
+  // small tiles so that many tiles and parallel chunks are exercised
+  configure( matcher, "tile_size", "16" );
+
+  std::vector< double > dists;
+  match_set_sptr ms = matcher.match_descriptors( d1, d2, dists );
+  TEST_EQUAL( "one match per query", ms->size(), v1.size() );
+  TEST_EQUAL( "one distance per match", dists.size(), ms->size() );
+
+  std::vector< match > matches = ms->matches();
+  for ( size_t i = 0; i < matches.size(); ++i )
+  {
+    TEST_EQUAL( "matches ordered by query", matches[i].first, i );
+    double best = std::numeric_limits< double >::max();
+    for ( size_t j = 0; j < v2.size(); ++j )
+    {
+      best = std::min( best, distance( v1[i], v2[j] ) );
+    }
+    TEST_NEAR( "nearest neighbor distance", dists[i], best, 1e-4 );
+    TEST_NEAR( "distance of returned match",
+               distance( v1[i], v2[matches[i].second] ), best, 1e-4 );
+  }
+
+  // the features are not used by match()
+  match_set_sptr ms2 = matcher.match( feature_set_sptr(), d1, feature_set_sptr(), d2 );
+  TEST_EQUAL( "match() agrees with match_descriptors()",
+              ms2->matches() == matches, true );
+
+  // a matrix set of the same descriptors gives the same result
+  descriptor_set_sptr m1 = std::make_shared< descriptor_matrix_set< float > >( v1 );
+  descriptor_set_sptr m2 = std::make_shared< descriptor_matrix_set< float > >( v2 );
+  std::vector< double > mdists;
+  TEST_EQUAL( "matrix set result",
+              matcher.match_descriptors( m1, m2, mdists )->matches() == matches, true );
+}
+
+
+IMPLEMENT_TEST(knn_ratio_cross_check)
+{
+  // one dimensional descriptors make the expected result easy to see
+  const double values1[] = { 0.0, 10.0, 20.0 };
+  const double values2[] = { 0.9, 1.0, 10.5, 14.0, 21.0 };
+  std::vector< descriptor_sptr > v1, v2;
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    std::shared_ptr< descriptor_fixed< double, 1 > > d( new descriptor_fixed< double, 1 >() );
+    d->raw_data()[0] = values1[i];
+    v1.push_back( d );
+  }
+  for ( unsigned i = 0; i < 5; ++i )
+  {
+    std::shared_ptr< descriptor_fixed< double, 1 > > d( new descriptor_fixed< double, 1 >() );
+    d->raw_data()[0] = values2[i];
+    v2.push_back( d );
+  }
+  descriptor_set_sptr d1 = std::make_shared< simple_descriptor_set >( v1 );
+  descriptor_set_sptr d2 = std::make_shared< simple_descriptor_set >( v2 );
+
+  algorithms::match_features_bruteforce matcher;
+  configure( matcher, "k", "2" );
+  std::vector< double > dists;
+  std::vector< match > m = matcher.match_descriptors( d1, d2, dists )->matches();
+  TEST_EQUAL( "two matches per query", m.size(), 6 );
+  TEST_EQUAL( "query 0 best", m[0].second, 0 );
+  TEST_EQUAL( "query 0 second", m[1].second, 1 );
+  TEST_EQUAL( "query 1 best", m[2].second, 2 );
+  TEST_EQUAL( "query 1 second", m[3].second, 3 );
+  TEST_NEAR( "query 1 second distance", dists[3], 4.0, 1e-12 );
+
+  // query 0 is ambiguous (0.9 vs 1.0) and fails the ratio test
+  configure( matcher, "k", "1" );
+  configure( matcher, "ratio_threshold", "0.8" );
+  m = matcher.match_descriptors( d1, d2, dists )->matches();
+  TEST_EQUAL( "ratio test matches", m.size(), 2 );
+  TEST_EQUAL( "ratio test first query", m[0].first, 1 );
+  TEST_EQUAL( "ratio test second query", m[1].first, 2 );
+
+  // with the ratio test disabled, cross check keeps the mutual matches
+  // (0, 0), (1, 2) and (2, 4)
+  configure( matcher, "ratio_threshold", "0" );
+  configure( matcher, "cross_check", "true" );
+  m = matcher.match_descriptors( d1, d2, dists )->matches();
+  TEST_EQUAL( "cross check matches", m.size(), 3 );
+
+  // a maximum distance removes the match at distance 1
+  configure( matcher, "max_distance", "0.95" );
+  m = matcher.match_descriptors( d1, d2, dists )->matches();
+  TEST_EQUAL( "max distance matches", m.size(), 2 );
+  TEST_EQUAL( "max distance second match", m[1].second, 2 );
+}
+
+
+IMPLEMENT_TEST(hamming)
+{
+  std::srand( 7 );
+  const size_t dim = 32;
+  std::shared_ptr< descriptor_matrix_set< unsigned char > >
+    d1( new descriptor_matrix_set< unsigned char >( 40, dim ) );
+  std::shared_ptr< descriptor_matrix_set< unsigned char > >
+    d2( new descriptor_matrix_set< unsigned char >( 40, dim ) );
+  for ( size_t i = 0; i < 40; ++i )
+  {
+    for ( size_t j = 0; j < dim; ++j )
+    {
+      d1->row( i )[j] = static_cast< unsigned char >( std::rand() & 0xff );
+    }
+  }
+  // the second set is the first in reverse order with one bit flipped
+  for ( size_t i = 0; i < 40; ++i )
+  {
+    std::memcpy( d2->row( 39 - i ), d1->row( i ), dim );
+    d2->row( 39 - i )[i % dim] ^= 0x10;
+  }
+
+  algorithms::match_features_bruteforce matcher;
+  configure( matcher, "cross_check", "true" );
+  std::vector< double > dists;
+  std::vector< match > m = matcher.match_descriptors( d1, d2, dists )->matches();
+  TEST_EQUAL( "all descriptors matched", m.size(), 40 );
+  for ( size_t i = 0; i < m.size(); ++i )
+  {
+    TEST_EQUAL( "reversed index", m[i].second, 39 - m[i].first );
+    TEST_EQUAL( "one bit distance", dists[i], 1.0 );
+  }
+
+  // Hamming distance is rejected for non-binary descriptors
+  configure( matcher, "distance_metric", "hamming" );
+  descriptor_set_sptr f = random_float_descriptors( 5, 8 );
+  EXPECT_EXCEPTION( invalid_value,
+                    matcher.match_descriptors( f, f, dists ),
+                    "matching float descriptors with Hamming distance" );
+}
+
+
+IMPLEMENT_TEST(mixed_element_types)
+{
+  std::srand( 11 );
+  descriptor_set_sptr f = random_float_descriptors( 30, 16 );
+  std::vector< descriptor_sptr > v = f->descriptors();
+
+  // the same values as doubles and as bytes (rounded down)
+  std::vector< descriptor_sptr > vd, vb;
+  for ( size_t i = 0; i < v.size(); ++i )
+  {
+    std::vector< double > values = v[i]->as_double();
+    std::shared_ptr< descriptor_dynamic< double > >
+      d( new descriptor_dynamic< double >( values.size() ) );
+    std::shared_ptr< descriptor_dynamic< unsigned char > >
+      b( new descriptor_dynamic< unsigned char >( values.size() ) );
+    for ( size_t j = 0; j < values.size(); ++j )
+    {
+      d->raw_data()[j] = values[j];
+      b->raw_data()[j] = static_cast< unsigned char >( values[j] );
+    }
+    vd.push_back( d );
+    vb.push_back( b );
+  }
+  descriptor_set_sptr d = std::make_shared< simple_descriptor_set >( vd );
+  descriptor_set_sptr b = std::make_shared< simple_descriptor_set >( vb );
+
+  algorithms::match_features_bruteforce matcher;
+  std::vector< double > dists;
+  std::vector< match > m = matcher.match_descriptors( f, d, dists )->matches();
+  TEST_EQUAL( "float to double matches", m.size(), v.size() );
+  for ( size_t i = 0; i < m.size(); ++i )
+  {
+    TEST_EQUAL( "float to double identity", m[i].second, m[i].first );
+    TEST_NEAR( "float to double distance", dists[i], 0.0, 1e-6 );
+  }
+
+  // bytes are compared to floats with the Euclidean distance
+  m = matcher.match_descriptors( b, f, dists )->matches();
+  TEST_EQUAL( "byte to float matches", m.size(), v.size() );
+  for ( size_t i = 0; i < m.size(); ++i )
+  {
+    TEST_NEAR( "byte to float distance", dists[i],
+               distance( vb[m[i].first], v[m[i].second] ), 1e-4 );
+  }
+
+  configure( matcher, "distance_metric", "hamming" );
+  EXPECT_EXCEPTION( invalid_value,
+                    matcher.match_descriptors( b, f, dists ),
+                    "matching bytes to floats with Hamming distance" );
+}
+
+
+IMPLEMENT_TEST(registration)
+{
+  algorithms::register_algorithms( registrar::instance() );
+  TEST_EQUAL( "bruteforce is registered",
+              algo::match_features::has_impl_name( "bruteforce" ), true );
+  algo::match_features_sptr m = algo::match_features::create( "bruteforce" );
+  TEST_EQUAL( "created the bruteforce matcher", m->impl_name(), "bruteforce" );
+}
@@ -118,8 +118,8 @@ void vital_camera_map_get_map( vital_camera_map_t *cam_map,
 {
   STANDARD_CATCH(
     "C::camera_map::get_map", eh,
-    vital::camera_map::map_camera_t map_cams =
-      vital_c::CAM_MAP_SPTR_CACHE.get( cam_map )->cameras();
+    vital::camera_map::cameras_view_t map_cams =
+      vital_c::CAM_MAP_SPTR_CACHE.get( cam_map )->cameras_view();
 
     *length = map_cams.size();
     *frame_numbers = (int64_t*)malloc(sizeof(int64_t) * *length);
@@ -36,6 +36,7 @@
 #include "image.h"
 
 #include <vital/types/image.h>
+#include <vital/exceptions/image.h>
 
 #include <vital/bindings/c/helpers/c_utils.h>
 #include <iostream>
@@ -66,6 +67,25 @@ vital_image_t* vital_image_new_with_dim( size_t width, size_t height,
 }
 
 
+/// Create a new image with dimensions and pixel type, allocating memory
+vital_image_t* vital_image_new_with_dim_and_type( size_t width, size_t height,
+                                                  size_t depth, bool interleave,
+                                                  vital_image_pixel_type_t pixel_type,
+                                                  size_t pixel_num_bytes )
+{
+  STANDARD_CATCH(
+    "C::image:new_with_dim_and_type", 0,
+    kwiver::vital::image_pixel_traits pt(
+      static_cast<kwiver::vital::image_pixel_traits::pixel_type>( pixel_type ),
+      pixel_num_bytes );
+    return reinterpret_cast<vital_image_t*>(
+      new kwiver::vital::image( width, height, depth, interleave, pt )
+      );
+  );
+  return 0;
+}
+
+
 /// Create a new image from new data
 vital_image_t* vital_image_new_from_data( unsigned char const *first_pixel,
                                           size_t width, size_t height, size_t depth,
@@ -122,11 +142,29 @@ void vital_image_destroy( vital_image_t *image )
 };
 
 
+namespace {
+
+/// Return the image behind \a image, checking that it has byte pixels
+kwiver::vital::image const&
+byte_image( vital_image_t *image )
+{
+  kwiver::vital::image const& img = *reinterpret_cast<kwiver::vital::image*>( image );
+  if ( img.pixel_traits() != kwiver::vital::image_pixel_traits() )
+  {
+    throw kwiver::vital::image_type_mismatch_exception(
+      "byte pixel accessor used on an image of another pixel type" );
+  }
+  return img;
+}
+
+} // end anonymous namespace
+
+
 int vital_image_get_pixel2( vital_image_t *image, unsigned i, unsigned j )
 {
   STANDARD_CATCH(
-    "C::image::destroy", 0,
-    return reinterpret_cast<kwiver::vital::image*>( image )->operator()(i, j);
+    "C::image::get_pixel2", 0,
+    return byte_image( image )( i, j );
   );
   return 0;
 }
@@ -135,12 +173,69 @@ int vital_image_get_pixel2( vital_image_t *image, unsigned i, unsigned j )
 int vital_image_get_pixel3( vital_image_t *image, unsigned i, unsigned j, unsigned k )
 {
   STANDARD_CATCH(
-    "C::image::destroy", 0,
-    return reinterpret_cast<kwiver::vital::image*>( image )->operator()(i, j, k);
+    "C::image::get_pixel3", 0,
+    return byte_image( image )( i, j, k );
+  );
+  return 0;
+}
+
+namespace {
+
+template < typename T >
+double
+typed_pixel( kwiver::vital::image const& img, unsigned i, unsigned j, unsigned k )
+{
+  return static_cast< double >( kwiver::vital::image_of< T >( img )( i, j, k ) );
+}
+
+} // end anonymous namespace
+
+
+double vital_image_get_pixel3_value( vital_image_t *image, unsigned i, unsigned j, unsigned k )
+{
+  typedef kwiver::vital::image_pixel_traits traits_t;
+  STANDARD_CATCH(
+    "C::image::get_pixel3_value", 0,
+    kwiver::vital::image const& img = *reinterpret_cast<kwiver::vital::image*>( image );
+    traits_t const& pt = img.pixel_traits();
+    switch ( pt.type )
+    {
+      case traits_t::UNSIGNED:
+        switch ( pt.num_bytes )
+        {
+          case 1: return typed_pixel< uint8_t >( img, i, j, k );
+          case 2: return typed_pixel< uint16_t >( img, i, j, k );
+          case 4: return typed_pixel< uint32_t >( img, i, j, k );
+          case 8: return typed_pixel< uint64_t >( img, i, j, k );
+        }
+        break;
+      case traits_t::SIGNED:
+        switch ( pt.num_bytes )
+        {
+          case 1: return typed_pixel< int8_t >( img, i, j, k );
+          case 2: return typed_pixel< int16_t >( img, i, j, k );
+          case 4: return typed_pixel< int32_t >( img, i, j, k );
+          case 8: return typed_pixel< int64_t >( img, i, j, k );
+        }
+        break;
+      case traits_t::FLOAT:
+        switch ( pt.num_bytes )
+        {
+          case 4: return typed_pixel< float >( img, i, j, k );
+          case 8: return typed_pixel< double >( img, i, j, k );
+        }
+        break;
+      case traits_t::BOOL:
+        return typed_pixel< bool >( img, i, j, k );
+      default:
+        break;
+    }
+    throw kwiver::vital::image_type_mismatch_exception( "unsupported pixel type" );
   );
   return 0;
 }
 
+
 //
 // A little shortcut for defining accessors
 //
@@ -164,4 +259,26 @@ ACCESSOR( size_t, w_step )
 ACCESSOR( size_t, h_step )
 ACCESSOR( size_t, d_step )
 
+
+
+vital_image_pixel_type_t vital_image_pixel_type( vital_image_t *image )
+{
+  STANDARD_CATCH(
+    "C::image::pixel_type", 0,
+    return static_cast<vital_image_pixel_type_t>(
+      reinterpret_cast<kwiver::vital::image*>(image)->pixel_traits().type );
+  );
+  return VITAL_IMAGE_PIXEL_UNKNOWN;
+}
+
+
+size_t vital_image_pixel_num_bytes( vital_image_t *image )
+{
+  STANDARD_CATCH(
+    "C::image::pixel_num_bytes", 0,
+    return reinterpret_cast<kwiver::vital::image*>(image)->pixel_traits().num_bytes;
+  );
+  return 0;
+}
+
 #undef ACCESSOR
@@ -52,6 +52,15 @@ typedef unsigned char vital_image_byte;
 /// VITAL Image opaque structure
 typedef struct vital_image_s vital_image_t;
 
+/// The kind of number stored in each pixel
+typedef enum {
+  VITAL_IMAGE_PIXEL_UNKNOWN = 0,
+  VITAL_IMAGE_PIXEL_UNSIGNED = 1,
+  VITAL_IMAGE_PIXEL_SIGNED = 2,
+  VITAL_IMAGE_PIXEL_FLOAT = 3,
+  VITAL_IMAGE_PIXEL_BOOL = 4
+} vital_image_pixel_type_t;
+
 
 /// Create a new, empty image
 VITAL_C_EXPORT
@@ -62,6 +71,23 @@ VITAL_C_EXPORT
 vital_image_t* vital_image_new_with_dim( size_t width, size_t height,
                                          size_t depth, bool interleave );
 
+/// Create a new image with dimensions and pixel type, allocating memory
+/**
+ * @param width Width of image in pixels
+ * @param height Height of image in pixels
+ * @param depth Number of planes in image
+ * @param interleave Set if the pixels are interleaved
+ * @param pixel_type The kind of number stored in each pixel
+ * @param pixel_num_bytes The number of bytes in each pixel value
+ *
+ * @return Opaque pointer to new image
+ */
+VITAL_C_EXPORT
+vital_image_t* vital_image_new_with_dim_and_type( size_t width, size_t height,
+                                                  size_t depth, bool interleave,
+                                                  vital_image_pixel_type_t pixel_type,
+                                                  size_t pixel_num_bytes );
+
 
 /// Create a new image from new data
 /**
@@ -129,12 +155,38 @@ size_t vital_image_h_step(  vital_image_t* image );
 VITAL_C_EXPORT
 size_t vital_image_d_step(  vital_image_t* image );
 
+/// Get the kind of number stored in each pixel
+VITAL_C_EXPORT
+vital_image_pixel_type_t vital_image_pixel_type( vital_image_t* image );
+
+/// Get the number of bytes in each pixel value
+VITAL_C_EXPORT
+size_t vital_image_pixel_num_bytes( vital_image_t* image );
+
+/// Get a pixel value of an image with byte pixels
+/**
+ * This fails and returns 0 for images of other pixel types; use
+ * vital_image_get_pixel3_value() for those.
+ */
 VITAL_C_EXPORT
 int vital_image_get_pixel2( vital_image_t *image, unsigned i, unsigned j );
 
+/// Get a pixel value of an image with byte pixels
+/**
+ * This fails and returns 0 for images of other pixel types; use
+ * vital_image_get_pixel3_value() for those.
+ */
 VITAL_C_EXPORT
 int vital_image_get_pixel3( vital_image_t *image, unsigned i, unsigned j, unsigned k );
 
+/// Get a pixel value of an image of any pixel type
+/**
+ * Integer and bool pixel values are converted to double, which is exact
+ * for values of up to 53 bits.
+ */
+VITAL_C_EXPORT
+double vital_image_get_pixel3_value( vital_image_t *image, unsigned i, unsigned j, unsigned k );
+
 #ifdef __cplusplus
 }
 #endif
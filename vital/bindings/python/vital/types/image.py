@@ -45,6 +45,13 @@ class Image (VitalObject):
     vital::image interface class
     """
 
+    # Kinds of number stored in each pixel, as returned by pixel_type()
+    PIXEL_UNKNOWN = 0
+    PIXEL_UNSIGNED = 1
+    PIXEL_SIGNED = 2
+    PIXEL_FLOAT = 3
+    PIXEL_BOOL = 4
+
     @classmethod
     def from_image(cls, other_image):
         """
@@ -97,6 +104,7 @@ class Image (VitalObject):
     # TODO: Need to add class-method from_numpy( cls, numpy_arry )
 
     def __init__(self, width=None, height=None, depth=1, interleave=False,
+                 pixel_type=PIXEL_UNSIGNED, pixel_num_bytes=1,
                  from_cptr=None):
         """
         Construct an empty image of no, or defined, dimensions.
@@ -104,20 +112,34 @@ class Image (VitalObject):
         If width or height are None, we construct and return an empty image of
         uninitialized size.
 
+        :param pixel_type: The kind of number stored in each pixel, one of the
+            PIXEL_* constants
+        :param pixel_num_bytes: The number of bytes in each pixel value
+
         """
-        super(Image, self).__init__(from_cptr, width, height, depth, interleave)
+        super(Image, self).__init__(from_cptr, width, height, depth, interleave,
+                                    pixel_type, pixel_num_bytes)
 
-    def _new(self, width, height, depth, interleave):
+    def _new(self, width, height, depth, interleave, pixel_type,
+             pixel_num_bytes):
         if width is None or height is None:
             img_new = self.VITAL_LIB.vital_image_new
             img_new.restype = self.C_TYPE_PTR
             return img_new()
-        else:
+        elif (pixel_type, pixel_num_bytes) == (self.PIXEL_UNSIGNED, 1):
             img_new = self.VITAL_LIB.vital_image_new_with_dim
             img_new.argtypes = [ctypes.c_size_t, ctypes.c_size_t,
                                 ctypes.c_size_t, ctypes.c_bool]
             img_new.restype = self.C_TYPE_PTR
             return img_new(width, height, depth, interleave)
+        else:
+            img_new = self.VITAL_LIB.vital_image_new_with_dim_and_type
+            img_new.argtypes = [ctypes.c_size_t, ctypes.c_size_t,
+                                ctypes.c_size_t, ctypes.c_bool,
+                                ctypes.c_int, ctypes.c_size_t]
+            img_new.restype = self.C_TYPE_PTR
+            return img_new(width, height, depth, interleave,
+                           pixel_type, pixel_num_bytes)
 
     def _destroy(self):
         img_destroy = self.VITAL_LIB.vital_image_destroy
@@ -184,6 +206,34 @@ class Image (VitalObject):
         """
         return self.VITAL_LIB.vital_image_d_step(self)
 
+    def pixel_type(self):
+        """
+        Get the kind of number stored in each pixel: 1 for unsigned, 2 for
+        signed, 3 for floating point and 4 for bool, or 0 if unknown
+        """
+        return self.VITAL_LIB.vital_image_pixel_type(self)
+
+    def pixel_num_bytes(self):
+        """
+        Get the number of bytes in each pixel value
+        """
+        pixel_num_bytes = self.VITAL_LIB.vital_image_pixel_num_bytes
+        pixel_num_bytes.restype = ctypes.c_size_t
+        return pixel_num_bytes(self)
+
+    def get_pixel(self, i, j, k=0):
+        """
+        Get the value of pixel (i, j) in plane k, for any pixel type
+
+        :return: The pixel value; integer and bool values are converted to
+            float, which is exact for values of up to 53 bits
+        :rtype: float
+        """
+        get_value = self.VITAL_LIB.vital_image_get_pixel3_value
+        get_value.argtypes = [self.C_TYPE_PTR, ctypes.c_uint, ctypes.c_uint,
+                              ctypes.c_uint]
+        get_value.restype = ctypes.c_double
+        return get_value(self, i, j, k)
 
 
     # ------------------------------------------------------------------
@@ -76,4 +76,18 @@ image_size_mismatch_exception
 {
 }
 
+
+// ------------------------------------------------------------------
+image_type_mismatch_exception
+::image_type_mismatch_exception(std::string message) VITAL_NOTHROW
+  : m_message(message)
+{
+  m_what = message;
+}
+
+image_type_mismatch_exception
+::~image_type_mismatch_exception() VITAL_NOTHROW
+{
+}
+
 } } // end vital namespace
@@ -92,6 +92,29 @@ public:
          m_given_h;
 };
 
+
+// ------------------------------------------------------------------
+/// Exception for image pixel type mismatch
+/**
+ * For when an image is accessed as pixels of a type other than the one
+ * it stores.
+ */
+class VITAL_EXPORT image_type_mismatch_exception
+  : public image_exception
+{
+public:
+  /// Constructor
+  /**
+   * \param message     Description of circumstances surrounding error.
+   */
+  image_type_mismatch_exception(std::string message) VITAL_NOTHROW;
+  /// Destructor
+  virtual ~image_type_mismatch_exception() VITAL_NOTHROW;
+
+  /// Given error message string
+  std::string m_message;
+};
+
 } } // end namespace
 
 #endif // VITAL_CORE_EXCEPTIONS_IMAGE_H
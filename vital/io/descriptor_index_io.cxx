@@ -0,0 +1,128 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of file IO functions for a \ref kwiver::vital::descriptor_index
+ */
+
+#include "descriptor_index_io.h"
+
+#include <fstream>
+
+#include <vital/exceptions.h>
+#include <kwiversys/SystemTools.hxx>
+
+namespace kwiver {
+namespace vital {
+
+
+/// Read in a descriptor index file, producing a descriptor_index
+descriptor_index_sptr
+read_descriptor_index_file( path_t const& file_path )
+{
+  // Check that file exists
+  if ( ! kwiversys::SystemTools::FileExists( file_path ) )
+  {
+    throw file_not_found_exception( file_path, "File does not exist." );
+  }
+  else if ( kwiversys::SystemTools::FileIsDirectory( file_path ) )
+  {
+    throw file_not_found_exception( file_path,
+         "Path given doesn't point to a regular file!" );
+  }
+
+  std::ifstream input_stream( file_path.c_str(), std::fstream::in | std::fstream::binary );
+  if ( ! input_stream )
+  {
+    throw file_not_read_exception( file_path,
+          "Could not open file at given path." );
+  }
+
+  try
+  {
+    return descriptor_index::read( input_stream );
+  }
+  catch ( invalid_data const& e )
+  {
+    throw file_not_read_exception( file_path, e.what() );
+  }
+} // read_descriptor_index_file
+
+
+/// Output the given \c descriptor_index object to the specified file path
+void
+write_descriptor_index_file( descriptor_index_sptr const& index,
+                             path_t const&                file_path )
+{
+  if ( ! index )
+  {
+    throw file_write_exception( file_path,
+          "No descriptor index given!" );
+  }
+
+  // If the given path is a directory, we obviously can't write to it.
+  if ( kwiversys::SystemTools::FileIsDirectory( file_path ) )
+  {
+    throw file_write_exception( file_path,
+          "Path given is a directory, can not write file." );
+  }
+
+  // Check that the directory of the given filepath exists, creating necessary
+  // directories where needed.
+  std::string parent_dir = kwiversys::SystemTools::GetFilenamePath(
+    kwiversys::SystemTools::CollapseFullPath( file_path ) );
+  if ( ! kwiversys::SystemTools::FileIsDirectory( parent_dir ) )
+  {
+    if ( ! kwiversys::SystemTools::MakeDirectory( parent_dir ) )
+    {
+      throw file_write_exception( parent_dir,
+            "Attempted directory creation, but no directory created!" );
+    }
+  }
+
+  std::ofstream ofile( file_path.c_str(), std::fstream::out | std::fstream::binary );
+  if ( ! ofile )
+  {
+    throw file_write_exception( file_path, "Could not open file for writing." );
+  }
+
+  try
+  {
+    index->write( ofile );
+  }
+  catch ( invalid_data const& e )
+  {
+    throw file_write_exception( file_path, e.what() );
+  }
+  ofile.close();
+} // write_descriptor_index_file
+
+} } // end namespace
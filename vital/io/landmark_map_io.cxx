@@ -103,7 +103,7 @@ write_ply_file( landmark_map_sptr const&  landmarks,
                                                      "property uint observations\n"
                                                      "end_header\n";
 
-  landmark_map::map_landmark_t lm_map = landmarks->landmarks();
+  const landmark_map::landmarks_view_t lm_map = landmarks->landmarks_view();
   typedef  landmark_map::map_landmark_t::value_type lm_map_val_t;
   VITAL_FOREACH( lm_map_val_t const& p, lm_map )
   {
@@ -141,8 +141,8 @@ write_track_file( track_set_sptr const& tracks,
 
   // open output file and write the tracks
   std::ofstream ofile( file_path.c_str() );
-  std::vector< vital::track_sptr > trks = tracks->tracks();
-  VITAL_FOREACH( vital::track_sptr t, trks )
+  const vital::track_set::tracks_view_t trks = tracks->tracks_view();
+  VITAL_FOREACH( vital::track_sptr const& t, trks )
   {
     VITAL_FOREACH( vital::track::track_state const& s, *t )
     {
@@ -35,7 +35,10 @@
 
 #include <test_common.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 #include <vital/types/camera.h>
 #include <vital/io/camera_io.h>
 
@@ -96,3 +99,88 @@ IMPLEMENT_TEST(projection)
   TEST_NEAR("camera projection = matrix multiplication",
              (cam.project(test_pt) - proj_pt).norm(), 0.0, 1e-12);
 }
+
+
+IMPLEMENT_TEST(batch_projection)
+{
+  using namespace kwiver::vital;
+  simple_camera_intrinsics::vector_t d( 5 );
+  d << -0.1, 0.02, 0.001, -0.002, 0.003;
+  simple_camera_intrinsics K( 1000, vector_2d( 300, 400 ), 0.9, 0.5, d );
+  simple_camera cam( vector_3d( 3, -4, 7 ), rotation_d(), K );
+  cam.look_at( vector_3d( 0, 1, -2 ) );
+
+  // more points than one block, with a partial last block
+  const size_t n = 1200;
+  std::vector< double > pts( 3 * n );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    pts[3 * i] = ( i % 37 ) * 0.1 - 2.0;
+    pts[3 * i + 1] = ( i % 23 ) * 0.2 - 1.0;
+    pts[3 * i + 2] = ( i % 11 ) * 0.3 - 3.0;
+  }
+  std::vector< double > pixels( 2 * n ), depths( n );
+  cam.project( &pts[0], n, &pixels[0] );
+  cam.depth( &pts[0], n, &depths[0] );
+
+  double max_pixel_err = 0.0, max_depth_err = 0.0;
+  for ( size_t i = 0; i < n; ++i )
+  {
+    const vector_3d pt( pts[3 * i], pts[3 * i + 1], pts[3 * i + 2] );
+    const vector_2d expected = cam.project( pt );
+    max_pixel_err = std::max( max_pixel_err,
+                              ( expected - vector_2d( pixels[2 * i], pixels[2 * i + 1] ) ).norm() );
+    max_depth_err = std::max( max_depth_err, std::abs( cam.depth( pt ) - depths[i] ) );
+  }
+  TEST_NEAR( "batch projection matches project()", max_pixel_err, 0.0, 1e-9 );
+  TEST_NEAR( "batch depth matches depth()", max_depth_err, 0.0, 1e-12 );
+
+  // without distortion coefficients
+  cam.set_intrinsics( camera_intrinsics_sptr( new simple_camera_intrinsics( 800, vector_2d( 320, 240 ) ) ) );
+  cam.project( &pts[0], n, &pixels[0] );
+  const vector_3d last( pts[3 * n - 3], pts[3 * n - 2], pts[3 * n - 1] );
+  TEST_NEAR( "batch projection without distortion",
+             ( cam.project( last ) - vector_2d( pixels[2 * n - 2], pixels[2 * n - 1] ) ).norm(),
+             0.0, 1e-9 );
+}
+
+
+IMPLEMENT_TEST(cached_matrix)
+{
+  using namespace kwiver::vital;
+  simple_camera cam( vector_3d( 1, 2, 3 ), rotation_d(),
+                     simple_camera_intrinsics( 1000, vector_2d( 300, 400 ) ) );
+
+  // the matrix computed by the base class from the accessors
+  const simple_camera& c = cam;
+  auto expected = [&c] () { return c.camera::as_matrix(); };
+
+  TEST_NEAR( "initial matrix", ( cam.as_matrix() - expected() ).norm(), 0.0, 1e-12 );
+
+  cam.set_center( vector_3d( -2, 5, 1 ) );
+  TEST_NEAR( "matrix after set_center",
+             ( cam.as_matrix() - expected() ).norm(), 0.0, 1e-12 );
+
+  cam.look_at( vector_3d( 0, 0, 0 ) );
+  TEST_NEAR( "matrix after look_at",
+             ( cam.as_matrix() - expected() ).norm(), 0.0, 1e-12 );
+
+  cam.set_translation( vector_3d( 0.5, -1, 4 ) );
+  TEST_NEAR( "matrix after set_translation",
+             ( cam.as_matrix() - expected() ).norm(), 0.0, 1e-12 );
+
+  const simple_camera copy( cam );
+  cam.set_intrinsics( camera_intrinsics_sptr( new simple_camera_intrinsics( 500, vector_2d( 10, 20 ) ) ) );
+  TEST_NEAR( "matrix after set_intrinsics",
+             ( cam.as_matrix() - expected() ).norm(), 0.0, 1e-12 );
+  TEST_NEAR( "copy keeps its own matrix",
+             ( copy.as_matrix() - copy.camera::as_matrix() ).norm(), 0.0, 1e-12 );
+
+  // the matrix projects like project() for a camera without distortion
+  const vector_3d pt( 0.3, -0.2, 1.5 );
+  const vector_3d h = cam.as_matrix() * pt.homogeneous();
+  TEST_NEAR( "matrix projection matches project()",
+             ( h.hnormalized() - cam.project( pt ) ).norm(), 0.0, 1e-9 );
+  TEST_EQUAL( "get_intrinsics does not add a reference",
+              cam.get_intrinsics().use_count(), 1 );
+}
@@ -36,6 +36,12 @@
 #include <test_common.h>
 
 #include <vital/types/camera_intrinsics.h>
+#include <vital/types/lens_distortion.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
 
 #define TEST_ARGS ()
 
@@ -86,3 +92,132 @@ IMPLEMENT_TEST(map)
             (mapped_from_3d - mapped_test_gt).norm(), 0.0, 1e-12);
 
 }
+
+
+IMPLEMENT_TEST(batch_distortion)
+{
+  using namespace kwiver::vital;
+  const double coeffs[] = { -0.2, 0.05, 0.002, -0.003, -0.01, 0.01, -0.002, 0.001 };
+  const int num_coeffs[] = { 0, 1, 2, 3, 4, 5, 7, 8 };
+
+  // a grid of points over the field of view, more than one block
+  std::vector< double > pts;
+  for ( int j = -20; j <= 20; ++j )
+  {
+    for ( int i = -30; i <= 30; ++i )
+    {
+      pts.push_back( i * 0.02 );
+      pts.push_back( j * 0.02 );
+    }
+  }
+  const size_t n = pts.size() / 2;
+
+  for ( unsigned t = 0; t < sizeof( num_coeffs ) / sizeof( int ); ++t )
+  {
+    simple_camera_intrinsics::vector_t d( num_coeffs[t] );
+    for ( int k = 0; k < num_coeffs[t]; ++k )
+    {
+      d[k] = coeffs[k];
+    }
+    simple_camera_intrinsics K( 1000, vector_2d( 640, 480 ), 0.9, 0.2, d );
+
+    std::vector< double > dist( 2 * n ), undist( 2 * n ), pixels( 2 * n ), unmapped( 2 * n );
+    K.distort_points( &pts[0], n, &dist[0] );
+    K.undistort_points( &dist[0], n, &undist[0] );
+    K.map_points( &pts[0], n, &pixels[0] );
+    K.unmap_points( &pixels[0], n, &unmapped[0] );
+
+    double dist_err = 0.0, undist_err = 0.0, round_trip_err = 0.0, unmap_err = 0.0;
+    for ( size_t i = 0; i < n; ++i )
+    {
+      const vector_2d pt( pts[2 * i], pts[2 * i + 1] );
+      const vector_2d dpt( dist[2 * i], dist[2 * i + 1] );
+      const vector_2d upt( undist[2 * i], undist[2 * i + 1] );
+      dist_err = std::max( dist_err, ( K.distort( pt ) - dpt ).norm() );
+      undist_err = std::max( undist_err, ( K.undistort( dpt ) - upt ).norm() );
+      round_trip_err = std::max( round_trip_err, ( upt - pt ).norm() );
+      unmap_err = std::max( unmap_err,
+                            ( K.unmap( K.map( pt ) ) -
+                              vector_2d( unmapped[2 * i], unmapped[2 * i + 1] ) ).norm() );
+    }
+    std::cout << num_coeffs[t] << " coefficients" << std::endl;
+    TEST_NEAR( "distort_points matches distort()", dist_err, 0.0, 1e-12 );
+    TEST_NEAR( "undistort_points matches undistort()", undist_err, 0.0, 1e-10 );
+    TEST_NEAR( "undistort_points inverts distort_points", round_trip_err, 0.0, 1e-10 );
+    TEST_NEAR( "unmap_points matches unmap()", unmap_err, 0.0, 1e-10 );
+
+    // in place
+    K.undistort_points( &dist[0], n, &dist[0] );
+    TEST_EQUAL( "undistort_points in place", dist == undist, true );
+  }
+}
+
+
+namespace {
+
+// Compare intrinsics with a fixed model to simple intrinsics with the same coefficients
+template < typename Model >
+void
+test_lens_model( std::string const& name )
+{
+  using namespace kwiver::vital;
+  const double coeffs[] = { -0.2, 0.05, 0.002, -0.003, -0.01, 0.01, -0.002, 0.001 };
+  simple_camera_intrinsics::vector_t d( Model::num_coeffs );
+  typename lens_camera_intrinsics< Model >::coeffs_t c;
+  for ( unsigned k = 0; k < Model::num_coeffs; ++k )
+  {
+    d[k] = c[k] = coeffs[k];
+  }
+  const simple_camera_intrinsics simple( 800, vector_2d( 320, 240 ), 0.9, 0.1, d );
+  const lens_camera_intrinsics< Model > fixed( 800, vector_2d( 320, 240 ), 0.9, 0.1, c );
+  const lens_camera_intrinsics< Model > converted( simple );
+
+  TEST_EQUAL( name + " coefficient count", fixed.dist_coeffs().size(), Model::num_coeffs );
+  TEST_EQUAL( name + " converted coefficients",
+              converted.dist_coeffs() == simple.dist_coeffs(), true );
+  TEST_EQUAL( name + " clone keeps the model",
+              dynamic_cast< lens_camera_intrinsics< Model >* >( fixed.clone().get() ) != 0, true );
+
+  double dist_err = 0.0, undist_err = 0.0, map_err = 0.0;
+  std::vector< double > pts;
+  for ( int j = -10; j <= 10; ++j )
+  {
+    for ( int i = -10; i <= 10; ++i )
+    {
+      const vector_2d pt( i * 0.05, j * 0.04 );
+      pts.push_back( pt.x() );
+      pts.push_back( pt.y() );
+      const vector_2d dpt = simple.distort( pt );
+      dist_err = std::max( dist_err, ( fixed.distort( pt ) - dpt ).norm() );
+      undist_err = std::max( undist_err, ( fixed.undistort( dpt ) - pt ).norm() );
+      map_err = std::max( map_err, ( fixed.unmap( simple.map( pt ) ) - pt ).norm() );
+    }
+  }
+  TEST_NEAR( name + " distort matches simple intrinsics", dist_err, 0.0, 1e-12 );
+  TEST_NEAR( name + " undistort inverts distort", undist_err, 0.0, 1e-10 );
+  TEST_NEAR( name + " unmap inverts simple map", map_err, 0.0, 1e-10 );
+
+  const size_t n = pts.size() / 2;
+  std::vector< double > a( 2 * n ), b( 2 * n );
+  fixed.map_points( &pts[0], n, &a[0] );
+  simple.map_points( &pts[0], n, &b[0] );
+  TEST_EQUAL( name + " map_points matches simple intrinsics", a == b, true );
+}
+
+} // end anonymous namespace
+
+
+IMPLEMENT_TEST(lens_models)
+{
+  using namespace kwiver::vital;
+  test_lens_model< no_distortion >( "none" );
+  test_lens_model< lens_distortion< 1 > >( "radial k1" );
+  test_lens_model< radial_k2_distortion >( "radial k2" );
+  test_lens_model< lens_distortion< 4 > >( "radial and tangential" );
+  test_lens_model< brown_distortion >( "Brown" );
+  test_lens_model< rational_distortion >( "rational" );
+
+  TEST_EQUAL( "terms of 3 coefficients", lens_distortion_terms( 3 ), 2 );
+  TEST_EQUAL( "terms of 7 coefficients", lens_distortion_terms( 7 ), 5 );
+  TEST_EQUAL( "terms of 12 coefficients", lens_distortion_terms( 12 ), 8 );
+}
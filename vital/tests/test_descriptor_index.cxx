@@ -0,0 +1,348 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief core descriptor_index tests
+ */
+
+#include <test_common.h>
+
+#include <vital/exceptions/io.h>
+#include <vital/io/descriptor_index_io.h>
+#include <vital/types/descriptor_index.h>
+#include <vital/types/descriptor_matrix_set.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+using namespace kwiver::vital;
+
+namespace {
+
+// Make a set of pseudo-random float descriptors
+std::shared_ptr< descriptor_matrix_set< float > >
+random_float_descriptors( size_t num, size_t dim )
+{
+  std::shared_ptr< descriptor_matrix_set< float > >
+    ds( new descriptor_matrix_set< float >( num, dim ) );
+  for ( size_t i = 0; i < num; ++i )
+  {
+    for ( size_t j = 0; j < dim; ++j )
+    {
+      ds->row( i )[j] = static_cast< float >( std::rand() % 1000 ) / 100.0f;
+    }
+  }
+  return ds;
+}
+
+
+// Make a set of pseudo-random binary descriptors
+std::shared_ptr< descriptor_matrix_set< unsigned char > >
+random_binary_descriptors( size_t num, size_t dim )
+{
+  std::shared_ptr< descriptor_matrix_set< unsigned char > >
+    ds( new descriptor_matrix_set< unsigned char >( num, dim ) );
+  for ( size_t i = 0; i < num; ++i )
+  {
+    for ( size_t j = 0; j < dim; ++j )
+    {
+      ds->row( i )[j] = static_cast< unsigned char >( std::rand() & 0xff );
+    }
+  }
+  return ds;
+}
+
+
+// Exact distances from a query to all rows of a set of descriptor sets
+std::vector< double >
+all_distances( std::vector< descriptor_sptr > const& rows, descriptor_sptr const& q )
+{
+  std::vector< double > qv = q->as_double();
+  std::vector< double > dists;
+  for ( size_t i = 0; i < rows.size(); ++i )
+  {
+    std::vector< double > rv = rows[i]->as_double();
+    double sum = 0.0;
+    for ( size_t j = 0; j < qv.size(); ++j )
+    {
+      sum += ( qv[j] - rv[j] ) * ( qv[j] - rv[j] );
+    }
+    dists.push_back( std::sqrt( sum ) );
+  }
+  return dists;
+}
+
+} // end anonymous namespace
+
+
+IMPLEMENT_TEST(kd_forest_exact)
+{
+  std::srand( 11 );
+  kd_forest_descriptor_index::parameters params;
+  params.max_checks = 0;
+  kd_forest_descriptor_index index( params );
+
+  // three batches exercise the initial build, leaf insertion and a rebuild
+  std::vector< descriptor_sptr > rows;
+  const size_t batches[] = { 300, 100, 400 };
+  for ( unsigned b = 0; b < 3; ++b )
+  {
+    descriptor_set_sptr ds = random_float_descriptors( batches[b], 12 );
+    TEST_EQUAL( "first index of batch", index.add( ds ), rows.size() );
+    std::vector< descriptor_sptr > d = ds->descriptors();
+    rows.insert( rows.end(), d.begin(), d.end() );
+  }
+  TEST_EQUAL( "index size", index.size(), rows.size() );
+  TEST_EQUAL( "index dim", index.dim(), 12 );
+
+  descriptor_set_sptr queries = random_float_descriptors( 50, 12 );
+  std::vector< descriptor_neighbors > result = index.nearest( queries, 3 );
+  TEST_EQUAL( "one result per query", result.size(), 50 );
+
+  std::vector< descriptor_sptr > qv = queries->descriptors();
+  for ( size_t i = 0; i < qv.size(); ++i )
+  {
+    std::vector< double > dists = all_distances( rows, qv[i] );
+    std::sort( dists.begin(), dists.end() );
+    TEST_EQUAL( "three neighbors", result[i].size(), 3 );
+    for ( size_t n = 0; n < result[i].size(); ++n )
+    {
+      TEST_NEAR( "exact neighbor distance", result[i][n].distance, dists[n], 1e-4 );
+    }
+  }
+
+  EXPECT_EXCEPTION( invalid_value,
+                    index.add( random_float_descriptors( 2, 5 ) ),
+                    "adding descriptors of a different length" );
+}
+
+
+IMPLEMENT_TEST(kd_forest_approximate)
+{
+  std::srand( 5 );
+  kd_forest_descriptor_index index;
+  descriptor_set_sptr ds = random_float_descriptors( 2000, 32 );
+  index.add( ds );
+
+  // an indexed descriptor is always found in the first leaf of each tree
+  std::vector< descriptor_neighbors > result = index.nearest( ds, 1 );
+  bool all_found = true;
+  for ( size_t i = 0; i < result.size(); ++i )
+  {
+    all_found = all_found && result[i].size() == 1 &&
+                result[i][0].distance == 0.0 && result[i][0].index == i;
+  }
+  TEST_EQUAL( "indexed descriptors find themselves", all_found, true );
+
+  descriptor_neighbors single = index.nearest( ds->descriptors()[17], 1 );
+  TEST_EQUAL( "single query", single[0].index, 17 );
+}
+
+
+IMPLEMENT_TEST(lsh)
+{
+  std::srand( 3 );
+  const size_t dim = 32;
+  lsh_descriptor_index index;
+  std::shared_ptr< descriptor_matrix_set< unsigned char > > ds =
+    random_binary_descriptors( 1000, dim );
+  index.add( ds );
+  TEST_EQUAL( "index size", index.size(), 1000 );
+
+  // queries are indexed descriptors with two bits flipped
+  std::shared_ptr< descriptor_matrix_set< unsigned char > >
+    queries( new descriptor_matrix_set< unsigned char >( 200, dim ) );
+  for ( size_t i = 0; i < 200; ++i )
+  {
+    std::memcpy( queries->row( i ), ds->row( i * 5 ), dim );
+    queries->row( i )[i % dim] ^= 0x01;
+    queries->row( i )[( i + 7 ) % dim] ^= 0x80;
+  }
+
+  std::vector< descriptor_neighbors > result = index.nearest( queries, 2 );
+  size_t found = 0;
+  for ( size_t i = 0; i < result.size(); ++i )
+  {
+    if ( ! result[i].empty() && result[i][0].index == i * 5 )
+    {
+      TEST_EQUAL( "two bit distance", result[i][0].distance, 2.0 );
+      ++found;
+    }
+  }
+  std::cout << "found " << found << " of " << result.size() << std::endl;
+  TEST_EQUAL( "recall of perturbed descriptors", found >= 190, true );
+
+  // incremental additions are searchable
+  std::shared_ptr< descriptor_matrix_set< unsigned char > > more =
+    random_binary_descriptors( 10, dim );
+  TEST_EQUAL( "first index of second batch", index.add( more ), 1000 );
+  descriptor_neighbors single = index.nearest( more->at( 4 ), 1 );
+  TEST_EQUAL( "added descriptor found", single[0].index, 1004 );
+  TEST_EQUAL( "added descriptor distance", single[0].distance, 0.0 );
+
+  // descriptors of other element types are rejected
+  descriptor_set_sptr floats = random_float_descriptors( 10, dim );
+  EXPECT_EXCEPTION( invalid_value, index.add( floats ),
+                    "adding float descriptors" );
+  TEST_EQUAL( "index size after rejected add", index.size(), 1010 );
+  EXPECT_EXCEPTION( invalid_value, index.nearest( floats, 1 ),
+                    "querying with float descriptors" );
+}
+
+
+IMPLEMENT_TEST(serialization)
+{
+  std::srand( 9 );
+  kd_forest_descriptor_index kd;
+  kd.add( random_float_descriptors( 400, 8 ) );
+  lsh_descriptor_index lsh;
+  lsh.add( random_binary_descriptors( 400, 16 ) );
+
+  descriptor_set_sptr fq = random_float_descriptors( 20, 8 );
+  descriptor_set_sptr bq = random_binary_descriptors( 20, 16 );
+
+  std::stringstream kd_stream;
+  kd.write( kd_stream );
+  descriptor_index_sptr kd2 = descriptor_index::read( kd_stream );
+  TEST_EQUAL( "k-d forest type",
+              std::dynamic_pointer_cast< kd_forest_descriptor_index >( kd2 ) != 0, true );
+  TEST_EQUAL( "k-d forest size", kd2->size(), 400 );
+
+  std::stringstream lsh_stream;
+  lsh.write( lsh_stream );
+  descriptor_index_sptr lsh2 = descriptor_index::read( lsh_stream );
+  TEST_EQUAL( "lsh type",
+              std::dynamic_pointer_cast< lsh_descriptor_index >( lsh2 ) != 0, true );
+
+  // the read indices give identical results
+  std::vector< descriptor_neighbors > a = kd.nearest( fq, 4 );
+  std::vector< descriptor_neighbors > b = kd2->nearest( fq, 4 );
+  std::vector< descriptor_neighbors > c = lsh.nearest( bq, 4 );
+  std::vector< descriptor_neighbors > d = lsh2->nearest( bq, 4 );
+  bool same = true;
+  for ( size_t i = 0; i < a.size(); ++i )
+  {
+    same = same && a[i].size() == b[i].size() && c[i].size() == d[i].size();
+    for ( size_t n = 0; same && n < a[i].size(); ++n )
+    {
+      same = a[i][n].index == b[i][n].index;
+    }
+    for ( size_t n = 0; same && n < c[i].size(); ++n )
+    {
+      same = c[i][n].index == d[i][n].index;
+    }
+  }
+  TEST_EQUAL( "identical results after reading", same, true );
+
+  // truncated and foreign streams are rejected
+  std::string bytes = kd_stream.str();
+  std::stringstream truncated( bytes.substr( 0, bytes.size() / 2 ) );
+  EXPECT_EXCEPTION( invalid_data, descriptor_index::read( truncated ),
+                    "reading a truncated stream" );
+  std::stringstream foreign( "not an index" );
+  EXPECT_EXCEPTION( invalid_data, descriptor_index::read( foreign ),
+                    "reading a stream that is not an index" );
+
+  // corrupt counts of trees and tables are rejected before allocating them
+  const uint32_t huge = 0xffffffff;
+  const size_t params_offset = 12;
+  std::string bad_params = bytes;
+  bad_params.replace( params_offset, 4, reinterpret_cast< char const* >( &huge ), 4 );
+  std::stringstream bad_params_stream( bad_params );
+  EXPECT_EXCEPTION( invalid_data, descriptor_index::read( bad_params_stream ),
+                    "reading a k-d forest with too many trees" );
+
+  // the tree count follows the parameters, dimensions and data
+  const size_t trees_offset = params_offset + 16 + 8 + 8 + 8 + 400 * 8 * sizeof( float );
+  uint32_t stored_trees = 0;
+  bytes.copy( reinterpret_cast< char* >( &stored_trees ), 4, trees_offset );
+  TEST_EQUAL( "stored tree count", stored_trees, kd.get_parameters().num_trees );
+  const uint32_t wrong_trees = 1000;
+  std::string bad_trees = bytes;
+  bad_trees.replace( trees_offset, 4, reinterpret_cast< char const* >( &wrong_trees ), 4 );
+  std::stringstream bad_trees_stream( bad_trees );
+  EXPECT_EXCEPTION( invalid_data, descriptor_index::read( bad_trees_stream ),
+                    "reading a k-d forest with a wrong number of trees" );
+
+  std::string bad_tables = lsh_stream.str();
+  bad_tables.replace( params_offset, 4, reinterpret_cast< char const* >( &huge ), 4 );
+  std::stringstream bad_tables_stream( bad_tables );
+  EXPECT_EXCEPTION( invalid_data, descriptor_index::read( bad_tables_stream ),
+                    "reading an LSH index with too many tables" );
+
+  // round trip through a file
+  const std::string path = "test_descriptor_index.vdi";
+  write_descriptor_index_file( lsh2, path );
+  descriptor_index_sptr lsh3 = read_descriptor_index_file( path );
+  TEST_EQUAL( "file round trip size", lsh3->size(), 400 );
+  std::remove( path.c_str() );
+}
+
+
+IMPLEMENT_TEST(zero_neighbors)
+{
+  std::srand( 13 );
+  kd_forest_descriptor_index::parameters params;
+  params.max_checks = 0;
+  kd_forest_descriptor_index kd( params );
+  kd.add( random_float_descriptors( 200, 8 ) );
+  lsh_descriptor_index lsh;
+  lsh.add( random_binary_descriptors( 200, 16 ) );
+
+  std::vector< descriptor_neighbors > a = kd.nearest( random_float_descriptors( 5, 8 ), 0 );
+  TEST_EQUAL( "k-d forest results for k = 0", a.size(), 5 );
+  TEST_EQUAL( "k-d forest neighbors for k = 0", a[4].empty(), true );
+
+  std::vector< descriptor_neighbors > b = lsh.nearest( random_binary_descriptors( 5, 16 ), 0 );
+  TEST_EQUAL( "lsh results for k = 0", b.size(), 5 );
+  TEST_EQUAL( "lsh neighbors for k = 0", b[4].empty(), true );
+}
@@ -0,0 +1,140 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief core descriptor_set tests
+ */
+
+#include <test_common.h>
+
+#include <iostream>
+#include <vector>
+
+#include <vital/types/descriptor_matrix_set.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(matrix_set_from_descriptors)
+{
+  using namespace kwiver::vital;
+
+  std::vector< descriptor_sptr > descs;
+  for ( unsigned i = 0; i < 5; ++i )
+  {
+    std::shared_ptr< descriptor_fixed< float, 10 > >
+      d( new descriptor_fixed< float, 10 >() );
+    for ( unsigned j = 0; j < 10; ++j )
+    {
+      d->raw_data()[j] = static_cast< float >( i * 10 + j );
+    }
+    descs.push_back( d );
+  }
+  // a descriptor of a different element type is converted
+  std::shared_ptr< descriptor_dynamic< double > >
+    dd( new descriptor_dynamic< double >( 10 ) );
+  for ( unsigned j = 0; j < 10; ++j )
+  {
+    dd->raw_data()[j] = 100.0 + j;
+  }
+  descs.push_back( dd );
+
+  descriptor_matrix_set< float > mat( descs );
+
+  TEST_EQUAL("Number of descriptors", mat.size(), 6);
+  TEST_EQUAL("Descriptor dimension", mat.dim(), 10);
+  TEST_EQUAL("Row stride is aligned",
+             mat.stride() * sizeof(float) % default_memory_alignment, 0);
+  TEST_EQUAL("Matrix data is aligned",
+             reinterpret_cast< size_t >( mat.data() ) % default_memory_alignment, 0);
+  TEST_EQUAL("Row padding is zero", mat.row( 2 )[ mat.stride() - 1 ], 0.0f);
+
+  for ( unsigned i = 0; i < 5; ++i )
+  {
+    for ( unsigned j = 0; j < 10; ++j )
+    {
+      TEST_EQUAL("Copied element", mat.row( i )[j], i * 10.0f + j);
+    }
+  }
+  TEST_EQUAL("Converted element", mat.row( 5 )[3], 103.0f);
+
+  // descriptors handed out refer to the matrix rows
+  std::vector< descriptor_sptr > rows = mat.descriptors();
+  TEST_EQUAL("Number of row descriptors", rows.size(), 6);
+  TEST_EQUAL("Row descriptor size", rows[3]->size(), 10);
+  std::vector< double > row_values = rows[3]->as_double();
+  TEST_EQUAL("Row descriptor value", row_values[4], 34.0);
+
+  descriptor_array_of< float >* row_typed =
+    dynamic_cast< descriptor_array_of< float >* >( rows[1].get() );
+  TEST_EQUAL("Row descriptor shares storage", row_typed->raw_data(), mat.row( 1 ));
+}
+
+
+IMPLEMENT_TEST(matrix_set_invalid_length)
+{
+  using namespace kwiver::vital;
+
+  std::vector< descriptor_sptr > descs;
+  descs.push_back( std::make_shared< descriptor_dynamic< float > >( 8 ) );
+  descs.push_back( std::make_shared< descriptor_dynamic< float > >( 9 ) );
+
+  EXPECT_EXCEPTION(
+    invalid_value,
+    descriptor_matrix_set< float > mat( descs ),
+    "constructing a matrix set from descriptors of different lengths" );
+}
+
+
+IMPLEMENT_TEST(matrix_set_row_lifetime)
+{
+  using namespace kwiver::vital;
+
+  descriptor_sptr row;
+  {
+    descriptor_matrix_set< unsigned char > mat( 3, 32 );
+    mat.row( 2 )[5] = 42;
+    row = mat.at( 2 );
+  }
+  TEST_EQUAL("Row outlives the set", row->as_bytes()[5], 42);
+}
@@ -0,0 +1,286 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief core feature_set tests
+ */
+
+#include <test_common.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <vital/types/columnar_feature_set.h>
+#include <vital/types/feature_grid_index.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+using namespace kwiver::vital;
+
+namespace {
+
+// Make a vector of features with distinct attribute values
+std::vector< feature_sptr >
+make_features( size_t num )
+{
+  std::vector< feature_sptr > feats;
+  for ( size_t i = 0; i < num; ++i )
+  {
+    std::shared_ptr< feature_d > f(
+      new feature_d( vector_2d( 10.0 * i, 5.0 + i ), 0.5 * i, 1.0 + i, 0.1 * i,
+                     rgb_color( static_cast< uint8_t >( i ), 2, 3 ) ) );
+    covariance_2d c;
+    c( 0, 0 ) = 2.0 + i;
+    c( 0, 1 ) = 0.5;
+    c( 1, 1 ) = 3.0;
+    f->set_covar( c );
+    feats.push_back( f );
+  }
+  return feats;
+}
+
+
+// Make a columnar set of pseudo-random features in a 640 x 480 image
+std::shared_ptr< columnar_feature_set_d >
+random_features( size_t num )
+{
+  std::shared_ptr< columnar_feature_set_d > fs( new columnar_feature_set_d );
+  for ( size_t i = 0; i < num; ++i )
+  {
+    fs->push_back( vector_2d( std::rand() % 64000 / 100.0,
+                              std::rand() % 48000 / 100.0 ) );
+  }
+  return fs;
+}
+
+
+// Squared distance between two points
+double
+dist2( vector_2d const& a, vector_2d const& b )
+{
+  return ( a - b ).squaredNorm();
+}
+
+} // end anonymous namespace
+
+
+IMPLEMENT_TEST(columnar_from_features)
+{
+  std::vector< feature_sptr > feats = make_features( 5 );
+  feats.push_back( feature_sptr() );
+  columnar_feature_set_d fs( feats );
+  TEST_EQUAL( "size", fs.size(), 6 );
+
+  std::vector< feature_sptr > out = fs.features();
+  TEST_EQUAL( "materialized size", out.size(), 6 );
+  for ( size_t i = 0; i < 5; ++i )
+  {
+    TEST_EQUAL( "location", out[i]->loc(), feats[i]->loc() );
+    TEST_EQUAL( "magnitude", out[i]->magnitude(), feats[i]->magnitude() );
+    TEST_EQUAL( "scale", out[i]->scale(), feats[i]->scale() );
+    TEST_EQUAL( "angle", out[i]->angle(), feats[i]->angle() );
+    TEST_EQUAL( "covariance", Eigen::Matrix2d( out[i]->covar() ),
+                Eigen::Matrix2d( feats[i]->covar() ) );
+    TEST_EQUAL( "color", out[i]->color() == feats[i]->color(), true );
+  }
+
+  // null features become default features
+  TEST_EQUAL( "default location", out[5]->loc(), vector_2d( 0, 0 ) );
+  TEST_EQUAL( "default scale", out[5]->scale(), 1.0 );
+  TEST_EQUAL( "default covariance", Eigen::Matrix2d( out[5]->covar() ),
+              Eigen::Matrix2d::Identity() );
+
+  // single precision columns convert the values
+  columnar_feature_set_f ffs( feats );
+  TEST_EQUAL( "float feature type", ffs.at( 2 )->data_type() == typeid( float ), true );
+  TEST_NEAR( "float location", ffs.at( 2 )->loc()[1], 7.0, 1e-6 );
+}
+
+
+IMPLEMENT_TEST(columnar_columns)
+{
+  columnar_feature_set_f fs;
+  fs.push_back( Eigen::Vector2f( 1, 2 ), 3 );
+  fs.push_back( Eigen::Vector2f( 4, 5 ), 6, 2 );
+  fs.push_back( *make_features( 2 )[1] );
+  TEST_EQUAL( "size", fs.size(), 3 );
+
+  float const* loc = fs.locations();
+  TEST_EQUAL( "x of second", loc[2], 4.0f );
+  TEST_EQUAL( "y of third", loc[5], 6.0f );
+  TEST_EQUAL( "magnitude column", fs.magnitudes()[1], 6.0f );
+  TEST_EQUAL( "scale column", fs.scales()[1], 2.0f );
+  TEST_EQUAL( "covariance column", fs.covariances()[6], 3.0f );
+
+  columnar_feature_set_f::location_matrix_t m = fs.location_matrix();
+  TEST_EQUAL( "matrix rows", m.rows(), 3 );
+  TEST_EQUAL( "matrix refers to the column", m.data() == loc, true );
+  TEST_EQUAL( "matrix element", m( 1, 1 ), 5.0f );
+
+  // writing a column changes the materialized features
+  fs.angles()[0] = 0.25f;
+  TEST_EQUAL( "modified angle", fs.at( 0 )->angle(), 0.25 );
+
+  fs.resize( 5 );
+  TEST_EQUAL( "resized", fs.size(), 5 );
+  TEST_EQUAL( "resized scale", fs.scales()[4], 1.0f );
+}
+
+
+IMPLEMENT_TEST(location_view)
+{
+  std::vector< feature_sptr > feats = make_features( 4 );
+  feature_set_sptr simple = std::make_shared< simple_feature_set >( feats );
+  feature_set_sptr col_d = std::make_shared< columnar_feature_set_d >( feats );
+  feature_set_sptr col_f = std::make_shared< columnar_feature_set_f >( feats );
+
+  feature_location_view vs( simple );
+  feature_location_view vd( col_d );
+  feature_location_view vf( col_f );
+  for ( size_t i = 0; i < feats.size(); ++i )
+  {
+    TEST_EQUAL( "simple set location", vs[i], feats[i]->loc() );
+    TEST_EQUAL( "double column location", vd[i], feats[i]->loc() );
+    TEST_EQUAL( "float column location", vf[i], feats[i]->loc() );
+  }
+}
+
+
+IMPLEMENT_TEST(grid_radius_rectangle)
+{
+  std::srand( 17 );
+  std::shared_ptr< columnar_feature_set_d > fs = random_features( 2000 );
+  feature_grid_index grid( fs );
+  TEST_EQUAL( "grid size", grid.size(), 2000 );
+
+  const vector_2d centers[] = { vector_2d( 320, 240 ), vector_2d( 0, 0 ),
+                                vector_2d( 700, 100 ), vector_2d( -50, -50 ) };
+  for ( unsigned c = 0; c < 4; ++c )
+  {
+    std::vector< size_t > found = grid.radius_query( centers[c], 40.0 );
+    std::sort( found.begin(), found.end() );
+    std::vector< size_t > expected;
+    for ( size_t i = 0; i < fs->size(); ++i )
+    {
+      if ( dist2( fs->location( i ), centers[c] ) <= 40.0 * 40.0 )
+      {
+        expected.push_back( i );
+      }
+    }
+    TEST_EQUAL( "radius query matches scan", found == expected, true );
+  }
+
+  const vector_2d lo( 100, 50 ), hi( 180, 300 );
+  std::vector< size_t > found = grid.rectangle_query( lo, hi );
+  std::sort( found.begin(), found.end() );
+  std::vector< size_t > expected;
+  for ( size_t i = 0; i < fs->size(); ++i )
+  {
+    const vector_2d p = fs->location( i );
+    if ( p[0] >= lo[0] && p[0] <= hi[0] && p[1] >= lo[1] && p[1] <= hi[1] )
+    {
+      expected.push_back( i );
+    }
+  }
+  TEST_EQUAL( "rectangle query matches scan", found == expected, true );
+  TEST_EQUAL( "empty rectangle outside the grid",
+              grid.rectangle_query( vector_2d( 1000, 1000 ),
+                                    vector_2d( 1100, 1100 ) ).empty(), true );
+}
+
+
+IMPLEMENT_TEST(grid_nearest)
+{
+  std::srand( 23 );
+  std::shared_ptr< columnar_feature_set_d > fs = random_features( 1500 );
+  // a small cell size forces many rings to be searched
+  feature_grid_index grid( fs, 5.0 );
+
+  const vector_2d queries[] = { vector_2d( 320, 240 ), vector_2d( 1, 479 ),
+                                vector_2d( 2000, -300 ), vector_2d( 600.5, 20.25 ) };
+  for ( unsigned q = 0; q < 4; ++q )
+  {
+    std::vector< size_t > found = grid.nearest( queries[q], 5 );
+    std::vector< std::pair< double, size_t > > all;
+    for ( size_t i = 0; i < fs->size(); ++i )
+    {
+      all.push_back( std::make_pair( dist2( fs->location( i ), queries[q] ), i ) );
+    }
+    std::sort( all.begin(), all.end() );
+    TEST_EQUAL( "five neighbors", found.size(), 5 );
+    for ( size_t n = 0; n < found.size(); ++n )
+    {
+      TEST_EQUAL( "neighbor matches scan", found[n], all[n].second );
+    }
+
+    std::vector< size_t > near = grid.nearest( queries[q], 5, 10.0 );
+    size_t expected = 0;
+    while ( expected < 5 && all[expected].first <= 100.0 )
+    {
+      ++expected;
+    }
+    TEST_EQUAL( "neighbors within max distance", near.size(), expected );
+  }
+}
+
+
+IMPLEMENT_TEST(grid_degenerate)
+{
+  feature_grid_index empty( std::make_shared< simple_feature_set >() );
+  TEST_EQUAL( "empty grid", empty.size(), 0 );
+  TEST_EQUAL( "empty radius query", empty.radius_query( vector_2d( 0, 0 ), 10 ).empty(), true );
+  TEST_EQUAL( "empty nearest", empty.nearest( vector_2d( 0, 0 ), 3 ).empty(), true );
+
+  // all features at one location
+  std::shared_ptr< columnar_feature_set_d > same( new columnar_feature_set_d );
+  for ( unsigned i = 0; i < 10; ++i )
+  {
+    same->push_back( vector_2d( 5, 5 ) );
+  }
+  feature_grid_index grid( same );
+  TEST_EQUAL( "coincident radius query", grid.radius_query( vector_2d( 5, 6 ), 1 ).size(), 10 );
+  TEST_EQUAL( "coincident nearest", grid.nearest( vector_2d( 100, 100 ), 3 ).size(), 3 );
+}
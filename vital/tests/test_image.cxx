@@ -35,7 +35,15 @@
 
 #include <test_common.h>
 
+#include <vital/exceptions/base.h>
+#include <vital/exceptions/image.h>
 #include <vital/types/image.h>
+#include <vital/types/image_container.h>
+#include <vital/types/image_memory_pool.h>
+#include <vital/types/image_view.h>
+
+#include <thread>
+#include <vector>
 
 #define TEST_ARGS ()
 
@@ -207,6 +215,206 @@ IMPLEMENT_TEST(copy_from)
 }
 
 
+IMPLEMENT_TEST(copy_from_layouts)
+{
+  // sizes where rows are not a multiple of the vector width
+  unsigned w=37, h=21;
+  for(unsigned d=1; d<=5; ++d)
+  {
+    kwiver::vital::image planar(w,h,d), interleaved(w,h,d,true);
+    for(unsigned k=0; k<d; ++k)
+    {
+      for(unsigned j=0; j<h; ++j)
+      {
+        for(unsigned i=0; i<w; ++i)
+        {
+          planar(i,j,k) = interleaved(i,j,k) =
+            static_cast<unsigned char>((7*i + 13*j + 101*k) % 251);
+        }
+      }
+    }
+    // a vertically flipped view with a negative row step
+    kwiver::vital::image flipped(planar.memory(), planar.first_pixel() + (h-1)*w,
+                                 w, h, d, 1, -static_cast<ptrdiff_t>(w), w*h);
+    // a view of every other pixel
+    kwiver::vital::image big(2*w, h, d, true);
+    kwiver::vital::image strided(big.memory(), big.first_pixel(),
+                                 w, h, d, 2*d, 2*d*w, 1);
+    strided.copy_from(interleaved);
+
+    kwiver::vital::image const* sources[] = { &planar, &interleaved, &flipped, &strided };
+    for(unsigned s=0; s<4; ++s)
+    {
+      kwiver::vital::image to_planar(w,h,d), to_interleaved(w,h,d,true);
+      to_planar.copy_from(*sources[s]);
+      to_interleaved.copy_from(*sources[s]);
+      kwiver::vital::image to_flipped(to_planar.memory(), to_planar.first_pixel() + (h-1)*w,
+                                      w, h, d, 1, -static_cast<ptrdiff_t>(w), w*h);
+      to_flipped.copy_from(*sources[s]);
+      if( ! equal_content(*sources[s], to_interleaved) )
+      {
+        TEST_ERROR("Copy of source " << s << " with depth " << d
+                   << " into an interleaved image differs");
+      }
+      if( ! equal_content(*sources[s], to_flipped) )
+      {
+        TEST_ERROR("Copy of source " << s << " with depth " << d
+                   << " into a flipped image differs");
+      }
+    }
+    kwiver::vital::image to_planar(w,h,d);
+    to_planar.copy_from(flipped);
+    if( ! equal_content(flipped, to_planar) )
+    {
+      TEST_ERROR("Copy of a flipped image with depth " << d << " differs");
+    }
+  }
+
+  // large enough to be copied in parallel
+  kwiver::vital::image large(1024, 768, 3, true), large_copy(1024, 768, 3);
+  for(unsigned j=0; j<768; ++j)
+  {
+    for(unsigned i=0; i<1024; ++i)
+    {
+      large(i,j,0) = static_cast<unsigned char>(i);
+      large(i,j,1) = static_cast<unsigned char>(j);
+      large(i,j,2) = static_cast<unsigned char>(i+j);
+    }
+  }
+  large_copy.copy_from(large);
+  kwiver::vital::image large_same(1024, 768, 3, true);
+  large_same.copy_from(large);
+  if( ! equal_content(large, large_copy) || ! equal_content(large, large_same) )
+  {
+    TEST_ERROR("Copies of a large image differ");
+  }
+}
+
+
+IMPLEMENT_TEST(memory_pool)
+{
+  using kwiver::vital::image_memory_pool;
+  TEST_EQUAL("Small bucket", image_memory_pool::bucket_size(10), 64);
+  TEST_EQUAL("Exact bucket", image_memory_pool::bucket_size(1024), 1024);
+  TEST_EQUAL("Rounded bucket", image_memory_pool::bucket_size(1025), 1152);
+
+  kwiver::vital::image_memory_pool_sptr pool = image_memory_pool::create(1 << 20);
+  unsigned char* first = 0;
+  {
+    kwiver::vital::image img(100, 200, 3, true, pool);
+    first = img.first_pixel();
+    TEST_EQUAL("Pooled image size is the bucket size", img.size(), 61440);
+    TEST_EQUAL("No idle buffers while in use", pool->idle_buffers(), 0);
+  }
+  TEST_EQUAL("Buffer returned to the pool", pool->idle_buffers(), 1);
+
+  kwiver::vital::image img2(100, 200, 3, false, pool);
+  TEST_EQUAL("Buffer reused", img2.first_pixel() == first, true);
+  TEST_EQUAL("Reuse counted", pool->reuse_count(), 1);
+
+  // set_size allocates from the same pool
+  img2.set_size(50, 50, 1);
+  TEST_EQUAL("Resized memory is pooled",
+             img2.memory()->allocator() == pool, true);
+  TEST_EQUAL("Old buffer returned on resize", pool->idle_buffers(), 1);
+
+  // buffers beyond the limit are freed, least recently returned first
+  {
+    kwiver::vital::image a(512, 512, 1, false, pool);
+    kwiver::vital::image b(512, 512, 3, false, pool);
+  }
+  TEST_EQUAL("Idle bytes bounded", pool->idle_bytes() <= pool->max_bytes(), true);
+  TEST_EQUAL("Least recently returned freed", pool->idle_buffers(), 2);
+  pool->clear();
+  TEST_EQUAL("Cleared", pool->idle_bytes(), 0);
+
+  // allocate and release from several threads
+  std::vector< std::thread > threads;
+  for(unsigned t=0; t<4; ++t)
+  {
+    threads.push_back(std::thread([pool]()
+    {
+      for(unsigned i=0; i<200; ++i)
+      {
+        kwiver::vital::image img(64 + i % 3, 64, 3, true, pool);
+        img(0, 0, 0) = 1;
+      }
+    }));
+  }
+  for(unsigned t=0; t<threads.size(); ++t)
+  {
+    threads[t].join();
+  }
+  TEST_EQUAL("Buffers recycled across threads", pool->idle_buffers() <= 12, true);
+  TEST_EQUAL("Buffers reused across threads", pool->reuse_count() > 100, true);
+}
+
+
+IMPLEMENT_TEST(padded_rows)
+{
+  using namespace kwiver::vital;
+
+  // default allocations are aligned to 64 bytes
+  image img(33, 7, 3, true);
+  TEST_EQUAL("Default alignment", reinterpret_cast<size_t>(img.first_pixel()) % 64, 0);
+  TEST_EQUAL("Footprint of an unpadded image", img.size(), 693);
+
+  for(unsigned interleave=0; interleave<2; ++interleave)
+  {
+    image padded(33, 7, 3, interleave != 0, 128);
+    TEST_EQUAL("Padded row step", padded.h_step(), 128);
+    TEST_EQUAL("First row aligned", reinterpret_cast<size_t>(padded.first_pixel()) % 128, 0);
+    size_t misaligned = 0;
+    for(unsigned k=0; k<3; ++k)
+    {
+      for(unsigned j=0; j<7; ++j)
+      {
+        if( ! interleave || k == 0 )
+        {
+          misaligned += (reinterpret_cast<size_t>(&padded(0, j, k)) % 128) != 0;
+        }
+        for(unsigned i=0; i<33; ++i)
+        {
+          padded(i,j,k) = static_cast<unsigned char>(i + 2*j + 3*k);
+        }
+      }
+    }
+    TEST_EQUAL("All rows aligned", misaligned, 0);
+    if( padded.size() < static_cast<size_t>(padded.h_step()) * 7 * (interleave ? 1 : 3) )
+    {
+      TEST_ERROR("Padded image size does not include the padding");
+    }
+
+    image copy;
+    copy.copy_from(padded);
+    if( ! equal_content(copy, padded) )
+    {
+      TEST_ERROR("Copy of a padded image differs");
+    }
+  }
+
+  EXPECT_EXCEPTION(invalid_value,
+                   image(10, 10, 1, false, 48),
+                   "constructing with a row alignment that is not a power of two");
+
+  // blocks above the huge page threshold are rounded to huge pages
+  image_allocator_sptr huge(new aligned_image_allocator(64, 1 << 20));
+  image large(1024, 1024, 3, true, huge);
+  TEST_EQUAL("Huge page footprint",
+             large.size() % aligned_image_allocator::huge_page_size, 0);
+  TEST_EQUAL("Huge page alignment",
+             reinterpret_cast<size_t>(large.first_pixel()) % aligned_image_allocator::huge_page_size, 0);
+  image small(16, 16, 1, false, huge);
+  TEST_EQUAL("Small blocks not rounded to huge pages", small.size(), 256);
+
+  // pools allocate from their allocator
+  image_memory_pool_sptr pool = image_memory_pool::create(1 << 24, huge);
+  image pooled(1024, 1024, 3, true, pool);
+  TEST_EQUAL("Pooled huge page alignment",
+             reinterpret_cast<size_t>(pooled.first_pixel()) % aligned_image_allocator::huge_page_size, 0);
+}
+
+
 IMPLEMENT_TEST(equal_content)
 {
   unsigned w=100, h=200, d=3;
@@ -236,6 +444,209 @@ IMPLEMENT_TEST(equal_content)
 }
 
 
+IMPLEMENT_TEST(hash_content)
+{
+  using namespace kwiver::vital;
+  const unsigned w=67, h=31, d=3;
+  image planar(w,h,d), interleaved(w,h,d,true), padded(w,h,d,true,size_t(64));
+  for(unsigned k=0; k<d; ++k)
+  {
+    for(unsigned j=0; j<h; ++j)
+    {
+      for(unsigned i=0; i<w; ++i)
+      {
+        planar(i,j,k) = static_cast<image::byte>(i*7 + j*j + 31*k);
+      }
+    }
+  }
+  interleaved.copy_from(planar);
+  padded.copy_from(planar);
+  // a strided layout using neither contiguous rows nor planes
+  image big(2*w, h, d);
+  image strided = big.subsample(2, 1);
+  strided.copy_from(planar);
+
+  const uint64_t hash = hash_content(planar);
+  TEST_EQUAL("Interleaved hash", hash_content(interleaved), hash);
+  TEST_EQUAL("Padded hash", hash_content(padded), hash);
+  TEST_EQUAL("Strided hash", hash_content(strided), hash);
+  TEST_EQUAL("Seeded hash differs", hash_content(planar, 1) != hash, true);
+  TEST_EQUAL("Padded equal content", equal_content(padded, interleaved), true);
+  TEST_EQUAL("Strided equal content", equal_content(strided, planar), true);
+
+  padded(w-1,h-1,2) ^= 1;
+  TEST_EQUAL("Changed pixel hash", hash_content(padded) != hash, true);
+  TEST_EQUAL("Changed pixel content", equal_content(padded, interleaved), false);
+  image planar2(w,h,d);
+  planar2.copy_from(planar);
+  TEST_EQUAL("Contiguous equal content", equal_content(planar2, planar), true);
+  planar2(0,0,0) ^= 1;
+  TEST_EQUAL("Contiguous changed content", equal_content(planar2, planar), false);
+
+  // same bytes, other shape or pixel type
+  image reshaped(planar.first_pixel(), h, w, d, 1, h, w*h);
+  TEST_EQUAL("Shape changes hash", hash_content(reshaped) != hash, true);
+  image retyped(planar.first_pixel(), w/2, h, d, planar.w_step(), planar.h_step()/2,
+                planar.d_step()/2, image_pixel_traits_of<uint16_t>());
+  image bytes(planar.first_pixel(), w/2, h, d, planar.w_step(), planar.h_step()/2,
+              planar.d_step()/2);
+  TEST_EQUAL("Pixel type changes hash", hash_content(retyped) != hash_content(bytes), true);
+
+  image_of<float> f1(5,4,2,true), f2(5,4,2);
+  for_each_pixel(image_view<float>(f1), [](float& v) { v = 0.25f; });
+  f2.copy_from(f1);
+  TEST_EQUAL("Typed interleaved hash", hash_content(f1), hash_content(f2));
+  TEST_EQUAL("Empty hash", hash_content(image()) == hash_content(image()), true);
+}
+
+
+IMPLEMENT_TEST(typed_pixels)
+{
+  using namespace kwiver::vital;
+  const unsigned w=37, h=21, d=3;
+
+  image_of<uint16_t> planar(w,h,d);
+  TEST_EQUAL("uint16 pixel type", planar.pixel_traits() == image_pixel_traits_of<uint16_t>(), true);
+  TEST_EQUAL("uint16 bytes allocated", planar.size(), w*h*d*2);
+  TEST_EQUAL("uint16 h_step in pixels", planar.h_step(), w);
+  for(unsigned k=0; k<d; ++k)
+  {
+    for(unsigned j=0; j<h; ++j)
+    {
+      for(unsigned i=0; i<w; ++i)
+      {
+        planar(i,j,k) = static_cast<uint16_t>(1000*k + 40*j + i + 16000);
+      }
+    }
+  }
+
+  // sharing through an image container does not copy
+  image_container_sptr c = std::make_shared<simple_image_container>(planar);
+  image_of<uint16_t> shared(c->get_image());
+  TEST_EQUAL("Shared memory", shared.memory() == planar.memory(), true);
+  TEST_EQUAL("Shared value", shared(5,6,2), planar(5,6,2));
+
+  // copy to every layout, where only contiguous copies use memcpy
+  image_of<uint16_t> interleaved(w,h,d,true);
+  interleaved.copy_from(planar);
+  TEST_EQUAL("Interleaved copy", equal_content(interleaved, planar), true);
+  TEST_EQUAL("Interleaved value", interleaved(36,20,1), planar(36,20,1));
+  image padded(w,h,d,false,image_pixel_traits_of<uint16_t>(),64);
+  TEST_EQUAL("Padded h_step in pixels", padded.h_step(), 64);
+  padded.copy_from(interleaved);
+  TEST_EQUAL("Padded copy", equal_content(padded, planar), true);
+  image_of<uint16_t> flipped(planar.first_pixel() + (h-1)*planar.h_step(), w, h, d,
+                             planar.w_step(), -planar.h_step(), planar.d_step());
+  image_of<uint16_t> unflipped;
+  unflipped.copy_from(flipped);
+  TEST_EQUAL("Flipped copy", unflipped(3,0,1), planar(3,h-1,1));
+
+  // copying into a byte image takes the pixel type
+  image bytes(w,h,d);
+  bytes.copy_from(planar);
+  TEST_EQUAL("Copy takes the pixel type", bytes.pixel_traits() == planar.pixel_traits(), true);
+  TEST_EQUAL("Copy reallocates", bytes.size(), w*h*d*2);
+  TEST_EQUAL("Retyped copy", equal_content(bytes, planar), true);
+
+  // equal content requires equal types and values
+  interleaved(1,2,0) += 1;
+  TEST_EQUAL("Different values", equal_content(interleaved, planar), false);
+  image_of<int16_t> other_type(w,h,d);
+  other_type.copy_from(image(planar.first_pixel(), w, h, d, planar.w_step(),
+                             planar.h_step(), planar.d_step(),
+                             image_pixel_traits_of<int16_t>()));
+  TEST_EQUAL("Same bits of another type", equal_content(other_type, planar), false);
+
+  image_of<float> depth_map(w,h);
+  depth_map(4,5) = 2.5f;
+  image_view<const float> view(static_cast<const image&>(depth_map));
+  TEST_EQUAL("Float view", view(4,5), 2.5f);
+
+  image_of<double> wide(2,2,1,true);
+  image_of<uint8_t> narrow(2,2);
+  image as_image = wide;
+  EXPECT_EXCEPTION(image_type_mismatch_exception,
+                   image_of<float> wrong(as_image),
+                   "accessing double pixels as float");
+  EXPECT_EXCEPTION(image_type_mismatch_exception,
+                   image_view<uint16_t> wrong_view(as_image),
+                   "viewing double pixels as uint16");
+  EXPECT_EXCEPTION(image_type_mismatch_exception,
+                   transform_image(as_image, val_zero_op),
+                   "transforming non-byte pixels");
+  const image& const_image = as_image;
+  EXPECT_EXCEPTION(image_type_mismatch_exception,
+                   as_image(1,1) = 0,
+                   "byte access to double pixels");
+  EXPECT_EXCEPTION(image_type_mismatch_exception,
+                   const_image(1,1,0),
+                   "const byte access to double pixels");
+  EXPECT_EXCEPTION(image_type_mismatch_exception,
+                   as_image.at(0,1),
+                   "color access to double pixels");
+
+  // a typed image keeps its pixel type on copy and resize
+  image_of<uint16_t> typed(4,4);
+  EXPECT_EXCEPTION(image_type_mismatch_exception,
+                   typed.copy_from(image(4,4,1)),
+                   "copying byte pixels into a uint16 image");
+  TEST_EQUAL("Failed copy keeps the type",
+             typed.pixel_traits() == image_pixel_traits_of<uint16_t>(), true);
+  typed.set_size(3,2,2);
+  TEST_EQUAL("Resize keeps the type",
+             typed.pixel_traits() == image_pixel_traits_of<uint16_t>(), true);
+  TEST_EQUAL("Resize allocates uint16 pixels", typed.size(), 3*2*2*sizeof(uint16_t));
+  typed.copy_from(planar);
+  TEST_EQUAL("Typed copy", equal_content(typed, planar), true);
+
+  image_of<uint8_t> from_bytes(narrow);
+  TEST_EQUAL("Bytes are uint8", from_bytes.pixel_traits() == image_pixel_traits(), true);
+  image_of<bool> mask(2,2);
+  TEST_EQUAL("Bool pixel type", mask.pixel_traits().type, image_pixel_traits::BOOL);
+}
+
+
+IMPLEMENT_TEST(crop_subsample)
+{
+  using namespace kwiver::vital;
+  image img(40, 30, 3, true);
+  for(unsigned k=0; k<3; ++k)
+  {
+    for(unsigned j=0; j<30; ++j)
+    {
+      for(unsigned i=0; i<40; ++i)
+      {
+        img(i,j,k) = static_cast<image::byte>(i + 2*j + 50*k);
+      }
+    }
+  }
+
+  image roi = img.crop(5, 7, 10, 12);
+  TEST_EQUAL("Crop shares memory", roi.memory() == img.memory(), true);
+  TEST_EQUAL("Crop width", roi.width(), 10);
+  TEST_EQUAL("Crop height", roi.height(), 12);
+  TEST_EQUAL("Crop pixel", roi(3,4,2), img(8,11,2));
+  roi(0,0,1) = 7;
+  TEST_EQUAL("Crop writes through", img(5,7,1), 7);
+  TEST_EQUAL("Full crop", equal_content(img.crop(0, 0, 40, 30), img), true);
+  EXPECT_EXCEPTION(std::out_of_range, img.crop(35, 0, 6, 1), "cropping past the right edge");
+  EXPECT_EXCEPTION(std::out_of_range, img.crop(0, 31, 1, 0), "cropping below the image");
+
+  image half = img.subsample(2, 3);
+  TEST_EQUAL("Subsample shares memory", half.memory() == img.memory(), true);
+  TEST_EQUAL("Subsample width", half.width(), 20);
+  TEST_EQUAL("Subsample height", half.height(), 10);
+  TEST_EQUAL("Subsample pixel", half(4,5,2), img(8,15,2));
+  TEST_EQUAL("Subsample of crop", roi.subsample(3, 5)(3,2,0), img(14,17,0));
+  EXPECT_EXCEPTION(invalid_value, img.subsample(0, 1), "subsampling by zero");
+
+  image_of<float> depth_map(9, 9);
+  depth_map(8, 8) = 1.5f;
+  image_of<float> corner(depth_map.crop(4, 4, 5, 5).subsample(2, 2));
+  TEST_EQUAL("Typed crop and subsample", corner(2, 2), 1.5f);
+}
+
+
 IMPLEMENT_TEST(transform_image)
 {
   // Testing that the transform image traverses pixels in memory order
@@ -513,3 +924,180 @@ IMPLEMENT_TEST(transform_image)
   }
 
 }
+
+
+IMPLEMENT_TEST(transform_image_functor)
+{
+  using namespace kwiver::vital;
+  typedef image::byte byte;
+
+  // large enough to be split across threads, and a small padded image
+  const unsigned sizes[2][2] = { { 640, 480 }, { 37, 5 } };
+  for(unsigned s=0; s<2; ++s)
+  {
+    const unsigned w = sizes[s][0], h = sizes[s][1];
+    image planar(w, h, 3), interleaved(w, h, 3, true), padded(w, h, 3, true, 64);
+    image* imgs[3] = { &planar, &interleaved, &padded };
+    for(unsigned n=0; n<3; ++n)
+    {
+      for(unsigned k=0; k<3; ++k)
+      {
+        for(unsigned j=0; j<h; ++j)
+        {
+          for(unsigned i=0; i<w; ++i)
+          {
+            (*imgs[n])(i,j,k) = static_cast<byte>(i + 3*j + 5*k);
+          }
+        }
+      }
+    }
+
+    for(unsigned threads=0; threads<2; ++threads)
+    {
+      for(unsigned n=0; n<3; ++n)
+      {
+        image img;
+        img.copy_from(*imgs[n]);
+        const int offset = 7;
+        transform_image(img, [offset](byte b) { return static_cast<byte>(b + offset); }, threads);
+
+        image inverted;
+        transform_image(img, inverted, [](byte b) { return static_cast<byte>(255 - b); }, threads);
+
+        image mask(w, h, 3);
+        transform_image(img, mask, [](byte b) { return static_cast<byte>(b % 2 ? 255 : 0); });
+        image masked;
+        transform_image(img, mask, masked, [](byte a, byte m) { return static_cast<byte>(a & m); }, threads);
+
+        image gray;
+        transform_pixels<3, 1>(img, gray, [](const byte* in, byte* out)
+        {
+          out[0] = static_cast<byte>((in[0] + in[1] + in[2]) / 3);
+        }, threads);
+
+        image swapped(w, h, 3, true);
+        transform_pixels<3, 3>(img, swapped, [](const byte* in, byte* out)
+        {
+          out[0] = in[2]; out[1] = in[1]; out[2] = in[0];
+        }, threads);
+
+        size_t num_wrong = 0;
+        for(unsigned j=0; j<h; ++j)
+        {
+          for(unsigned i=0; i<w; ++i)
+          {
+            unsigned sum = 0;
+            for(unsigned k=0; k<3; ++k)
+            {
+              const byte v = static_cast<byte>(i + 3*j + 5*k + offset);
+              sum += v;
+              num_wrong += img(i,j,k) != v;
+              num_wrong += inverted(i,j,k) != 255 - v;
+              num_wrong += masked(i,j,k) != (v % 2 ? v : 0);
+              num_wrong += swapped(i,j,2-k) != v;
+            }
+            num_wrong += gray(i,j) != sum / 3;
+          }
+        }
+        if( num_wrong != 0 )
+        {
+          TEST_ERROR("Transform of layout " << n << " of size " << w << "x" << h
+                     << " with " << (threads ? "one thread" : "all threads")
+                     << " has " << num_wrong << " wrong pixels");
+        }
+      }
+    }
+  }
+
+  image a(10, 10, 1), b(10, 11, 1), c;
+  auto add = [](byte x, byte y) { return static_cast<byte>(x + y); };
+  EXPECT_EXCEPTION(image_size_mismatch_exception,
+                   transform_image(a, b, c, add),
+                   "combining images of different sizes");
+  EXPECT_EXCEPTION(image_size_mismatch_exception,
+                   (transform_pixels<3, 1>(a, c, [](const byte*, byte* out) { out[0] = 0; })),
+                   "transforming pixels with the wrong number of channels");
+}
+
+
+IMPLEMENT_TEST(image_view)
+{
+  using namespace kwiver::vital;
+  typedef image::byte byte;
+
+  image planar(7, 5, 3), interleaved(7, 5, 3, true), padded(7, 5, 3, false, 16);
+  image* imgs[3] = { &planar, &interleaved, &padded };
+  for(unsigned n=0; n<3; ++n)
+  {
+    image& img = *imgs[n];
+    image_view<byte> v(img);
+    for(unsigned k=0; k<3; ++k)
+    {
+      for(unsigned j=0; j<5; ++j)
+      {
+        for(unsigned i=0; i<7; ++i)
+        {
+          v(i,j,k) = static_cast<byte>(100*k + 10*j + i);
+        }
+      }
+    }
+
+    size_t num_wrong = 0;
+    for(unsigned k=0; k<3; ++k)
+    {
+      for(unsigned j=0; j<5; ++j)
+      {
+        for(unsigned i=0; i<7; ++i)
+        {
+          num_wrong += img(i,j,k) != 100*k + 10*j + i;
+          num_wrong += img.unchecked_pixel(i,j,k) != img(i,j,k);
+          num_wrong += v.row(j,k)[i * v.w_step()] != img(i,j,k);
+        }
+      }
+    }
+    for(unsigned j=0; j<5; ++j)
+    {
+      for(unsigned i=0; i<7; ++i)
+      {
+        num_wrong += img.unchecked_at(i,j) != img.at(i,j);
+      }
+    }
+    TEST_EQUAL("Accessors agree", num_wrong, 0);
+
+    // row, column, channel and plane iterators
+    image_view<const byte> cv(static_cast<const image&>(img));
+    TEST_EQUAL("Row length", cv.row_end(2, 1) - cv.row_begin(2, 1), 7);
+    TEST_EQUAL("Row value", (unsigned)cv.row_begin(2, 1)[3], 123);
+    unsigned col_sum = 0;
+    for(image_view<const byte>::step_iterator it = cv.column_begin(4, 2);
+        it != cv.column_end(4, 2); ++it)
+    {
+      col_sum += *it;
+    }
+    TEST_EQUAL("Column sum", col_sum, 5 * 204 + 10 * (0+1+2+3+4));
+    std::vector<byte> channels(cv.channel_begin(6, 1), cv.channel_end(6, 1));
+    TEST_EQUAL("Channels", channels.size() == 3 && channels[2] == 216, true);
+    size_t count = 0;
+    unsigned last = 0;
+    bool ordered = true;
+    for(image_view<const byte>::plane_iterator it = cv.plane_begin(1);
+        it != cv.plane_end(1); ++it, ++count)
+    {
+      ordered = ordered && (count == 0 || *it > last);
+      last = *it;
+    }
+    TEST_EQUAL("Plane size", count, 35);
+    TEST_EQUAL("Plane in row order", ordered, true);
+
+    // for_each_pixel visits every pixel once
+    unsigned sum = 0, expected = 0;
+    for(unsigned k=0; k<3; ++k)
+      for(unsigned j=0; j<5; ++j)
+        for(unsigned i=0; i<7; ++i)
+          expected += 100*k + 10*j + i;
+    for_each_pixel(static_cast<const image&>(img), [&sum](const byte& b) { sum += b; });
+    TEST_EQUAL("for_each_pixel sum", sum, expected);
+    for_each_pixel(img, [](byte& b) { b = static_cast<byte>(b + 1); });
+    TEST_EQUAL("for_each_pixel modifies", (unsigned)img(6, 4, 2), 247);
+  }
+}
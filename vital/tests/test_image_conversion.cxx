@@ -0,0 +1,179 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief core image conversion tests
+ */
+
+#include <test_common.h>
+
+#include <vital/exceptions/image.h>
+#include <vital/types/image_conversion.h>
+
+#include <iostream>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+using namespace kwiver::vital;
+
+namespace {
+
+image
+make_test_image( size_t w, size_t h, size_t d, bool interleave )
+{
+  image img( w, h, d, interleave );
+  for ( unsigned k = 0; k < d; ++k )
+  {
+    for ( unsigned j = 0; j < h; ++j )
+    {
+      for ( unsigned i = 0; i < w; ++i )
+      {
+        img( i, j, k ) = static_cast< image::byte >( ( 3 * i + 5 * j * j + 70 * k ) % 256 );
+      }
+    }
+  }
+  return img;
+}
+
+} // end anonymous namespace
+
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(gray)
+{
+  // large enough to convert in parallel
+  const image planar = make_test_image( 301, 250, 3, false );
+  const image interleaved = make_test_image( 301, 250, 3, true );
+  const image gray = convert_to_gray( planar );
+  TEST_EQUAL( "Gray width", gray.width(), 301 );
+  TEST_EQUAL( "Gray height", gray.height(), 250 );
+  TEST_EQUAL( "Gray depth", gray.depth(), 1 );
+
+  unsigned num_wrong = 0;
+  for ( unsigned j = 0; j < gray.height(); ++j )
+  {
+    for ( unsigned i = 0; i < gray.width(); ++i )
+    {
+      const unsigned y = ( 77 * planar( i, j, 0 ) + 150 * planar( i, j, 1 ) +
+                           29 * planar( i, j, 2 ) + 128 ) / 256;
+      num_wrong += gray( i, j ) != y ? 1 : 0;
+    }
+  }
+  TEST_EQUAL( "Gray pixels", num_wrong, 0 );
+  TEST_EQUAL( "Interleaved input", equal_content( convert_to_gray( interleaved, 0, 1, 2, 1 ), gray ), true );
+  TEST_EQUAL( "Strided input", equal_content( convert_to_gray( interleaved.subsample( 2, 1 ) ),
+                                             gray.subsample( 2, 1 ) ), true );
+
+  // reversing the channel order of BGR input gives the same result
+  const image bgr = reorder_channels( planar, std::vector< unsigned >{ 2, 1, 0 }, true );
+  TEST_EQUAL( "BGR input", equal_content( convert_to_gray( bgr, 2, 1, 0 ), gray ), true );
+
+  const image two = make_test_image( 10, 10, 2, true );
+  const image first = convert_to_gray( two );
+  TEST_EQUAL( "Gray and alpha is a view", first.memory() == two.memory(), true );
+  TEST_EQUAL( "Gray and alpha depth", first.depth(), 1 );
+  TEST_EQUAL( "Gray and alpha value", first( 3, 4 ), two( 3, 4, 0 ) );
+
+  EXPECT_EXCEPTION( std::out_of_range, convert_to_gray( planar, 0, 1, 3 ),
+                    "converting a missing channel" );
+  image_of< uint16_t > wide( 8, 8, 3 );
+  EXPECT_EXCEPTION( image_type_mismatch_exception, convert_to_gray( wide ),
+                    "converting 16 bit pixels to gray" );
+}
+
+
+IMPLEMENT_TEST(reorder)
+{
+  const image img = make_test_image( 300, 250, 4, false );
+  const std::vector< unsigned > order{ 2, 1, 0, 3, 3 };
+  for ( unsigned l = 0; l < 2; ++l )
+  {
+    const bool interleave = l == 1;
+    const image out = reorder_channels( img, order, interleave );
+    TEST_EQUAL( "Reordered depth", out.depth(), 5 );
+    TEST_EQUAL( "Reordered layout", out.d_step() == 1, interleave );
+    unsigned num_wrong = 0;
+    for ( unsigned k = 0; k < out.depth(); ++k )
+    {
+      for ( unsigned j = 0; j < out.height(); ++j )
+      {
+        for ( unsigned i = 0; i < out.width(); ++i )
+        {
+          num_wrong += out( i, j, k ) != img( i, j, order[k] ) ? 1 : 0;
+        }
+      }
+    }
+    TEST_EQUAL( "Reordered pixels", num_wrong, 0 );
+
+    // and back again from the converted layout
+    const image back = reorder_channels( out, std::vector< unsigned >{ 2, 1, 0, 4 }, ! interleave, 1 );
+    TEST_EQUAL( "Round trip", equal_content( back, img ), true );
+  }
+
+  const image interleaved = reorder_channels( img, std::vector< unsigned >(), true );
+  TEST_EQUAL( "Layout only", equal_content( interleaved, img ), true );
+  TEST_EQUAL( "Layout only is interleaved", interleaved.d_step(), 1 );
+
+  const image alpha = reorder_channels( interleaved, std::vector< unsigned >{ 3 }, false );
+  TEST_EQUAL( "Extracted depth", alpha.depth(), 1 );
+  TEST_EQUAL( "Extracted value", alpha( 7, 9 ), img( 7, 9, 3 ) );
+
+  image_of< uint16_t > wide( 20, 10, 3, true );
+  for ( unsigned k = 0; k < 3; ++k )
+  {
+    for ( unsigned j = 0; j < 10; ++j )
+    {
+      for ( unsigned i = 0; i < 20; ++i )
+      {
+        wide( i, j, k ) = static_cast< uint16_t >( 1000 * k + 20 * j + i );
+      }
+    }
+  }
+  const image_of< uint16_t > swapped( reorder_channels( wide, std::vector< unsigned >{ 2, 0 }, false ) );
+  TEST_EQUAL( "Typed channel 0", swapped( 5, 6, 0 ), wide( 5, 6, 2 ) );
+  TEST_EQUAL( "Typed channel 1", swapped( 5, 6, 1 ), wide( 5, 6, 0 ) );
+
+  EXPECT_EXCEPTION( std::out_of_range,
+                    reorder_channels( img, std::vector< unsigned >{ 4 }, false ),
+                    "reordering a missing channel" );
+}
@@ -0,0 +1,183 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief core image_pyramid class tests
+ */
+
+#include <test_common.h>
+
+#include <vital/exceptions/image.h>
+#include <vital/types/image_pyramid.h>
+
+#include <iostream>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+using namespace kwiver::vital;
+
+namespace {
+
+image
+make_test_image( size_t w, size_t h, size_t d, bool interleave )
+{
+  image img( w, h, d, interleave );
+  for ( unsigned k = 0; k < d; ++k )
+  {
+    for ( unsigned j = 0; j < h; ++j )
+    {
+      for ( unsigned i = 0; i < w; ++i )
+      {
+        img( i, j, k ) = static_cast< image::byte >( ( 3 * i + 5 * j * j + 70 * k ) % 256 );
+      }
+    }
+  }
+  return img;
+}
+
+} // end anonymous namespace
+
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(levels)
+{
+  image img = make_test_image( 101, 40, 2, false );
+  image_pyramid pyr( img, 10, image_pyramid::BOX_FILTER );
+  TEST_EQUAL( "Levels stop at one row", pyr.num_levels(), 6 );
+  TEST_EQUAL( "Level zero is shared", pyr.level( 0 ).memory() == img.memory(), true );
+  TEST_EQUAL( "Level 1 width", pyr.level( 1 ).width(), 50 );
+  TEST_EQUAL( "Level 1 height", pyr.level( 1 ).height(), 20 );
+  TEST_EQUAL( "Level 5 width", pyr.level( 5 ).width(), 3 );
+  TEST_EQUAL( "Level 5 height", pyr.level( 5 ).height(), 1 );
+  TEST_EQUAL( "Level 3 scale", image_pyramid::scale( 3 ), 0.125 );
+  EXPECT_EXCEPTION( std::out_of_range, pyr.level( 6 ), "accessing a missing level" );
+
+  // box filter is the rounded mean of each 2x2 block
+  const image& l1 = pyr.level( 1 );
+  unsigned num_wrong = 0;
+  for ( unsigned k = 0; k < 2; ++k )
+  {
+    for ( unsigned j = 0; j < l1.height(); ++j )
+    {
+      for ( unsigned i = 0; i < l1.width(); ++i )
+      {
+        const unsigned sum = img( 2*i, 2*j, k ) + img( 2*i+1, 2*j, k ) +
+                             img( 2*i, 2*j+1, k ) + img( 2*i+1, 2*j+1, k );
+        num_wrong += l1( i, j, k ) != ( sum + 2 ) / 4 ? 1 : 0;
+      }
+    }
+  }
+  TEST_EQUAL( "Box filtered pixels", num_wrong, 0 );
+
+  image_of< uint16_t > wide( 8, 8 );
+  EXPECT_EXCEPTION( image_type_mismatch_exception,
+                    image_pyramid( wide, 2 ),
+                    "building a pyramid of 16 bit pixels" );
+}
+
+
+IMPLEMENT_TEST(gaussian)
+{
+  // large enough to build the first levels in parallel
+  image planar = make_test_image( 640, 480, 3, false );
+  image interleaved( 640, 480, 3, true );
+  interleaved.copy_from( planar );
+
+  image_pyramid serial( planar, 4, image_pyramid::GAUSSIAN_FILTER, 1 );
+  image_pyramid parallel( interleaved, 4, image_pyramid::GAUSSIAN_FILTER, 0 );
+  TEST_EQUAL( "Number of levels", serial.num_levels(), 4 );
+  for ( unsigned l = 1; l < 4; ++l )
+  {
+    if ( ! equal_content( serial.level( l ), parallel.level( l ) ) )
+    {
+      TEST_ERROR( "Level " << l << " depends on the layout or threads" );
+    }
+  }
+
+  // compare to the separable filter with clamped borders
+  const unsigned weights[5] = { 1, 4, 6, 4, 1 };
+  const image& l1 = serial.level( 1 );
+  unsigned num_wrong = 0;
+  for ( unsigned k = 0; k < 3; ++k )
+  {
+    for ( int j = 0; j < static_cast< int >( l1.height() ); ++j )
+    {
+      for ( int i = 0; i < static_cast< int >( l1.width() ); ++i )
+      {
+        unsigned sum = 0;
+        for ( int v = 0; v < 5; ++v )
+        {
+          for ( int u = 0; u < 5; ++u )
+          {
+            const int x = std::min( std::max( 2 * i + u - 2, 0 ), 639 );
+            const int y = std::min( std::max( 2 * j + v - 2, 0 ), 479 );
+            sum += weights[u] * weights[v] * planar( x, y, k );
+          }
+        }
+        num_wrong += l1( i, j, k ) != ( sum + 128 ) / 256 ? 1 : 0;
+      }
+    }
+  }
+  TEST_EQUAL( "Gaussian filtered pixels", num_wrong, 0 );
+}
+
+
+IMPLEMENT_TEST(shared_pyramid)
+{
+  image img = make_test_image( 64, 48, 1, false );
+  auto container = std::make_shared< pyramid_image_container >( img );
+  image_container_sptr as_container = container;
+
+  image_pyramid_sptr p1 = get_image_pyramid( as_container, 3 );
+  image_pyramid_sptr p2 = get_image_pyramid( as_container, 2 );
+  TEST_EQUAL( "Pyramid is shared", p1 == p2, true );
+  image_pyramid_sptr p3 = get_image_pyramid( as_container, 4 );
+  TEST_EQUAL( "More levels rebuild", p3 != p1, true );
+  TEST_EQUAL( "Rebuilt levels", p3->num_levels(), 4 );
+  image_pyramid_sptr p4 = container->pyramid( 2, image_pyramid::BOX_FILTER );
+  TEST_EQUAL( "Other filter rebuilds", p4->filter(), image_pyramid::BOX_FILTER );
+
+  image_container_sptr plain = std::make_shared< simple_image_container >( img );
+  TEST_EQUAL( "Plain containers build a pyramid",
+              get_image_pyramid( plain, 3 )->num_levels(), 3 );
+}
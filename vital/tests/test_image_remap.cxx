@@ -0,0 +1,190 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief core remap_table tests
+ */
+
+#include <test_common.h>
+
+#include <vital/exceptions/image.h>
+#include <vital/types/image_remap.h>
+
+#include <algorithm>
+#include <iostream>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+using namespace kwiver::vital;
+
+namespace {
+
+/// An image whose pixels are a linear function of their location
+image
+make_gradient_image( size_t w, size_t h, size_t d, bool interleave )
+{
+  image img( w, h, d, interleave );
+  for ( unsigned k = 0; k < d; ++k )
+  {
+    for ( unsigned j = 0; j < h; ++j )
+    {
+      for ( unsigned i = 0; i < w; ++i )
+      {
+        img( i, j, k ) = static_cast< image::byte >( 2 * i + 3 * j + 10 * k );
+      }
+    }
+  }
+  return img;
+}
+
+} // end anonymous namespace
+
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(identity)
+{
+  const simple_camera_intrinsics K( 500, vector_2d( 20, 15 ) );
+  const image planar = make_gradient_image( 40, 30, 3, false );
+  const image interleaved = make_gradient_image( 40, 30, 3, true );
+  const remap_table::map_type types[] = { remap_table::FIXED_POINT_MAP, remap_table::FLOAT_MAP };
+  const size_t tiles[] = { 0, 8, 16 };
+  for ( unsigned t = 0; t < 2; ++t )
+  {
+    VITAL_FOREACH( size_t tile, tiles )
+    {
+      const remap_table table( K, K, 40, 30, types[t], tile );
+      TEST_EQUAL( "Identity remap of planar image",
+                  equal_content( remap( planar, table ), planar ), true );
+      const image out = remap( interleaved, table );
+      TEST_EQUAL( "Identity remap of interleaved image", equal_content( out, planar ), true );
+      TEST_EQUAL( "Interleaved layout kept", out.d_step(), 1 );
+    }
+  }
+}
+
+
+IMPLEMENT_TEST(shift)
+{
+  // moving the principal point shifts the source location by ( 0.5, 0.25 )
+  const simple_camera_intrinsics src( 500, vector_2d( 20.5, 15.25 ) );
+  const simple_camera_intrinsics dst( 500, vector_2d( 20, 15 ) );
+  const image img = make_gradient_image( 40, 30, 2, false );
+  const remap_table::map_type types[] = { remap_table::FIXED_POINT_MAP, remap_table::FLOAT_MAP };
+  for ( unsigned t = 0; t < 2; ++t )
+  {
+    const remap_table table( src, dst, 40, 30, types[t], 16 );
+    TEST_NEAR( "Source location x", table.source( 3, 4 ).x(), 3.5, 1e-6 );
+    TEST_NEAR( "Source location y", table.source( 3, 4 ).y(), 4.25, 1e-6 );
+
+    const image out = remap( img, table );
+    unsigned num_wrong = 0;
+    for ( unsigned k = 0; k < 2; ++k )
+    {
+      for ( unsigned j = 0; j < 30; ++j )
+      {
+        for ( unsigned i = 0; i < 40; ++i )
+        {
+          // bilinear interpolation of a linear function is exact, and
+          // the last column and row have no pixels to interpolate from
+          const unsigned expected = ( i < 39 && j < 29 ) ? 2 * i + 3 * j + 10 * k + 2 : 0;
+          num_wrong += out( i, j, k ) != expected ? 1 : 0;
+        }
+      }
+    }
+    TEST_EQUAL( "Shifted pixels", num_wrong, 0 );
+  }
+}
+
+
+IMPLEMENT_TEST(undistortion)
+{
+  simple_camera_intrinsics::vector_t d( 5 );
+  d << -0.2, 0.05, 0.001, -0.002, 0.01;
+  const simple_camera_intrinsics K( 300, vector_2d( 160, 120 ), 1.0, 0.0, d );
+  const simple_camera_intrinsics ideal( 300, vector_2d( 160, 120 ) );
+
+  const remap_table rows = remap_table::undistortion( K, 320, 240, remap_table::FLOAT_MAP );
+  const remap_table tiles = remap_table::undistortion( K, 320, 240, remap_table::FIXED_POINT_MAP, 32 );
+  TEST_EQUAL( "Table width", tiles.width(), 320 );
+  TEST_EQUAL( "Table height", tiles.height(), 240 );
+  TEST_EQUAL( "Table tile size", tiles.tile_size(), 32 );
+
+  double max_float_err = 0.0, max_fixed_err = 0.0;
+  for ( unsigned j = 0; j < 240; ++j )
+  {
+    for ( unsigned i = 0; i < 320; ++i )
+    {
+      const vector_2d expected = K.map( ideal.unmap( vector_2d( i, j ) ) );
+      max_float_err = std::max( max_float_err, ( rows.source( i, j ) - expected ).norm() );
+      max_fixed_err = std::max( max_fixed_err, ( tiles.source( i, j ) - expected ).cwiseAbs().maxCoeff() );
+    }
+  }
+  TEST_NEAR( "Float table locations", max_float_err, 0.0, 1e-3 );
+  TEST_NEAR( "Fixed point table locations", max_fixed_err, 0.0, 1.0 / 64 + 1e-9 );
+
+  // fixed point and float interpolation differ by at most the rounding
+  image img( 320, 240 );
+  for ( unsigned j = 0; j < 240; ++j )
+  {
+    for ( unsigned i = 0; i < 320; ++i )
+    {
+      img( i, j ) = static_cast< image::byte >( ( i * 255 / 319 + j * 255 / 239 ) / 2 );
+    }
+  }
+  const image a = remap( img, rows );
+  const image b = remap( img, tiles, 1 );
+  unsigned max_diff = 0;
+  for ( unsigned j = 0; j < 240; ++j )
+  {
+    for ( unsigned i = 0; i < 320; ++i )
+    {
+      max_diff = std::max< unsigned >( max_diff, std::abs( a( i, j ) - b( i, j ) ) );
+    }
+  }
+  std::cout << "Largest difference of float and fixed point remap: " << max_diff << std::endl;
+  TEST_EQUAL( "Float and fixed point remap agree", max_diff <= 1, true );
+
+  image_of< uint16_t > wide( 8, 8 );
+  EXPECT_EXCEPTION( image_type_mismatch_exception, remap( wide, rows ),
+                    "remapping 16 bit pixels" );
+}
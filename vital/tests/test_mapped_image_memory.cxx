@@ -0,0 +1,155 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief core mapped_image_memory class tests
+ */
+
+#include <test_common.h>
+
+#include <vital/exceptions/io.h>
+#include <vital/types/mapped_image_memory.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <stdint.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+using namespace kwiver::vital;
+
+namespace {
+
+const size_t header_bytes = 16;
+const size_t w = 50, h = 40, d = 3;
+
+/// Write a header and an interleaved image of uint16 pixels to a file
+void
+write_raw_file( const std::string& filename )
+{
+  std::vector< uint16_t > pixels( w * h * d );
+  for ( size_t j = 0; j < h; ++j )
+  {
+    for ( size_t i = 0; i < w; ++i )
+    {
+      for ( size_t k = 0; k < d; ++k )
+      {
+        pixels[( j * w + i ) * d + k] = static_cast< uint16_t >( 1000 * k + 100 * j + i );
+      }
+    }
+  }
+  std::ofstream out( filename.c_str(), std::ios::binary );
+  const std::string header( header_bytes, 'H' );
+  out.write( header.data(), header.size() );
+  out.write( reinterpret_cast< const char* >( &pixels[0] ), pixels.size() * sizeof( uint16_t ) );
+}
+
+} // end anonymous namespace
+
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(map_file)
+{
+  const std::string filename = "test_mapped_image_memory_map_file.raw";
+  write_raw_file( filename );
+
+  {
+    image_of< uint16_t > img( map_raw_image( filename, w, h, d, true,
+                                             image_pixel_traits_of< uint16_t >(),
+                                             mapped_image_memory::READ_ONLY, header_bytes ) );
+    TEST_EQUAL( "Mapped size", img.size(), w * h * d * 2 );
+    TEST_EQUAL( "Mapped pixel", img( 7, 9, 2 ), 2907 );
+    TEST_EQUAL( "Last mapped pixel", img( w - 1, h - 1, d - 1 ), 2000 + 100 * ( h - 1 ) + w - 1 );
+
+    auto mem = std::dynamic_pointer_cast< mapped_image_memory >( img.memory() );
+    TEST_EQUAL( "Memory is mapped", mem != nullptr, true );
+    mem->will_need( 0, 1 << 20 );
+
+    // views keep the mapping alive
+    image_of< uint16_t > tile( img.crop( 10, 10, 5, 5 ) );
+    img = image_of< uint16_t >();
+    TEST_EQUAL( "Tile pixel", tile( 1, 2, 0 ), 1211 );
+
+    image_of< uint16_t > heap;
+    heap.copy_from( tile );
+    TEST_EQUAL( "Copied tile", equal_content( heap, tile ), true );
+  }
+
+  {
+    image_of< uint16_t > img( map_raw_image( filename, w, h, d, true,
+                                             image_pixel_traits_of< uint16_t >(),
+                                             mapped_image_memory::COPY_ON_WRITE, header_bytes ) );
+    img( 0, 0, 0 ) = 12345;
+    TEST_EQUAL( "Copy on write pixel", img( 0, 0, 0 ), 12345 );
+  }
+
+  {
+    image_of< uint16_t > img( map_raw_image( filename, w, h, d, true,
+                                             image_pixel_traits_of< uint16_t >(),
+                                             mapped_image_memory::READ_ONLY, header_bytes ) );
+    TEST_EQUAL( "File is not modified", img( 0, 0, 0 ), 0 );
+  }
+
+  // planar bytes starting at an offset that is not page aligned
+  image header = map_raw_image( filename, 4, 2, 2, false, image_pixel_traits(),
+                                mapped_image_memory::READ_ONLY, 0 );
+  TEST_EQUAL( "Planar header byte", header( 3, 1, 1 ), 'H' );
+  // the low byte of pixel ( 1, 0, 0 ), which is 1, on little endian machines
+  image after_header = map_raw_image( filename, 2, 1, 1, false, image_pixel_traits(),
+                                      mapped_image_memory::READ_ONLY, header_bytes + 6 );
+  const uint16_t one = 1;
+  const int expected = *reinterpret_cast< const unsigned char* >( &one );
+  TEST_EQUAL( "Unaligned offset", static_cast< int >( after_header( 0, 0 ) ), expected );
+
+  EXPECT_EXCEPTION( file_not_read_exception,
+                    map_raw_image( filename, w, h + 1, d, true,
+                                   image_pixel_traits_of< uint16_t >() ),
+                    "mapping more pixels than the file holds" );
+  EXPECT_EXCEPTION( file_not_found_exception,
+                    mapped_image_memory( "no_such_file.raw" ),
+                    "mapping a missing file" );
+
+  std::remove( filename.c_str() );
+}
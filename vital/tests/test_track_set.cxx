@@ -90,3 +90,142 @@ IMPLEMENT_TEST(accessor_functions)
 
   TEST_EQUAL("Percentage tracked", test_set->percentage_tracked(-1,-2), 0.5);
 }
+
+
+IMPLEMENT_TEST(indexed_accessor_functions)
+{
+  using namespace kwiver::vital;
+
+  unsigned track_id = 0;
+
+  std::vector< track_sptr > test_tracks;
+
+  track::track_state test_state1( 1, feature_sptr(), descriptor_sptr() );
+  track::track_state test_state2( 2, feature_sptr(), descriptor_sptr() );
+  track::track_state test_state3( 3, feature_sptr(), descriptor_sptr() );
+  track::track_state test_state4( 4, feature_sptr(), descriptor_sptr() );
+
+  test_tracks.push_back( track_sptr( new track( test_state1 ) ) );
+  test_tracks.back()->set_id( track_id++ );
+  test_tracks.push_back( track_sptr( new track( test_state1 ) ) );
+  test_tracks.back()->set_id( track_id++ );
+  test_tracks.push_back( track_sptr( new track( test_state2 ) ) );
+  test_tracks.back()->set_id( track_id++ );
+  test_tracks.push_back( track_sptr( new track( test_state3 ) ) );
+  test_tracks.back()->set_id( track_id++ );
+
+  test_tracks[0]->append( test_state2 );
+  test_tracks[0]->append( test_state3 );
+  test_tracks[1]->append( test_state2 );
+  test_tracks[2]->append( test_state3 );
+
+  indexed_track_set* indexed = new indexed_track_set( test_tracks );
+  track_set_sptr test_set( indexed );
+
+  TEST_EQUAL("Total set size", test_set->size(), 4);
+  TEST_EQUAL("First frame", test_set->first_frame(), 1);
+  TEST_EQUAL("Last frame", test_set->last_frame(), 3);
+  TEST_EQUAL("Number of frames", test_set->all_frame_ids().size(), 3);
+
+  TEST_EQUAL("Active set size 1", test_set->active_tracks(-1)->size(), 3);
+  TEST_EQUAL("Active set size 2", test_set->active_tracks(-2)->size(), 3);
+  TEST_EQUAL("Active set size 3", test_set->active_tracks(-3)->size(), 2);
+  TEST_EQUAL("Inactive set size", test_set->inactive_tracks(-3)->size(), 2);
+  TEST_EQUAL("Active set size (no states)", test_set->active_tracks(10)->size(), 0);
+
+  TEST_EQUAL("Terminated set size", test_set->terminated_tracks(-1)->size(), 3);
+  TEST_EQUAL("New set size", test_set->new_tracks(-2)->size(), 1);
+
+  TEST_EQUAL("Percentage tracked", test_set->percentage_tracked(-1,-2), 0.5);
+
+  // per-frame results are plain track sets, not re-indexed copies
+  track_set_sptr active = test_set->active_tracks(-1);
+  TEST_EQUAL("Active set not indexed",
+             std::dynamic_pointer_cast<indexed_track_set>(active) == nullptr, true);
+  TEST_EQUAL("Active set last frame", active->last_frame(), 3);
+
+  TEST_EQUAL("Frame features size", test_set->frame_features(2)->size(), 3);
+  TEST_EQUAL("Frame descriptors size", test_set->frame_descriptors(2)->size(), 3);
+
+  // extend one track and add a new one through the set
+  if( ! indexed->append_state( test_tracks[0], test_state4 ) )
+  {
+    TEST_ERROR("Failed to append a correctly ordered track state");
+  }
+  if( indexed->append_state( test_tracks[1], test_state1 ) )
+  {
+    TEST_ERROR("Appended an incorrectly ordered track state");
+  }
+  track_sptr new_track( new track( test_state4 ) );
+  new_track->set_id( track_id++ );
+  indexed->insert( new_track );
+
+  TEST_EQUAL("Total set size after update", test_set->size(), 5);
+  TEST_EQUAL("Last frame after update", test_set->last_frame(), 4);
+  TEST_EQUAL("Active set size after update", test_set->active_tracks(-1)->size(), 2);
+  TEST_EQUAL("New set size after update", test_set->new_tracks(-1)->size(), 1);
+  TEST_EQUAL("Terminated set size after update",
+             test_set->terminated_tracks(3)->size(), 2);
+  TEST_EQUAL("Last frame features size", test_set->last_frame_features()->size(), 2);
+
+  TEST_EQUAL("Number of track ids", test_set->all_track_ids().size(), 5);
+  TEST_EQUAL("Get track by id", test_set->get_track( 2 ), test_tracks[2]);
+  TEST_EQUAL("Get added track by id", test_set->get_track( 4 ), new_track);
+  if( test_set->get_track( 10 ) )
+  {
+    TEST_ERROR("Found a track with an id not in the set");
+  }
+}
+
+
+namespace {
+
+// A track set that only implements the required interface
+class minimal_track_set
+  : public kwiver::vital::track_set
+{
+public:
+  explicit minimal_track_set( std::vector< kwiver::vital::track_sptr > const& t )
+    : data_( t ) { }
+
+  virtual std::vector< kwiver::vital::track_sptr > tracks() const { return data_; }
+
+private:
+  std::vector< kwiver::vital::track_sptr > data_;
+};
+
+}
+
+
+IMPLEMENT_TEST(tracks_view)
+{
+  using namespace kwiver::vital;
+
+  std::vector< track_sptr > test_tracks;
+  for( unsigned i = 0; i < 3; ++i )
+  {
+    test_tracks.push_back( track_sptr( new track(
+      track::track_state( i, feature_sptr(), descriptor_sptr() ) ) ) );
+    test_tracks.back()->set_id( i );
+  }
+
+  simple_track_set simple( test_tracks );
+  track_set::tracks_view_t const simple_view = simple.tracks_view();
+  TEST_EQUAL("Simple view size", simple_view.size(), 3);
+  TEST_EQUAL("Simple view element", simple_view[1], test_tracks[1]);
+
+  // the default view must remain valid after the owning copy is gone
+  track_set::tracks_view_t const default_view =
+    minimal_track_set( test_tracks ).tracks_view();
+  TEST_EQUAL("Default view size", default_view.size(), 3);
+
+  unsigned count = 0;
+  VITAL_FOREACH( track_sptr const& t, default_view )
+  {
+    TEST_EQUAL("Default view element", t, test_tracks[count]);
+    ++count;
+  }
+  TEST_EQUAL("Default view iteration count", count, 3);
+  TEST_EQUAL("Default implementation last frame",
+             minimal_track_set( test_tracks ).last_frame(), 2);
+}
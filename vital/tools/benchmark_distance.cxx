@@ -0,0 +1,185 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief benchmark for the vectorized distance kernels
+ */
+
+#include <vital/util/distance_kernels.h>
+#include <kwiversys/CommandLineArguments.hxx>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+typedef kwiversys::CommandLineArguments argT;
+
+using namespace kwiver::vital;
+
+// Global options
+bool opt_help( false );
+int opt_dim( 128 );
+int opt_queries( 1000 );
+int opt_rows( 5000 );
+int opt_iterations( 3 );
+
+
+namespace {
+
+// ------------------------------------------------------------------
+template < typename T >
+std::vector< T >
+random_data( size_t n )
+{
+  std::vector< T > v( n );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    v[i] = static_cast< T >( std::rand() % 256 );
+  }
+  return v;
+}
+
+
+// ------------------------------------------------------------------
+/// Time the many-to-many form of a kernel and return the best time
+template < typename T, typename R >
+double
+time_kernel( void (*kernel)( T const*, size_t, size_t,
+                             T const*, size_t, size_t, size_t, R* ),
+             std::vector< T > const& a, std::vector< T > const& b,
+             std::vector< R >& out )
+{
+  const size_t dim = static_cast< size_t >( opt_dim );
+  double best = 0.0;
+  for ( int it = 0; it < opt_iterations; ++it )
+  {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    kernel( &a[0], opt_queries, dim, &b[0], opt_rows, dim, dim, &out[0] );
+    const std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+    if ( it == 0 || elapsed.count() < best )
+    {
+      best = elapsed.count();
+    }
+  }
+  return best;
+}
+
+
+// ------------------------------------------------------------------
+/// Run one kernel at every supported instruction set level
+template < typename T, typename R >
+void
+benchmark( char const* name,
+           void (*kernel)( T const*, size_t, size_t,
+                           T const*, size_t, size_t, size_t, R* ) )
+{
+  const size_t dim = static_cast< size_t >( opt_dim );
+  std::vector< T > a = random_data< T >( opt_queries * dim );
+  std::vector< T > b = random_data< T >( opt_rows * dim );
+  std::vector< R > out( static_cast< size_t >( opt_queries ) * opt_rows );
+
+  const double num_dist = static_cast< double >( opt_queries ) * opt_rows;
+  double scalar_time = 0.0;
+
+  std::cout << name << " (" << dim << " elements of " << sizeof( T ) << " bytes)\n";
+  for ( int l = SIMD_SCALAR; l <= supported_simd_level(); ++l )
+  {
+    const simd_level_t level = set_distance_simd_level( static_cast< simd_level_t >( l ) );
+    const double t = time_kernel( kernel, a, b, out );
+    if ( level == SIMD_SCALAR )
+    {
+      scalar_time = t;
+    }
+
+    std::cout << "  " << std::setw( 8 ) << simd_level_name( level )
+              << std::fixed << std::setprecision( 3 )
+              << std::setw( 10 ) << t << " s"
+              << std::setw( 10 ) << std::setprecision( 1 )
+              << num_dist / t * 1e-6 << " Mdist/s"
+              << std::setw( 8 ) << std::setprecision( 2 )
+              << scalar_time / t << "x\n";
+  }
+  set_distance_simd_level( supported_simd_level() );
+}
+
+} // end namespace
+
+
+// ------------------------------------------------------------------
+int
+main( int argc, char* argv[] )
+{
+  kwiversys::CommandLineArguments arg;
+
+  arg.Initialize( argc, argv );
+
+  arg.AddArgument( "--help",        argT::NO_ARGUMENT, &opt_help, "Display usage information" );
+  arg.AddArgument( "--dim",         argT::SPACE_ARGUMENT, &opt_dim, "Descriptor length in elements" );
+  arg.AddArgument( "--queries",     argT::SPACE_ARGUMENT, &opt_queries, "Number of query descriptors" );
+  arg.AddArgument( "--rows",        argT::SPACE_ARGUMENT, &opt_rows, "Number of database descriptors" );
+  arg.AddArgument( "--iterations",  argT::SPACE_ARGUMENT, &opt_iterations, "Number of timed repetitions" );
+
+  if ( ! arg.Parse() )
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if ( opt_help )
+  {
+    std::cout << "This program measures the throughput of the vital distance kernels\n"
+              << "at each instruction set level supported by this CPU, relative to\n"
+              << "the scalar implementation.\n"
+              << "\n"
+              << "Options are:\n"
+              << arg.GetHelp() << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  if ( opt_dim <= 0 || opt_queries <= 0 || opt_rows <= 0 || opt_iterations <= 0 )
+  {
+    std::cerr << "All sizes must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Supported instruction set: "
+            << simd_level_name( supported_simd_level() ) << "\n"
+            << opt_queries << " x " << opt_rows << " distances per run\n\n";
+
+  benchmark< float, float >( "L2 squared (float)", l2_squared_many_to_many );
+  benchmark< double, double >( "L2 squared (double)", l2_squared_many_to_many );
+  benchmark< float, float >( "dot product (float)", dot_product_many_to_many );
+  benchmark< unsigned char, unsigned >( "Hamming (binary)", hamming_distance_many_to_many );
+
+  return EXIT_SUCCESS;
+}
@@ -38,6 +38,7 @@
 #include <vital/types/matrix.h>
 #include <Eigen/Geometry>
 
+#include <algorithm>
 #include <iomanip>
 
 namespace kwiver {
@@ -82,6 +83,61 @@ camera
 }
 
 
+namespace {
+
+/// Number of points transformed at once by the batch functions
+const size_t point_block_size = 512;
+
+typedef Eigen::Matrix< double, 3, Eigen::Dynamic > points_3d;
+typedef Eigen::Map< const points_3d > const_points_3d_map;
+
+} // end anonymous namespace
+
+
+/// Project many 3D points into 2D image points
+void
+camera
+::project( const double* pts, size_t n, double* pixels ) const
+{
+  const matrix_3x3d R( this->rotation() );
+  const vector_3d c( this->center() );
+  const camera_intrinsics_sptr K = this->intrinsics();
+
+  const size_t block = std::min( n, point_block_size );
+  points_3d offset( 3, block ), cam_pts( 3, block );
+  Eigen::Matrix< double, 2, Eigen::Dynamic > norm_pts( 2, block );
+  for ( size_t b = 0; b < n; b += block )
+  {
+    const size_t m = std::min( block, n - b );
+    const const_points_3d_map P( pts + 3 * b, 3, m );
+    offset.leftCols( m ) = P.colwise() - c;
+    cam_pts.leftCols( m ).noalias() = R * offset.leftCols( m );
+    norm_pts.leftCols( m ).array() = cam_pts.topLeftCorner( 2, m ).array().rowwise() /
+                                     cam_pts.row( 2 ).head( m ).array();
+    K->map_points( norm_pts.data(), m, pixels + 2 * b );
+  }
+}
+
+
+/// Compute the distances of many 3D points to the image plane
+void
+camera
+::depth( const double* pts, size_t n, double* depths ) const
+{
+  const Eigen::RowVector3d r( matrix_3x3d( this->rotation() ).row( 2 ) );
+  const vector_3d c( this->center() );
+
+  const size_t block = std::min( n, point_block_size );
+  points_3d offset( 3, block );
+  for ( size_t b = 0; b < n; b += block )
+  {
+    const size_t m = std::min( block, n - b );
+    offset.leftCols( m ) = const_points_3d_map( pts + 3 * b, 3, m ).colwise() - c;
+    Eigen::Map< Eigen::RowVectorXd >( depths + b, m ).noalias() = r * offset.leftCols( m );
+  }
+}
+
+
 /// output stream operator for a base class camera
 std::ostream&
 operator<<( std::ostream& s, const camera& c )
@@ -103,6 +159,41 @@ operator<<( std::ostream& s, const camera& c )
 }
 
 
+/// Convert to a 3x4 homogeneous projection matrix
+matrix_3x4d
+simple_camera
+::as_matrix() const
+{
+  std::shared_ptr< const matrix_3x4d > P = std::atomic_load( &matrix_cache_ );
+  if ( ! P )
+  {
+    // Two threads may both build the matrix here; either result is correct
+    P = std::allocate_shared< matrix_3x4d >(
+          Eigen::aligned_allocator< matrix_3x4d >(), camera::as_matrix() );
+    std::atomic_store( &matrix_cache_, P );
+  }
+  return *P;
+}
+
+
+/// Project a 3D point into a 2D image point
+vector_2d
+simple_camera
+::project( const vector_3d& pt ) const
+{
+  return intrinsics_->map( orientation_ * ( pt - center_ ) );
+}
+
+
+/// Compute the distance of the 3D point to the image plane
+double
+simple_camera
+::depth( const vector_3d& pt ) const
+{
+  return ( orientation_ * ( pt - center_ ) ).z();
+}
+
+
 /// Rotate the camera about its center such that it looks at the given point.
 void
 simple_camera
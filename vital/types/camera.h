@@ -104,6 +104,27 @@ public:
    */
   virtual double depth(const vector_3d& pt) const;
 
+  /// Project many 3D points into 2D image points
+  /**
+   *  This gives the same result as project() on each point, but reads the
+   *  rotation, center and intrinsics once and transforms blocks of points
+   *  with vectorized matrix products.
+   *
+   *  \param pts     array of 3 \a n coordinates, the x, y and z of each
+   *                 point adjacent
+   *  \param n       number of points
+   *  \param pixels  output array of 2 \a n coordinates
+   */
+  virtual void project( const double* pts, size_t n, double* pixels ) const;
+
+  /// Compute the distances of many 3D points to the image plane
+  /**
+   *  \param pts     array of 3 \a n coordinates, as for project()
+   *  \param n       number of points
+   *  \param depths  output array of \a n depths
+   */
+  virtual void depth( const double* pts, size_t n, double* depths ) const;
+
 protected:
   camera();
 
@@ -123,6 +144,9 @@ class VITAL_EXPORT simple_camera :
   public camera
 {
 public:
+  using camera::project;
+  using camera::depth;
+
   /// Default Constructor
   simple_camera ( )
   : center_( 0.0, 0.0, 0.0 ),
@@ -189,6 +213,21 @@ public:
   virtual camera_intrinsics_sptr intrinsics() const
   { return intrinsics_; }
 
+  /// Convert to a 3x4 homogeneous projection matrix
+  /**
+   *  The matrix is computed on first use and kept until one of the setters
+   *  changes the camera.  The cache cannot see changes made to the
+   *  intrinsics object through another shared pointer; call set_intrinsics()
+   *  again after modifying shared intrinsics in place.
+   */
+  virtual matrix_3x4d as_matrix() const;
+
+  /// Project a 3D point into a 2D image point
+  virtual vector_2d project( const vector_3d& pt ) const;
+
+  /// Compute the distance of the 3D point to the image plane
+  virtual double depth( const vector_3d& pt ) const;
+
   /// Accessor for the camera center of projection using underlying data type
   const vector_3d& get_center() const { return center_; }
 
@@ -199,22 +238,35 @@ public:
   const rotation_d& get_rotation() const { return orientation_; }
 
   /// Accessor for the intrinsics using underlying data type
-  camera_intrinsics_sptr get_intrinsics() const { return intrinsics_; }
+  /**
+   *  Unlike intrinsics(), this does not copy the shared pointer, so it is
+   *  cheap enough to call once per projected point.
+   */
+  const camera_intrinsics_sptr& get_intrinsics() const { return intrinsics_; }
 
   /// Set the camera center of projection
-  void set_center( const vector_3d& center ) { center_ = center; }
+  void set_center( const vector_3d& center )
+  {
+    center_ = center;
+    clear_matrix_cache();
+  }
 
   /// Set the translation vector (relative to current rotation)
   void set_translation( const vector_3d& translation )
   {
     center_ = -( orientation_.inverse() * translation );
+    clear_matrix_cache();
   }
 
   /// Set the covariance matrix of the feature
   void set_center_covar( const covariance_3d& center_covar ) { center_covar_ = center_covar; }
 
   /// Set the rotation
-  void set_rotation( const rotation_d& rotation ) { orientation_ = rotation; }
+  void set_rotation( const rotation_d& rotation )
+  {
+    orientation_ = rotation;
+    clear_matrix_cache();
+  }
 
   /// Set the intrinsics
   void set_intrinsics( const camera_intrinsics_sptr& intrinsics )
@@ -222,6 +274,7 @@ public:
     intrinsics_ = ! intrinsics
                   ? camera_intrinsics_sptr(new simple_camera_intrinsics())
                   : intrinsics;
+    clear_matrix_cache();
   }
 
   /// Rotate the camera about its center such that it looks at the given point.
@@ -235,6 +288,14 @@ public:
                 const vector_3d& up_direction = vector_3d::UnitZ() );
 
 protected:
+  /// Discard the cached projection matrix
+  /**
+   *  Derived classes that modify the protected members directly must call
+   *  this afterwards.
+   */
+  void clear_matrix_cache()
+  { std::atomic_store( &matrix_cache_, std::shared_ptr< const matrix_3x4d >() ); }
+
   /// The camera center of project
   vector_3d center_;
   /// The covariance of the camera center location
@@ -243,6 +304,14 @@ protected:
   rotation_d orientation_;
   /// The camera intrinics
   camera_intrinsics_sptr intrinsics_;
+
+private:
+  /// The projection matrix built by as_matrix(), or null if not yet built
+  /**
+   *  The matrix is immutable once built and is swapped atomically, so
+   *  concurrent const calls are safe.  Copies of the camera share it.
+   */
+  mutable std::shared_ptr< const matrix_3x4d > matrix_cache_;
 };
 
 
@@ -36,9 +36,11 @@
  */
 
 #include <vital/types/camera_intrinsics.h>
+#include <vital/types/lens_distortion.h>
 #include <vital/io/eigen_io.h>
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <iomanip>
 
 namespace kwiver {
@@ -99,139 +101,76 @@ camera_intrinsics
 }
 
 
-
 namespace // anonymous namespace
 {
 
-
-/// Compute the radial distortion scaling
-/** Distortion scaling is a function of the squared radius \p r2
- *  and the distortion parameters \p d
- */
-template < typename T >
-T
-radial_distortion_scale( const T                r2,
-                         const Eigen::VectorXd&  d )
+/// Apply a calibration matrix to an array of \p n distorted points in place
+void
+apply_calibration( const camera_intrinsics& k, double* pts, size_t n )
 {
-  T scale = T( 1 );
-
-  if ( d.rows() > 0 )
-  {
-    scale += r2 * d[0];
-    if ( d.rows() > 1 )
-    {
-      const T r4 = r2 * r2;
-      scale += r4 * d[1];
-      if ( d.rows() > 4 )
-      {
-        const T r6 = r2 * r4;
-        scale += r6 * d[4];
-        if ( d.rows() > 7 )
-        {
-          scale /= T( 1 ) + r2 * d[5] + r4 * d[6] + r6 * d[7];
-        }
-      }
-    }
-  }
-  return scale;
+  const double f = k.focal_length();
+  Eigen::Matrix2d A;
+  A << f, k.skew(),
+       0, f / k.aspect_ratio();
+  Eigen::Map< Eigen::Matrix< double, 2, Eigen::Dynamic > > P( pts, 2, n );
+  P = ( A * P ).colwise() + k.principal_point();
 }
 
+} // end anonymous namespace
 
-/// Compute radial distortion as a scaling and offset
-/** For a point \p pt and distortion coefficients \p d compute
- *  a scale and offset such that distortion can be applied as
- *  \code
- *    distorted_pt = pt * scale + offset;
- *  \endcode
- */
-template < typename T >
+
+/// Map many normalized image points into actual image coordinates
 void
-distortion_scale_offset( const Eigen::Matrix< T, 2, 1 >& pt,
-                         const Eigen::VectorXd& d,
-                         T& scale, Eigen::Matrix< T, 2, 1 >& offset )
+camera_intrinsics
+::map_points( const double* norm_pts, size_t n, double* pixels ) const
 {
-  const T x2 = pt.x() * pt.x();
-  const T y2 = pt.y() * pt.y();
-  const T r2 = x2 + y2;
-
-  scale = radial_distortion_scale( r2, d );
-  offset = Eigen::Matrix< T, 2, 1 > ( T( 0 ), T( 0 ) );
-  if ( d.rows() > 3 )
-  {
-    const T two_xy = 2 * pt.x() * pt.y();
-    offset = Eigen::Matrix< T, 2, 1 > ( d[2] * two_xy + d[3] * ( r2 + 2 * x2 ),
-                                        d[3] * two_xy + d[2] * ( r2 + 2 * y2 ) );
-  }
+  this->distort_points( norm_pts, n, pixels );
+  apply_calibration( *this, pixels, n );
 }
 
 
-/// Compute the derivative of the radial distortion as a function of \p r2
-template < typename T >
-T
-radial_distortion_deriv( const T                r2,
-                         const Eigen::VectorXd&  d )
+/// Unmap many image points back into normalized image coordinates
+void
+camera_intrinsics
+::unmap_points( const double* pixels, size_t n, double* norm_pts ) const
 {
-  T deriv = T( 0 );
+  const double f = this->focal_length();
+  const double a = this->aspect_ratio();
+  const double s = this->skew();
+  Eigen::Matrix2d A_inv;
+  A_inv << 1.0 / f, -s * a / ( f * f ),
+           0,       a / f;
+  Eigen::Map< const Eigen::Matrix< double, 2, Eigen::Dynamic > > P( pixels, 2, n );
+  Eigen::Map< Eigen::Matrix< double, 2, Eigen::Dynamic > > N( norm_pts, 2, n );
+  N = A_inv * ( P.colwise() - this->principal_point() );
+  this->undistort_points( norm_pts, n, norm_pts );
+}
+
 
-  if ( d.rows() > 0 )
+/// Map many normalized image points into distorted coordinates
+void
+camera_intrinsics
+::distort_points( const double* norm_pts, size_t n, double* dist_pts ) const
+{
+  for ( size_t i = 0; i < n; ++i )
   {
-    deriv += d[0];
-    if ( d.rows() > 1 )
-    {
-      deriv += 2 * d[1] * r2;
-      if ( d.rows() > 4 )
-      {
-        const T r4 = r2 * r2;
-        deriv += 3 * d[4] * r4;
-        if ( d.rows() > 7 )
-        {
-          const T r6 = r4 * r2;
-          const T a1 = T( 1 ) / ( d[5] * r2 + d[6] * r4 + d[7] * r6 + T( 1 ) );
-          const T a2 = d[5] + 2 * d[6] * r2 + 3 * d[7] * r4;
-          deriv -= a2 * a1 * ( d[0] * r2 + d[1] * r4 + d[4] * r6 + T( 1 ) );
-          deriv *= a1;
-        }
-      }
-    }
+    vector_2d::Map( dist_pts + 2 * i ) = this->distort( vector_2d::Map( norm_pts + 2 * i ) );
   }
-  return deriv;
 }
 
 
-/// Compute the Jacobian of the distortion at a point
-template < typename T >
-Eigen::Matrix< T, 2, 2 >
-distortion_jacobian( const Eigen::Matrix< T, 2, 1 >& pt,
-                     const Eigen::VectorXd& d )
+/// Unmap many distorted normalized points into normalized coordinates
+void
+camera_intrinsics
+::undistort_points( const double* dist_pts, size_t n, double* norm_pts ) const
 {
-  const T x2 = pt.x() * pt.x();
-  const T y2 = pt.y() * pt.y();
-  const T xy = pt.x() * pt.y();
-  const T r2 = x2 + y2;
-  const T d_scale = 2 * radial_distortion_deriv( r2, d );
-  const T scale = radial_distortion_scale( r2, d );
-  Eigen::Matrix< T, 2, 2 > J;
-
-  J << d_scale * x2 + scale, d_scale * xy,
-    d_scale * xy, d_scale * y2 + scale;
-  // add tangential distortion jacobian
-  if ( d.rows() > 3 )
+  for ( size_t i = 0; i < n; ++i )
   {
-    const T axy = 2 * ( d[2] * pt.x() + d[3] * pt.y() );
-    const T ay = 2 * d[2] * pt.y();
-    const T ax = 2 * d[3] * pt.x();
-    J( 0, 0 ) += ay + 3 * ax;
-    J( 0, 1 ) += axy;
-    J( 1, 0 ) += axy;
-    J( 0, 0 ) += 3 * ay + ax;
+    vector_2d::Map( norm_pts + 2 * i ) = this->undistort( vector_2d::Map( dist_pts + 2 * i ) );
   }
-  return J;
 }
 
 
-} // end anonymous namespace
-
-
 /// Constructor - from a calibration matrix
 simple_camera_intrinsics
 ::simple_camera_intrinsics( const matrix_3x3d& K,
@@ -250,11 +189,16 @@ vector_2d
 simple_camera_intrinsics
 ::distort( const vector_2d& norm_pt ) const
 {
-  double scale;
-  vector_2d offset;
-
-  distortion_scale_offset( norm_pt, dist_coeffs_, scale, offset );
-  return scale * norm_pt + offset;
+  const double* c = dist_coeffs_.data();
+  switch ( lens_distortion_terms( dist_coeffs_.size() ) )
+  {
+    case 8: return lens_distortion< 8 >::distort( c, norm_pt );
+    case 5: return lens_distortion< 5 >::distort( c, norm_pt );
+    case 4: return lens_distortion< 4 >::distort( c, norm_pt );
+    case 2: return lens_distortion< 2 >::distort( c, norm_pt );
+    case 1: return lens_distortion< 1 >::distort( c, norm_pt );
+    default: return norm_pt;
+  }
 }
 
 
@@ -263,28 +207,36 @@ vector_2d
 simple_camera_intrinsics
 ::undistort( const vector_2d& dist_pt ) const
 {
-  double scale;
-  vector_2d offset, residual;
-  vector_2d norm_pt = dist_pt;
-
-  // iteratively solve for the undistorted point
-  for ( unsigned int i = 0; i < 5; ++i )
+  const double* c = dist_coeffs_.data();
+  switch ( lens_distortion_terms( dist_coeffs_.size() ) )
   {
-    distortion_scale_offset( norm_pt, dist_coeffs_, scale, offset );
-    // This is a Gauss-Newton update
-    // an alternative is a fixed point iteration as used by OpenCV:
-    //   norm_pt = (dist_pt - offset) / scale;
-    // Gauss-Newton seems to have faster convergence
-    matrix_2x2d J = distortion_jacobian( norm_pt, dist_coeffs_ );
-    residual = norm_pt * scale + offset - dist_pt;
-    // check the maximum absolution residual to test convergence
-    if ( residual.cwiseAbs().maxCoeff() < 1e-12 )
-    {
-      break;
-    }
-    norm_pt -= J.ldlt().solve( residual );
+    case 8: return lens_distortion< 8 >::undistort( c, dist_pt );
+    case 5: return lens_distortion< 5 >::undistort( c, dist_pt );
+    case 4: return lens_distortion< 4 >::undistort( c, dist_pt );
+    case 2: return lens_distortion< 2 >::undistort( c, dist_pt );
+    case 1: return lens_distortion< 1 >::undistort( c, dist_pt );
+    default: return dist_pt;
   }
-  return norm_pt;
+}
+
+
+/// Map many normalized image points into distorted coordinates
+void
+simple_camera_intrinsics
+::distort_points( const double* norm_pts, size_t n, double* dist_pts ) const
+{
+  distort_lens_points( static_cast< unsigned >( dist_coeffs_.size() ),
+                       dist_coeffs_.data(), norm_pts, n, dist_pts );
+}
+
+
+/// Unmap many distorted normalized points into normalized coordinates
+void
+simple_camera_intrinsics
+::undistort_points( const double* dist_pts, size_t n, double* norm_pts ) const
+{
+  undistort_lens_points( static_cast< unsigned >( dist_coeffs_.size() ),
+                         dist_coeffs_.data(), dist_pts, n, norm_pts );
 }
 
 
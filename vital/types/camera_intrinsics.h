@@ -103,6 +103,54 @@ public:
    */
   virtual vector_2d unmap(const vector_2d& norm_pt) const;
 
+  /// Map many normalized image points into actual image coordinates
+  /**
+   *  This gives the same result as map() on each point.  The default
+   *  implementation calls distort() on each point and then applies the
+   *  calibration matrix to all points with vectorized arithmetic.
+   *
+   *  \param norm_pts  array of 2 \a n normalized coordinates
+   *  \param n         number of points
+   *  \param pixels    output array of 2 \a n image coordinates, which may
+   *                   be the same array as \a norm_pts
+   */
+  virtual void map_points(const double* norm_pts, size_t n, double* pixels) const;
+
+  /// Unmap many image points back into normalized image coordinates
+  /**
+   *  This gives the same result as unmap() on each point, with the
+   *  inverse calibration matrix applied to all points at once followed by
+   *  undistort_points().
+   *
+   *  \param pixels    array of 2 \a n image coordinates
+   *  \param n         number of points
+   *  \param norm_pts  output array of 2 \a n normalized coordinates,
+   *                   which may be the same array as \a pixels
+   */
+  virtual void unmap_points(const double* pixels, size_t n, double* norm_pts) const;
+
+  /// Map many normalized image points into distorted coordinates
+  /**
+   *  The default implementation calls distort() on each point.
+   *
+   *  \param norm_pts  array of 2 \a n normalized coordinates
+   *  \param n         number of points
+   *  \param dist_pts  output array of 2 \a n distorted coordinates, which
+   *                   may be the same array as \a norm_pts
+   */
+  virtual void distort_points(const double* norm_pts, size_t n, double* dist_pts) const;
+
+  /// Unmap many distorted normalized points into normalized coordinates
+  /**
+   *  The default implementation calls undistort() on each point.
+   *
+   *  \param dist_pts  array of 2 \a n distorted coordinates
+   *  \param n         number of points
+   *  \param norm_pts  output array of 2 \a n normalized coordinates, which
+   *                   may be the same array as \a dist_pts
+   */
+  virtual void undistort_points(const double* dist_pts, size_t n, double* norm_pts) const;
+
   /// Map normalized image coordinates into distorted coordinates
   /**
    *  The default implementation is the identity transformation (no distortion)
@@ -221,6 +269,23 @@ public:
    */
   virtual vector_2d undistort(const vector_2d& dist_pt) const;
 
+  /// Map many normalized image points into distorted coordinates
+  /**
+   *  The distortion model is selected once from the number of
+   *  coefficients, and blocks of points are distorted with vectorized
+   *  arithmetic.  Without coefficients the points are copied.
+   */
+  virtual void distort_points(const double* norm_pts, size_t n, double* dist_pts) const;
+
+  /// Unmap many distorted normalized points into normalized coordinates
+  /**
+   *  Each iteration of the solver updates a block of points with
+   *  vectorized arithmetic, and points leave the block as soon as their
+   *  residual is below tolerance, so points near the center, which
+   *  converge in one or two iterations, cost little.
+   */
+  virtual void undistort_points(const double* dist_pts, size_t n, double* norm_pts) const;
+
 protected:
   /// focal length of camera
   double focal_length_;
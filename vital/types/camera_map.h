@@ -40,6 +40,7 @@
 
 #include <vital/vital_types.h>
 #include <vital/vital_config.h>
+#include <vital/util/container_view.h>
 
 #include <map>
 #include <memory>
@@ -54,6 +55,9 @@ public:
   /// typedef for std::map from integer IDs to cameras
   typedef std::map< frame_id_t, camera_sptr > map_camera_t;
 
+  /// typedef for a read-only view of the camera map
+  typedef container_view< map_camera_t > cameras_view_t;
+
   /// Destructor
   virtual ~camera_map() VITAL_DEFAULT_DTOR
 
@@ -62,6 +66,13 @@ public:
 
   /// Return a map from integer IDs to camera shared pointers
   virtual map_camera_t cameras() const = 0;
+
+  /// Return a read-only view of the map from integer IDs to cameras; see container_view
+  virtual cameras_view_t cameras_view() const
+  {
+    return cameras_view_t(
+      std::make_shared< const map_camera_t >( this->cameras() ) );
+  }
 };
 
 /// typedef for a camera shared pointer
@@ -86,6 +97,9 @@ public:
   /// Return a map from integer IDs to camera shared pointers
   virtual map_camera_t cameras() const { return data_; }
 
+  /// Return a read-only view of the map from integer IDs to cameras
+  virtual cameras_view_t cameras_view() const { return cameras_view_t( data_ ); }
+
 
 protected:
   /// The map from integer IDs to camera shared pointers
@@ -0,0 +1,325 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for a feature_set stored as one array per attribute
+ */
+
+#ifndef VITAL_COLUMNAR_FEATURE_SET_H_
+#define VITAL_COLUMNAR_FEATURE_SET_H_
+
+#include "feature_set.h"
+
+#include <vital/vital_foreach.h>
+
+#include <Eigen/Core>
+
+#include <memory>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+// ------------------------------------------------------------------
+/// A feature set that stores each feature attribute in a contiguous array
+/**
+ * Rather than one feature object per feature, this set keeps a column per
+ * attribute: an N x 2 row-major array of locations, arrays of magnitudes,
+ * scales and angles, an N x 3 array of packed covariances (the upper
+ * triangle in the order of covariance_::data()) and an array of colors.
+ * Algorithms can operate directly on the columns through the raw pointer
+ * accessors, for example passing location_matrix() to a solver without
+ * touching any feature object.
+ *
+ * Feature objects are only created when requested through features() or
+ * at().  They are copies, so modifying them does not modify the set.
+ *
+ * \tparam T  The real number type of the columns (float or double).
+ */
+template < typename T >
+class columnar_feature_set :
+  public feature_set
+{
+public:
+  /// The real number type of the columns
+  typedef T value_type;
+  /// A read-only map of the locations as an N x 2 matrix
+  typedef Eigen::Map< const Eigen::Matrix< T, Eigen::Dynamic, 2, Eigen::RowMajor > >
+    location_matrix_t;
+
+  /// Default Constructor
+  columnar_feature_set() { }
+
+  /// Constructor for \a num default features
+  /**
+   * Default features are at the origin with unit scale and covariance,
+   * zero magnitude and angle, and the default color.
+   */
+  explicit columnar_feature_set( size_t num )
+  {
+    this->resize( num );
+  }
+
+  /// Constructor from a vector of features
+  /**
+   * The feature attributes are copied into the columns.  Null features
+   * are stored as default features.
+   */
+  explicit columnar_feature_set( std::vector< feature_sptr > const& features )
+  {
+    this->reserve( features.size() );
+    VITAL_FOREACH( feature_sptr const& f, features )
+    {
+      if ( f )
+      {
+        this->push_back( *f );
+      }
+      else
+      {
+        this->resize( this->size() + 1 );
+      }
+    }
+  }
+
+  /// Return the number of features in the set
+  virtual size_t size() const { return magnitudes_.size(); }
+
+  /// Return a vector of newly created features holding the column values
+  virtual std::vector< feature_sptr > features() const
+  {
+    std::vector< feature_sptr > feats;
+    feats.reserve( this->size() );
+    for ( size_t i = 0; i < this->size(); ++i )
+    {
+      feats.push_back( this->at( i ) );
+    }
+    return feats;
+  }
+
+  /// Return a newly created feature holding the values of feature \a i
+  feature_sptr at( size_t i ) const
+  {
+    std::shared_ptr< feature_< T > > f =
+      std::make_shared< feature_< T > >( this->location( i ), magnitudes_[i],
+                                         scales_[i], angles_[i], colors_[i] );
+    covariance_< 2, T > c;
+    c( 0, 0 ) = covariances_[3 * i];
+    c( 0, 1 ) = covariances_[3 * i + 1];
+    c( 1, 1 ) = covariances_[3 * i + 2];
+    f->set_covar( c );
+    return f;
+  }
+
+  /// Return the location of feature \a i
+  Eigen::Matrix< T, 2, 1 > location( size_t i ) const
+  {
+    return Eigen::Matrix< T, 2, 1 >( locations_[2 * i], locations_[2 * i + 1] );
+  }
+
+  /// Append a feature, copying its attributes into the columns
+  void push_back( feature const& f )
+  {
+    const vector_2d loc = f.loc();
+    const covariance_2d covar = f.covar();
+    locations_.push_back( static_cast< T >( loc[0] ) );
+    locations_.push_back( static_cast< T >( loc[1] ) );
+    magnitudes_.push_back( static_cast< T >( f.magnitude() ) );
+    scales_.push_back( static_cast< T >( f.scale() ) );
+    angles_.push_back( static_cast< T >( f.angle() ) );
+    covariances_.push_back( static_cast< T >( covar( 0, 0 ) ) );
+    covariances_.push_back( static_cast< T >( covar( 0, 1 ) ) );
+    covariances_.push_back( static_cast< T >( covar( 1, 1 ) ) );
+    colors_.push_back( f.color() );
+  }
+
+  /// Append a feature given its location and optional attributes
+  void push_back( Eigen::Matrix< T, 2, 1 > const& loc, T mag = 0,
+                  T scale = 1, T angle = 0,
+                  rgb_color const& color = rgb_color() )
+  {
+    locations_.push_back( loc[0] );
+    locations_.push_back( loc[1] );
+    magnitudes_.push_back( mag );
+    scales_.push_back( scale );
+    angles_.push_back( angle );
+    covariances_.push_back( 1 );
+    covariances_.push_back( 0 );
+    covariances_.push_back( 1 );
+    colors_.push_back( color );
+  }
+
+  /// Reserve storage for \a num features in every column
+  void reserve( size_t num )
+  {
+    locations_.reserve( 2 * num );
+    magnitudes_.reserve( num );
+    scales_.reserve( num );
+    angles_.reserve( num );
+    covariances_.reserve( 3 * num );
+    colors_.reserve( num );
+  }
+
+  /// Change the number of features, appending default features if growing
+  void resize( size_t num )
+  {
+    const size_t old = this->size();
+    locations_.resize( 2 * num, T( 0 ) );
+    magnitudes_.resize( num, T( 0 ) );
+    scales_.resize( num, T( 1 ) );
+    angles_.resize( num, T( 0 ) );
+    covariances_.resize( 3 * num, T( 0 ) );
+    colors_.resize( num );
+    for ( size_t i = old; i < num; ++i )
+    {
+      covariances_[3 * i] = covariances_[3 * i + 2] = T( 1 );
+    }
+  }
+
+  /// Return the N x 2 row-major array of locations
+  T* locations() { return locations_.empty() ? 0 : &locations_[0]; }
+  /// Return the N x 2 row-major array of locations
+  T const* locations() const { return locations_.empty() ? 0 : &locations_[0]; }
+
+  /// Return the locations as a read-only N x 2 matrix without copying them
+  location_matrix_t location_matrix() const
+  {
+    return location_matrix_t( this->locations(), this->size(), 2 );
+  }
+
+  /// Return the array of magnitudes
+  T* magnitudes() { return magnitudes_.empty() ? 0 : &magnitudes_[0]; }
+  /// Return the array of magnitudes
+  T const* magnitudes() const { return magnitudes_.empty() ? 0 : &magnitudes_[0]; }
+
+  /// Return the array of scales
+  T* scales() { return scales_.empty() ? 0 : &scales_[0]; }
+  /// Return the array of scales
+  T const* scales() const { return scales_.empty() ? 0 : &scales_[0]; }
+
+  /// Return the array of angles
+  T* angles() { return angles_.empty() ? 0 : &angles_[0]; }
+  /// Return the array of angles
+  T const* angles() const { return angles_.empty() ? 0 : &angles_[0]; }
+
+  /// Return the N x 3 array of packed covariances
+  /**
+   * Each row holds the (0, 0), (0, 1) and (1, 1) covariance entries.
+   */
+  T* covariances() { return covariances_.empty() ? 0 : &covariances_[0]; }
+  /// Return the N x 3 array of packed covariances
+  T const* covariances() const { return covariances_.empty() ? 0 : &covariances_[0]; }
+
+  /// Return the array of colors
+  rgb_color* colors() { return colors_.empty() ? 0 : &colors_[0]; }
+  /// Return the array of colors
+  rgb_color const* colors() const { return colors_.empty() ? 0 : &colors_[0]; }
+
+
+protected:
+  /// N x 2 row-major feature locations
+  std::vector< T > locations_;
+  /// feature magnitudes
+  std::vector< T > magnitudes_;
+  /// feature scales
+  std::vector< T > scales_;
+  /// feature angles
+  std::vector< T > angles_;
+  /// N x 3 packed feature covariances
+  std::vector< T > covariances_;
+  /// feature colors
+  std::vector< rgb_color > colors_;
+};
+
+/// Double-precision columnar_feature_set type
+typedef columnar_feature_set< double > columnar_feature_set_d;
+/// Single-precision columnar_feature_set type
+typedef columnar_feature_set< float > columnar_feature_set_f;
+
+
+// ------------------------------------------------------------------
+/// Random access to the locations of any feature set
+/**
+ * For a columnar_feature_set the locations are read directly from its
+ * location column.  Any other feature set is accessed through a view of
+ * its features.  This lets algorithms that only need locations, such as
+ * the estimators of geometric relations between matched features, avoid
+ * creating feature objects.
+ */
+class feature_location_view
+{
+public:
+  /// Constructor
+  explicit feature_location_view( feature_set_sptr const& features )
+    : m_set( features ),
+    m_double( location_column< double >( features ) ),
+    m_float( location_column< float >( features ) ),
+    m_view( ( m_double || m_float )
+            ? feature_set::features_view_t(
+                std::make_shared< const std::vector< feature_sptr > >() )
+            : features->features_view() )
+  {
+  }
+
+  /// Return the location of feature \a i
+  vector_2d operator[]( size_t i ) const
+  {
+    if ( m_double )
+    {
+      return vector_2d( m_double[2 * i], m_double[2 * i + 1] );
+    }
+    if ( m_float )
+    {
+      return vector_2d( m_float[2 * i], m_float[2 * i + 1] );
+    }
+    return m_view[i]->loc();
+  }
+
+
+private:
+  /// Return the location column of a columnar set of type \a U, or null
+  template < typename U >
+  static U const* location_column( feature_set_sptr const& features )
+  {
+    columnar_feature_set< U > const* c =
+      dynamic_cast< columnar_feature_set< U > const* >( features.get() );
+    return c ? c->locations() : 0;
+  }
+
+  /// keeps the feature set alive while the view refers to its columns
+  feature_set_sptr m_set;
+  double const* m_double;
+  float const* m_float;
+  feature_set::features_view_t m_view;
+};
+
+} } // end namespace vital
+
+#endif // VITAL_COLUMNAR_FEATURE_SET_H_
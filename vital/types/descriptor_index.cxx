@@ -0,0 +1,1155 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of approximate nearest neighbor descriptor indices
+ */
+
+#include "descriptor_index.h"
+
+#include <vital/exceptions/base.h>
+#include <vital/exceptions/io.h>
+#include <vital/types/descriptor_matrix_set.h>
+#include <vital/util/distance_kernels.h>
+#include <vital/util/thread_pool.h>
+#include <vital/vital_foreach.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+#include <stdint.h>
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+/// Identifies a descriptor index stream
+const char index_magic[4] = { 'V', 'D', 'I', 'X' };
+/// Version of the stream format
+const uint32_t index_version = 1;
+/// Type tags of the stream format
+const uint32_t kd_forest_tag = 1;
+const uint32_t lsh_tag = 2;
+/// Largest number of trees or hash tables accepted when reading a stream
+const uint32_t max_stored_tables = 1024;
+
+
+// ------------------------------------------------------------------
+// Binary stream helpers
+template < typename T >
+void
+write_value( std::ostream& s, T const& v )
+{
+  s.write( reinterpret_cast< char const* >( &v ), sizeof( T ) );
+}
+
+
+template < typename T >
+void
+write_vector( std::ostream& s, std::vector< T > const& v )
+{
+  write_value< uint64_t >( s, v.size() );
+  if ( ! v.empty() )
+  {
+    s.write( reinterpret_cast< char const* >( &v[0] ), v.size() * sizeof( T ) );
+  }
+}
+
+
+template < typename T >
+T
+read_value( std::istream& s )
+{
+  T v;
+  if ( ! s.read( reinterpret_cast< char* >( &v ), sizeof( T ) ) )
+  {
+    throw invalid_data( "unexpected end of descriptor index stream" );
+  }
+  return v;
+}
+
+
+template < typename T >
+void
+read_vector( std::istream& s, std::vector< T >& v )
+{
+  const uint64_t n = read_value< uint64_t >( s );
+  // read in bounded pieces so a corrupt size fails at the end of the stream
+  // rather than with a huge allocation
+  const uint64_t piece = ( 1 << 20 ) / sizeof( T ) + 1;
+  v.clear();
+  for ( uint64_t done = 0; done < n; )
+  {
+    const size_t count = static_cast< size_t >( std::min( piece, n - done ) );
+    v.resize( static_cast< size_t >( done ) + count );
+    if ( ! s.read( reinterpret_cast< char* >( &v[static_cast< size_t >( done )] ),
+                   count * sizeof( T ) ) )
+    {
+      throw invalid_data( "unexpected end of descriptor index stream" );
+    }
+    done += count;
+  }
+}
+
+
+void
+check_stream( std::ostream& s )
+{
+  if ( ! s )
+  {
+    throw invalid_data( "failed to write descriptor index stream" );
+  }
+}
+
+
+// ------------------------------------------------------------------
+// Append the descriptors of a set to row-major storage of \a dim columns.
+// If \a dim is zero it is set from the first non-null descriptor.
+template < typename T >
+void
+append_rows( descriptor_set_sptr const& ds, size_t& dim, std::vector< T >& rows )
+{
+  if ( ! ds || ds->size() == 0 )
+  {
+    return;
+  }
+
+  std::shared_ptr< descriptor_matrix_set< T > > m =
+    std::dynamic_pointer_cast< descriptor_matrix_set< T > >( ds );
+  if ( m && ( dim == 0 || dim == m->dim() ) )
+  {
+    dim = m->dim();
+    const size_t first = rows.size();
+    rows.resize( first + m->size() * dim );
+    for ( size_t i = 0; i < m->size(); ++i )
+    {
+      std::memcpy( &rows[first + i * dim], m->row( i ), dim * sizeof( T ) );
+    }
+    return;
+  }
+
+  const descriptor_set::descriptors_view_t descs = ds->descriptors_view();
+  if ( dim == 0 )
+  {
+    VITAL_FOREACH( descriptor_sptr const& d, descs )
+    {
+      if ( d )
+      {
+        dim = d->size();
+        break;
+      }
+    }
+  }
+
+  const size_t first = rows.size();
+  rows.resize( first + descs.size() * dim, T( 0 ) );
+  for ( size_t i = 0; i < descs.size(); ++i )
+  {
+    descriptor const* d = descs[i].get();
+    if ( ! d )
+    {
+      continue;
+    }
+    if ( d->size() != dim )
+    {
+      rows.resize( first );
+      std::stringstream msg;
+      msg << "descriptor " << i << " has length " << d->size()
+          << " but the index has length " << dim;
+      throw invalid_value( msg.str() );
+    }
+
+    T* row = &rows[first + i * dim];
+    descriptor_array_of< T > const* d_typed =
+      dynamic_cast< descriptor_array_of< T > const* >( d );
+    if ( d_typed )
+    {
+      std::memcpy( row, d_typed->raw_data(), dim * sizeof( T ) );
+    }
+    else
+    {
+      std::vector< double > const values = d->as_double();
+      for ( size_t j = 0; j < dim; ++j )
+      {
+        row[j] = static_cast< T >( values[j] );
+      }
+    }
+  }
+}
+
+
+// ------------------------------------------------------------------
+// Throw invalid_value unless all descriptors of a set have byte elements
+void
+check_byte_elements( descriptor_set_sptr const& ds )
+{
+  if ( ! ds || std::dynamic_pointer_cast< descriptor_matrix_set< unsigned char > >( ds ) )
+  {
+    return;
+  }
+
+  const descriptor_set::descriptors_view_t descs = ds->descriptors_view();
+  for ( size_t i = 0; i < descs.size(); ++i )
+  {
+    descriptor const* d = descs[i].get();
+    if ( d && ! dynamic_cast< descriptor_array_of< unsigned char > const* >( d ) )
+    {
+      std::stringstream msg;
+      msg << "descriptor " << i << " does not have unsigned char elements";
+      throw invalid_value( msg.str() );
+    }
+  }
+}
+
+
+// ------------------------------------------------------------------
+// A short list of the best neighbors found so far, sorted by distance
+template < typename D >
+class neighbor_list
+{
+public:
+  explicit neighbor_list( unsigned k ) : k_( k ) { list_.reserve( k + 1 ); }
+
+  bool full() const { return list_.size() >= k_; }
+
+  D worst() const
+  {
+    if ( k_ == 0 )
+    {
+      return D();
+    }
+    return full() ? list_.back().first : std::numeric_limits< D >::max();
+  }
+
+  void insert( D d, uint32_t index )
+  {
+    if ( k_ == 0 || ( full() && ! ( d < list_.back().first ) ) )
+    {
+      return;
+    }
+    typename std::vector< std::pair< D, uint32_t > >::iterator it =
+      std::upper_bound( list_.begin(), list_.end(), std::make_pair( d, index ) );
+    list_.insert( it, std::make_pair( d, index ) );
+    if ( list_.size() > k_ )
+    {
+      list_.pop_back();
+    }
+  }
+
+  std::vector< std::pair< D, uint32_t > > const& items() const { return list_; }
+
+private:
+  unsigned k_;
+  std::vector< std::pair< D, uint32_t > > list_;
+};
+
+
+// ------------------------------------------------------------------
+// Marks descriptors already compared for the current query without
+// clearing an array per query
+class visit_marks
+{
+public:
+  explicit visit_marks( size_t n ) : marks_( n, 0 ), stamp_( 0 ) { }
+
+  void next_query()
+  {
+    if ( ++stamp_ == 0 )
+    {
+      std::fill( marks_.begin(), marks_.end(), 0 );
+      stamp_ = 1;
+    }
+  }
+
+  /// Mark \a i as visited, returning false if it already was
+  bool visit( uint32_t i )
+  {
+    if ( marks_[i] == stamp_ )
+    {
+      return false;
+    }
+    marks_[i] = stamp_;
+    return true;
+  }
+
+private:
+  std::vector< uint32_t > marks_;
+  uint32_t stamp_;
+};
+
+
+// ------------------------------------------------------------------
+// Check the size of an index before adding descriptors to it
+void
+check_capacity( size_t current, size_t added )
+{
+  if ( current + added > std::numeric_limits< uint32_t >::max() )
+  {
+    throw invalid_value( "descriptor index can hold at most 2^32 - 1 descriptors" );
+  }
+}
+
+} // end anonymous namespace
+
+
+// ==================================================================
+descriptor_neighbors
+descriptor_index
+::nearest( descriptor_sptr const& query, unsigned k ) const
+{
+  std::vector< descriptor_sptr > q( 1, query );
+  return this->nearest( std::make_shared< simple_descriptor_set >( q ), k, 1 )[0];
+}
+
+
+// ------------------------------------------------------------------
+descriptor_index_sptr
+descriptor_index
+::read( std::istream& stream )
+{
+  char magic[4];
+  if ( ! stream.read( magic, 4 ) || std::memcmp( magic, index_magic, 4 ) != 0 )
+  {
+    throw invalid_data( "stream does not contain a descriptor index" );
+  }
+  const uint32_t version = read_value< uint32_t >( stream );
+  if ( version != index_version )
+  {
+    std::stringstream msg;
+    msg << "unsupported descriptor index version " << version;
+    throw invalid_data( msg.str() );
+  }
+
+  const uint32_t tag = read_value< uint32_t >( stream );
+  switch ( tag )
+  {
+    case kd_forest_tag:
+      return kd_forest_descriptor_index::read_body( stream );
+    case lsh_tag:
+      return lsh_descriptor_index::read_body( stream );
+  }
+
+  std::stringstream msg;
+  msg << "unknown descriptor index type " << tag;
+  throw invalid_data( msg.str() );
+}
+
+
+// ==================================================================
+/// Private implementation of the k-d forest
+class kd_forest_descriptor_index::priv
+{
+public:
+  /// A node of a k-d tree; leaves have no children
+  struct node
+  {
+    node() : split_dim( 0 ), split_value( 0 ) { child[0] = child[1] = -1; }
+
+    bool is_leaf() const { return child[0] < 0; }
+
+    int32_t child[2];
+    uint32_t split_dim;
+    float split_value;
+    std::vector< uint32_t > points;
+  };
+
+  /// A tree is stored as an array of nodes with the root first
+  typedef std::vector< node > tree;
+
+  /// A branch of a tree left unexplored during a search
+  struct branch
+  {
+    float bound;
+    uint32_t tree_id;
+    int32_t node_id;
+
+    // reversed so that std::priority_queue yields the smallest bound
+    bool operator<( branch const& other ) const { return bound > other.bound; }
+  };
+
+  explicit priv( parameters const& p )
+    : params( p ),
+    dim( 0 ),
+    built_size( 0 ),
+    rng( p.seed )
+  {
+  }
+
+  size_t size() const { return dim ? data.size() / dim : 0; }
+
+  float const* row( size_t i ) const { return &data[i * dim]; }
+
+  /// Build all trees from scratch
+  void build()
+  {
+    trees.assign( std::max( 1u, params.num_trees ), tree() );
+    std::vector< uint32_t > all( size() );
+    for ( size_t i = 0; i < all.size(); ++i )
+    {
+      all[i] = static_cast< uint32_t >( i );
+    }
+    for ( size_t t = 0; t < trees.size(); ++t )
+    {
+      trees[t].push_back( node() );
+      std::vector< uint32_t > pts = all;
+      build_node( trees[t], 0, pts );
+    }
+    built_size = size();
+  }
+
+  /// Make node \a id of \a tr a subtree over the points \a pts
+  void build_node( tree& tr, int32_t id, std::vector< uint32_t >& pts )
+  {
+    const size_t leaf_size = std::max( 1u, params.leaf_size );
+    if ( pts.size() <= leaf_size || ! choose_split( pts, tr[id] ) )
+    {
+      tr[id].child[0] = tr[id].child[1] = -1;
+      tr[id].points.swap( pts );
+      return;
+    }
+
+    const uint32_t d = tr[id].split_dim;
+    const float v = tr[id].split_value;
+    std::vector< uint32_t >::iterator mid =
+      std::partition( pts.begin(), pts.end(),
+                      [this, d, v] ( uint32_t p ) { return row( p )[d] <= v; } );
+    if ( mid == pts.begin() || mid == pts.end() )
+    {
+      tr[id].child[0] = tr[id].child[1] = -1;
+      tr[id].points.swap( pts );
+      return;
+    }
+
+    std::vector< uint32_t > left( pts.begin(), mid );
+    std::vector< uint32_t > right( mid, pts.end() );
+    std::vector< uint32_t >().swap( pts );
+    tr[id].points.clear();
+
+    const int32_t l = static_cast< int32_t >( tr.size() );
+    tr.push_back( node() );
+    tr.push_back( node() );
+    tr[id].child[0] = l;
+    tr[id].child[1] = l + 1;
+    build_node( tr, l, left );
+    build_node( tr, l + 1, right );
+  }
+
+  /// Choose a split dimension at random among those of highest variance
+  bool choose_split( std::vector< uint32_t > const& pts, node& n )
+  {
+    const size_t max_samples = 100;
+    const size_t num_samples = std::min( max_samples, pts.size() );
+    const size_t step = pts.size() / num_samples;
+
+    std::vector< double > mean( dim, 0.0 );
+    std::vector< double > var( dim, 0.0 );
+    for ( size_t s = 0; s < num_samples; ++s )
+    {
+      float const* r = row( pts[s * step] );
+      for ( size_t j = 0; j < dim; ++j )
+      {
+        mean[j] += r[j];
+        var[j] += static_cast< double >( r[j] ) * r[j];
+      }
+    }
+
+    std::vector< uint32_t > dims( dim );
+    for ( size_t j = 0; j < dim; ++j )
+    {
+      mean[j] /= num_samples;
+      var[j] = var[j] / num_samples - mean[j] * mean[j];
+      dims[j] = static_cast< uint32_t >( j );
+    }
+
+    const size_t num_candidates = std::min< size_t >( 5, dim );
+    std::partial_sort( dims.begin(), dims.begin() + num_candidates, dims.end(),
+                       [&var] ( uint32_t a, uint32_t b ) { return var[a] > var[b]; } );
+    if ( ! ( var[dims[0]] > 0.0 ) )
+    {
+      return false;
+    }
+
+    size_t c = std::uniform_int_distribution< size_t >( 0, num_candidates - 1 )( rng );
+    if ( ! ( var[dims[c]] > 0.0 ) )
+    {
+      c = 0;
+    }
+    n.split_dim = dims[c];
+    n.split_value = static_cast< float >( mean[dims[c]] );
+    return true;
+  }
+
+  /// Insert point \a p into a built tree, splitting the leaf if it grows too large
+  void insert( tree& tr, uint32_t p )
+  {
+    int32_t id = 0;
+    float const* r = row( p );
+    while ( ! tr[id].is_leaf() )
+    {
+      id = tr[id].child[ r[tr[id].split_dim] <= tr[id].split_value ? 0 : 1 ];
+    }
+    tr[id].points.push_back( p );
+    if ( tr[id].points.size() > 2 * std::max( 1u, params.leaf_size ) )
+    {
+      std::vector< uint32_t > pts;
+      pts.swap( tr[id].points );
+      build_node( tr, id, pts );
+    }
+  }
+
+  /// Descend from a node to a leaf, queueing the branches not taken
+  void descend( float const* q, uint32_t t, int32_t id, float bound,
+                neighbor_list< float >& best, visit_marks& marks,
+                std::priority_queue< branch >& branches, size_t& checks ) const
+  {
+    tree const& tr = trees[t];
+    while ( ! tr[id].is_leaf() )
+    {
+      node const& n = tr[id];
+      const float diff = q[n.split_dim] - n.split_value;
+      const int near_side = diff <= 0.0f ? 0 : 1;
+      // any point across the split plane is at least this far away
+      const float far_bound = std::max( bound, diff * diff );
+      if ( far_bound < best.worst() )
+      {
+        branch b = { far_bound, t, n.child[1 - near_side] };
+        branches.push( b );
+      }
+      id = n.child[near_side];
+    }
+
+    VITAL_FOREACH( uint32_t p, tr[id].points )
+    {
+      if ( marks.visit( p ) )
+      {
+        best.insert( l2_squared( q, row( p ), dim ), p );
+        ++checks;
+      }
+    }
+  }
+
+  /// Search all trees for the neighbors of \a q
+  void search( float const* q, unsigned k, visit_marks& marks,
+               descriptor_neighbors& result ) const
+  {
+    neighbor_list< float > best( k );
+    std::priority_queue< branch > branches;
+    size_t checks = 0;
+    const size_t max_checks = params.max_checks == 0
+      ? std::numeric_limits< size_t >::max()
+      : std::max< size_t >( params.max_checks, k );
+
+    marks.next_query();
+    for ( uint32_t t = 0; t < trees.size(); ++t )
+    {
+      descend( q, t, 0, 0.0f, best, marks, branches, checks );
+    }
+    while ( ! branches.empty() && checks < max_checks )
+    {
+      const branch b = branches.top();
+      branches.pop();
+      if ( ! ( b.bound < best.worst() ) )
+      {
+        break;
+      }
+      descend( q, b.tree_id, b.node_id, b.bound, best, marks, branches, checks );
+    }
+
+    result.clear();
+    for ( size_t i = 0; i < best.items().size(); ++i )
+    {
+      descriptor_neighbor n;
+      n.index = best.items()[i].second;
+      n.distance = std::sqrt( static_cast< double >( best.items()[i].first ) );
+      result.push_back( n );
+    }
+  }
+
+  parameters params;
+  size_t dim;
+  std::vector< float > data;
+  std::vector< tree > trees;
+  size_t built_size;
+  std::mt19937 rng;
+};
+
+
+// ------------------------------------------------------------------
+kd_forest_descriptor_index
+::kd_forest_descriptor_index( parameters const& params )
+  : d_( new priv( params ) )
+{
+}
+
+
+kd_forest_descriptor_index
+::~kd_forest_descriptor_index()
+{
+}
+
+
+kd_forest_descriptor_index::parameters const&
+kd_forest_descriptor_index
+::get_parameters() const
+{
+  return d_->params;
+}
+
+
+void
+kd_forest_descriptor_index
+::set_max_checks( unsigned max_checks )
+{
+  d_->params.max_checks = max_checks;
+}
+
+
+size_t
+kd_forest_descriptor_index
+::size() const
+{
+  return d_->size();
+}
+
+
+size_t
+kd_forest_descriptor_index
+::dim() const
+{
+  return d_->dim;
+}
+
+
+// ------------------------------------------------------------------
+size_t
+kd_forest_descriptor_index
+::add( descriptor_set_sptr const& descriptors )
+{
+  const size_t first = d_->size();
+  check_capacity( first, descriptors ? descriptors->size() : 0 );
+  append_rows( descriptors, d_->dim, d_->data );
+  const size_t n = d_->size();
+  if ( n == first )
+  {
+    return first;
+  }
+
+  // rebuilding whenever the index doubles keeps the trees balanced at an
+  // amortized constant cost per descriptor
+  if ( d_->trees.empty() || n >= 2 * d_->built_size )
+  {
+    d_->build();
+  }
+  else
+  {
+    for ( size_t t = 0; t < d_->trees.size(); ++t )
+    {
+      for ( size_t i = first; i < n; ++i )
+      {
+        d_->insert( d_->trees[t], static_cast< uint32_t >( i ) );
+      }
+    }
+  }
+  return first;
+}
+
+
+// ------------------------------------------------------------------
+std::vector< descriptor_neighbors >
+kd_forest_descriptor_index
+::nearest( descriptor_set_sptr const& queries, unsigned k,
+           unsigned num_threads ) const
+{
+  std::vector< descriptor_neighbors > results;
+  if ( ! queries || queries->size() == 0 )
+  {
+    return results;
+  }
+
+  size_t qdim = d_->dim;
+  std::vector< float > q;
+  append_rows( queries, qdim, q );
+  results.resize( queries->size() );
+  if ( d_->size() == 0 || k == 0 )
+  {
+    return results;
+  }
+
+  priv const& d = *d_;
+  parallel_for( 0, results.size(), [&] ( size_t b, size_t e )
+  {
+    visit_marks marks( d.size() );
+    for ( size_t i = b; i < e; ++i )
+    {
+      d.search( &q[i * d.dim], k, marks, results[i] );
+    }
+  }, 0, num_threads );
+  return results;
+}
+
+
+// ------------------------------------------------------------------
+void
+kd_forest_descriptor_index
+::write( std::ostream& s ) const
+{
+  s.write( index_magic, 4 );
+  write_value( s, index_version );
+  write_value( s, kd_forest_tag );
+
+  write_value< uint32_t >( s, d_->params.num_trees );
+  write_value< uint32_t >( s, d_->params.leaf_size );
+  write_value< uint32_t >( s, d_->params.max_checks );
+  write_value< uint32_t >( s, d_->params.seed );
+  write_value< uint64_t >( s, d_->dim );
+  write_value< uint64_t >( s, d_->built_size );
+  write_vector( s, d_->data );
+
+  write_value< uint32_t >( s, static_cast< uint32_t >( d_->trees.size() ) );
+  VITAL_FOREACH( priv::tree const& tr, d_->trees )
+  {
+    write_value< uint64_t >( s, tr.size() );
+    VITAL_FOREACH( priv::node const& n, tr )
+    {
+      write_value( s, n.child[0] );
+      write_value( s, n.child[1] );
+      write_value( s, n.split_dim );
+      write_value( s, n.split_value );
+      write_vector( s, n.points );
+    }
+  }
+  check_stream( s );
+}
+
+
+// ------------------------------------------------------------------
+descriptor_index_sptr
+kd_forest_descriptor_index
+::read_body( std::istream& s )
+{
+  parameters params;
+  params.num_trees  = read_value< uint32_t >( s );
+  params.leaf_size  = read_value< uint32_t >( s );
+  params.max_checks = read_value< uint32_t >( s );
+  params.seed       = read_value< uint32_t >( s );
+  if ( params.num_trees > max_stored_tables )
+  {
+    throw invalid_data( "invalid number of k-d trees in descriptor index" );
+  }
+
+  std::shared_ptr< kd_forest_descriptor_index > index =
+    std::make_shared< kd_forest_descriptor_index >( params );
+  priv& d = *index->d_;
+  d.dim = static_cast< size_t >( read_value< uint64_t >( s ) );
+  d.built_size = static_cast< size_t >( read_value< uint64_t >( s ) );
+  read_vector( s, d.data );
+  if ( d.dim == 0 ? ! d.data.empty() : d.data.size() % d.dim != 0 )
+  {
+    throw invalid_data( "descriptor index data does not match its dimension" );
+  }
+
+  // the trees are either not built yet or all built
+  const size_t n = d.size();
+  const uint32_t num_trees = read_value< uint32_t >( s );
+  if ( num_trees != 0 && num_trees != std::max( 1u, params.num_trees ) )
+  {
+    throw invalid_data( "invalid number of k-d trees in descriptor index" );
+  }
+  d.trees.resize( num_trees );
+  VITAL_FOREACH( priv::tree& tr, d.trees )
+  {
+    const uint64_t num_nodes = read_value< uint64_t >( s );
+    if ( num_nodes == 0 || num_nodes > 2 * static_cast< uint64_t >( n ) + 1 )
+    {
+      throw invalid_data( "invalid k-d tree size in descriptor index" );
+    }
+    tr.resize( static_cast< size_t >( num_nodes ) );
+    for ( size_t i = 0; i < tr.size(); ++i )
+    {
+      priv::node& nd = tr[i];
+      nd.child[0] = read_value< int32_t >( s );
+      nd.child[1] = read_value< int32_t >( s );
+      nd.split_dim = read_value< uint32_t >( s );
+      nd.split_value = read_value< float >( s );
+      read_vector( s, nd.points );
+
+      // children always follow their parent, so this also rules out cycles
+      const bool leaf = nd.child[0] < 0 && nd.child[1] < 0;
+      const bool valid_inner =
+        nd.child[0] > static_cast< int32_t >( i ) && nd.child[1] > static_cast< int32_t >( i ) &&
+        static_cast< uint64_t >( nd.child[0] ) < num_nodes &&
+        static_cast< uint64_t >( nd.child[1] ) < num_nodes &&
+        nd.split_dim < d.dim;
+      if ( ! leaf && ! valid_inner )
+      {
+        throw invalid_data( "invalid k-d tree node in descriptor index" );
+      }
+      VITAL_FOREACH( uint32_t p, nd.points )
+      {
+        if ( p >= n )
+        {
+          throw invalid_data( "invalid descriptor in k-d tree leaf" );
+        }
+      }
+    }
+  }
+  return index;
+}
+
+
+// ==================================================================
+/// Private implementation of the hash index
+class lsh_descriptor_index::priv
+{
+public:
+  typedef std::unordered_map< uint32_t, std::vector< uint32_t > > table;
+
+  explicit priv( parameters const& p )
+    : params( p ),
+    dim( 0 )
+  {
+  }
+
+  size_t size() const { return dim ? data.size() / dim : 0; }
+
+  unsigned char const* row( size_t i ) const { return &data[i * dim]; }
+
+  /// Choose the key bits of each table once the descriptor length is known
+  void init_tables()
+  {
+    std::mt19937 rng( params.seed );
+    const size_t num_bits = dim * 8;
+    const size_t key_bits = std::min< size_t >( std::min( params.key_bits, 32u ), num_bits );
+
+    std::vector< uint32_t > all( num_bits );
+    for ( size_t i = 0; i < num_bits; ++i )
+    {
+      all[i] = static_cast< uint32_t >( i );
+    }
+
+    key_positions.assign( std::max( 1u, params.num_tables ), std::vector< uint32_t >() );
+    tables.assign( key_positions.size(), table() );
+    for ( size_t t = 0; t < key_positions.size(); ++t )
+    {
+      std::shuffle( all.begin(), all.end(), rng );
+      key_positions[t].assign( all.begin(), all.begin() + key_bits );
+    }
+  }
+
+  /// Compute the key of a descriptor in table \a t
+  uint32_t key( unsigned char const* r, size_t t ) const
+  {
+    std::vector< uint32_t > const& pos = key_positions[t];
+    uint32_t k = 0;
+    for ( size_t b = 0; b < pos.size(); ++b )
+    {
+      k |= static_cast< uint32_t >( ( r[pos[b] >> 3] >> ( pos[b] & 7 ) ) & 1 ) << b;
+    }
+    return k;
+  }
+
+  /// Compare the descriptors in the bucket of \a key in table \a t to \a q
+  void probe( unsigned char const* q, size_t t, uint32_t key,
+              neighbor_list< unsigned >& best, visit_marks& marks ) const
+  {
+    table::const_iterator it = tables[t].find( key );
+    if ( it == tables[t].end() )
+    {
+      return;
+    }
+    VITAL_FOREACH( uint32_t p, it->second )
+    {
+      if ( marks.visit( p ) )
+      {
+        best.insert( hamming_distance( q, row( p ), dim ), p );
+      }
+    }
+  }
+
+  /// Search all tables for the neighbors of \a q
+  void search( unsigned char const* q, unsigned k, visit_marks& marks,
+               descriptor_neighbors& result ) const
+  {
+    neighbor_list< unsigned > best( k );
+    marks.next_query();
+    for ( size_t t = 0; t < tables.size(); ++t )
+    {
+      const uint32_t key0 = key( q, t );
+      const size_t bits = key_positions[t].size();
+      probe( q, t, key0, best, marks );
+      if ( params.multi_probe_level < 1 )
+      {
+        continue;
+      }
+      for ( size_t b1 = 0; b1 < bits; ++b1 )
+      {
+        const uint32_t key1 = key0 ^ ( 1u << b1 );
+        probe( q, t, key1, best, marks );
+        if ( params.multi_probe_level < 2 )
+        {
+          continue;
+        }
+        for ( size_t b2 = b1 + 1; b2 < bits; ++b2 )
+        {
+          probe( q, t, key1 ^ ( 1u << b2 ), best, marks );
+        }
+      }
+    }
+
+    result.clear();
+    for ( size_t i = 0; i < best.items().size(); ++i )
+    {
+      descriptor_neighbor n;
+      n.index = best.items()[i].second;
+      n.distance = static_cast< double >( best.items()[i].first );
+      result.push_back( n );
+    }
+  }
+
+  parameters params;
+  size_t dim;
+  std::vector< unsigned char > data;
+  std::vector< std::vector< uint32_t > > key_positions;
+  std::vector< table > tables;
+};
+
+
+// ------------------------------------------------------------------
+lsh_descriptor_index
+::lsh_descriptor_index( parameters const& params )
+  : d_( new priv( params ) )
+{
+}
+
+
+lsh_descriptor_index
+::~lsh_descriptor_index()
+{
+}
+
+
+lsh_descriptor_index::parameters const&
+lsh_descriptor_index
+::get_parameters() const
+{
+  return d_->params;
+}
+
+
+size_t
+lsh_descriptor_index
+::size() const
+{
+  return d_->size();
+}
+
+
+size_t
+lsh_descriptor_index
+::dim() const
+{
+  return d_->dim;
+}
+
+
+// ------------------------------------------------------------------
+size_t
+lsh_descriptor_index
+::add( descriptor_set_sptr const& descriptors )
+{
+  const size_t first = d_->size();
+  check_capacity( first, descriptors ? descriptors->size() : 0 );
+  check_byte_elements( descriptors );
+  append_rows( descriptors, d_->dim, d_->data );
+  const size_t n = d_->size();
+  if ( n == first )
+  {
+    return first;
+  }
+
+  if ( d_->tables.empty() )
+  {
+    d_->init_tables();
+  }
+  for ( size_t t = 0; t < d_->tables.size(); ++t )
+  {
+    for ( size_t i = first; i < n; ++i )
+    {
+      d_->tables[t][d_->key( d_->row( i ), t )].push_back( static_cast< uint32_t >( i ) );
+    }
+  }
+  return first;
+}
+
+
+// ------------------------------------------------------------------
+std::vector< descriptor_neighbors >
+lsh_descriptor_index
+::nearest( descriptor_set_sptr const& queries, unsigned k,
+           unsigned num_threads ) const
+{
+  std::vector< descriptor_neighbors > results;
+  if ( ! queries || queries->size() == 0 )
+  {
+    return results;
+  }
+
+  check_byte_elements( queries );
+  size_t qdim = d_->dim;
+  std::vector< unsigned char > q;
+  append_rows( queries, qdim, q );
+  results.resize( queries->size() );
+  if ( d_->size() == 0 || k == 0 )
+  {
+    return results;
+  }
+
+  priv const& d = *d_;
+  parallel_for( 0, results.size(), [&] ( size_t b, size_t e )
+  {
+    visit_marks marks( d.size() );
+    for ( size_t i = b; i < e; ++i )
+    {
+      d.search( &q[i * d.dim], k, marks, results[i] );
+    }
+  }, 0, num_threads );
+  return results;
+}
+
+
+// ------------------------------------------------------------------
+void
+lsh_descriptor_index
+::write( std::ostream& s ) const
+{
+  s.write( index_magic, 4 );
+  write_value( s, index_version );
+  write_value( s, lsh_tag );
+
+  write_value< uint32_t >( s, d_->params.num_tables );
+  write_value< uint32_t >( s, d_->params.key_bits );
+  write_value< uint32_t >( s, d_->params.multi_probe_level );
+  write_value< uint32_t >( s, d_->params.seed );
+  write_value< uint64_t >( s, d_->dim );
+  write_vector( s, d_->data );
+
+  write_value< uint32_t >( s, static_cast< uint32_t >( d_->tables.size() ) );
+  for ( size_t t = 0; t < d_->tables.size(); ++t )
+  {
+    write_vector( s, d_->key_positions[t] );
+    write_value< uint64_t >( s, d_->tables[t].size() );
+    VITAL_FOREACH( priv::table::value_type const& bucket, d_->tables[t] )
+    {
+      write_value( s, bucket.first );
+      write_vector( s, bucket.second );
+    }
+  }
+  check_stream( s );
+}
+
+
+// ------------------------------------------------------------------
+descriptor_index_sptr
+lsh_descriptor_index
+::read_body( std::istream& s )
+{
+  parameters params;
+  params.num_tables        = read_value< uint32_t >( s );
+  params.key_bits          = read_value< uint32_t >( s );
+  params.multi_probe_level = read_value< uint32_t >( s );
+  params.seed              = read_value< uint32_t >( s );
+  if ( params.num_tables > max_stored_tables )
+  {
+    throw invalid_data( "invalid number of hash tables in descriptor index" );
+  }
+
+  std::shared_ptr< lsh_descriptor_index > index =
+    std::make_shared< lsh_descriptor_index >( params );
+  priv& d = *index->d_;
+  d.dim = static_cast< size_t >( read_value< uint64_t >( s ) );
+  read_vector( s, d.data );
+  if ( d.dim == 0 ? ! d.data.empty() : d.data.size() % d.dim != 0 )
+  {
+    throw invalid_data( "descriptor index data does not match its dimension" );
+  }
+
+  // the tables are created with the first added descriptors
+  const size_t n = d.size();
+  const uint32_t num_tables = read_value< uint32_t >( s );
+  if ( num_tables != 0 && num_tables != std::max( 1u, params.num_tables ) )
+  {
+    throw invalid_data( "invalid number of hash tables in descriptor index" );
+  }
+  d.key_positions.resize( num_tables );
+  d.tables.resize( num_tables );
+  for ( size_t t = 0; t < num_tables; ++t )
+  {
+    read_vector( s, d.key_positions[t] );
+    if ( d.key_positions[t].size() > 32 )
+    {
+      throw invalid_data( "invalid hash key length in descriptor index" );
+    }
+    VITAL_FOREACH( uint32_t p, d.key_positions[t] )
+    {
+      if ( p >= d.dim * 8 )
+      {
+        throw invalid_data( "invalid hash key bit in descriptor index" );
+      }
+    }
+
+    const uint64_t num_buckets = read_value< uint64_t >( s );
+    for ( uint64_t b = 0; b < num_buckets; ++b )
+    {
+      const uint32_t key = read_value< uint32_t >( s );
+      std::vector< uint32_t >& bucket = d.tables[t][key];
+      read_vector( s, bucket );
+      VITAL_FOREACH( uint32_t p, bucket )
+      {
+        if ( p >= n )
+        {
+          throw invalid_data( "invalid descriptor in hash bucket" );
+        }
+      }
+    }
+  }
+  return index;
+}
+
+} } // end namespace vital
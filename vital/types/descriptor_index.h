@@ -0,0 +1,277 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for approximate nearest neighbor descriptor indices
+ */
+
+#ifndef VITAL_DESCRIPTOR_INDEX_H_
+#define VITAL_DESCRIPTOR_INDEX_H_
+
+#include <vital/vital_export.h>
+#include <vital/vital_config.h>
+
+#include "descriptor_set.h"
+
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+/// A neighbor found by a descriptor_index query
+struct descriptor_neighbor
+{
+  /// Index of the neighbor in the order descriptors were added to the index
+  size_t index;
+  /// Distance from the query to the neighbor
+  /**
+   * Euclidean distance for real valued descriptors and the number of
+   * differing bits for binary descriptors.
+   */
+  double distance;
+};
+
+/// The neighbors of one query, sorted by increasing distance
+typedef std::vector< descriptor_neighbor > descriptor_neighbors;
+
+class descriptor_index;
+/// Shared pointer for base descriptor_index type
+typedef std::shared_ptr< descriptor_index > descriptor_index_sptr;
+
+
+// ------------------------------------------------------------------
+/// An abstract index for approximate nearest neighbor descriptor search
+/**
+ * A descriptor index is built incrementally by adding descriptor sets, for
+ * example the descriptors of each new frame, and answers batches of
+ * k nearest neighbor queries.  Each descriptor is identified by its
+ * position in the sequence of all descriptors added to the index.
+ *
+ * Queries are approximate: a neighbor may be missed in exchange for
+ * searching only a small part of the index.  Batches of queries are
+ * distributed across the shared thread pool.
+ *
+ * An index may be written to a stream and read back, including its search
+ * structure, so that large indices need not be rebuilt at startup.
+ */
+class VITAL_EXPORT descriptor_index
+{
+public:
+  /// Destructor
+  virtual ~descriptor_index() VITAL_DEFAULT_DTOR
+
+  /// Return the number of descriptors in the index
+  virtual size_t size() const = 0;
+
+  /// Return the length of the indexed descriptors, zero if the index is empty
+  virtual size_t dim() const = 0;
+
+  /// Add a set of descriptors to the index
+  /**
+   * The descriptors are copied into the index.  Null descriptors are
+   * stored as descriptors of zeros so that indices remain aligned with
+   * the input set.
+   *
+   * \param descriptors the descriptors to add
+   * \returns the index of the first added descriptor
+   * \throws invalid_value if the descriptor length differs from dim()
+   */
+  virtual size_t add( descriptor_set_sptr const& descriptors ) = 0;
+
+  /// Find approximate nearest neighbors of each of a set of queries
+  /**
+   * \param queries     the query descriptors
+   * \param k           the number of neighbors to find for each query
+   * \param num_threads the maximum number of threads to use, all threads
+   *                    of the shared thread pool if zero
+   * \returns the neighbors of each query, in query order
+   * \throws invalid_value if the query length differs from dim()
+   */
+  virtual std::vector< descriptor_neighbors >
+  nearest( descriptor_set_sptr const& queries, unsigned k,
+           unsigned num_threads = 0 ) const = 0;
+
+  /// Find approximate nearest neighbors of a single query
+  descriptor_neighbors nearest( descriptor_sptr const& query, unsigned k ) const;
+
+  /// Write the index, including its search structure, to a binary stream
+  /**
+   * \throws invalid_data if the stream can not be written
+   */
+  virtual void write( std::ostream& stream ) const = 0;
+
+  /// Read an index written by write()
+  /**
+   * The type of the returned index is determined by the stream contents.
+   *
+   * \throws invalid_data if the stream does not contain a valid index
+   */
+  static descriptor_index_sptr read( std::istream& stream );
+};
+
+
+// ------------------------------------------------------------------
+/// A forest of randomized k-d trees indexing real valued descriptors
+/**
+ * Each tree splits the descriptors on a dimension chosen at random among
+ * those of highest variance.  A query descends every tree and then
+ * explores the most promising unexplored branches of all trees in order
+ * until \c max_checks descriptors have been compared.  Descriptors added
+ * after the trees are built are inserted into the leaves, which split
+ * when they grow beyond twice the leaf size.
+ *
+ * Descriptors are stored in single precision.
+ */
+class VITAL_EXPORT kd_forest_descriptor_index
+  : public descriptor_index
+{
+public:
+  /// Parameters of the forest
+  struct parameters
+  {
+    parameters()
+      : num_trees( 4 ),
+      leaf_size( 16 ),
+      max_checks( 256 ),
+      seed( 0 ) { }
+
+    /// The number of randomized trees
+    unsigned num_trees;
+    /// The target number of descriptors in each leaf
+    unsigned leaf_size;
+    /// The number of descriptors compared per query; zero for an exact search
+    unsigned max_checks;
+    /// Seed of the random choice of split dimensions
+    unsigned seed;
+  };
+
+  /// Constructor
+  explicit kd_forest_descriptor_index( parameters const& params = parameters() );
+
+  /// Destructor
+  virtual ~kd_forest_descriptor_index();
+
+  /// Return the parameters of the forest
+  parameters const& get_parameters() const;
+
+  /// Set the number of descriptors compared per query
+  void set_max_checks( unsigned max_checks );
+
+  virtual size_t size() const;
+  virtual size_t dim() const;
+  virtual size_t add( descriptor_set_sptr const& descriptors );
+  using descriptor_index::nearest;
+  virtual std::vector< descriptor_neighbors >
+  nearest( descriptor_set_sptr const& queries, unsigned k,
+           unsigned num_threads = 0 ) const;
+  virtual void write( std::ostream& stream ) const;
+
+
+private:
+  friend class descriptor_index;
+
+  /// Read the body of an index written by write()
+  static descriptor_index_sptr read_body( std::istream& stream );
+
+  class priv;
+  std::unique_ptr< priv > d_;
+};
+
+
+// ------------------------------------------------------------------
+/// A multi-probe locality sensitive hash index of binary descriptors
+/**
+ * Each hash table keys the descriptors by a random subset of their bits.
+ * A query examines the bucket of its own key in every table and, with
+ * multi-probe level 1 or 2, also the buckets whose keys differ from it by
+ * one or two bits.  All descriptors found are compared by Hamming
+ * distance.  Adding descriptors simply inserts them into the tables.
+ *
+ * The descriptors must have unsigned char elements; add() and nearest()
+ * throw invalid_value for descriptors of other types.
+ */
+class VITAL_EXPORT lsh_descriptor_index
+  : public descriptor_index
+{
+public:
+  /// Parameters of the hash tables
+  struct parameters
+  {
+    parameters()
+      : num_tables( 6 ),
+      key_bits( 16 ),
+      multi_probe_level( 1 ),
+      seed( 0 ) { }
+
+    /// The number of hash tables
+    unsigned num_tables;
+    /// The number of descriptor bits in each hash key, at most 32
+    unsigned key_bits;
+    /// The Hamming radius around the query key of probed buckets, 0 to 2
+    unsigned multi_probe_level;
+    /// Seed of the random choice of key bits
+    unsigned seed;
+  };
+
+  /// Constructor
+  explicit lsh_descriptor_index( parameters const& params = parameters() );
+
+  /// Destructor
+  virtual ~lsh_descriptor_index();
+
+  /// Return the parameters of the hash tables
+  parameters const& get_parameters() const;
+
+  virtual size_t size() const;
+  virtual size_t dim() const;
+  virtual size_t add( descriptor_set_sptr const& descriptors );
+  using descriptor_index::nearest;
+  virtual std::vector< descriptor_neighbors >
+  nearest( descriptor_set_sptr const& queries, unsigned k,
+           unsigned num_threads = 0 ) const;
+  virtual void write( std::ostream& stream ) const;
+
+
+private:
+  friend class descriptor_index;
+
+  /// Read the body of an index written by write()
+  static descriptor_index_sptr read_body( std::istream& stream );
+
+  class priv;
+  std::unique_ptr< priv > d_;
+};
+
+} } // end namespace vital
+
+#endif // VITAL_DESCRIPTOR_INDEX_H_
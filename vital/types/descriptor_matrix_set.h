@@ -0,0 +1,257 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for a descriptor_set stored as one contiguous matrix
+ */
+
+#ifndef VITAL_DESCRIPTOR_MATRIX_SET_H_
+#define VITAL_DESCRIPTOR_MATRIX_SET_H_
+
+#include "descriptor_set.h"
+
+#include <vital/exceptions/base.h>
+#include <vital/util/aligned_memory.h>
+#include <vital/vital_foreach.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+// ------------------------------------------------------------------
+/// A descriptor that refers to one row of a descriptor_matrix_set
+/**
+ * The row shares ownership of the matrix storage, so it remains valid
+ * even if the descriptor set it was taken from is destroyed.  Modifying
+ * the row data modifies the matrix.
+ */
+template < typename T >
+class descriptor_row :
+  public descriptor_array_of< T >
+{
+public:
+  /// Constructor
+  /**
+   * \param data  pointer to the first element of the row, sharing
+   *              ownership of the underlying storage
+   * \param len   the number of elements in the row
+   */
+  descriptor_row( std::shared_ptr< T > const& data, size_t len )
+    : data_( data ),
+    length_( len ) { }
+
+  /// The number of elements of the underlying type
+  std::size_t size() const { return length_; }
+
+  /// Return an pointer to the raw data array
+  T* raw_data() { return data_.get(); }
+
+  /// Return an pointer to the raw data array
+  const T* raw_data() const { return data_.get(); }
+
+
+protected:
+  /// pointer to the row data
+  std::shared_ptr< T > data_;
+  /// length of the row
+  size_t length_;
+};
+
+
+// ------------------------------------------------------------------
+/// A descriptor set that stores all descriptors in one contiguous block
+/**
+ * Descriptors are stored as the rows of a row-major matrix in a single
+ * allocation aligned to vital::default_memory_alignment.  Each row is
+ * padded with zeros to a multiple of the alignment, so every row is
+ * aligned and the padding does not affect distance computations.
+ * Algorithms such as feature matchers can access the raw block through
+ * data() and stride() to stream over all descriptors without chasing a
+ * pointer per descriptor.
+ *
+ * For compatibility with code written against the descriptor_set
+ * interface, descriptors() returns lightweight descriptor_row objects that
+ * refer to the rows of the matrix rather than copies of them.
+ *
+ * \tparam T  The descriptor element type (e.g. float or unsigned char).
+ */
+template < typename T >
+class descriptor_matrix_set :
+  public descriptor_set
+{
+public:
+  /// The type of a descriptor element
+  typedef T value_type;
+
+  /// Constructor for a zero filled set of \a num descriptors of length \a dim
+  descriptor_matrix_set( size_t num, size_t dim )
+  {
+    this->allocate( num, dim );
+  }
+
+  /// Constructor from a vector of descriptors
+  /**
+   * The descriptor data is copied into the matrix.  Descriptors whose
+   * element type is \a T are copied directly, others are converted
+   * through descriptor::as_double().  Null descriptors are stored as rows
+   * of zeros.
+   *
+   * \throws invalid_value if the descriptors are not all the same length
+   */
+  explicit descriptor_matrix_set( std::vector< descriptor_sptr > const& descriptors )
+  {
+    size_t dim = 0;
+    VITAL_FOREACH( descriptor_sptr const& d, descriptors )
+    {
+      if ( d )
+      {
+        dim = d->size();
+        break;
+      }
+    }
+    this->allocate( descriptors.size(), dim );
+
+    for ( size_t i = 0; i < descriptors.size(); ++i )
+    {
+      descriptor const* d = descriptors[i].get();
+      if ( ! d )
+      {
+        continue;
+      }
+      if ( d->size() != dim )
+      {
+        std::stringstream msg;
+        msg << "descriptor " << i << " has length " << d->size()
+            << " but expected length " << dim;
+        throw invalid_value( msg.str() );
+      }
+
+      T* row = this->row( i );
+      descriptor_array_of< T > const* d_typed =
+        dynamic_cast< descriptor_array_of< T > const* >( d );
+      if ( d_typed )
+      {
+        std::memcpy( row, d_typed->raw_data(), dim * sizeof( T ) );
+      }
+      else
+      {
+        std::vector< double > const values = d->as_double();
+        for ( size_t j = 0; j < dim; ++j )
+        {
+          row[j] = static_cast< T >( values[j] );
+        }
+      }
+    }
+  }
+
+  /// Return the number of descriptors in the set
+  virtual size_t size() const { return num_; }
+
+  /// Return a vector of descriptors that refer to the rows of the matrix
+  virtual std::vector< descriptor_sptr > descriptors() const
+  {
+    std::vector< descriptor_sptr > descs;
+    descs.reserve( num_ );
+    for ( size_t i = 0; i < num_; ++i )
+    {
+      descs.push_back( this->at( i ) );
+    }
+    return descs;
+  }
+
+  /// Return a descriptor that refers to row \a i of the matrix
+  descriptor_sptr at( size_t i ) const
+  {
+    return std::make_shared< descriptor_row< T > >(
+      std::shared_ptr< T >( data_, data_.get() + i * stride_ ), dim_ );
+  }
+
+  /// Return the number of elements in each descriptor
+  size_t dim() const { return dim_; }
+
+  /// Return the number of elements between the starts of consecutive rows
+  /**
+   * The stride is at least dim() and rows are padded with zeros.
+   */
+  size_t stride() const { return stride_; }
+
+  /// Return a pointer to the first element of the matrix
+  T* data() { return data_.get(); }
+
+  /// Return a pointer to the first element of the matrix
+  const T* data() const { return data_.get(); }
+
+  /// Return a pointer to the first element of row \a i
+  T* row( size_t i ) { return data_.get() + i * stride_; }
+
+  /// Return a pointer to the first element of row \a i
+  const T* row( size_t i ) const { return data_.get() + i * stride_; }
+
+
+protected:
+  /// Allocate zero filled storage for \a num rows of \a dim elements
+  void allocate( size_t num, size_t dim )
+  {
+    num_ = num;
+    dim_ = dim;
+    stride_ = align_size( dim * sizeof( T ) ) / sizeof( T );
+    if ( stride_ * sizeof( T ) % default_memory_alignment != 0 )
+    {
+      // element size does not divide the alignment, so pack the rows
+      stride_ = dim;
+    }
+
+    const size_t bytes = num_ * stride_ * sizeof( T );
+    data_.reset( static_cast< T* >( aligned_malloc( bytes ) ), aligned_free );
+    if ( bytes > 0 )
+    {
+      std::memset( data_.get(), 0, bytes );
+    }
+  }
+
+  /// The matrix storage
+  std::shared_ptr< T > data_;
+  /// The number of descriptors
+  size_t num_;
+  /// The number of elements in each descriptor
+  size_t dim_;
+  /// The number of elements between the starts of consecutive rows
+  size_t stride_;
+};
+
+} } // end namespace vital
+
+#endif // VITAL_DESCRIPTOR_MATRIX_SET_H_
@@ -40,6 +40,9 @@
 #include "descriptor.h"
 #include <vital/vital_config.h>
 #include <vital/logger/logger.h>
+#include <vital/util/container_view.h>
+
+#include <vector>
 
 namespace kwiver {
 namespace vital {
@@ -53,6 +56,9 @@ namespace vital {
 class descriptor_set
 {
 public:
+  /// typedef for a read-only view of the descriptor vector
+  typedef container_view< std::vector< descriptor_sptr > > descriptors_view_t;
+
   /// Destructor
   virtual ~descriptor_set() VITAL_DEFAULT_DTOR
 
@@ -62,6 +68,13 @@ public:
   /// Return a vector of descriptor shared pointers
   virtual std::vector< descriptor_sptr > descriptors() const = 0;
 
+  /// Return a read-only view of the descriptor shared pointers; see container_view
+  virtual descriptors_view_t descriptors_view() const
+  {
+    return descriptors_view_t(
+      std::make_shared< const std::vector< descriptor_sptr > >( this->descriptors() ) );
+  }
+
 protected:
   descriptor_set() : m_logger( kwiver::vital::get_logger( "vital.descriptor_set" ) ) { }
 
@@ -90,6 +103,9 @@ public:
   /// Return a vector of descriptor shared pointers
   virtual std::vector< descriptor_sptr > descriptors() const { return data_; }
 
+  /// Return a read-only view of the descriptor shared pointers
+  virtual descriptors_view_t descriptors_view() const { return descriptors_view_t( data_ ); }
+
 
 protected:
   /// The vector of featrues
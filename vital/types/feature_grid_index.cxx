@@ -0,0 +1,395 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the uniform grid spatial index of features
+ */
+
+#include "feature_grid_index.h"
+
+#include <vital/types/columnar_feature_set.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace kwiver {
+namespace vital {
+
+/// Private implementation class
+class feature_grid_index::priv
+{
+public:
+  priv()
+    : min_x( 0 ), min_y( 0 ), cell( 1 ), nx( 1 ), ny( 1 ) { }
+
+  /// Build the grid over the locations in \a xy
+  void build( double requested_cell_size )
+  {
+    const size_t n = xy.size() / 2;
+    double max_x = -std::numeric_limits< double >::infinity();
+    double max_y = max_x;
+    min_x = min_y = std::numeric_limits< double >::infinity();
+    for ( size_t i = 0; i < n; ++i )
+    {
+      if ( std::isfinite( xy[2 * i] ) && std::isfinite( xy[2 * i + 1] ) )
+      {
+        min_x = std::min( min_x, xy[2 * i] );
+        max_x = std::max( max_x, xy[2 * i] );
+        min_y = std::min( min_y, xy[2 * i + 1] );
+        max_y = std::max( max_y, xy[2 * i + 1] );
+      }
+    }
+    if ( ! ( min_x <= max_x ) )
+    {
+      min_x = min_y = max_x = max_y = 0.0;
+    }
+
+    const double width = max_x - min_x;
+    const double height = max_y - min_y;
+    cell = requested_cell_size;
+    if ( ! ( cell > 0.0 ) )
+    {
+      // about two features per cell if they were spread uniformly
+      cell = std::sqrt( 2.0 * width * height / std::max< size_t >( n, 1 ) );
+      if ( ! ( cell > 0.0 ) )
+      {
+        cell = std::max( std::max( width, height ) / std::max< size_t >( n, 1 ), 1.0 );
+      }
+    }
+
+    // bound the memory used by a cell size much smaller than the spacing
+    const double max_cells = std::max< double >( 4.0 * n, 1024.0 );
+    const double cells = ( std::floor( width / cell ) + 1 ) * ( std::floor( height / cell ) + 1 );
+    if ( cells > max_cells )
+    {
+      cell *= std::sqrt( cells / max_cells ) * 1.01;
+    }
+    nx = static_cast< int >( std::floor( width / cell ) ) + 1;
+    ny = static_cast< int >( std::floor( height / cell ) ) + 1;
+
+    // counting sort of the features by cell
+    std::vector< size_t > cell_of( n );
+    cell_start.assign( static_cast< size_t >( nx ) * ny + 1, 0 );
+    for ( size_t i = 0; i < n; ++i )
+    {
+      cell_of[i] = cell_index( xy[2 * i], xy[2 * i + 1] );
+      ++cell_start[cell_of[i] + 1];
+    }
+    for ( size_t c = 1; c < cell_start.size(); ++c )
+    {
+      cell_start[c] += cell_start[c - 1];
+    }
+    items.resize( n );
+    std::vector< size_t > fill( cell_start.begin(), cell_start.end() - 1 );
+    for ( size_t i = 0; i < n; ++i )
+    {
+      items[fill[cell_of[i]]++] = i;
+    }
+  }
+
+  /// Return the grid column or row of a coordinate, unclamped
+  static int grid_coord( double v, double origin, double cell_size )
+  {
+    const double c = std::floor( ( v - origin ) / cell_size );
+    // saturate so that far away queries do not overflow
+    return static_cast< int >( std::max( -1.0e9, std::min( 1.0e9, c ) ) );
+  }
+
+  /// Return the cell containing a location, clamped to the grid
+  size_t cell_index( double x, double y ) const
+  {
+    if ( ! std::isfinite( x ) || ! std::isfinite( y ) )
+    {
+      return 0;
+    }
+    const int cx = std::max( 0, std::min( nx - 1, grid_coord( x, min_x, cell ) ) );
+    const int cy = std::max( 0, std::min( ny - 1, grid_coord( y, min_y, cell ) ) );
+    return static_cast< size_t >( cy ) * nx + cx;
+  }
+
+  /// Call \a f for each feature in the cells overlapping a rectangle
+  template < typename F >
+  void for_each_in_cells( double x0, double y0, double x1, double y1, F f ) const
+  {
+    const int cx0 = std::max( 0, grid_coord( x0, min_x, cell ) );
+    const int cy0 = std::max( 0, grid_coord( y0, min_y, cell ) );
+    const int cx1 = std::min( nx - 1, grid_coord( x1, min_x, cell ) );
+    const int cy1 = std::min( ny - 1, grid_coord( y1, min_y, cell ) );
+    if ( cx0 > cx1 || cy0 > cy1 )
+    {
+      return;
+    }
+    for ( int cy = cy0; cy <= cy1; ++cy )
+    {
+      // the cells of a row are contiguous in items
+      const size_t row = static_cast< size_t >( cy ) * nx;
+      for ( size_t k = cell_start[row + cx0]; k < cell_start[row + cx1 + 1]; ++k )
+      {
+        f( items[k] );
+      }
+    }
+  }
+
+  /// Call \a f for each feature in cell (\a cx, \a cy) if it is in the grid
+  template < typename F >
+  void for_each_in_cell( int cx, int cy, F& f ) const
+  {
+    if ( cx < 0 || cy < 0 || cx >= nx || cy >= ny )
+    {
+      return;
+    }
+    const size_t c = static_cast< size_t >( cy ) * nx + cx;
+    for ( size_t k = cell_start[c]; k < cell_start[c + 1]; ++k )
+    {
+      f( items[k] );
+    }
+  }
+
+  /// interleaved x and y feature coordinates
+  std::vector< double > xy;
+  /// start of each cell in items, plus the end of the last cell
+  std::vector< size_t > cell_start;
+  /// feature indices sorted by cell
+  std::vector< size_t > items;
+
+  double min_x;
+  double min_y;
+  double cell;
+  int nx;
+  int ny;
+};
+
+
+// ------------------------------------------------------------------
+feature_grid_index
+::feature_grid_index( feature_set_sptr const& features, double cell_size )
+  : d_( new priv )
+{
+  if ( features && features->size() > 0 )
+  {
+    const feature_location_view locs( features );
+    const size_t n = features->size();
+    d_->xy.resize( 2 * n );
+    for ( size_t i = 0; i < n; ++i )
+    {
+      const vector_2d p = locs[i];
+      d_->xy[2 * i] = p[0];
+      d_->xy[2 * i + 1] = p[1];
+    }
+  }
+  d_->build( cell_size );
+}
+
+
+feature_grid_index
+::~feature_grid_index()
+{
+}
+
+
+size_t
+feature_grid_index
+::size() const
+{
+  return d_->items.size();
+}
+
+
+double
+feature_grid_index
+::cell_size() const
+{
+  return d_->cell;
+}
+
+
+vector_2d
+feature_grid_index
+::location( size_t i ) const
+{
+  return vector_2d( d_->xy[2 * i], d_->xy[2 * i + 1] );
+}
+
+
+// ------------------------------------------------------------------
+void
+feature_grid_index
+::radius_query( vector_2d const& center, double radius,
+                std::vector< size_t >& result ) const
+{
+  result.clear();
+  if ( ! ( radius >= 0.0 ) )
+  {
+    return;
+  }
+
+  const double cx = center[0];
+  const double cy = center[1];
+  const double r2 = radius * radius;
+  std::vector< double > const& xy = d_->xy;
+  d_->for_each_in_cells( cx - radius, cy - radius, cx + radius, cy + radius,
+                         [&] ( size_t i )
+  {
+    const double dx = xy[2 * i] - cx;
+    const double dy = xy[2 * i + 1] - cy;
+    if ( dx * dx + dy * dy <= r2 )
+    {
+      result.push_back( i );
+    }
+  } );
+}
+
+
+std::vector< size_t >
+feature_grid_index
+::radius_query( vector_2d const& center, double radius ) const
+{
+  std::vector< size_t > result;
+  this->radius_query( center, radius, result );
+  return result;
+}
+
+
+// ------------------------------------------------------------------
+void
+feature_grid_index
+::rectangle_query( vector_2d const& min_pt, vector_2d const& max_pt,
+                   std::vector< size_t >& result ) const
+{
+  result.clear();
+  std::vector< double > const& xy = d_->xy;
+  d_->for_each_in_cells( min_pt[0], min_pt[1], max_pt[0], max_pt[1],
+                         [&] ( size_t i )
+  {
+    const double x = xy[2 * i];
+    const double y = xy[2 * i + 1];
+    if ( x >= min_pt[0] && x <= max_pt[0] && y >= min_pt[1] && y <= max_pt[1] )
+    {
+      result.push_back( i );
+    }
+  } );
+}
+
+
+std::vector< size_t >
+feature_grid_index
+::rectangle_query( vector_2d const& min_pt, vector_2d const& max_pt ) const
+{
+  std::vector< size_t > result;
+  this->rectangle_query( min_pt, max_pt, result );
+  return result;
+}
+
+
+// ------------------------------------------------------------------
+std::vector< size_t >
+feature_grid_index
+::nearest( vector_2d const& point, unsigned k, double max_distance ) const
+{
+  typedef std::pair< double, size_t > candidate;
+  std::vector< candidate > best;
+  if ( k == 0 || this->size() == 0 )
+  {
+    return std::vector< size_t >();
+  }
+
+  const double px = point[0];
+  const double py = point[1];
+  const double max_d2 = max_distance > 0.0
+    ? max_distance * max_distance
+    : std::numeric_limits< double >::infinity();
+  std::vector< double > const& xy = d_->xy;
+
+  auto visit = [&] ( size_t i )
+  {
+    const double dx = xy[2 * i] - px;
+    const double dy = xy[2 * i + 1] - py;
+    const double d2 = dx * dx + dy * dy;
+    if ( d2 > max_d2 || ( best.size() == k && ! ( d2 < best.back().first ) ) )
+    {
+      return;
+    }
+    candidate c( d2, i );
+    best.insert( std::upper_bound( best.begin(), best.end(), c ), c );
+    if ( best.size() > k )
+    {
+      best.pop_back();
+    }
+  };
+
+  // visit rings of cells at increasing Chebyshev distance from the cell
+  // of the query, starting with the first ring that touches the grid
+  const int qx = priv::grid_coord( px, d_->min_x, d_->cell );
+  const int qy = priv::grid_coord( py, d_->min_y, d_->cell );
+  const int nx = d_->nx;
+  const int ny = d_->ny;
+  const int r_start = std::max( std::max( 0, std::max( -qx, qx - ( nx - 1 ) ) ),
+                                std::max( -qy, qy - ( ny - 1 ) ) );
+  const int r_end = std::max( std::max( qx, nx - 1 - qx ), std::max( qy, ny - 1 - qy ) );
+
+  for ( int r = r_start; r <= r_end; ++r )
+  {
+    // every cell of this ring is at least this far from the query
+    const double bound = std::max( 0, r - 1 ) * d_->cell;
+    const double bound2 = bound * bound;
+    if ( bound2 > max_d2 || ( best.size() == k && bound2 > best.back().first ) )
+    {
+      break;
+    }
+
+    for ( int y = std::max( 0, qy - r ); y <= std::min( ny - 1, qy + r ); ++y )
+    {
+      if ( y == qy - r || y == qy + r )
+      {
+        for ( int x = std::max( 0, qx - r ); x <= std::min( nx - 1, qx + r ); ++x )
+        {
+          d_->for_each_in_cell( x, y, visit );
+        }
+      }
+      else
+      {
+        d_->for_each_in_cell( qx - r, y, visit );
+        d_->for_each_in_cell( qx + r, y, visit );
+      }
+    }
+  }
+
+  std::vector< size_t > result;
+  result.reserve( best.size() );
+  for ( size_t i = 0; i < best.size(); ++i )
+  {
+    result.push_back( best[i].second );
+  }
+  return result;
+}
+
+} } // end namespace vital
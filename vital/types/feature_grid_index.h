@@ -0,0 +1,144 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for a uniform grid spatial index of feature locations
+ */
+
+#ifndef VITAL_FEATURE_GRID_INDEX_H_
+#define VITAL_FEATURE_GRID_INDEX_H_
+
+#include <vital/vital_export.h>
+#include <vital/vital_config.h>
+
+#include "feature_set.h"
+#include "vector.h"
+
+#include <memory>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+// ------------------------------------------------------------------
+/// A uniform grid over the locations of a feature set
+/**
+ * The bounding box of the feature locations is divided into square cells
+ * and the index of every feature is stored with the others of its cell
+ * in one contiguous array, built in a single counting pass.  Radius,
+ * rectangle and k nearest neighbor queries then only visit the cells
+ * overlapping the query region, so their cost depends on the local
+ * feature density rather than on the size of the set.
+ *
+ * The index holds a copy of the locations; it does not change if the
+ * feature set is modified.  Query results are indices into the feature
+ * set.
+ */
+class VITAL_EXPORT feature_grid_index
+{
+public:
+  /// Constructor
+  /**
+   * \param features  the features to index
+   * \param cell_size the width of a grid cell in pixels; if not positive
+   *                  the size is chosen to give about two features per
+   *                  cell on average
+   */
+  explicit feature_grid_index( feature_set_sptr const& features,
+                               double cell_size = 0.0 );
+
+  /// Destructor
+  ~feature_grid_index();
+
+  /// Return the number of indexed features
+  size_t size() const;
+
+  /// Return the width of a grid cell in pixels
+  double cell_size() const;
+
+  /// Return the location of indexed feature \a i
+  vector_2d location( size_t i ) const;
+
+  /// Find the features within distance \a radius of \a center
+  /**
+   * \param center  the center of the query circle
+   * \param radius  the radius of the query circle; features at exactly
+   *                this distance are included
+   * \param result  output indices of the features, in no particular order;
+   *                cleared before the query
+   */
+  void radius_query( vector_2d const& center, double radius,
+                     std::vector< size_t >& result ) const;
+
+  /// Find the features within distance \a radius of \a center
+  std::vector< size_t > radius_query( vector_2d const& center, double radius ) const;
+
+  /// Find the features in the axis aligned rectangle [\a min_pt, \a max_pt]
+  /**
+   * \param min_pt  the corner of the rectangle with the smallest coordinates
+   * \param max_pt  the corner of the rectangle with the largest coordinates
+   * \param result  output indices of the features, in no particular order;
+   *                cleared before the query
+   */
+  void rectangle_query( vector_2d const& min_pt, vector_2d const& max_pt,
+                        std::vector< size_t >& result ) const;
+
+  /// Find the features in the axis aligned rectangle [\a min_pt, \a max_pt]
+  std::vector< size_t > rectangle_query( vector_2d const& min_pt,
+                                         vector_2d const& max_pt ) const;
+
+  /// Find the \a k features nearest to \a point
+  /**
+   * Cells are visited in rings of increasing distance around \a point
+   * until no unvisited cell can contain a feature nearer than the k-th
+   * found so far.
+   *
+   * \param point        the query location
+   * \param k            the number of features to find
+   * \param max_distance if positive, only features within this distance
+   *                     of \a point are returned
+   * \returns indices of up to \a k features sorted by increasing distance
+   */
+  std::vector< size_t > nearest( vector_2d const& point, unsigned k,
+                                 double max_distance = 0.0 ) const;
+
+
+private:
+  class priv;
+  const std::unique_ptr< priv > d_;
+};
+
+/// Shared pointer for feature_grid_index
+typedef std::shared_ptr< feature_grid_index > feature_grid_index_sptr;
+
+} } // end namespace vital
+
+#endif // VITAL_FEATURE_GRID_INDEX_H_
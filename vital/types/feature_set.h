@@ -39,6 +39,7 @@
 #include "feature.h"
 
 #include <vital/vital_config.h>
+#include <vital/util/container_view.h>
 
 #include <vector>
 
@@ -54,6 +55,9 @@ namespace vital {
 class feature_set
 {
 public:
+  /// typedef for a read-only view of the feature vector
+  typedef container_view< std::vector< feature_sptr > > features_view_t;
+
   /// Destructor
   virtual ~feature_set() VITAL_DEFAULT_DTOR
 
@@ -62,6 +66,13 @@ public:
 
   /// Return a vector of feature shared pointers
   virtual std::vector< feature_sptr > features() const = 0;
+
+  /// Return a read-only view of the feature shared pointers; see container_view
+  virtual features_view_t features_view() const
+  {
+    return features_view_t(
+      std::make_shared< const std::vector< feature_sptr > >( this->features() ) );
+  }
 };
 
 /// Shared pointer for base feature_set type
@@ -86,6 +97,9 @@ public:
   /// Return a vector of feature shared pointers
   virtual std::vector< feature_sptr > features() const { return data_; }
 
+  /// Return a read-only view of the feature shared pointers
+  virtual features_view_t features_view() const { return features_view_t( data_ ); }
+
 
 protected:
   /// The vector of features
@@ -34,7 +34,21 @@
  */
 
 #include "image.h"
+
+#include <vital/exceptions/base.h>
+#include <vital/exceptions/image.h>
+#include <vital/util/aligned_memory.h>
+#include <vital/util/pixel_kernels.h>
+#include <vital/util/thread_pool.h>
+
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+#include <stdint.h>
 
 namespace kwiver {
 namespace vital {
@@ -51,19 +65,37 @@ image_memory
 /// Constructor - allocated n bytes
 image_memory
 ::image_memory( size_t n )
-  : data_( new char[n] ),
-    size_( n )
+  : data_( 0 ),
+    size_( 0 ),
+    allocator_( image_allocator::default_allocator() )
 {
+  size_ = allocator_->allocation_size( n );
+  data_ = allocator_->allocate( size_ );
+}
+
+
+/// Constructor - allocated n bytes from an allocator
+image_memory
+::image_memory( size_t n, const image_allocator_sptr& allocator )
+  : data_( 0 ),
+    size_( 0 ),
+    allocator_( allocator ? allocator : image_allocator::default_allocator() )
+{
+  size_ = allocator_->allocation_size( n );
+  data_ = allocator_->allocate( size_ );
 }
 
 
 /// Copy Constructor
 image_memory
 ::image_memory( const image_memory& other )
-  : data_( new char[other.size()] ),
-    size_( other.size() )
+  : data_( 0 ),
+    size_( 0 ),
+    allocator_( other.allocator_ ? other.allocator_ : image_allocator::default_allocator() )
 {
-  std::memcpy( data_, other.data_, size_ );
+  size_ = allocator_->allocation_size( other.size_ );
+  data_ = allocator_->allocate( size_ );
+  std::memcpy( data_, other.data_, other.size_ );
 }
 
 
@@ -71,7 +103,24 @@ image_memory
 image_memory
 ::~image_memory()
 {
-  delete [] reinterpret_cast< char* > ( data_ );
+  release();
+}
+
+
+/// Release the memory
+void
+image_memory
+::release()
+{
+  if ( allocator_ )
+  {
+    allocator_->deallocate( data_, size_ );
+  }
+  else
+  {
+    delete [] reinterpret_cast< char* > ( data_ );
+  }
+  data_ = 0;
 }
 
 
@@ -87,16 +136,16 @@ image_memory
 
   if ( size_ != other.size_ )
   {
-    delete [] reinterpret_cast< char* > ( data_ );
-    data_ = 0;
-    if ( other.size_ > 0 )
+    release();
+    if ( ! allocator_ )
     {
-      data_ = new char[other.size_];
+      allocator_ = other.allocator_ ? other.allocator_ : image_allocator::default_allocator();
     }
-    size_ = other.size_;
+    size_ = allocator_->allocation_size( other.size_ );
+    data_ = allocator_->allocate( size_ );
   }
 
-  std::memcpy( data_, other.data_, size_ );
+  std::memcpy( data_, other.data_, other.size_ );
   return *this;
 }
 
@@ -113,9 +162,28 @@ image_memory
 //======================================================================
 
 
+/// Output the pixel type, such as "uint16" or "float32"
+std::ostream&
+operator<<( std::ostream& os, const image_pixel_traits& pt )
+{
+  switch ( pt.type )
+  {
+    case image_pixel_traits::UNSIGNED: os << "uint"; break;
+    case image_pixel_traits::SIGNED:   os << "int"; break;
+    case image_pixel_traits::FLOAT:    os << "float"; break;
+    case image_pixel_traits::BOOL:     os << "bool"; break;
+    default:                           os << "unknown"; break;
+  }
+  return os << pt.num_bytes * 8;
+}
+
+
+//======================================================================
+
+
 /// Default Constructor
 image
-::image()
+::image( const image_pixel_traits& pt )
   : data_(),
   first_pixel_( NULL ),
   width_( 0 ),
@@ -123,22 +191,34 @@ image
   depth_( 0 ),
   w_step_( 0 ),
   h_step_( 0 ),
-  d_step_( 0 )
+  d_step_( 0 ),
+  pixel_traits_( pt )
 {
 }
 
 
 /// Constructor that allocates image memory
 image
-::image( size_t width, size_t height, size_t depth, bool interleave )
-  : data_( new image_memory( width * height * depth ) ),
+::image( size_t width, size_t height, size_t depth, bool interleave,
+         const image_allocator_sptr& allocator )
+  : image( width, height, depth, interleave, image_pixel_traits(), allocator )
+{
+}
+
+
+/// Constructor that allocates image memory for pixels of any type
+image
+::image( size_t width, size_t height, size_t depth, bool interleave,
+         const image_pixel_traits& pt, const image_allocator_sptr& allocator )
+  : data_( new image_memory( width * height * depth * pt.num_bytes, allocator ) ),
     first_pixel_( reinterpret_cast< byte* > ( data_->data() ) ),
     width_( width ),
     height_( height ),
     depth_( depth ),
     w_step_( 1 ),
     h_step_( width ),
-    d_step_( width * height )
+    d_step_( width * height ),
+    pixel_traits_( pt )
 {
   if ( interleave )
   {
@@ -149,18 +229,85 @@ image
 }
 
 
+/// Constructor that allocates image memory with padded rows
+image
+::image( size_t width, size_t height, size_t depth, bool interleave,
+         size_t row_alignment, const image_allocator_sptr& allocator )
+  : image( width, height, depth, interleave, image_pixel_traits(), row_alignment, allocator )
+{
+}
+
+
+/// Constructor that allocates padded rows of pixels of any type
+image
+::image( size_t width, size_t height, size_t depth, bool interleave,
+         const image_pixel_traits& pt, size_t row_alignment,
+         const image_allocator_sptr& allocator )
+  : data_(),
+    first_pixel_( NULL ),
+    width_( width ),
+    height_( height ),
+    depth_( depth ),
+    w_step_( 1 ),
+    h_step_( 0 ),
+    d_step_( 0 ),
+    pixel_traits_( pt )
+{
+  if ( row_alignment == 0 || ( row_alignment & ( row_alignment - 1 ) ) != 0 )
+  {
+    throw invalid_value( "image row alignment must be a power of two" );
+  }
+
+  const size_t nb = pt.num_bytes;
+  const size_t row_bytes = align_size( ( interleave ? width * depth : width ) * nb, row_alignment );
+  if ( row_bytes % nb != 0 )
+  {
+    throw invalid_value( "image row alignment must be a multiple of the pixel size" );
+  }
+  const size_t num_planes = interleave ? 1 : depth;
+
+  // room to move the first row to an aligned address if the allocator
+  // guarantees less alignment than requested
+  const image_allocator_sptr& alloc =
+    allocator ? allocator : image_allocator::default_allocator();
+  const size_t extra =
+    alloc->alignment() < row_alignment ? row_alignment - alloc->alignment() : 0;
+
+  data_ = image_memory_sptr( new image_memory( row_bytes * height * num_planes + extra, alloc ) );
+  first_pixel_ = reinterpret_cast< byte* > ( data_->data() );
+  const size_t misalignment = reinterpret_cast< uintptr_t > ( first_pixel_ ) % row_alignment;
+  if ( misalignment != 0 )
+  {
+    first_pixel_ += row_alignment - misalignment;
+  }
+
+  h_step_ = row_bytes / nb;
+  if ( interleave )
+  {
+    w_step_ = depth;
+    d_step_ = 1;
+  }
+  else
+  {
+    d_step_ = h_step_ * height;
+  }
+}
+
+
 /// Constructor that points at existing memory
 image
-::image( const byte* first_pixel, size_t width, size_t height, size_t depth,
-           ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step )
+::image( const void* first_pixel, size_t width, size_t height, size_t depth,
+         ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step,
+         const image_pixel_traits& pt )
   : data_(),
-    first_pixel_( const_cast< byte* > ( first_pixel ) ),
+    first_pixel_( reinterpret_cast< byte* > ( const_cast< void* > ( first_pixel ) ) ),
     width_( width ),
     height_( height ),
     depth_( depth ),
     w_step_( w_step ),
     h_step_( h_step ),
-    d_step_( d_step )
+    d_step_( d_step ),
+    pixel_traits_( pt )
 {
 }
 
@@ -168,16 +315,18 @@ image
 /// Constructor that shares memory with another image
 image
 ::image( const image_memory_sptr& mem,
-         const byte* first_pixel, size_t width, size_t height, size_t depth,
-         ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step )
+         const void* first_pixel, size_t width, size_t height, size_t depth,
+         ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step,
+         const image_pixel_traits& pt )
   : data_( mem ),
-    first_pixel_( const_cast< byte* > ( first_pixel ) ),
+    first_pixel_( reinterpret_cast< byte* > ( const_cast< void* > ( first_pixel ) ) ),
     width_( width ),
     height_( height ),
     depth_( depth ),
     w_step_( w_step ),
     h_step_( h_step ),
-    d_step_( d_step )
+    d_step_( d_step ),
+    pixel_traits_( pt )
 {
 }
 
@@ -192,7 +341,8 @@ image
     depth_( other.depth_ ),
     w_step_( other.w_step_ ),
     h_step_( other.h_step_ ),
-    d_step_( other.d_step_ )
+    d_step_( other.d_step_ ),
+    pixel_traits_( other.pixel_traits_ )
 {
 }
 
@@ -214,6 +364,7 @@ image
   w_step_      = other.w_step_;
   h_step_      = other.h_step_;
   d_step_      = other.d_step_;
+  pixel_traits_ = other.pixel_traits_;
   return *this;
 }
 
@@ -231,39 +382,297 @@ image
 }
 
 
+/// Get a view of a rectangle of the image
+image
+image
+::crop( size_t x_offset, size_t y_offset, size_t width, size_t height ) const
+{
+  if ( x_offset > width_ || width > width_ - x_offset ||
+       y_offset > height_ || height > height_ - y_offset )
+  {
+    throw std::out_of_range( "kwiver::vital::image::crop() rectangle outside the image" );
+  }
+  const byte* first = first_pixel_ + static_cast< ptrdiff_t >( pixel_traits_.num_bytes ) *
+    ( w_step_ * static_cast< ptrdiff_t >( x_offset ) + h_step_ * static_cast< ptrdiff_t >( y_offset ) );
+  return image( data_, first, width, height, depth_, w_step_, h_step_, d_step_, pixel_traits_ );
+}
+
+
+/// Get a view of every x_step column of every y_step row
+image
+image
+::subsample( size_t x_step, size_t y_step ) const
+{
+  if ( x_step == 0 || y_step == 0 )
+  {
+    throw invalid_value( "image subsample steps must be positive" );
+  }
+  return image( data_, first_pixel_,
+                ( width_ + x_step - 1 ) / x_step, ( height_ + y_step - 1 ) / y_step, depth_,
+                w_step_ * static_cast< ptrdiff_t >( x_step ),
+                h_step_ * static_cast< ptrdiff_t >( y_step ), d_step_, pixel_traits_ );
+}
+
+
+namespace {
+
+/// Check if the pixels of an image fill a block of memory without gaps
+/**
+ * This requires positive steps such that, ordered by step size, each
+ * dimension steps over exactly one block of the previous dimension.
+ */
+bool
+is_contiguous( const image& img )
+{
+  std::pair< ptrdiff_t, size_t > dims[3] = {
+    std::make_pair( img.w_step(), img.width() ),
+    std::make_pair( img.h_step(), img.height() ),
+    std::make_pair( img.d_step(), img.depth() )
+  };
+  std::sort( dims, dims + 3 );
+
+  ptrdiff_t expected = 1;
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    // the step of a dimension of size one is never used
+    if ( dims[i].second == 1 )
+    {
+      continue;
+    }
+    if ( dims[i].first != expected )
+    {
+      return false;
+    }
+    expected *= static_cast< ptrdiff_t >( dims[i].second );
+  }
+  return true;
+}
+
+
+/// Check if an image stores the channels of each row adjacent to each other
+bool
+has_interleaved_rows( const image& img )
+{
+  return ( img.d_step() == 1 || img.depth() == 1 ) &&
+         img.w_step() == static_cast< ptrdiff_t >( img.depth() );
+}
+
+
+/// Check if an image stores each row of each channel contiguously
+bool
+has_planar_rows( const image& img )
+{
+  return img.w_step() == 1 || img.width() == 1;
+}
+
+
+/// Bytes copied per unit of work passed to parallel_for_work()
+/**
+ * Copying 16 bytes costs about as much as the work per pixel that the
+ * parallel threshold is tuned for, so copies of at least 1 MB are split
+ * across threads, in chunks of 256 KB.
+ */
+const size_t copy_bytes_per_work = 16;
+const size_t copy_chunk_work = parallel_work_threshold / 4;
+
+
+/// Copy the pixels of a loop nest between two arrays given byte steps
+/**
+ * T is an unsigned integer the size of one pixel value, so that values
+ * of any pixel type are copied bit for bit.
+ */
+template < typename T >
+void
+copy_pixels( const image::byte* src, image::byte* dst, const size_t* sizes,
+             const ptrdiff_t* src_steps, const ptrdiff_t* dst_steps )
+{
+  for ( size_t d = 0; d < sizes[2]; ++d, src += src_steps[2], dst += dst_steps[2] )
+  {
+    const image::byte* src_row = src;
+    image::byte* dst_row = dst;
+    for ( size_t h = 0; h < sizes[1]; ++h, src_row += src_steps[1], dst_row += dst_steps[1] )
+    {
+      const image::byte* s = src_row;
+      image::byte* t = dst_row;
+      for ( size_t w = 0; w < sizes[0]; ++w, s += src_steps[0], t += dst_steps[0] )
+      {
+        T v;
+        std::memcpy( &v, s, sizeof( T ) );
+        std::memcpy( t, &v, sizeof( T ) );
+      }
+    }
+  }
+}
+
+} // end anonymous namespace
+
+
 /// Deep copy the image data from another image into this one
+/**
+ * Copies use the fastest method allowed by the two memory layouts: a
+ * single block copy for identical contiguous layouts, a block copy per
+ * row for matching row layouts, vectorized conversion of each row
+ * between planar and interleaved layouts of bytes, or a loop over every
+ * pixel.
+ */
 void
 image
 ::copy_from( const image& other )
 {
+  if ( pixel_traits_ != other.pixel_traits_ )
+  {
+    // force set_size to allocate memory for the new pixel type
+    pixel_traits_ = other.pixel_traits_;
+    width_ = height_ = depth_ = 0;
+  }
   set_size( other.width_, other.height_, other.depth_ );
+  if ( width_ == 0 || height_ == 0 || depth_ == 0 )
+  {
+    return;
+  }
 
-  // TODO check if the images are contiguous and use a
-  // memcpy for more efficient copying
-
-  const ptrdiff_t o_d_step = other.d_step();
-  const ptrdiff_t o_h_step = other.h_step();
-  const ptrdiff_t o_w_step = other.w_step();
+  const bool same_layout = ( other.w_step_ == w_step_ && other.h_step_ == h_step_ &&
+                             other.d_step_ == d_step_ );
 
   const byte* o_data = other.first_pixel();
   byte* data = this->first_pixel_;
-  for ( unsigned int d = 0; d < depth_; ++d, o_data += o_d_step, data += d_step_ )
+  if ( same_layout && o_data == data )
+  {
+    // copying an image onto itself
+    return;
+  }
+
+  // work in bytes from here on
+  const size_t nb = pixel_traits_.num_bytes;
+  const ptrdiff_t pb = static_cast< ptrdiff_t >( nb );
+
+  if ( same_layout && is_contiguous( *this ) )
+  {
+    // positive steps, so the first pixel is the start of the block
+    const size_t num_bytes = width_ * height_ * depth_ * nb;
+    const size_t block = 64 * 1024;
+    parallel_for_work( ( num_bytes + block - 1 ) / block, block / copy_bytes_per_work,
+                       [=] ( size_t b, size_t e )
+    {
+      std::memcpy( data + b * block, o_data + b * block, std::min( e * block, num_bytes ) - b * block );
+    }, 0, copy_chunk_work );
+    return;
+  }
+
+  const size_t width = width_;
+  const size_t depth = depth_;
+  const ptrdiff_t h_step = h_step_ * pb;
+  const ptrdiff_t d_step = d_step_ * pb;
+  const ptrdiff_t o_h_step = other.h_step_ * pb;
+  const ptrdiff_t o_d_step = other.d_step_ * pb;
+  const bool interleaved = has_interleaved_rows( *this );
+  const bool o_interleaved = has_interleaved_rows( other );
+  const bool planar = has_planar_rows( *this );
+  const bool o_planar = has_planar_rows( other );
+
+  if ( interleaved && o_interleaved )
   {
-    const byte* o_row = o_data;
-    byte* row = data;
-    for ( unsigned int h = 0; h < height_; ++h, o_row += o_h_step, row += h_step_ )
+    const size_t row_work = width * depth * nb / copy_bytes_per_work;
+    parallel_for_work( height_, row_work, [=] ( size_t b, size_t e )
     {
-      const byte* o_pixel = o_row;
-      byte* pixel = row;
-      for ( unsigned int w = 0; w < width_; ++w, o_pixel += o_w_step, pixel += w_step_ )
+      for ( ptrdiff_t h = b; h < static_cast< ptrdiff_t >( e ); ++h )
       {
-        *pixel = *o_pixel;
+        std::memcpy( data + h * h_step, o_data + h * o_h_step, width * depth * nb );
       }
-    }
+    }, 0, copy_chunk_work );
+    return;
+  }
+
+  if ( planar && o_planar )
+  {
+    // rows of all channels, numbered channel by channel
+    const size_t height = height_;
+    const size_t row_work = width * nb / copy_bytes_per_work;
+    parallel_for_work( height * depth, row_work, [=] ( size_t b, size_t e )
+    {
+      for ( size_t r = b; r < e; ++r )
+      {
+        const ptrdiff_t d = r / height;
+        const ptrdiff_t h = r % height;
+        std::memcpy( data + d * d_step + h * h_step,
+                     o_data + d * o_d_step + h * o_h_step, width * nb );
+      }
+    }, 0, copy_chunk_work );
+    return;
+  }
+
+  if ( nb == 1 && interleaved && o_planar )
+  {
+    const size_t row_work = width * depth / copy_bytes_per_work;
+    parallel_for_work( height_, row_work, [=] ( size_t b, size_t e )
+    {
+      std::vector< const byte* > planes( depth );
+      for ( ptrdiff_t h = b; h < static_cast< ptrdiff_t >( e ); ++h )
+      {
+        for ( ptrdiff_t d = 0; d < static_cast< ptrdiff_t >( depth ); ++d )
+        {
+          planes[d] = o_data + d * o_d_step + h * o_h_step;
+        }
+        interleave_pixels( &planes[0], depth, width, data + h * h_step );
+      }
+    }, 0, copy_chunk_work );
+    return;
+  }
+
+  if ( nb == 1 && planar && o_interleaved )
+  {
+    const size_t row_work = width * depth / copy_bytes_per_work;
+    parallel_for_work( height_, row_work, [=] ( size_t b, size_t e )
+    {
+      std::vector< byte* > planes( depth );
+      for ( ptrdiff_t h = b; h < static_cast< ptrdiff_t >( e ); ++h )
+      {
+        for ( ptrdiff_t d = 0; d < static_cast< ptrdiff_t >( depth ); ++d )
+        {
+          planes[d] = data + d * d_step + h * h_step;
+        }
+        deinterleave_pixels( o_data + h * o_h_step, depth, width, &planes[0] );
+      }
+    }, 0, copy_chunk_work );
+    return;
+  }
+
+  const size_t sizes[3] = { width_, height_, depth_ };
+  const ptrdiff_t o_steps[3] = { other.w_step_ * pb, o_h_step, o_d_step };
+  const ptrdiff_t steps[3] = { w_step_ * pb, h_step, d_step };
+  switch ( nb )
+  {
+    case 1: copy_pixels< uint8_t >( o_data, data, sizes, o_steps, steps ); break;
+    case 2: copy_pixels< uint16_t >( o_data, data, sizes, o_steps, steps ); break;
+    case 4: copy_pixels< uint32_t >( o_data, data, sizes, o_steps, steps ); break;
+    case 8: copy_pixels< uint64_t >( o_data, data, sizes, o_steps, steps ); break;
+    default:
+      for ( size_t d = 0; d < depth_; ++d )
+      {
+        for ( size_t h = 0; h < height_; ++h )
+        {
+          for ( size_t w = 0; w < width_; ++w )
+          {
+            const ptrdiff_t i = w, j = h, k = d;
+            std::memcpy( data + i * steps[0] + j * steps[1] + k * steps[2],
+                         o_data + i * o_steps[0] + j * o_steps[1] + k * o_steps[2], nb );
+          }
+        }
+      }
+      break;
   }
 }
 
 
+/// Throw image_type_mismatch_exception for access as pixels of type \a pt
+void
+image
+::throw_pixel_type_mismatch( const image_pixel_traits& pt ) const
+{
+  detail::check_pixel_traits( *this, pt );
+}
+
+
 /// Set the size of the image.
 void
 image
@@ -274,7 +683,15 @@ image
     return;
   }
 
-  data_ = image_memory_sptr( new image_memory( width * height * depth ) );
+  image_allocator_sptr allocator;
+  if ( data_ )
+  {
+    allocator = data_->allocator();
+  }
+  // release the old memory first so a pool may reuse it
+  data_.reset();
+  data_ = image_memory_sptr( new image_memory( width * height * depth * pixel_traits_.num_bytes,
+                                               allocator ) );
   width_ = width;
   height_ = height;
   depth_ = depth;
@@ -291,22 +708,88 @@ image
 
 
 /// Compare to images to see if the pixels have the same values.
+/**
+ * Pixel values are compared bit for bit, so for floating point pixels
+ * NaN values match themselves and 0 does not match -0.  Images with the
+ * same contiguous layout are compared as one block and images with
+ * matching row layouts row by row, both with memcmp.
+ */
 bool
 equal_content( const image& img1, const image& img2 )
 {
   if ( ( img1.width()  != img2.width() ) ||
        ( img1.height() != img2.height() ) ||
-       ( img1.depth()  != img2.depth() ) )
+       ( img1.depth()  != img2.depth() ) ||
+       ( img1.pixel_traits() != img2.pixel_traits() ) )
   {
     return false;
   }
-  for ( unsigned k = 0; k < img1.depth(); ++k )
+  const size_t width = img1.width();
+  const size_t height = img1.height();
+  const size_t depth = img1.depth();
+  if ( width == 0 || height == 0 || depth == 0 )
+  {
+    return true;
+  }
+
+  const size_t nb = img1.pixel_traits().num_bytes;
+  const ptrdiff_t pb = static_cast< ptrdiff_t >( nb );
+  const image::byte* data1 = img1.first_pixel();
+  const image::byte* data2 = img2.first_pixel();
+  const bool same_layout = ( img1.w_step() == img2.w_step() && img1.h_step() == img2.h_step() &&
+                             img1.d_step() == img2.d_step() );
+  if ( same_layout && data1 == data2 )
+  {
+    return true;
+  }
+  if ( same_layout && is_contiguous( img1 ) )
   {
-    for ( unsigned j = 0; j < img1.height(); ++j )
+    return std::memcmp( data1, data2, width * height * depth * nb ) == 0;
+  }
+
+  const ptrdiff_t h_step1 = img1.h_step() * pb;
+  const ptrdiff_t h_step2 = img2.h_step() * pb;
+  if ( has_interleaved_rows( img1 ) && has_interleaved_rows( img2 ) )
+  {
+    for ( ptrdiff_t j = 0; j < static_cast< ptrdiff_t >( height ); ++j )
     {
-      for ( unsigned i = 0; i < img1.width(); ++i )
+      if ( std::memcmp( data1 + j * h_step1, data2 + j * h_step2, width * depth * nb ) != 0 )
       {
-        if ( img1( i, j, k ) != img2( i, j, k ) )
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const ptrdiff_t d_step1 = img1.d_step() * pb;
+  const ptrdiff_t d_step2 = img2.d_step() * pb;
+  if ( has_planar_rows( img1 ) && has_planar_rows( img2 ) )
+  {
+    for ( ptrdiff_t k = 0; k < static_cast< ptrdiff_t >( depth ); ++k )
+    {
+      for ( ptrdiff_t j = 0; j < static_cast< ptrdiff_t >( height ); ++j )
+      {
+        if ( std::memcmp( data1 + k * d_step1 + j * h_step1,
+                          data2 + k * d_step2 + j * h_step2, width * nb ) != 0 )
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  const ptrdiff_t w_step1 = img1.w_step() * pb;
+  const ptrdiff_t w_step2 = img2.w_step() * pb;
+  for ( ptrdiff_t k = 0; k < static_cast< ptrdiff_t >( depth ); ++k )
+  {
+    for ( ptrdiff_t j = 0; j < static_cast< ptrdiff_t >( height ); ++j )
+    {
+      const image::byte* p1 = data1 + k * d_step1 + j * h_step1;
+      const image::byte* p2 = data2 + k * d_step2 + j * h_step2;
+      for ( size_t i = 0; i < width; ++i, p1 += w_step1, p2 += w_step2 )
+      {
+        if ( nb == 1 ? *p1 != *p2 : std::memcmp( p1, p2, nb ) != 0 )
         {
           return false;
         }
@@ -317,50 +800,320 @@ equal_content( const image& img1, const image& img2 )
 }
 
 
+namespace {
+
+// ==================================================================
+// The XXH64 hash function
+
+const uint64_t xxh_prime1 = 11400714785074694791ULL;
+const uint64_t xxh_prime2 = 14029467366897019727ULL;
+const uint64_t xxh_prime3 = 1609587929392839161ULL;
+const uint64_t xxh_prime4 = 9650029242287828579ULL;
+const uint64_t xxh_prime5 = 2870177450012600261ULL;
+
+
+inline uint64_t
+rotl64( uint64_t x, int r )
+{
+  return ( x << r ) | ( x >> ( 64 - r ) );
+}
+
+
+inline uint64_t
+read64( const image::byte* p )
+{
+  uint64_t v;
+  std::memcpy( &v, p, sizeof( v ) );
+  return v;
+}
+
+
+inline uint32_t
+read32( const image::byte* p )
+{
+  uint32_t v;
+  std::memcpy( &v, p, sizeof( v ) );
+  return v;
+}
+
+
+inline uint64_t
+xxh_round( uint64_t acc, uint64_t input )
+{
+  acc += input * xxh_prime2;
+  acc = rotl64( acc, 31 );
+  return acc * xxh_prime1;
+}
+
+
+inline uint64_t
+xxh_merge( uint64_t acc, uint64_t val )
+{
+  acc ^= xxh_round( 0, val );
+  return acc * xxh_prime1 + xxh_prime4;
+}
+
+
+/// Hash \a len bytes with the XXH64 algorithm
+uint64_t
+xxh64( const image::byte* p, size_t len, uint64_t seed )
+{
+  const image::byte* const end = p + len;
+  uint64_t h;
+  if ( len >= 32 )
+  {
+    uint64_t v1 = seed + xxh_prime1 + xxh_prime2;
+    uint64_t v2 = seed + xxh_prime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - xxh_prime1;
+    for ( ; p + 32 <= end; p += 32 )
+    {
+      v1 = xxh_round( v1, read64( p ) );
+      v2 = xxh_round( v2, read64( p + 8 ) );
+      v3 = xxh_round( v3, read64( p + 16 ) );
+      v4 = xxh_round( v4, read64( p + 24 ) );
+    }
+    h = rotl64( v1, 1 ) + rotl64( v2, 7 ) + rotl64( v3, 12 ) + rotl64( v4, 18 );
+    h = xxh_merge( h, v1 );
+    h = xxh_merge( h, v2 );
+    h = xxh_merge( h, v3 );
+    h = xxh_merge( h, v4 );
+  }
+  else
+  {
+    h = seed + xxh_prime5;
+  }
+  h += static_cast< uint64_t >( len );
+
+  for ( ; p + 8 <= end; p += 8 )
+  {
+    h ^= xxh_round( 0, read64( p ) );
+    h = rotl64( h, 27 ) * xxh_prime1 + xxh_prime4;
+  }
+  if ( p + 4 <= end )
+  {
+    h ^= static_cast< uint64_t >( read32( p ) ) * xxh_prime1;
+    h = rotl64( h, 23 ) * xxh_prime2 + xxh_prime3;
+    p += 4;
+  }
+  for ( ; p < end; ++p )
+  {
+    h ^= *p * xxh_prime5;
+    h = rotl64( h, 11 ) * xxh_prime1;
+  }
+
+  h ^= h >> 33;
+  h *= xxh_prime2;
+  h ^= h >> 29;
+  h *= xxh_prime3;
+  h ^= h >> 32;
+  return h;
+}
+
+} // end anonymous namespace
+
+
+/// Compute a 64-bit hash of the size, pixel type and pixel values of an image
+/**
+ * The hash of each row of each channel, in order of row then channel,
+ * is seeded with the hash of the previous one, and the first with a hash
+ * of the size and pixel type.
+ */
+uint64_t
+hash_content( const image& img, uint64_t seed )
+{
+  const size_t width = img.width();
+  const size_t height = img.height();
+  const size_t depth = img.depth();
+  const size_t nb = img.pixel_traits().num_bytes;
+
+  const uint64_t header[5] = { width, height, depth,
+                               static_cast< uint64_t >( img.pixel_traits().type ), nb };
+  uint64_t h = xxh64( reinterpret_cast< const image::byte* >( header ), sizeof( header ), seed );
+  if ( width == 0 || height == 0 || depth == 0 )
+  {
+    return h;
+  }
+
+  const ptrdiff_t pb = static_cast< ptrdiff_t >( nb );
+  const ptrdiff_t w_step = img.w_step() * pb;
+  const ptrdiff_t h_step = img.h_step() * pb;
+  const ptrdiff_t d_step = img.d_step() * pb;
+  const size_t row_bytes = width * nb;
+  const image::byte* data = img.first_pixel();
+
+  if ( has_planar_rows( img ) )
+  {
+    for ( ptrdiff_t j = 0; j < static_cast< ptrdiff_t >( height ); ++j )
+    {
+      for ( ptrdiff_t k = 0; k < static_cast< ptrdiff_t >( depth ); ++k )
+      {
+        h = xxh64( data + j * h_step + k * d_step, row_bytes, h );
+      }
+    }
+    return h;
+  }
+
+  // gather the rows of each channel into a buffer
+  std::vector< image::byte > buffer( row_bytes * depth );
+  std::vector< image::byte* > planes( depth );
+  for ( size_t k = 0; k < depth; ++k )
+  {
+    planes[k] = &buffer[k * row_bytes];
+  }
+  const bool vectorized = ( nb == 1 && has_interleaved_rows( img ) );
+  for ( ptrdiff_t j = 0; j < static_cast< ptrdiff_t >( height ); ++j )
+  {
+    const image::byte* row = data + j * h_step;
+    if ( vectorized )
+    {
+      deinterleave_pixels( row, depth, width, &planes[0] );
+    }
+    else
+    {
+      for ( ptrdiff_t k = 0; k < static_cast< ptrdiff_t >( depth ); ++k )
+      {
+        const image::byte* src = row + k * d_step;
+        for ( size_t i = 0; i < width; ++i, src += w_step )
+        {
+          std::memcpy( planes[k] + i * nb, src, nb );
+        }
+      }
+    }
+    for ( size_t k = 0; k < depth; ++k )
+    {
+      h = xxh64( planes[k], row_bytes, h );
+    }
+  }
+  return h;
+}
+
+
 /// Transform a given image in place given a unary function
 void
 transform_image( image& img,
                  image::byte ( * op )( image::byte const& ) )
 {
-  // determine which order to traverse dimensions
-  // [0] -> smalled distance between values
-  // [2] -> greatest distance between values
-  size_t side_len[3];
-  ptrdiff_t step_size[3];
-  bool wBh = img.w_step() < img.h_step(),
-       dBh = img.d_step() < img.h_step(),
-       dBw = img.d_step() < img.w_step();
-  size_t w_idx = ( ! wBh ) + dBw,
-         h_idx = wBh + dBh,
-         d_idx = ( ! dBw ) + ( ! dBh );
-
-  side_len[w_idx] = img.width();
-  side_len[h_idx] = img.height();
-  side_len[d_idx] = img.depth();
-  step_size[w_idx] = img.w_step();
-  step_size[h_idx] = img.h_step();
-  step_size[d_idx] = img.d_step();
-
-  // position index with a dimension
-  unsigned i0, i1, i2;
-  // Pointers to the first pixel of the current dimension iteration
-  vital::image::byte* d0_s, * d1_s, * d2_s;
-
-  d2_s = img.first_pixel();
-  for ( i2 = 0; i2 < side_len[2]; ++i2, d2_s += step_size[2] )
-  {
-    d1_s = d2_s;
-    for ( i1 = 0; i1 < side_len[1]; ++i1, d1_s += step_size[1] )
+  transform_image( img, [op] ( image::byte const& b ) { return op( b ); } );
+}
+
+
+namespace detail {
+
+/// Make the loop nest over the pixels of \a num images of the same size
+image_loop
+make_image_loop( const image* const* imgs, unsigned num )
+{
+  const size_t sizes[3] = { imgs[0]->width(), imgs[0]->height(), imgs[0]->depth() };
+  ptrdiff_t steps[3][3];
+  for ( unsigned k = 0; k < num; ++k )
+  {
+    steps[k][0] = imgs[k]->w_step();
+    steps[k][1] = imgs[k]->h_step();
+    steps[k][2] = imgs[k]->d_step();
+  }
+  return make_image_loop( sizes, steps, num );
+}
+
+
+/// Make the loop nest over \a num arrays of the given size and steps
+image_loop
+make_image_loop( const size_t* sizes, const ptrdiff_t ( *steps )[3], unsigned num )
+{
+  // order the dimensions by the step size of the first array,
+  // with dimensions of size one last since they are not iterated
+  unsigned order[3] = { 0, 1, 2 };
+  std::stable_sort( order, order + 3, [&] ( unsigned a, unsigned b )
+  {
+    if ( ( sizes[a] == 1 ) != ( sizes[b] == 1 ) )
+    {
+      return sizes[b] == 1;
+    }
+    return std::abs( steps[0][a] ) < std::abs( steps[0][b] );
+  } );
+
+  image_loop l;
+  l.num_images = num;
+  for ( unsigned d = 0; d < 3; ++d )
+  {
+    l.size[d] = sizes[order[d]];
+    for ( unsigned k = 0; k < num; ++k )
     {
-      d0_s = d1_s;
-      for ( i0 = 0; i0 < side_len[0]; ++i0, d0_s += step_size[0] )
+      l.step[k][d] = steps[k][order[d]];
+    }
+  }
+
+  // merge each dimension into the next inner one while contiguous in every image
+  unsigned d = 0;
+  while ( d < 2 )
+  {
+    bool contiguous = ( l.size[d + 1] > 1 );
+    for ( unsigned k = 0; k < num && contiguous; ++k )
+    {
+      contiguous = ( l.step[k][d + 1] == l.step[k][d] * static_cast< ptrdiff_t >( l.size[d] ) );
+    }
+    if ( ! contiguous )
+    {
+      ++d;
+      continue;
+    }
+    l.size[d] *= l.size[d + 1];
+    for ( unsigned e = d + 1; e < 2; ++e )
+    {
+      l.size[e] = l.size[e + 1];
+      for ( unsigned k = 0; k < num; ++k )
       {
-        *d0_s = op( *d0_s );
+        l.step[k][e] = l.step[k][e + 1];
       }
     }
+    l.size[2] = 1;
+  }
+  return l;
+}
+
+
+/// Throw image_size_mismatch_exception unless the images have the same size
+void
+check_same_size( const image& img1, const image& img2 )
+{
+  if ( img1.width() != img2.width() || img1.height() != img2.height() ||
+       img1.depth() != img2.depth() )
+  {
+    throw image_size_mismatch_exception(
+      "images must have the same width, height and depth",
+      img1.width(), img1.height(), img2.width(), img2.height() );
   }
 }
 
 
+/// Throw image_type_mismatch_exception unless the image has pixels of type \a pt
+void
+check_pixel_traits( const image& img, const image_pixel_traits& pt )
+{
+  if ( img.pixel_traits() != pt )
+  {
+    std::ostringstream str;
+    str << "image has " << img.pixel_traits() << " pixels instead of " << pt;
+    throw image_type_mismatch_exception( str.str() );
+  }
+}
+
+
+/// Throw image_size_mismatch_exception unless the image has \a depth channels
+void
+check_depth( const image& img, size_t depth )
+{
+  if ( img.depth() != depth )
+  {
+    std::ostringstream str;
+    str << "image has " << img.depth() << " channels instead of " << depth;
+    throw image_size_mismatch_exception( str.str(), img.width(), img.height(),
+                                         img.width(), img.height() );
+  }
+}
+
+} // end namespace detail
+
+
 }
 }   // end namespace vital
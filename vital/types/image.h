@@ -37,14 +37,22 @@
 #define VITAL_IMAGE_H_
 
 #include <vital/types/color.h>
+#include <vital/types/image_allocator.h>
 
 #include <vital/vital_export.h>
 
+#include <vital/util/thread_pool.h>
+
+#include <algorithm>
+#include <iosfwd>
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
 
 #include <cstddef>
 
+#include <stdint.h>
+
 namespace kwiver {
 namespace vital {
 
@@ -57,8 +65,10 @@ namespace vital {
  * memory is separated from the image object so it can be shared among
  * many image objects.
  *
- * Derived image memory classes can proved access to image memory
- * stored in other forms, such as on the GPU or in 3rd party data structures.
+ * The memory is obtained from an image_allocator, by default one that
+ * aligns blocks to 64 bytes.  Derived image memory classes can proved
+ * access to image memory stored in other forms, such as on the GPU or in
+ * 3rd party data structures.
  */
 class VITAL_EXPORT image_memory
 {
@@ -66,12 +76,19 @@ public:
   /// Default Constructor
   image_memory();
 
-  /// Constructor - allocates n bytes
+  /// Constructor - allocates n bytes from the default allocator
   /**
    * \param n bytes to allocate
    */
   image_memory( size_t n );
 
+  /// Constructor - allocates n bytes from the given allocator
+  /**
+   * \param n bytes to allocate
+   * \param allocator allocator to use, or null for the default allocator
+   */
+  image_memory( size_t n, const image_allocator_sptr& allocator );
+
   /// Copy constructor
   /**
    * \param other The other image_memory to copy from.
@@ -92,8 +109,18 @@ public:
   virtual void* data();
 
   /// The number of bytes allocated
+  /**
+   * This is the footprint reported by the allocator, which may be
+   * larger than the number of bytes requested.
+   */
   size_t size() const { return size_; }
 
+  /// The allocator that owns the memory
+  /**
+   * This is null for derived classes that manage their own memory.
+   */
+  const image_allocator_sptr& allocator() const { return allocator_; }
+
 
 protected:
   /// The image data
@@ -101,17 +128,96 @@ protected:
 
   /// The number of bytes allocated
   size_t size_;
+
+  /// The allocator of data_, or null if data_ was allocated with new[]
+  image_allocator_sptr allocator_;
+
+private:
+  /// Release data_
+  void release();
 };
 
 /// Shared pointer for base image_memory type
 typedef std::shared_ptr< image_memory > image_memory_sptr;
 
 
+// ==================================================================
+/// The type of the pixel values of an image
+/**
+ * An image stores the kind of number in each pixel and its size in
+ * bytes, so that images of 16 bit, 32 bit or floating point pixels can
+ * share memory and pass through image containers like byte images do.
+ */
+struct image_pixel_traits
+{
+  /// The kind of number stored in each pixel
+  enum pixel_type
+  {
+    UNKNOWN = 0,
+    UNSIGNED = 1,
+    SIGNED = 2,
+    FLOAT = 3,
+    BOOL = 4
+  };
+
+  /// Constructor
+  /**
+   * The default is unsigned bytes.
+   * \param t The kind of number stored in each pixel
+   * \param num_bytes The number of bytes in each pixel value
+   */
+  explicit image_pixel_traits( pixel_type t = UNSIGNED, size_t num_bytes = 1 )
+    : type( t ), num_bytes( num_bytes ) { }
+
+  bool operator==( const image_pixel_traits& other ) const
+  {
+    return type == other.type && num_bytes == other.num_bytes;
+  }
+
+  bool operator!=( const image_pixel_traits& other ) const
+  {
+    return ! ( *this == other );
+  }
+
+  /// The kind of number stored in each pixel
+  pixel_type type;
+  /// The number of bytes in each pixel value
+  size_t num_bytes;
+};
+
+/// Output the pixel type, such as "uint16" or "float32"
+VITAL_EXPORT std::ostream& operator<<( std::ostream& os, const image_pixel_traits& pt );
+
+
+/// The image_pixel_traits of pixel values of type T
+template < typename T >
+struct image_pixel_traits_of : public image_pixel_traits
+{
+  image_pixel_traits_of()
+    : image_pixel_traits( std::is_floating_point< T >::value ? FLOAT :
+                          std::is_signed< T >::value ? SIGNED : UNSIGNED,
+                          sizeof( T ) ) { }
+};
+
+/// The image_pixel_traits of bool pixel values
+template <>
+struct image_pixel_traits_of< bool > : public image_pixel_traits
+{
+  image_pixel_traits_of()
+    : image_pixel_traits( BOOL, sizeof( bool ) ) { }
+};
+
+
 // ==================================================================
 /// The representation of an in-memory image.
 /**
  * Images share memory using the image_memory class.  This is
  * effectively a view on an image.
+ *
+ * The pixels are bytes unless the image is constructed with other
+ * image_pixel_traits.  The steps count pixel values, not bytes, and the
+ * byte accessors below only apply to images of bytes; use image_of to
+ * access other pixel types.
  */
 class VITAL_EXPORT image
 {
@@ -120,7 +226,10 @@ public:
   typedef unsigned char byte;
 
   /// Default Constructor
-  image();
+  /**
+   * \param pt The type of the pixels set_size() will allocate
+   */
+  explicit image( const image_pixel_traits& pt = image_pixel_traits() );
 
   /// Constructor that allocates image memory
   /**
@@ -130,8 +239,54 @@ public:
    * \param height Number of pixel rows
    * \param depth Number of image channels
    * \param interleave Set if the pixels are interleaved
+   * \param allocator Allocator of the image memory, such as an
+   *                  image_memory_pool, or null for the default allocator.
+   *                  set_size() also allocates from this allocator.
    */
-  image( size_t width, size_t height, size_t depth = 1, bool interleave = false );
+  image( size_t width, size_t height, size_t depth = 1, bool interleave = false,
+         const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+  /// Constructor that allocates image memory for pixels of any type
+  /**
+   * \param width Number of pixels in width
+   * \param height Number of pixel rows
+   * \param depth Number of image channels
+   * \param interleave Set if the pixels are interleaved
+   * \param pt The type of the pixels
+   * \param allocator Allocator of the image memory, or null for the
+   *                  default allocator
+   */
+  image( size_t width, size_t height, size_t depth, bool interleave,
+         const image_pixel_traits& pt,
+         const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+  /// Constructor that allocates image memory with padded rows
+  /**
+   * Create a new blank (empty) image of specified size where each row
+   * starts at a multiple of \a row_alignment bytes, so that SIMD code
+   * can use aligned loads at the start of every row.  The padding is
+   * included in h_step() and in size().
+   *
+   * \param width Number of pixels in width
+   * \param height Number of pixel rows
+   * \param depth Number of image channels
+   * \param interleave Set if the pixels are interleaved
+   * \param row_alignment Alignment of each row in bytes; a power of two
+   * \param allocator Allocator of the image memory, or null for the
+   *                  default allocator
+   */
+  image( size_t width, size_t height, size_t depth, bool interleave,
+         size_t row_alignment,
+         const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+  /// Constructor that allocates padded rows of pixels of any type
+  /**
+   * As above, where \a row_alignment must also be a multiple of the
+   * pixel size so that h_step() is a whole number of pixels.
+   */
+  image( size_t width, size_t height, size_t depth, bool interleave,
+         const image_pixel_traits& pt, size_t row_alignment,
+         const image_allocator_sptr& allocator = image_allocator_sptr() );
 
   /// Constructor that points at existing memory
   /**
@@ -144,12 +299,14 @@ public:
    * \param width Number of pixels wide
    * \param height Number of pixels high
    * \param depth Number of image channels
-   * \param w_step Byte increment to get to next pixel column
-   * \param h_step Byte increment to get to next pixel row
-   * \param d_step Byte increment to get to next image channel
+   * \param w_step Pixel increment to get to next pixel column
+   * \param h_step Pixel increment to get to next pixel row
+   * \param d_step Pixel increment to get to next image channel
+   * \param pt The type of the pixels
    */
-  image( const byte* first_pixel, size_t width, size_t height, size_t depth,
-         ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step );
+  image( const void* first_pixel, size_t width, size_t height, size_t depth,
+         ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step,
+         const image_pixel_traits& pt = image_pixel_traits() );
 
   /// Constructor that shares memory with another image
   /**
@@ -162,13 +319,15 @@ public:
    * \param width Number of pixels wide
    * \param height Number of pixels high
    * \param depth Number of image channels
-   * \param w_step Byte increment to get to next pixel column
-   * \param h_step Byte increment to get to next pixel row
-   * \param d_step Byte increment to get to next image channel
+   * \param w_step Pixel increment to get to next pixel column
+   * \param h_step Pixel increment to get to next pixel row
+   * \param d_step Pixel increment to get to next image channel
+   * \param pt The type of the pixels
    */
   image( const image_memory_sptr& mem,
-         const byte* first_pixel, size_t width, size_t height, size_t depth,
-         ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step );
+         const void* first_pixel, size_t width, size_t height, size_t depth,
+         ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step,
+         const image_pixel_traits& pt = image_pixel_traits() );
 
   /// Copy Constructor
   /**
@@ -216,6 +375,9 @@ public:
   /// The depth (or number of channels) of the image
   size_t depth() const { return depth_; }
 
+  /// The type of the pixels
+  const image_pixel_traits& pixel_traits() const { return pixel_traits_; }
+
   /// The the step in memory to next pixel in the width direction
   ptrdiff_t w_step() const { return w_step_; }
 
@@ -236,6 +398,7 @@ public:
    *
    * \param i width position (x)
    * \param j height position (y)
+   * \throws image_type_mismatch_exception if the pixels are not bytes
    */
   inline rgb_color at( unsigned i, unsigned j ) const
   {
@@ -243,6 +406,7 @@ public:
     {
       throw std::out_of_range("kwiver::vital::image::at(unsigned, unsigned) const");
     }
+    check_byte_pixels();
 
     if ( depth_ < 3 )
     {
@@ -259,8 +423,12 @@ public:
 
   /// Access pixels in the first channel of the image
   /**
+   * The byte accessors of this class require an image of byte pixels;
+   * use image_of<T> to access pixels of other types.
+   *
    * \param i width position (x)
    * \param j height position (y)
+   * \throws image_type_mismatch_exception if the pixels are not bytes
    */
   inline byte& operator()( unsigned i, unsigned j )
   {
@@ -268,6 +436,7 @@ public:
     {
       throw std::out_of_range("kwiver::vital::image::operator()(unsigned, unsigned)");
     }
+    check_byte_pixels();
     return first_pixel_[w_step_ * i + h_step_ * j];
   }
 
@@ -279,6 +448,7 @@ public:
     {
       throw std::out_of_range("kwiver::vital::image::operator()(unsigned, unsigned) const");
     }
+    check_byte_pixels();
     return first_pixel_[w_step_ * i + h_step_ * j];
   }
 
@@ -290,6 +460,7 @@ public:
     {
       throw std::out_of_range("kwiver::vital::image::operator()(unsigned, unsigned, unsigned)");
     }
+    check_byte_pixels();
     return first_pixel_[w_step_ * i + h_step_ * j + d_step_ * k];
   }
 
@@ -301,17 +472,88 @@ public:
     {
       throw std::out_of_range("kwiver::vital::image::operator()(unsigned, unsigned, unsigned) const");
     }
+    check_byte_pixels();
+    return first_pixel_[w_step_ * i + h_step_ * j + d_step_ * k];
+  }
+
+
+  /// Access pixels in the image without bounds checking
+  /**
+   * This is equivalent to operator() but does not check the indices
+   * or the pixel type, for inner loops that stay within an image of
+   * byte pixels by construction.
+   *
+   * \param i width position (x)
+   * \param j height position (y)
+   * \param k channel
+   */
+  inline byte& unchecked_pixel( unsigned i, unsigned j, unsigned k = 0 )
+  {
     return first_pixel_[w_step_ * i + h_step_ * j + d_step_ * k];
   }
 
 
+  /// Const access pixels in the image without bounds checking
+  inline const byte& unchecked_pixel( unsigned i, unsigned j, unsigned k = 0 ) const
+  {
+    return first_pixel_[w_step_ * i + h_step_ * j + d_step_ * k];
+  }
+
+
+  /// Const access pixels as rgb_color without bounds checking
+  /**
+   * This is equivalent to at() but does not check the indices or the
+   * pixel type, so the image must have byte pixels.
+   *
+   * \param i width position (x)
+   * \param j height position (y)
+   */
+  inline rgb_color unchecked_at( unsigned i, unsigned j ) const
+  {
+    const byte* p = first_pixel_ + w_step_ * i + h_step_ * j;
+    if ( depth_ < 3 )
+    {
+      return { p[0], p[0], p[0] };
+    }
+    return { p[0], p[d_step_], p[2 * d_step_] };
+  }
+
+
+  /// Get a view of a rectangle of the image
+  /**
+   * The returned image shares memory with this image, so no pixels are
+   * copied and writes to either image are visible in the other.
+   *
+   * \param x_offset Column of the first pixel of the view
+   * \param y_offset Row of the first pixel of the view
+   * \param width Number of pixels wide
+   * \param height Number of pixels high
+   *
+   * \throws std::out_of_range if the rectangle is not inside the image
+   */
+  image crop( size_t x_offset, size_t y_offset, size_t width, size_t height ) const;
+
+  /// Get a view of every \a x_step column of every \a y_step row
+  /**
+   * The returned image shares memory with this image and keeps the first
+   * pixel, so it is ceil(width / x_step) by ceil(height / y_step) pixels.
+   *
+   * \throws invalid_value if a step is zero
+   */
+  image subsample( size_t x_step, size_t y_step ) const;
+
   /// Deep copy the image data from another image into this one
+  /**
+   * This image takes the pixel type of \a other, reallocating if the
+   * size or pixel type differ.
+   */
   void copy_from( const image& other );
 
   /// Set the size of the image.
   /**
    * If the size has not changed, do nothing.
-   * Otherwise, allocate new memory matching the new size.
+   * Otherwise, allocate new memory matching the new size and the
+   * current pixel type, from the same allocator as the current memory.
    * \param width a new image width
    * \param height a new image height
    * \param depth a new image depth
@@ -320,6 +562,18 @@ public:
 
 
 protected:
+  /// Throw image_type_mismatch_exception unless the pixels are bytes
+  inline void check_byte_pixels() const
+  {
+    if ( pixel_traits_ != image_pixel_traits() )
+    {
+      throw_pixel_type_mismatch( image_pixel_traits() );
+    }
+  }
+
+  /// Throw image_type_mismatch_exception for access as pixels of type \a pt
+  void throw_pixel_type_mismatch( const image_pixel_traits& pt ) const;
+
   /// Smart pointer to memory viewed by this class
   image_memory_sptr data_;
   /// Pointer to the pixel at the origin
@@ -336,10 +590,143 @@ protected:
   ptrdiff_t h_step_;
   /// Increment to move to the next pixel along the depth direction
   ptrdiff_t d_step_;
+  /// The type of the pixels
+  image_pixel_traits pixel_traits_;
 
 };
 
 
+namespace detail {
+
+/// Throw image_type_mismatch_exception unless the image has pixels of type \a pt
+VITAL_EXPORT void check_pixel_traits( const image& img, const image_pixel_traits& pt );
+
+} // end namespace detail
+
+
+/// An image of pixels of type T
+/**
+ * This is an image with typed access to its pixels.  It shares memory
+ * like any other image, and converting an image to image_of<T> checks
+ * that it holds pixels of type T, without copying.
+ *
+ * Example:
+\code
+kwiver::vital::image_of< uint16_t > thermal( 640, 512 );
+thermal( 10, 20 ) = 16383;
+kwiver::vital::image_container_sptr c =
+  std::make_shared< kwiver::vital::simple_image_container >( thermal );
+kwiver::vital::image_of< uint16_t > same( c->get_image() );
+\endcode
+ */
+template < typename T >
+class image_of : public image
+{
+public:
+  /// Default Constructor
+  image_of()
+    : image( image_pixel_traits_of< T >() ) { }
+
+  /// Constructor that allocates image memory
+  image_of( size_t width, size_t height, size_t depth = 1, bool interleave = false,
+            const image_allocator_sptr& allocator = image_allocator_sptr() )
+    : image( width, height, depth, interleave, image_pixel_traits_of< T >(), allocator ) { }
+
+  /// Constructor that points at existing memory
+  image_of( const T* first_pixel, size_t width, size_t height, size_t depth,
+            ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step )
+    : image( first_pixel, width, height, depth, w_step, h_step, d_step,
+             image_pixel_traits_of< T >() ) { }
+
+  /// Constructor that shares memory with another image
+  image_of( const image_memory_sptr& mem,
+            const T* first_pixel, size_t width, size_t height, size_t depth,
+            ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step )
+    : image( mem, first_pixel, width, height, depth, w_step, h_step, d_step,
+             image_pixel_traits_of< T >() ) { }
+
+  /// Constructor that shares memory with an image of pixels of type T
+  /**
+   * \throws image_type_mismatch_exception if \a other does not hold
+   *         pixels of type T
+   */
+  image_of( const image& other )
+    : image( other )
+  {
+    check_type( other );
+  }
+
+  /// Assignment from an image of pixels of type T
+  const image_of< T >& operator=( const image& other )
+  {
+    check_type( other );
+    image::operator=( other );
+    return *this;
+  }
+
+  /// Deep copy the pixels of an image of pixels of type T into this image
+  /**
+   * \throws image_type_mismatch_exception if \a other does not hold
+   *         pixels of type T
+   */
+  void copy_from( const image& other )
+  {
+    check_type( other );
+    image::copy_from( other );
+  }
+
+  /// Set the size of the image, allocating pixels of type T if needed
+  void set_size( size_t width, size_t height, size_t depth = 1 )
+  {
+    image::set_size( width, height, depth );
+  }
+
+  /// Const access to the pointer to first image pixel
+  const T* first_pixel() const { return reinterpret_cast< const T* >( first_pixel_ ); }
+
+  /// Access to the pointer to first image pixel
+  T* first_pixel() { return reinterpret_cast< T* >( first_pixel_ ); }
+
+  /// Access pixels in the image (width, height, channel)
+  T& operator()( unsigned i, unsigned j, unsigned k = 0 )
+  {
+    if( i >= width_ || j >= height_ || k >= depth_ )
+    {
+      throw std::out_of_range("kwiver::vital::image_of<T>::operator()(unsigned, unsigned, unsigned)");
+    }
+    return first_pixel()[w_step_ * i + h_step_ * j + d_step_ * k];
+  }
+
+  /// Const access pixels in the image (width, height, channel)
+  const T& operator()( unsigned i, unsigned j, unsigned k = 0 ) const
+  {
+    if( i >= width_ || j >= height_ || k >= depth_ )
+    {
+      throw std::out_of_range("kwiver::vital::image_of<T>::operator()(unsigned, unsigned, unsigned) const");
+    }
+    return first_pixel()[w_step_ * i + h_step_ * j + d_step_ * k];
+  }
+
+  /// Access pixels in the image without bounds checking
+  T& unchecked_pixel( unsigned i, unsigned j, unsigned k = 0 )
+  {
+    return first_pixel()[w_step_ * i + h_step_ * j + d_step_ * k];
+  }
+
+  /// Const access pixels in the image without bounds checking
+  const T& unchecked_pixel( unsigned i, unsigned j, unsigned k = 0 ) const
+  {
+    return first_pixel()[w_step_ * i + h_step_ * j + d_step_ * k];
+  }
+
+private:
+  static void check_type( const image& other )
+  {
+    detail::check_pixel_traits( other, image_pixel_traits_of< T >() );
+  }
+};
+
+
 /// Compare to images to see if the pixels have the same values.
 /**
  * This does not require that the images have the same memory layout,
@@ -350,11 +737,32 @@ protected:
 VITAL_EXPORT bool equal_content( const image& img1, const image& img2 );
 
 
+/// Compute a 64-bit hash of the size, pixel type and pixel values of an image
+/**
+ * Like equal_content(), this does not depend on the memory layout, so
+ * images with equal content have equal hashes.  Images with different
+ * content have equal hashes with a probability of about 2^-64, which makes
+ * the hash suitable for recognizing repeated video frames.  The hash is
+ * computed with the XXH64 algorithm over the rows of each channel and
+ * runs at close to memory bandwidth for images with contiguous rows.
+ *
+ * Hashes of the same image are equal on machines with the same byte
+ * order, but should not be stored where they are read on other machines.
+ *
+ * \param img the image to hash
+ * \param seed a value mixed into the hash, to compute independent hashes
+ */
+VITAL_EXPORT uint64_t hash_content( const image& img, uint64_t seed = 0 );
+
+
 /// Transform a given image in place given a unary function
 /**
  * Apply a given unary function to all pixels in the image. This is guareteed
  * to traverse the pixels in an optimal order, i.e. in-memory-order traversal.
  *
+ * Functors and lambdas use the templated overload below, which can inline
+ * the operation and optionally use several threads.
+ *
  * Example:
 \code
 static kwiver::vital::image::byte invert_mask_pixel( kwiver::vital::image::byte const &b )
@@ -388,6 +796,333 @@ VITAL_EXPORT void transform_image( image& img,
                                    image::byte ( * op )( image::byte const& ) );
 
 
+namespace detail {
+
+/// A loop nest over the pixels of up to three images of the same size
+/**
+ * The dimensions are ordered by the memory layout of the first image,
+ * innermost first, and dimensions that are contiguous in every image are
+ * merged, so that each innermost run is as long as possible.
+ */
+struct image_loop
+{
+  /// Number of iterations of each loop, innermost first
+  size_t size[3];
+  /// Pointer increment of each loop, for each image
+  ptrdiff_t step[3][3];
+  /// Number of images
+  unsigned num_images;
+};
+
+
+/// Make the loop nest over the pixels of \a num images of the same size
+VITAL_EXPORT image_loop make_image_loop( const image* const* imgs, unsigned num );
+
+/// Make the loop nest over \a num arrays of the given size and steps
+/**
+ * \param sizes Width, height and depth shared by the arrays
+ * \param steps Width, height and depth steps of each array
+ * \param num Number of arrays, at most three
+ */
+VITAL_EXPORT image_loop make_image_loop( const size_t* sizes,
+                                         const ptrdiff_t ( *steps )[3],
+                                         unsigned num );
+
+/// Throw image_size_mismatch_exception unless the images have the same size
+VITAL_EXPORT void check_same_size( const image& img1, const image& img2 );
+
+/// Throw image_size_mismatch_exception unless the image has \a depth channels
+VITAL_EXPORT void check_depth( const image& img, size_t depth );
+
+
+/// Apply \a run to each innermost run of a loop nest
+/**
+ * \a run is called with an array of offsets of the start of the run from
+ * the first pixel of each image, and the number of pixels in the run.
+ *
+ * If \a max_threads is not one, large loops are split across the shared
+ * thread pool using at most \a max_threads threads, or all of them if it
+ * is zero.  Loops with few rows have their rows split into blocks.
+ */
+template < typename Run >
+void
+for_each_image_run( const image_loop& l, unsigned max_threads, Run run )
+{
+  // the smallest block of a row handed to a thread
+  const size_t min_block = 4096;
+
+  const size_t rows = l.size[1] * l.size[2];
+  const bool parallel = use_parallel( rows * l.size[0], max_threads );
+  const size_t blocks_per_row = ( parallel && rows < 64 )
+    ? std::max< size_t >( 1, l.size[0] / min_block ) : 1;
+  const size_t block = ( l.size[0] + blocks_per_row - 1 ) / blocks_per_row;
+
+  auto body = [&] ( size_t begin, size_t end )
+  {
+    ptrdiff_t offsets[3];
+    for ( size_t u = begin; u < end; ++u )
+    {
+      const size_t r = u / blocks_per_row;
+      const size_t c = ( u % blocks_per_row ) * block;
+      const ptrdiff_t i1 = static_cast< ptrdiff_t >( r % l.size[1] );
+      const ptrdiff_t i2 = static_cast< ptrdiff_t >( r / l.size[1] );
+      for ( unsigned k = 0; k < l.num_images; ++k )
+      {
+        offsets[k] = i2 * l.step[k][2] + i1 * l.step[k][1] +
+                     static_cast< ptrdiff_t >( c ) * l.step[k][0];
+      }
+      run( offsets, std::min( block, l.size[0] - c ) );
+    }
+  };
+
+  parallel_for_work( rows * blocks_per_row, block, body, max_threads, 16 * 1024 );
+}
+
+} // end namespace detail
+
+
+/// Transform a given image in place given a unary functor
+/**
+ * Apply \a op, any callable taking a byte and returning a byte, to all
+ * pixels of an image of bytes.  The pixels are visited in memory order, and where
+ * the pixels are contiguous the inner loop is a plain array loop the
+ * compiler can inline \a op into and vectorize.
+ *
+ * Example:
+\code
+kwiver::vital::transform_image( img, []( kwiver::vital::image::byte b )
+                                     { return 255 - b; }, 0 );
+\endcode
+ *
+ * \param img Input image reference to transform the data of
+ * \param op Unary functor which takes a byte and returns a byte
+ * \param max_threads The maximum number of threads; one, the default,
+ *                    runs on the calling thread in memory order, and zero
+ *                    uses all threads of the shared thread pool.  With
+ *                    more than one thread \a op must be thread safe.
+ *
+ * \throws image_type_mismatch_exception if the pixels are not bytes
+ */
+template < typename Op >
+void
+transform_image( image& img, Op op, unsigned max_threads = 1 )
+{
+  detail::check_pixel_traits( img, image_pixel_traits() );
+  const image* imgs[1] = { &img };
+  const detail::image_loop l = detail::make_image_loop( imgs, 1 );
+  image::byte* const origin = img.first_pixel();
+  const ptrdiff_t s = l.step[0][0];
+
+  detail::for_each_image_run( l, max_threads, [&] ( const ptrdiff_t* off, size_t n )
+  {
+    image::byte* p = origin + off[0];
+    if ( s == 1 )
+    {
+      for ( size_t i = 0; i < n; ++i )
+      {
+        p[i] = op( p[i] );
+      }
+    }
+    else
+    {
+      for ( size_t i = 0; i < n; ++i, p += s )
+      {
+        *p = op( *p );
+      }
+    }
+  } );
+}
+
+
+/// Transform the pixels of one image into another given a unary functor
+/**
+ * Sets each pixel of \a out to \a op applied to the matching pixel of
+ * \a in.  \a out is resized to the size of \a in if needed.
+ *
+ * \param in The input image
+ * \param out The output image
+ * \param op Unary functor which takes a byte and returns a byte
+ * \param max_threads The maximum number of threads, as for the in place
+ *                    transform_image()
+ */
+template < typename Op >
+void
+transform_image( const image& in, image& out, Op op, unsigned max_threads = 1 )
+{
+  detail::check_pixel_traits( in, image_pixel_traits() );
+  out.set_size( in.width(), in.height(), in.depth() );
+  detail::check_pixel_traits( out, image_pixel_traits() );
+
+  const image* imgs[2] = { &out, &in };
+  const detail::image_loop l = detail::make_image_loop( imgs, 2 );
+  image::byte* const out_origin = out.first_pixel();
+  const image::byte* const in_origin = in.first_pixel();
+  const ptrdiff_t s_out = l.step[0][0];
+  const ptrdiff_t s_in = l.step[1][0];
+
+  detail::for_each_image_run( l, max_threads, [&] ( const ptrdiff_t* off, size_t n )
+  {
+    image::byte* o = out_origin + off[0];
+    const image::byte* a = in_origin + off[1];
+    if ( s_out == 1 && s_in == 1 )
+    {
+      for ( size_t i = 0; i < n; ++i )
+      {
+        o[i] = op( a[i] );
+      }
+    }
+    else
+    {
+      for ( size_t i = 0; i < n; ++i, o += s_out, a += s_in )
+      {
+        *o = op( *a );
+      }
+    }
+  } );
+}
+
+
+/// Combine the pixels of two images into a third given a binary functor
+/**
+ * Sets each pixel of \a out to \a op applied to the matching pixels of
+ * \a in1 and \a in2, for example to apply a mask.  \a out is resized
+ * to the size of the inputs if needed.
+ *
+ * \param in1 The first input image
+ * \param in2 The second input image, of the same size as \a in1
+ * \param out The output image
+ * \param op Binary functor which takes two bytes and returns a byte
+ * \param max_threads The maximum number of threads, as for the in place
+ *                    transform_image()
+ *
+ * \throws image_size_mismatch_exception if the input sizes differ
+ */
+template < typename Op >
+void
+transform_image( const image& in1, const image& in2, image& out, Op op,
+                 unsigned max_threads = 1 )
+{
+  detail::check_same_size( in1, in2 );
+  detail::check_pixel_traits( in1, image_pixel_traits() );
+  detail::check_pixel_traits( in2, image_pixel_traits() );
+  out.set_size( in1.width(), in1.height(), in1.depth() );
+  detail::check_pixel_traits( out, image_pixel_traits() );
+
+  const image* imgs[3] = { &out, &in1, &in2 };
+  const detail::image_loop l = detail::make_image_loop( imgs, 3 );
+  image::byte* const out_origin = out.first_pixel();
+  const image::byte* const origin1 = in1.first_pixel();
+  const image::byte* const origin2 = in2.first_pixel();
+  const ptrdiff_t s_out = l.step[0][0];
+  const ptrdiff_t s1 = l.step[1][0];
+  const ptrdiff_t s2 = l.step[2][0];
+
+  detail::for_each_image_run( l, max_threads, [&] ( const ptrdiff_t* off, size_t n )
+  {
+    image::byte* o = out_origin + off[0];
+    const image::byte* a = origin1 + off[1];
+    const image::byte* b = origin2 + off[2];
+    if ( s_out == 1 && s1 == 1 && s2 == 1 )
+    {
+      for ( size_t i = 0; i < n; ++i )
+      {
+        o[i] = op( a[i], b[i] );
+      }
+    }
+    else
+    {
+      for ( size_t i = 0; i < n; ++i, o += s_out, a += s1, b += s2 )
+      {
+        *o = op( *a, *b );
+      }
+    }
+  } );
+}
+
+
+/// Transform whole pixels of one image into another given a functor
+/**
+ * For each pixel, \a op is called with a pointer to the \a InDepth
+ * channel values of the input pixel and a pointer to room for the
+ * \a OutDepth channel values of the output pixel, both contiguous, for
+ * operations that combine channels such as color conversion or look up
+ * tables indexed by several channels.  \a out is resized to the width
+ * and height of \a in with \a OutDepth channels if needed.
+ *
+ * Example:
+\code
+// luminance of an RGB image
+kwiver::vital::transform_pixels< 3, 1 >( rgb, gray,
+  []( const kwiver::vital::image::byte* in, kwiver::vital::image::byte* out )
+  { out[0] = ( 77 * in[0] + 150 * in[1] + 29 * in[2] ) >> 8; } );
+\endcode
+ *
+ * \param in The input image, with \a InDepth channels
+ * \param out The output image
+ * \param op Functor called as op( const byte* in_pixel, byte* out_pixel )
+ * \param max_threads The maximum number of threads, as for the in place
+ *                    transform_image()
+ *
+ * \throws image_size_mismatch_exception if \a in does not have \a InDepth
+ *         channels
+ */
+template < unsigned InDepth, unsigned OutDepth, typename Op >
+void
+transform_pixels( const image& in, image& out, Op op, unsigned max_threads = 1 )
+{
+  detail::check_depth( in, InDepth );
+  detail::check_pixel_traits( in, image_pixel_traits() );
+  out.set_size( in.width(), in.height(), OutDepth );
+  detail::check_pixel_traits( out, image_pixel_traits() );
+
+  // loop over the first channel of each image, one iteration per pixel
+  const image out_plane( out.first_pixel(), out.width(), out.height(), 1,
+                         out.w_step(), out.h_step(), out.d_step() );
+  const image in_plane( in.first_pixel(), in.width(), in.height(), 1,
+                        in.w_step(), in.h_step(), in.d_step() );
+  const image* imgs[2] = { &out_plane, &in_plane };
+  const detail::image_loop l = detail::make_image_loop( imgs, 2 );
+  image::byte* const out_origin = out.first_pixel();
+  const image::byte* const in_origin = in.first_pixel();
+  const ptrdiff_t s_out = l.step[0][0];
+  const ptrdiff_t s_in = l.step[1][0];
+  const ptrdiff_t d_out = out.d_step();
+  const ptrdiff_t d_in = in.d_step();
+
+  detail::for_each_image_run( l, max_threads, [&] ( const ptrdiff_t* off, size_t n )
+  {
+    image::byte* o = out_origin + off[0];
+    const image::byte* a = in_origin + off[1];
+    image::byte in_px[InDepth];
+    image::byte out_px[OutDepth];
+    for ( size_t i = 0; i < n; ++i, o += s_out, a += s_in )
+    {
+      const image::byte* src = a;
+      if ( d_in != 1 )
+      {
+        for ( unsigned k = 0; k < InDepth; ++k )
+        {
+          in_px[k] = a[k * d_in];
+        }
+        src = in_px;
+      }
+      if ( d_out == 1 )
+      {
+        op( src, o );
+      }
+      else
+      {
+        op( src, out_px );
+        for ( unsigned k = 0; k < OutDepth; ++k )
+        {
+          o[k * d_out] = out_px[k];
+        }
+      }
+    }
+  } );
+}
+
+
 } }   // end namespace vital
 
 
@@ -0,0 +1,114 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the image memory allocators
+ */
+
+#include "image_allocator.h"
+
+#include <vital/exceptions/base.h>
+#include <vital/util/aligned_memory.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace kwiver {
+namespace vital {
+
+image_allocator
+::~image_allocator()
+{
+}
+
+
+image_allocator_sptr const&
+image_allocator
+::default_allocator()
+{
+  static const image_allocator_sptr allocator( new aligned_image_allocator );
+  return allocator;
+}
+
+
+// ------------------------------------------------------------------
+aligned_image_allocator
+::aligned_image_allocator( size_t alignment, size_t huge_page_threshold )
+  : alignment_( alignment ),
+    huge_page_threshold_( huge_page_threshold )
+{
+  if ( alignment < sizeof( void* ) || ( alignment & ( alignment - 1 ) ) != 0 )
+  {
+    throw invalid_value( "image allocator alignment must be a power of two "
+                         "and a multiple of the pointer size" );
+  }
+}
+
+
+size_t
+aligned_image_allocator
+::allocation_size( size_t n ) const
+{
+  if ( huge_page_threshold_ > 0 && n >= huge_page_threshold_ )
+  {
+    return align_size( n, huge_page_size );
+  }
+  return n;
+}
+
+
+void*
+aligned_image_allocator
+::allocate( size_t n )
+{
+  n = allocation_size( n );
+  if ( huge_page_threshold_ > 0 && n >= huge_page_threshold_ )
+  {
+    void* data = aligned_malloc( n, huge_page_size );
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // only advice; the block works the same if it is refused
+    madvise( data, n, MADV_HUGEPAGE );
+#endif
+    return data;
+  }
+  return aligned_malloc( n, alignment_ );
+}
+
+
+void
+aligned_image_allocator
+::deallocate( void* data, size_t /*n*/ )
+{
+  aligned_free( data );
+}
+
+} } // end namespace
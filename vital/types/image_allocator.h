@@ -0,0 +1,140 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface for image memory allocators
+ */
+
+#ifndef VITAL_IMAGE_ALLOCATOR_H_
+#define VITAL_IMAGE_ALLOCATOR_H_
+
+#include <vital/vital_export.h>
+
+#include <memory>
+
+#include <cstddef>
+
+namespace kwiver {
+namespace vital {
+
+class image_allocator;
+
+/// Shared pointer for image_allocator
+typedef std::shared_ptr< image_allocator > image_allocator_sptr;
+
+
+/// Abstract source of the memory blocks that hold image pixels
+/**
+ * An allocator may reserve more memory than requested, for example to
+ * round blocks up to an alignment boundary or to a size bucket.
+ * allocation_size() reports the actual footprint; image_memory records it
+ * as its size and passes it to both allocate() and deallocate().
+ */
+class VITAL_EXPORT image_allocator
+{
+public:
+  virtual ~image_allocator();
+
+  /// The number of bytes reserved for a request of \a n bytes
+  /**
+   * This must be at least \a n, and reserving the returned number of
+   * bytes must not reserve more.
+   */
+  virtual size_t allocation_size( size_t n ) const = 0;
+
+  /// Allocate a block of allocation_size( \a n ) bytes
+  /**
+   * \returns the block, or null if \a n is zero
+   * \throws std::bad_alloc if the allocation fails
+   */
+  virtual void* allocate( size_t n ) = 0;
+
+  /// Release a block returned by allocate( \a n )
+  virtual void deallocate( void* data, size_t n ) = 0;
+
+  /// The alignment, in bytes, of the blocks returned by allocate()
+  virtual size_t alignment() const = 0;
+
+  /// The allocator used for image memory when none is specified
+  /**
+   * This allocates blocks aligned to 64 bytes.
+   */
+  static image_allocator_sptr const& default_allocator();
+};
+
+
+// ==================================================================
+/// Allocator of aligned blocks, optionally backed by huge pages
+/**
+ * Blocks start at a multiple of the requested alignment, so the rows of
+ * an image padded to the same alignment start on aligned addresses and
+ * SIMD kernels may use aligned loads.
+ *
+ * Blocks of at least \a huge_page_threshold bytes are instead aligned to
+ * and rounded up to huge_page_size.  On Linux they are marked with
+ * madvise( MADV_HUGEPAGE ) so that transparent huge pages can back them,
+ * which reduces the page faults and TLB misses of large video frames.
+ */
+class VITAL_EXPORT aligned_image_allocator
+  : public image_allocator
+{
+public:
+  /// The size of a huge page assumed for alignment
+  static const size_t huge_page_size = 2 * 1024 * 1024;
+
+  /// Constructor
+  /**
+   * \param alignment  alignment of each block; a power of two that is a
+   *                   multiple of sizeof(void*)
+   * \param huge_page_threshold  minimum size of the blocks backed by huge
+   *                   pages, or zero to never use huge pages
+   *
+   * \throws invalid_value if the alignment is not valid
+   */
+  explicit aligned_image_allocator( size_t alignment = 64,
+                                    size_t huge_page_threshold = 0 );
+
+  virtual size_t allocation_size( size_t n ) const;
+  virtual void* allocate( size_t n );
+  virtual void deallocate( void* data, size_t n );
+  virtual size_t alignment() const { return alignment_; }
+
+  /// The minimum size of the blocks backed by huge pages, or zero
+  size_t huge_page_threshold() const { return huge_page_threshold_; }
+
+private:
+  size_t alignment_;
+  size_t huge_page_threshold_;
+};
+
+} } // end namespace
+
+#endif // VITAL_IMAGE_ALLOCATOR_H_
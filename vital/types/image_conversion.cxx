@@ -0,0 +1,243 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of image channel and layout conversion
+ */
+
+#include "image_conversion.h"
+
+#include <vital/util/pixel_kernels.h>
+#include <vital/util/thread_pool.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+typedef image::byte byte;
+
+
+/// Get a view of channel \a k of \a img
+image
+channel_view( const image& img, size_t k )
+{
+  const ptrdiff_t nb = static_cast< ptrdiff_t >( img.pixel_traits().num_bytes );
+  return image( img.memory(), img.first_pixel() + nb * img.d_step() * static_cast< ptrdiff_t >( k ),
+                img.width(), img.height(), 1,
+                img.w_step(), img.h_step(), img.d_step(), img.pixel_traits() );
+}
+
+
+/// Reads the rows of all channels of a byte image as contiguous planes
+/**
+ * Rows of planar images are used in place.  Interleaved rows are split
+ * with deinterleave_pixels() and rows with other steps are gathered, in
+ * both cases into buffers owned by the reader, so each thread needs its
+ * own reader.
+ */
+class row_reader
+{
+public:
+  explicit row_reader( const image& img )
+    : img_( img ),
+      interleaved_( img.depth() > 1 && img.d_step() == 1 &&
+                    img.w_step() == static_cast< ptrdiff_t >( img.depth() ) ),
+      buffers_( img.w_step() == 1 ? 0 : img.depth() * img.width() ),
+      rows_( img.depth() )
+  {
+  }
+
+  /// Return pointers to row \a j of each channel
+  byte const* const* read( size_t j )
+  {
+    const size_t width = img_.width();
+    const size_t depth = img_.depth();
+    const byte* row = img_.first_pixel() + img_.h_step() * static_cast< ptrdiff_t >( j );
+    if ( img_.w_step() == 1 )
+    {
+      for ( size_t k = 0; k < depth; ++k )
+      {
+        rows_[k] = row + img_.d_step() * static_cast< ptrdiff_t >( k );
+      }
+      return &rows_[0];
+    }
+
+    std::vector< byte* > planes( depth );
+    for ( size_t k = 0; k < depth; ++k )
+    {
+      planes[k] = &buffers_[k * width];
+      rows_[k] = planes[k];
+    }
+    if ( interleaved_ )
+    {
+      deinterleave_pixels( row, depth, width, &planes[0] );
+      return &rows_[0];
+    }
+    const ptrdiff_t w_step = img_.w_step();
+    for ( size_t k = 0; k < depth; ++k )
+    {
+      const byte* src = row + img_.d_step() * static_cast< ptrdiff_t >( k );
+      for ( size_t i = 0; i < width; ++i )
+      {
+        planes[k][i] = src[w_step * static_cast< ptrdiff_t >( i )];
+      }
+    }
+    return &rows_[0];
+  }
+
+private:
+  const image& img_;
+  const bool interleaved_;
+  std::vector< byte > buffers_;
+  std::vector< const byte* > rows_;
+};
+
+
+/// Throw if \a channel is not a channel of \a img
+void
+check_channel( const image& img, unsigned channel )
+{
+  if ( channel >= img.depth() )
+  {
+    throw std::out_of_range( "kwiver::vital image conversion channel "
+                             "is not in the source image" );
+  }
+}
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+image
+convert_to_gray( const image& src, unsigned red, unsigned green, unsigned blue,
+                 unsigned max_threads, const image_allocator_sptr& allocator )
+{
+  detail::check_pixel_traits( src, image_pixel_traits() );
+  if ( src.depth() < 3 )
+  {
+    return src.depth() == 0 ? src : channel_view( src, 0 );
+  }
+  check_channel( src, red );
+  check_channel( src, green );
+  check_channel( src, blue );
+
+  image dst( src.width(), src.height(), 1, false, allocator );
+  if ( src.width() == 0 || src.height() == 0 )
+  {
+    return dst;
+  }
+  const size_t width = src.width();
+  parallel_for_work( src.height(), width * src.depth(),
+                     [&] ( size_t begin, size_t end )
+  {
+    row_reader reader( src );
+    for ( size_t j = begin; j < end; ++j )
+    {
+      byte const* const* rows = reader.read( j );
+      rgb_to_gray( rows[red], rows[green], rows[blue], width,
+                   &dst.unchecked_pixel( 0, static_cast< unsigned >( j ) ) );
+    }
+  }, max_threads );
+  return dst;
+}
+
+
+// ------------------------------------------------------------------
+image
+reorder_channels( const image& src, const std::vector< unsigned >& channels,
+                  bool interleave, unsigned max_threads,
+                  const image_allocator_sptr& allocator )
+{
+  std::vector< unsigned > order( channels );
+  if ( order.empty() )
+  {
+    for ( unsigned k = 0; k < src.depth(); ++k )
+    {
+      order.push_back( k );
+    }
+  }
+  for ( size_t k = 0; k < order.size(); ++k )
+  {
+    check_channel( src, order[k] );
+  }
+
+  const size_t width = src.width();
+  const size_t depth = order.size();
+  image dst( width, src.height(), depth, interleave, src.pixel_traits(), allocator );
+  if ( width == 0 || src.height() == 0 || depth == 0 )
+  {
+    return dst;
+  }
+
+  if ( src.pixel_traits() != image_pixel_traits() )
+  {
+    for ( size_t k = 0; k < depth; ++k )
+    {
+      image out = channel_view( dst, k );
+      out.copy_from( channel_view( src, order[k] ) );
+    }
+    return dst;
+  }
+
+  parallel_for_work( src.height(), width * depth,
+                     [&] ( size_t begin, size_t end )
+  {
+    row_reader reader( src );
+    std::vector< const byte* > planes( depth );
+    for ( size_t j = begin; j < end; ++j )
+    {
+      byte const* const* rows = reader.read( j );
+      for ( size_t k = 0; k < depth; ++k )
+      {
+        planes[k] = rows[order[k]];
+      }
+      const unsigned y = static_cast< unsigned >( j );
+      if ( interleave )
+      {
+        interleave_pixels( &planes[0], depth, width, &dst.unchecked_pixel( 0, y ) );
+        continue;
+      }
+      for ( size_t k = 0; k < depth; ++k )
+      {
+        std::memcpy( &dst.unchecked_pixel( 0, y, static_cast< unsigned >( k ) ),
+                     planes[k], width );
+      }
+    }
+  }, max_threads );
+  return dst;
+}
+
+} } // end namespace
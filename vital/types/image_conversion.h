@@ -0,0 +1,104 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface for converting the channels and layout of images
+ */
+
+#ifndef VITAL_IMAGE_CONVERSION_H_
+#define VITAL_IMAGE_CONVERSION_H_
+
+#include <vital/types/image.h>
+
+#include <vital/vital_export.h>
+
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+/// Convert a color image to a single channel of luma
+/**
+ * Each pixel is ( 77 R + 150 G + 29 B + 128 ) / 256, the BT.601 weights
+ * in fixed point, computed with rgb_to_gray().  Interleaved rows are
+ * split into planes with the vectorized kernels first, so both layouts
+ * are converted at the same speed.  Rows are converted in parallel on
+ * the shared thread pool.
+ *
+ * Images with one or two channels, gray or gray and alpha, are already
+ * gray; the result is a view of their first channel, sharing memory.
+ *
+ * \param src          an image of bytes
+ * \param red          the channel of \a src holding red
+ * \param green        the channel of \a src holding green
+ * \param blue         the channel of \a src holding blue; use 2, 1, 0
+ *                     for BGR images
+ * \param max_threads  the maximum number of threads, all if zero
+ * \param allocator    allocator of the result, or null for the default
+ *
+ * \throws image_type_mismatch_exception if \a src does not hold bytes
+ * \throws std::out_of_range if a color channel is not in \a src
+ */
+VITAL_EXPORT image
+convert_to_gray( const image& src,
+                 unsigned red = 0, unsigned green = 1, unsigned blue = 2,
+                 unsigned max_threads = 0,
+                 const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+
+/// Copy a selection of channels of an image into a new layout
+/**
+ * Channel k of the result is channel \a channels[k] of \a src, so this
+ * swaps channels ({ 2, 1, 0 } converts RGB to BGR), extracts channels
+ * ({ 3 } is the alpha of RGBA) and duplicates them.  An empty \a channels
+ * keeps all channels in order, which only changes the layout.
+ *
+ * Images of bytes are converted a row at a time with the vectorized
+ * interleave and deinterleave kernels, in parallel on the shared thread
+ * pool.  Other pixel types are copied a channel at a time with
+ * image::copy_from().
+ *
+ * \param src          the image to convert
+ * \param channels     the channels of \a src to copy, in output order
+ * \param interleave   whether the result has interleaved or planar pixels
+ * \param max_threads  the maximum number of threads, all if zero
+ * \param allocator    allocator of the result, or null for the default
+ *
+ * \throws std::out_of_range if a channel is not in \a src
+ */
+VITAL_EXPORT image
+reorder_channels( const image& src, const std::vector< unsigned >& channels,
+                  bool interleave, unsigned max_threads = 0,
+                  const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+} } // end namespace
+
+#endif // VITAL_IMAGE_CONVERSION_H_
@@ -0,0 +1,267 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the image memory pool
+ */
+
+#include "image_memory_pool.h"
+
+#include <list>
+#include <mutex>
+
+namespace kwiver {
+namespace vital {
+
+/// Private implementation class
+class image_memory_pool::priv
+{
+public:
+  priv( size_t max, const image_allocator_sptr& alloc )
+    : max_bytes( max ),
+      idle_bytes( 0 ),
+      reuse_count( 0 ),
+      allocator( alloc )
+  {
+  }
+
+  ~priv()
+  {
+    free_until( 0 );
+  }
+
+  /// Free the least recently returned buffers until at most \a n bytes are idle
+  void free_until( size_t n )
+  {
+    while ( idle_bytes > n && ! idle.empty() )
+    {
+      idle_bytes -= idle.front().first;
+      allocator->deallocate( idle.front().second, idle.front().first );
+      idle.pop_front();
+    }
+  }
+
+  mutable std::mutex mutex;
+  size_t max_bytes;
+  size_t idle_bytes;
+  size_t reuse_count;
+  image_allocator_sptr allocator;
+
+  /// Size and address of the idle buffers, most recently returned last
+  std::list< std::pair< size_t, void* > > idle;
+};
+
+
+// ------------------------------------------------------------------
+image_memory_pool
+::image_memory_pool( size_t max_bytes, const image_allocator_sptr& allocator )
+  : d_( new priv( max_bytes, allocator ? allocator : image_allocator::default_allocator() ) )
+{
+}
+
+
+image_memory_pool
+::~image_memory_pool()
+{
+}
+
+
+image_memory_pool_sptr
+image_memory_pool
+::create( size_t max_bytes, const image_allocator_sptr& allocator )
+{
+  return image_memory_pool_sptr( new image_memory_pool( max_bytes, allocator ) );
+}
+
+
+image_memory_pool_sptr const&
+image_memory_pool
+::global()
+{
+  static const image_memory_pool_sptr pool = create();
+  return pool;
+}
+
+
+// ------------------------------------------------------------------
+size_t
+image_memory_pool
+::bucket_size( size_t n )
+{
+  const size_t min_size = 64;
+  if ( n <= min_size )
+  {
+    return min_size;
+  }
+
+  // eight buckets between consecutive powers of two
+  unsigned bits = 0;
+  for ( size_t v = n - 1; v > 0; v >>= 1 )
+  {
+    ++bits;
+  }
+  const size_t step = size_t( 1 ) << ( bits - 4 );
+  return ( n + step - 1 ) & ~( step - 1 );
+}
+
+
+size_t
+image_memory_pool
+::allocation_size( size_t n ) const
+{
+  if ( n == 0 )
+  {
+    return 0;
+  }
+  return d_->allocator->allocation_size( bucket_size( n ) );
+}
+
+
+size_t
+image_memory_pool
+::alignment() const
+{
+  return d_->allocator->alignment();
+}
+
+
+// ------------------------------------------------------------------
+void*
+image_memory_pool
+::allocate( size_t n )
+{
+  n = allocation_size( n );
+  if ( n == 0 )
+  {
+    return 0;
+  }
+
+  {
+    std::lock_guard< std::mutex > lock( d_->mutex );
+    // prefer the most recently returned buffer, which is most likely cached
+    for ( std::list< std::pair< size_t, void* > >::iterator it = d_->idle.end();
+          it != d_->idle.begin(); )
+    {
+      --it;
+      if ( it->first == n )
+      {
+        void* data = it->second;
+        d_->idle_bytes -= n;
+        d_->idle.erase( it );
+        ++d_->reuse_count;
+        return data;
+      }
+    }
+  }
+
+  return d_->allocator->allocate( n );
+}
+
+
+// ------------------------------------------------------------------
+void
+image_memory_pool
+::deallocate( void* data, size_t n )
+{
+  if ( ! data )
+  {
+    return;
+  }
+  n = allocation_size( n );
+
+  std::lock_guard< std::mutex > lock( d_->mutex );
+  if ( n > d_->max_bytes )
+  {
+    d_->allocator->deallocate( data, n );
+    return;
+  }
+  d_->free_until( d_->max_bytes - n );
+  d_->idle.push_back( std::make_pair( n, data ) );
+  d_->idle_bytes += n;
+}
+
+
+// ------------------------------------------------------------------
+size_t
+image_memory_pool
+::max_bytes() const
+{
+  std::lock_guard< std::mutex > lock( d_->mutex );
+  return d_->max_bytes;
+}
+
+
+void
+image_memory_pool
+::set_max_bytes( size_t n )
+{
+  std::lock_guard< std::mutex > lock( d_->mutex );
+  d_->max_bytes = n;
+  d_->free_until( n );
+}
+
+
+size_t
+image_memory_pool
+::idle_bytes() const
+{
+  std::lock_guard< std::mutex > lock( d_->mutex );
+  return d_->idle_bytes;
+}
+
+
+size_t
+image_memory_pool
+::idle_buffers() const
+{
+  std::lock_guard< std::mutex > lock( d_->mutex );
+  return d_->idle.size();
+}
+
+
+size_t
+image_memory_pool
+::reuse_count() const
+{
+  std::lock_guard< std::mutex > lock( d_->mutex );
+  return d_->reuse_count;
+}
+
+
+void
+image_memory_pool
+::clear()
+{
+  std::lock_guard< std::mutex > lock( d_->mutex );
+  d_->free_until( 0 );
+}
+
+} } // end namespace
@@ -0,0 +1,137 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface for recycling image memory through a pool
+ */
+
+#ifndef VITAL_IMAGE_MEMORY_POOL_H_
+#define VITAL_IMAGE_MEMORY_POOL_H_
+
+#include <vital/types/image_allocator.h>
+
+#include <vital/vital_export.h>
+#include <vital/noncopyable.h>
+
+#include <memory>
+
+namespace kwiver {
+namespace vital {
+
+/// A bounded pool of image buffers for reuse
+/**
+ * Allocating a large image buffer for every video frame causes page
+ * faults and allocator overhead on every frame.  A pool is an allocator
+ * that keeps the blocks released by image memory and hands them out again
+ * for the next allocation of a similar size.  Images allocated from a
+ * pool return their memory to it when the last pointer to the memory is
+ * released.
+ *
+ * Requested sizes are rounded up to one of eight buckets per power of two,
+ * wasting at most an eighth of each buffer, and only buffers from the same
+ * bucket are reused.  At most max_bytes() bytes are kept in idle buffers;
+ * the least recently returned buffers are freed first when the pool is
+ * over this limit.  The buffers themselves come from another allocator.
+ *
+ * Image memory keeps its pool alive until its buffer is returned.  All
+ * methods may be called from any thread.
+ */
+class VITAL_EXPORT image_memory_pool
+  : public image_allocator,
+    private noncopyable
+{
+public:
+  /// Default limit on the bytes kept in idle buffers
+  static const size_t default_max_bytes = 256 * 1024 * 1024;
+
+  /// Create a pool keeping at most \a max_bytes in idle buffers
+  /**
+   * \param max_bytes  the limit on the bytes kept in idle buffers
+   * \param allocator  the allocator of the buffers, or null for the
+   *                   default allocator
+   */
+  static std::shared_ptr< image_memory_pool >
+  create( size_t max_bytes = default_max_bytes,
+          const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+  /// The pool shared by the whole process
+  static std::shared_ptr< image_memory_pool > const& global();
+
+  /// Destructor; frees all idle buffers
+  virtual ~image_memory_pool();
+
+  virtual size_t allocation_size( size_t n ) const;
+
+  /// Allocate a buffer, reusing an idle buffer if possible
+  virtual void* allocate( size_t n );
+
+  /// Keep a buffer for reuse, or free it if the pool is full
+  virtual void deallocate( void* data, size_t n );
+
+  virtual size_t alignment() const;
+
+  /// The maximum number of bytes kept in idle buffers
+  size_t max_bytes() const;
+
+  /// Set the maximum number of bytes kept in idle buffers
+  /**
+   * Idle buffers are freed as needed to satisfy the new limit.
+   */
+  void set_max_bytes( size_t n );
+
+  /// The number of bytes currently held in idle buffers
+  size_t idle_bytes() const;
+
+  /// The number of idle buffers
+  size_t idle_buffers() const;
+
+  /// The number of allocations that reused an idle buffer
+  size_t reuse_count() const;
+
+  /// Free all idle buffers
+  void clear();
+
+  /// The bucket a request of \a n bytes is rounded up to
+  static size_t bucket_size( size_t n );
+
+private:
+  image_memory_pool( size_t max_bytes, const image_allocator_sptr& allocator );
+
+  class priv;
+  const std::unique_ptr< priv > d_;
+};
+
+/// Shared pointer for image_memory_pool
+typedef std::shared_ptr< image_memory_pool > image_memory_pool_sptr;
+
+} } // end namespace
+
+#endif // VITAL_IMAGE_MEMORY_POOL_H_
@@ -0,0 +1,251 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of multi-scale image pyramids
+ */
+
+#include "image_pyramid.h"
+
+#include <vital/util/pixel_kernels.h>
+#include <vital/util/thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <stdint.h>
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+typedef image::byte byte;
+
+
+/// Get row \a j of channel \a k as contiguous bytes
+/**
+ * Rows of images with a width step other than one are gathered into
+ * \a buffer.
+ */
+const byte*
+contiguous_row( const image& img, size_t j, size_t k, std::vector< byte >& buffer )
+{
+  const byte* row = img.first_pixel() + img.h_step() * static_cast< ptrdiff_t >( j ) +
+                                        img.d_step() * static_cast< ptrdiff_t >( k );
+  if ( img.w_step() == 1 )
+  {
+    return row;
+  }
+  buffer.resize( img.width() );
+  const ptrdiff_t w_step = img.w_step();
+  for ( size_t i = 0; i < img.width(); ++i )
+  {
+    buffer[i] = row[w_step * static_cast< ptrdiff_t >( i )];
+  }
+  return &buffer[0];
+}
+
+
+/// The fewest output rows built by one parallel chunk
+/**
+ * Chunks of several rows let the Gaussian filter reuse its row sums.
+ */
+const size_t min_rows_per_chunk = 4;
+
+
+/// Halve \a src into \a dst with a 2x2 box filter
+void
+halve_box( const image& src, image& dst, unsigned max_threads )
+{
+  const size_t width = dst.width();
+  const size_t height = dst.height();
+  parallel_for_work( height * dst.depth(), width, [&] ( size_t begin, size_t end )
+  {
+    std::vector< byte > buffer0, buffer1;
+    for ( size_t r = begin; r < end; ++r )
+    {
+      const size_t k = r / height;
+      const size_t j = r % height;
+      const byte* row0 = contiguous_row( src, 2 * j, k, buffer0 );
+      const byte* row1 = contiguous_row( src, 2 * j + 1, k, buffer1 );
+      downsample_box_2x( row0, row1, width, &dst.unchecked_pixel( 0, j, k ) );
+    }
+  }, max_threads, parallel_work_threshold, min_rows_per_chunk );
+}
+
+
+/// Halve \a src into \a dst with a 5x5 binomial filter
+void
+halve_gaussian( const image& src, image& dst, unsigned max_threads )
+{
+  const size_t width = dst.width();
+  const size_t height = dst.height();
+  const ptrdiff_t last_row = static_cast< ptrdiff_t >( src.height() ) - 1;
+  parallel_for_work( height * dst.depth(), width, [&] ( size_t begin, size_t end )
+  {
+    // horizontal sums of the last five source rows, keyed by channel and row
+    std::vector< uint16_t > sums[5];
+    ptrdiff_t keys[5] = { -1, -1, -1, -1, -1 };
+    for ( unsigned s = 0; s < 5; ++s )
+    {
+      sums[s].resize( width );
+    }
+    std::vector< byte > buffer;
+    const uint16_t* rows[5];
+
+    for ( size_t r = begin; r < end; ++r )
+    {
+      const size_t k = r / height;
+      const ptrdiff_t j = static_cast< ptrdiff_t >( r % height );
+      for ( unsigned t = 0; t < 5; ++t )
+      {
+        // the five rows are consecutive before clamping, so they use
+        // different slots unless they are the same row
+        const ptrdiff_t y = std::min( std::max< ptrdiff_t >( 2 * j - 2 + t, 0 ), last_row );
+        const unsigned s = static_cast< unsigned >( y % 5 );
+        const ptrdiff_t key = static_cast< ptrdiff_t >( k ) * ( last_row + 1 ) + y;
+        if ( keys[s] != key )
+        {
+          gaussian_filter_row_2x( contiguous_row( src, y, k, buffer ), src.width(),
+                                  width, &sums[s][0] );
+          keys[s] = key;
+        }
+        rows[t] = &sums[s][0];
+      }
+      gaussian_filter_column( rows, width, &dst.unchecked_pixel( 0, j, k ) );
+    }
+  }, max_threads, parallel_work_threshold, min_rows_per_chunk );
+}
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+image_pyramid
+::image_pyramid()
+  : filter_( GAUSSIAN_FILTER )
+{
+}
+
+
+image_pyramid
+::image_pyramid( const image& img, unsigned num_levels, filter_type filter,
+                 unsigned max_threads, const image_allocator_sptr& allocator )
+  : filter_( filter )
+{
+  detail::check_pixel_traits( img, image_pixel_traits() );
+  if ( num_levels == 0 )
+  {
+    return;
+  }
+
+  levels_.reserve( num_levels );
+  levels_.push_back( img );
+  while ( levels_.size() < num_levels )
+  {
+    const image& src = levels_.back();
+    if ( src.width() < 2 || src.height() < 2 || src.depth() == 0 )
+    {
+      break;
+    }
+    image dst( src.width() / 2, src.height() / 2, src.depth(), false, allocator );
+    if ( filter_ == BOX_FILTER )
+    {
+      halve_box( src, dst, max_threads );
+    }
+    else
+    {
+      halve_gaussian( src, dst, max_threads );
+    }
+    levels_.push_back( dst );
+  }
+}
+
+
+const image&
+image_pyramid
+::level( size_t i ) const
+{
+  if ( i >= levels_.size() )
+  {
+    throw std::out_of_range( "kwiver::vital::image_pyramid::level()" );
+  }
+  return levels_[i];
+}
+
+
+double
+image_pyramid
+::scale( size_t i )
+{
+  return std::ldexp( 1.0, -static_cast< int >( i ) );
+}
+
+
+// ------------------------------------------------------------------
+pyramid_image_container
+::pyramid_image_container( const image& d )
+  : simple_image_container( d ),
+    requested_levels_( 0 )
+{
+}
+
+
+image_pyramid_sptr
+pyramid_image_container
+::pyramid( unsigned num_levels, image_pyramid::filter_type filter )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+  if ( ! pyramid_ || pyramid_->filter() != filter || requested_levels_ < num_levels )
+  {
+    pyramid_ = std::make_shared< image_pyramid >( data, num_levels, filter );
+    requested_levels_ = num_levels;
+  }
+  return pyramid_;
+}
+
+
+// ------------------------------------------------------------------
+image_pyramid_sptr
+get_image_pyramid( const image_container_sptr& img, unsigned num_levels,
+                   image_pyramid::filter_type filter )
+{
+  auto shared = std::dynamic_pointer_cast< pyramid_image_container >( img );
+  if ( shared )
+  {
+    return shared->pyramid( num_levels, filter );
+  }
+  return std::make_shared< image_pyramid >( img->get_image(), num_levels, filter );
+}
+
+} } // end namespace
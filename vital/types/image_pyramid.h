@@ -0,0 +1,163 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface for multi-scale image pyramids
+ */
+
+#ifndef VITAL_IMAGE_PYRAMID_H_
+#define VITAL_IMAGE_PYRAMID_H_
+
+#include <vital/types/image.h>
+#include <vital/types/image_container.h>
+
+#include <vital/vital_export.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+/// A sequence of images, each half the size of the previous one
+/**
+ * Level zero is the original image, shared rather than copied.  Each
+ * further level halves the width and height of the previous level,
+ * rounding down, with either a 2x2 box filter or a 5x5 binomial
+ * approximation of a Gaussian.  Levels are built in parallel on the
+ * shared thread pool with vectorized kernels, and are stored as planar
+ * images of bytes.
+ *
+ * A pyramid is not modified after it is built, so one pyramid may be
+ * shared between threads and between the algorithms processing a frame;
+ * see pyramid_image_container.
+ */
+class VITAL_EXPORT image_pyramid
+{
+public:
+  /// The filter used to halve each level
+  enum filter_type
+  {
+    BOX_FILTER,
+    GAUSSIAN_FILTER
+  };
+
+  /// Construct an empty pyramid
+  image_pyramid();
+
+  /// Build a pyramid of an image
+  /**
+   * Fewer than \a num_levels levels are built if a level would have no
+   * pixels.
+   *
+   * \param img The image of bytes at level zero
+   * \param num_levels The number of levels, including level zero
+   * \param filter The filter used to halve each level
+   * \param max_threads The maximum number of threads; zero uses all
+   *                    threads of the shared thread pool, and one runs on
+   *                    the calling thread
+   * \param allocator Allocator of the level images, or null for the
+   *                  default allocator
+   *
+   * \throws image_type_mismatch_exception if the pixels of \a img are
+   *         not bytes
+   */
+  image_pyramid( const image& img, unsigned num_levels,
+                 filter_type filter = GAUSSIAN_FILTER, unsigned max_threads = 0,
+                 const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+  /// The number of levels, including the original image
+  size_t num_levels() const { return levels_.size(); }
+
+  /// The filter used to halve each level
+  filter_type filter() const { return filter_; }
+
+  /// The image at level \a i
+  /**
+   * \throws std::out_of_range if there is no such level
+   */
+  const image& level( size_t i ) const;
+
+  /// The scale of level \a i relative to level zero, 2 to the power -i
+  static double scale( size_t i );
+
+private:
+  std::vector< image > levels_;
+  filter_type filter_;
+};
+
+/// Shared pointer for image_pyramid
+typedef std::shared_ptr< image_pyramid > image_pyramid_sptr;
+
+
+// ==================================================================
+/// An image container that builds a pyramid of its image on demand
+/**
+ * Pass one of these to every algorithm processing a frame so that they
+ * share a single pyramid.  The first call to pyramid() builds it and
+ * later calls return the same pyramid, or build a new one if they
+ * request more levels or another filter.
+ */
+class VITAL_EXPORT pyramid_image_container
+  : public simple_image_container
+{
+public:
+  /// Constructor
+  explicit pyramid_image_container( const image& d );
+
+  /// Get a pyramid of at least \a num_levels levels of the image
+  /**
+   * Safe to call from several threads; the pyramid is built once.  The
+   * pyramid may have fewer levels if the image is too small.
+   */
+  image_pyramid_sptr pyramid( unsigned num_levels,
+                              image_pyramid::filter_type filter = image_pyramid::GAUSSIAN_FILTER );
+
+private:
+  std::mutex mutex_;
+  image_pyramid_sptr pyramid_;
+  unsigned requested_levels_;
+};
+
+
+/// Get a pyramid of an image container, shared if the container allows it
+/**
+ * This returns the cached pyramid of a pyramid_image_container, or builds
+ * a new pyramid of any other image container.
+ */
+VITAL_EXPORT image_pyramid_sptr
+get_image_pyramid( const image_container_sptr& img, unsigned num_levels,
+                   image_pyramid::filter_type filter = image_pyramid::GAUSSIAN_FILTER );
+
+} } // end namespace
+
+#endif // VITAL_IMAGE_PYRAMID_H_
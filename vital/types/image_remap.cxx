@@ -0,0 +1,379 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of precomputed image remap tables
+ */
+
+#include "image_remap.h"
+
+#include <vital/util/pixel_kernels.h>
+#include <vital/util/thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+typedef image::byte byte;
+
+/// Fixed point locations further out than this are clamped to it
+const double max_fixed_point = 1 << 30;
+
+/// The number of pixels computed or remapped by one parallel chunk
+const size_t chunk_pixels = 16 * 1024;
+
+
+/// Neighbours of a run of output pixels in a source image
+/**
+ * For each pixel this holds the offset of the top left neighbour, the
+ * offsets to the right and lower neighbours, which are zero at the last
+ * column or row, and whether the location is inside the image at all.
+ */
+struct neighbours
+{
+  void resize( size_t n )
+  {
+    offset.resize( n );
+    right.resize( n );
+    down.resize( n );
+    inside.resize( n );
+  }
+
+  std::vector< ptrdiff_t > offset;
+  std::vector< ptrdiff_t > right;
+  std::vector< ptrdiff_t > down;
+  std::vector< unsigned char > inside;
+};
+
+
+/// Interpolate a run of \a n pixels of channel \a k from fixed point locations
+void
+interpolate_fixed( const image& src, size_t k, const int32_t* xy, size_t n,
+                   neighbours& nb, std::vector< unsigned char >& corners,
+                   std::vector< unsigned char >& fractions, byte* dst )
+{
+  if ( k == 0 )
+  {
+    // the neighbours are the same for every channel
+    const int32_t max_x = static_cast< int32_t >( std::max< size_t >( src.width(), 1 ) - 1 )
+                          << remap_table::fraction_bits;
+    const int32_t max_y = static_cast< int32_t >( std::max< size_t >( src.height(), 1 ) - 1 )
+                          << remap_table::fraction_bits;
+    const int32_t mask = ( 1 << remap_table::fraction_bits ) - 1;
+    nb.resize( n );
+    fractions.resize( 2 * n );
+    for ( size_t i = 0; i < n; ++i )
+    {
+      const int32_t x = xy[2 * i];
+      const int32_t y = xy[2 * i + 1];
+      nb.inside[i] = src.width() > 0 && src.height() > 0 &&
+                     x >= 0 && x <= max_x && y >= 0 && y <= max_y;
+      if ( ! nb.inside[i] )
+      {
+        fractions[2 * i] = fractions[2 * i + 1] = 0;
+        continue;
+      }
+      const ptrdiff_t xi = x >> remap_table::fraction_bits;
+      const ptrdiff_t yi = y >> remap_table::fraction_bits;
+      nb.offset[i] = xi * src.w_step() + yi * src.h_step();
+      nb.right[i] = x < max_x ? src.w_step() : 0;
+      nb.down[i] = y < max_y ? src.h_step() : 0;
+      fractions[2 * i] = static_cast< unsigned char >( x & mask );
+      fractions[2 * i + 1] = static_cast< unsigned char >( y & mask );
+    }
+  }
+
+  const byte* base = src.first_pixel() + src.d_step() * static_cast< ptrdiff_t >( k );
+  corners.resize( 4 * n );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    unsigned char* c = &corners[4 * i];
+    if ( ! nb.inside[i] )
+    {
+      c[0] = c[1] = c[2] = c[3] = 0;
+      continue;
+    }
+    const byte* p = base + nb.offset[i];
+    c[0] = p[0];
+    c[1] = p[nb.right[i]];
+    c[2] = p[nb.down[i]];
+    c[3] = p[nb.down[i] + nb.right[i]];
+  }
+  bilinear_interpolate( &corners[0], &fractions[0], n, dst );
+}
+
+
+/// Interpolate a run of \a n pixels of channel \a k from float locations
+void
+interpolate_float( const image& src, size_t k, const float* xy, size_t n,
+                   neighbours& nb, std::vector< float >& weights, byte* dst )
+{
+  if ( k == 0 )
+  {
+    const float max_x = static_cast< float >( src.width() ) - 1;
+    const float max_y = static_cast< float >( src.height() ) - 1;
+    nb.resize( n );
+    weights.resize( 2 * n );
+    for ( size_t i = 0; i < n; ++i )
+    {
+      const float x = xy[2 * i];
+      const float y = xy[2 * i + 1];
+      // also false for NaN
+      nb.inside[i] = x >= 0 && x <= max_x && y >= 0 && y <= max_y;
+      if ( ! nb.inside[i] )
+      {
+        continue;
+      }
+      const float xf = std::floor( x );
+      const float yf = std::floor( y );
+      nb.offset[i] = static_cast< ptrdiff_t >( xf ) * src.w_step() +
+                     static_cast< ptrdiff_t >( yf ) * src.h_step();
+      nb.right[i] = xf < max_x ? src.w_step() : 0;
+      nb.down[i] = yf < max_y ? src.h_step() : 0;
+      weights[2 * i] = x - xf;
+      weights[2 * i + 1] = y - yf;
+    }
+  }
+
+  const byte* base = src.first_pixel() + src.d_step() * static_cast< ptrdiff_t >( k );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    if ( ! nb.inside[i] )
+    {
+      dst[i] = 0;
+      continue;
+    }
+    const byte* p = base + nb.offset[i];
+    const float ax = weights[2 * i];
+    const float ay = weights[2 * i + 1];
+    const float top = p[0] + ax * ( p[nb.right[i]] - p[0] );
+    const float bottom = p[nb.down[i]] + ax * ( p[nb.down[i] + nb.right[i]] - p[nb.down[i]] );
+    dst[i] = static_cast< byte >( top + ay * ( bottom - top ) + 0.5f );
+  }
+}
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+remap_table
+::remap_table()
+  : width_( 0 ),
+    height_( 0 ),
+    type_( FIXED_POINT_MAP ),
+    tile_size_( 0 )
+{
+}
+
+
+remap_table
+::remap_table( const camera_intrinsics& src, const camera_intrinsics& dst,
+               size_t width, size_t height, map_type type, size_t tile_size,
+               unsigned max_threads )
+  : width_( width ),
+    height_( height ),
+    type_( type ),
+    tile_size_( tile_size )
+{
+  if ( type_ == FIXED_POINT_MAP )
+  {
+    fixed_.resize( 2 * width * height );
+  }
+  else
+  {
+    float_.resize( 2 * width * height );
+  }
+  if ( width == 0 || height == 0 )
+  {
+    return;
+  }
+
+  const size_t tw = tile_width();
+  const double scale = 1 << fraction_bits;
+  parallel_for_work( height, width, [&] ( size_t begin, size_t end )
+  {
+    std::vector< double > pts( 2 * width );
+    for ( size_t j = begin; j < end; ++j )
+    {
+      for ( size_t i = 0; i < width; ++i )
+      {
+        pts[2 * i] = static_cast< double >( i );
+        pts[2 * i + 1] = static_cast< double >( j );
+      }
+      dst.unmap_points( &pts[0], width, &pts[0] );
+      src.map_points( &pts[0], width, &pts[0] );
+
+      // the row is contiguous within each tile
+      for ( size_t x0 = 0; x0 < width; x0 += tw )
+      {
+        const size_t e = entry( x0, j );
+        const size_t n = std::min( tw, width - x0 );
+        const double* p = &pts[2 * x0];
+        if ( type_ == FLOAT_MAP )
+        {
+          std::copy( p, p + 2 * n, &float_[2 * e] );
+          continue;
+        }
+        for ( size_t c = 0; c < 2 * n; ++c )
+        {
+          const double v = p[c] * scale;
+          fixed_[2 * e + c] = std::isfinite( v )
+            ? static_cast< int32_t >( std::floor( std::min( std::max( v, -max_fixed_point ),
+                                                            max_fixed_point ) + 0.5 ) )
+            : static_cast< int32_t >( -max_fixed_point );
+        }
+      }
+    }
+  }, max_threads, chunk_pixels );
+}
+
+
+remap_table
+remap_table
+::undistortion( const camera_intrinsics& K, size_t width, size_t height,
+                map_type type, size_t tile_size, unsigned max_threads )
+{
+  const simple_camera_intrinsics ideal( K.focal_length(), K.principal_point(),
+                                        K.aspect_ratio(), K.skew() );
+  return remap_table( K, ideal, width, height, type, tile_size, max_threads );
+}
+
+
+size_t
+remap_table
+::entry( size_t i, size_t j ) const
+{
+  const size_t tw = tile_width();
+  const size_t th = tile_height();
+  const size_t x0 = i - i % tw;
+  const size_t y0 = j - j % th;
+  // tiles in the last row or column of tiles may be smaller
+  const size_t band_height = std::min( th, height_ - y0 );
+  const size_t run = std::min( tw, width_ - x0 );
+  return y0 * width_ + x0 * band_height + ( j - y0 ) * run + ( i - x0 );
+}
+
+
+vector_2d
+remap_table
+::source( size_t i, size_t j ) const
+{
+  const size_t e = entry( i, j );
+  if ( type_ == FLOAT_MAP )
+  {
+    return vector_2d( float_[2 * e], float_[2 * e + 1] );
+  }
+  const double scale = 1.0 / ( 1 << fraction_bits );
+  return vector_2d( fixed_[2 * e] * scale, fixed_[2 * e + 1] * scale );
+}
+
+
+// ------------------------------------------------------------------
+image
+remap( const image& src, const remap_table& table, unsigned max_threads,
+       const image_allocator_sptr& allocator )
+{
+  detail::check_pixel_traits( src, image_pixel_traits() );
+  const size_t depth = src.depth();
+  const bool interleave = depth > 1 && src.d_step() == 1 &&
+                          src.w_step() == static_cast< ptrdiff_t >( depth );
+  image dst( table.width(), table.height(), depth, interleave, allocator );
+  if ( dst.width() == 0 || dst.height() == 0 || depth == 0 )
+  {
+    return dst;
+  }
+
+  const size_t width = table.width();
+  const size_t height = table.height();
+  const size_t tw = table.tile_width();
+  const size_t th = table.tile_height();
+  const size_t tiles_x = ( width + tw - 1 ) / tw;
+  const size_t tiles_y = ( height + th - 1 ) / th;
+  parallel_for_work( tiles_x * tiles_y, tw * th * depth,
+                     [&] ( size_t begin, size_t end )
+  {
+    neighbours nb;
+    std::vector< unsigned char > corners, fractions;
+    std::vector< float > weights;
+    std::vector< std::vector< byte > > planes( interleave ? depth : 0 );
+    std::vector< const byte* > plane_ptrs( depth );
+
+    for ( size_t t = begin; t < end; ++t )
+    {
+      const size_t x0 = ( t % tiles_x ) * tw;
+      const size_t y0 = ( t / tiles_x ) * th;
+      const size_t n = std::min( tw, width - x0 );
+      const size_t y1 = std::min( y0 + th, height );
+      for ( size_t j = y0; j < y1; ++j )
+      {
+        const size_t e = table.entry( x0, j );
+        const unsigned x = static_cast< unsigned >( x0 );
+        const unsigned y = static_cast< unsigned >( j );
+        for ( size_t k = 0; k < depth; ++k )
+        {
+          byte* out;
+          if ( interleave )
+          {
+            planes[k].resize( n );
+            out = &planes[k][0];
+            plane_ptrs[k] = out;
+          }
+          else
+          {
+            out = &dst.unchecked_pixel( x, y, static_cast< unsigned >( k ) );
+          }
+
+          if ( table.type() == remap_table::FIXED_POINT_MAP )
+          {
+            interpolate_fixed( src, k, table.fixed_point_entries() + 2 * e, n,
+                               nb, corners, fractions, out );
+          }
+          else
+          {
+            interpolate_float( src, k, table.float_entries() + 2 * e, n,
+                               nb, weights, out );
+          }
+        }
+        if ( interleave )
+        {
+          interleave_pixels( &plane_ptrs[0], depth, n, &dst.unchecked_pixel( x, y ) );
+        }
+      }
+    }
+  }, max_threads, chunk_pixels );
+  return dst;
+}
+
+} } // end namespace
@@ -0,0 +1,176 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface for precomputed image remap tables
+ */
+
+#ifndef VITAL_IMAGE_REMAP_H_
+#define VITAL_IMAGE_REMAP_H_
+
+#include <vital/types/camera_intrinsics.h>
+#include <vital/types/image.h>
+
+#include <vital/vital_export.h>
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace kwiver {
+namespace vital {
+
+/// A precomputed source location for every pixel of an output image
+/**
+ * A remap table stores, for each pixel of an output image, the location
+ * in a source image it is interpolated from.  A table built from two
+ * camera_intrinsics maps the image of one camera model to another: each
+ * output pixel is unmapped with the output intrinsics and mapped with
+ * the source intrinsics, using the batch functions of camera_intrinsics.
+ * Lens distortion is removed by mapping to the same intrinsics without
+ * distortion; see undistortion().  Building the table costs as much as
+ * unmapping every pixel once, after which remap() only interpolates.
+ *
+ * Locations are stored either as floats or in fixed point with
+ * fraction_bits fractional bits, which halves the precision of the
+ * interpolation weights but allows the vectorized integer interpolation
+ * kernel.  Entries may also be stored in square tiles rather than rows,
+ * and remap() then fills the output a tile at a time, which reads the
+ * source image with better locality where the mapping bends or rotates
+ * rows, as near the corners of wide angle lenses.
+ *
+ * A table is not modified after it is built, so it may be shared between
+ * threads.
+ */
+class VITAL_EXPORT remap_table
+{
+public:
+  /// The representation of source locations
+  enum map_type
+  {
+    FIXED_POINT_MAP,
+    FLOAT_MAP
+  };
+
+  /// The number of fractional bits of fixed point locations
+  static const unsigned fraction_bits = 5;
+
+  /// Construct an empty table
+  remap_table();
+
+  /// Build a table mapping an image of one camera model to another
+  /**
+   * \param src          intrinsics of the source images
+   * \param dst          intrinsics of the output images
+   * \param width        width of the output images
+   * \param height       height of the output images
+   * \param type         the representation of source locations
+   * \param tile_size    the width and height of tiles of entries, or
+   *                     zero to store entries in rows
+   * \param max_threads  the maximum number of threads, all if zero
+   */
+  remap_table( const camera_intrinsics& src, const camera_intrinsics& dst,
+               size_t width, size_t height,
+               map_type type = FIXED_POINT_MAP, size_t tile_size = 0,
+               unsigned max_threads = 0 );
+
+  /// Build a table removing the lens distortion of a camera
+  /**
+   * The output has the calibration matrix of \a K without distortion and
+   * the same size as the source images.
+   */
+  static remap_table undistortion( const camera_intrinsics& K,
+                                   size_t width, size_t height,
+                                   map_type type = FIXED_POINT_MAP,
+                                   size_t tile_size = 0,
+                                   unsigned max_threads = 0 );
+
+  /// The width of the output images
+  size_t width() const { return width_; }
+  /// The height of the output images
+  size_t height() const { return height_; }
+  /// The representation of source locations
+  map_type type() const { return type_; }
+  /// The width and height of tiles, or zero for rows
+  size_t tile_size() const { return tile_size_; }
+
+  /// The source location of output pixel (\a i, \a j), as stored
+  vector_2d source( size_t i, size_t j ) const;
+
+  /// Width of the tiles used for storage and processing
+  size_t tile_width() const { return tile_size_ ? tile_size_ : width_; }
+  /// Height of the tiles used for storage and processing
+  size_t tile_height() const { return tile_size_ ? tile_size_ : 1; }
+  /// Index of the entry of output pixel (\a i, \a j)
+  /**
+   * The entries of each row of a tile are adjacent, so the entries of
+   * output pixels (\a i, \a j) to (\a i + k, \a j) within a tile are
+   * entry( i, j ) to entry( i, j ) + k.
+   */
+  size_t entry( size_t i, size_t j ) const;
+
+  /// The fixed point x and y of each entry, for FIXED_POINT_MAP
+  const int32_t* fixed_point_entries() const { return fixed_.empty() ? 0 : &fixed_[0]; }
+  /// The x and y of each entry, for FLOAT_MAP
+  const float* float_entries() const { return float_.empty() ? 0 : &float_[0]; }
+
+private:
+  size_t width_;
+  size_t height_;
+  map_type type_;
+  size_t tile_size_;
+  std::vector< int32_t > fixed_;
+  std::vector< float > float_;
+};
+
+
+/// Interpolate an image at the source locations of a remap table
+/**
+ * The output has the size of \a table, the depth of \a src, and the
+ * same interleaved or planar layout as \a src.  Pixels are bilinearly
+ * interpolated, and pixels whose source location is outside \a src are
+ * zero.  Tiles or rows of the table are interpolated in parallel on the
+ * shared thread pool.
+ *
+ * \param src          an image of bytes
+ * \param table        the source location of each output pixel
+ * \param max_threads  the maximum number of threads, all if zero
+ * \param allocator    allocator of the result, or null for the default
+ *
+ * \throws image_type_mismatch_exception if \a src does not hold bytes
+ */
+VITAL_EXPORT image
+remap( const image& src, const remap_table& table, unsigned max_threads = 0,
+       const image_allocator_sptr& allocator = image_allocator_sptr() );
+
+} } // end namespace
+
+#endif // VITAL_IMAGE_REMAP_H_
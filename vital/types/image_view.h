@@ -0,0 +1,344 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Typed, unchecked views of image pixels with iterators
+ */
+
+#ifndef VITAL_IMAGE_VIEW_H_
+#define VITAL_IMAGE_VIEW_H_
+
+#include <vital/types/image.h>
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace kwiver {
+namespace vital {
+
+// ==================================================================
+/// Random access iterator over pixels a fixed step apart
+/**
+ * Iterates along a row, a column or the channels of a pixel.
+ */
+template < typename T >
+class image_step_iterator
+{
+public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef ptrdiff_t difference_type;
+  typedef T* pointer;
+  typedef T& reference;
+
+  image_step_iterator() : p_( 0 ), step_( 1 ) { }
+  image_step_iterator( T* p, ptrdiff_t step ) : p_( p ), step_( step ) { }
+
+  T& operator*() const { return *p_; }
+  T* operator->() const { return p_; }
+  T& operator[]( difference_type n ) const { return p_[n * step_]; }
+
+  image_step_iterator& operator++() { p_ += step_; return *this; }
+  image_step_iterator& operator--() { p_ -= step_; return *this; }
+  image_step_iterator operator++( int ) { image_step_iterator t( *this ); p_ += step_; return t; }
+  image_step_iterator operator--( int ) { image_step_iterator t( *this ); p_ -= step_; return t; }
+  image_step_iterator& operator+=( difference_type n ) { p_ += n * step_; return *this; }
+  image_step_iterator& operator-=( difference_type n ) { p_ -= n * step_; return *this; }
+  image_step_iterator operator+( difference_type n ) const { return image_step_iterator( p_ + n * step_, step_ ); }
+  image_step_iterator operator-( difference_type n ) const { return image_step_iterator( p_ - n * step_, step_ ); }
+  difference_type operator-( image_step_iterator const& o ) const { return ( p_ - o.p_ ) / step_; }
+
+  bool operator==( image_step_iterator const& o ) const { return p_ == o.p_; }
+  bool operator!=( image_step_iterator const& o ) const { return p_ != o.p_; }
+  bool operator<( image_step_iterator const& o ) const { return ( o.p_ - p_ ) / step_ > 0; }
+  bool operator>( image_step_iterator const& o ) const { return o < *this; }
+  bool operator<=( image_step_iterator const& o ) const { return ! ( o < *this ); }
+  bool operator>=( image_step_iterator const& o ) const { return ! ( *this < o ); }
+
+private:
+  T* p_;
+  ptrdiff_t step_;
+};
+
+
+// ==================================================================
+/// Forward iterator over the pixels of one channel, row by row
+template < typename T >
+class image_plane_iterator
+{
+public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef ptrdiff_t difference_type;
+  typedef T* pointer;
+  typedef T& reference;
+
+  image_plane_iterator()
+    : row_( 0 ), p_( 0 ), col_( 0 ), width_( 0 ), w_step_( 0 ), h_step_( 0 ) { }
+
+  image_plane_iterator( T* row, size_t width, ptrdiff_t w_step, ptrdiff_t h_step )
+    : row_( row ), p_( row ), col_( 0 ), width_( width ), w_step_( w_step ), h_step_( h_step ) { }
+
+  T& operator*() const { return *p_; }
+  T* operator->() const { return p_; }
+
+  image_plane_iterator& operator++()
+  {
+    p_ += w_step_;
+    if ( ++col_ == width_ )
+    {
+      col_ = 0;
+      row_ += h_step_;
+      p_ = row_;
+    }
+    return *this;
+  }
+
+  image_plane_iterator operator++( int ) { image_plane_iterator t( *this ); ++*this; return t; }
+
+  bool operator==( image_plane_iterator const& o ) const { return row_ == o.row_ && col_ == o.col_; }
+  bool operator!=( image_plane_iterator const& o ) const { return ! ( *this == o ); }
+
+private:
+  T* row_;
+  T* p_;
+  size_t col_;
+  size_t width_;
+  ptrdiff_t w_step_;
+  ptrdiff_t h_step_;
+};
+
+
+// ==================================================================
+/// A typed view of image pixels without bounds checking
+/**
+ * This is a lightweight, non-owning view of the pixels of an image, with
+ * steps measured in pixels of type \a T.  Unlike image it does not check
+ * indices, and gives direct access to row pointers and iterators, so that
+ * inner loops compile down to pointer arithmetic.
+ *
+ * A view does not keep the image memory alive; the image it was made from
+ * must outlive it.
+ *
+ * Example:
+\code
+kwiver::vital::image_view< kwiver::vital::image::byte > v( img );
+for ( size_t j = 0; j < v.height(); ++j )
+{
+  auto row = v.row( j );
+  for ( size_t i = 0; i < v.width(); ++i )
+  {
+    row[i * v.w_step()] = 255 - row[i * v.w_step()];
+  }
+}
+\endcode
+ */
+template < typename T >
+class image_view
+{
+public:
+  typedef T value_type;
+  typedef image_step_iterator< T > step_iterator;
+  typedef image_plane_iterator< T > plane_iterator;
+
+  /// Construct an empty view
+  image_view()
+    : first_( 0 ), width_( 0 ), height_( 0 ), depth_( 0 ),
+      w_step_( 0 ), h_step_( 0 ), d_step_( 0 ) { }
+
+  /// Construct a view of existing memory
+  /**
+   * \param first Address of the first pixel
+   * \param width Number of pixels wide
+   * \param height Number of pixels high
+   * \param depth Number of channels
+   * \param w_step Pixel increment to get to next pixel column
+   * \param h_step Pixel increment to get to next pixel row
+   * \param d_step Pixel increment to get to next channel
+   */
+  image_view( T* first, size_t width, size_t height, size_t depth,
+              ptrdiff_t w_step, ptrdiff_t h_step, ptrdiff_t d_step )
+    : first_( first ), width_( width ), height_( height ), depth_( depth ),
+      w_step_( w_step ), h_step_( h_step ), d_step_( d_step ) { }
+
+  /// Construct a view of the pixels of an image of pixels of type T
+  /**
+   * \throws image_type_mismatch_exception if \a img does not hold
+   *         pixels of type T
+   */
+  explicit image_view( image& img )
+    : first_( reinterpret_cast< T* >( img.first_pixel() ) ), width_( img.width() ),
+      height_( img.height() ), depth_( img.depth() ), w_step_( img.w_step() ),
+      h_step_( img.h_step() ), d_step_( img.d_step() )
+  {
+    detail::check_pixel_traits( img, image_pixel_traits_of< typename std::remove_cv< T >::type >() );
+  }
+
+  /// Construct a read-only view of the pixels of an image of pixels of type T
+  explicit image_view( const image& img )
+    : first_( reinterpret_cast< T* >( img.first_pixel() ) ), width_( img.width() ),
+      height_( img.height() ), depth_( img.depth() ), w_step_( img.w_step() ),
+      h_step_( img.h_step() ), d_step_( img.d_step() )
+  {
+    detail::check_pixel_traits( img, image_pixel_traits_of< typename std::remove_cv< T >::type >() );
+  }
+
+  size_t width() const { return width_; }
+  size_t height() const { return height_; }
+  size_t depth() const { return depth_; }
+  ptrdiff_t w_step() const { return w_step_; }
+  ptrdiff_t h_step() const { return h_step_; }
+  ptrdiff_t d_step() const { return d_step_; }
+
+  /// Pointer to the first pixel
+  T* first_pixel() const { return first_; }
+
+  /// Access a pixel without bounds checking
+  T& operator()( size_t i, size_t j, size_t k = 0 ) const
+  {
+    return first_[w_step_ * static_cast< ptrdiff_t >( i ) +
+                  h_step_ * static_cast< ptrdiff_t >( j ) +
+                  d_step_ * static_cast< ptrdiff_t >( k )];
+  }
+
+  /// Pointer to the first pixel of row \a j in channel \a k
+  T* row( size_t j, size_t k = 0 ) const
+  {
+    return first_ + h_step_ * static_cast< ptrdiff_t >( j ) +
+                    d_step_ * static_cast< ptrdiff_t >( k );
+  }
+
+  /// Pointer to the first pixel of channel \a k
+  T* plane( size_t k ) const
+  {
+    return first_ + d_step_ * static_cast< ptrdiff_t >( k );
+  }
+
+  /// Iterators along row \a j of channel \a k
+  step_iterator row_begin( size_t j, size_t k = 0 ) const { return step_iterator( row( j, k ), w_step_ ); }
+  step_iterator row_end( size_t j, size_t k = 0 ) const { return row_begin( j, k ) + width_; }
+
+  /// Iterators along column \a i of channel \a k
+  step_iterator column_begin( size_t i, size_t k = 0 ) const
+  {
+    return step_iterator( plane( k ) + w_step_ * static_cast< ptrdiff_t >( i ), h_step_ );
+  }
+  step_iterator column_end( size_t i, size_t k = 0 ) const { return column_begin( i, k ) + height_; }
+
+  /// Iterators over the channels of pixel ( \a i, \a j )
+  step_iterator channel_begin( size_t i, size_t j ) const { return step_iterator( &( *this )( i, j ), d_step_ ); }
+  step_iterator channel_end( size_t i, size_t j ) const { return channel_begin( i, j ) + depth_; }
+
+  /// Iterators over all pixels of channel \a k, row by row
+  plane_iterator plane_begin( size_t k = 0 ) const
+  {
+    return width_ == 0 ? plane_end( k ) : plane_iterator( plane( k ), width_, w_step_, h_step_ );
+  }
+  plane_iterator plane_end( size_t k = 0 ) const
+  {
+    return plane_iterator( row( height_, k ), width_, w_step_, h_step_ );
+  }
+
+private:
+  T* first_;
+  size_t width_;
+  size_t height_;
+  size_t depth_;
+  ptrdiff_t w_step_;
+  ptrdiff_t h_step_;
+  ptrdiff_t d_step_;
+};
+
+
+/// Apply a functor to every pixel of a view in memory order
+/**
+ * \a f is called with a reference to each pixel value.  The traversal
+ * order is chosen from the steps of the view as in transform_image(), so
+ * that contiguous pixels are visited in a plain array loop.
+ *
+ * \param view The pixels to visit
+ * \param f Functor called as f( T& value )
+ * \param max_threads The maximum number of threads; one, the default,
+ *                    runs on the calling thread, and zero uses all threads
+ *                    of the shared thread pool.
+ */
+template < typename T, typename F >
+void
+for_each_pixel( const image_view< T >& view, F f, unsigned max_threads = 1 )
+{
+  const size_t sizes[3] = { view.width(), view.height(), view.depth() };
+  const ptrdiff_t steps[1][3] = { { view.w_step(), view.h_step(), view.d_step() } };
+  const detail::image_loop l = detail::make_image_loop( sizes, steps, 1 );
+  T* const origin = view.first_pixel();
+  const ptrdiff_t s = l.step[0][0];
+
+  detail::for_each_image_run( l, max_threads, [&] ( const ptrdiff_t* off, size_t n )
+  {
+    T* p = origin + off[0];
+    if ( s == 1 )
+    {
+      for ( size_t i = 0; i < n; ++i )
+      {
+        f( p[i] );
+      }
+    }
+    else
+    {
+      for ( size_t i = 0; i < n; ++i, p += s )
+      {
+        f( *p );
+      }
+    }
+  } );
+}
+
+
+/// Apply a functor to every pixel of an image in memory order
+template < typename F >
+void
+for_each_pixel( image& img, F f, unsigned max_threads = 1 )
+{
+  for_each_pixel( image_view< image::byte >( img ), f, max_threads );
+}
+
+
+/// Apply a functor to every pixel of a read-only image in memory order
+template < typename F >
+void
+for_each_pixel( const image& img, F f, unsigned max_threads = 1 )
+{
+  for_each_pixel( image_view< const image::byte >( img ), f, max_threads );
+}
+
+} } // end namespace
+
+#endif // VITAL_IMAGE_VIEW_H_
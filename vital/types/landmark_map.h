@@ -39,6 +39,7 @@
 #include "landmark.h"
 
 #include <vital/vital_types.h>
+#include <vital/util/container_view.h>
 
 #include <map>
 #include <memory>
@@ -54,6 +55,9 @@ public:
   /// typedef for std::map from integer IDs to landmarks
   typedef std::map< landmark_id_t, landmark_sptr > map_landmark_t;
 
+  /// typedef for a read-only view of the landmark map
+  typedef container_view< map_landmark_t > landmarks_view_t;
+
   /// Destructor
   virtual ~landmark_map() VITAL_DEFAULT_DTOR
 
@@ -62,6 +66,13 @@ public:
 
   /// Return a map from integer IDs to landmark shared pointers
   virtual map_landmark_t landmarks() const = 0;
+
+  /// Return a read-only view of the map from integer IDs to landmarks; see container_view
+  virtual landmarks_view_t landmarks_view() const
+  {
+    return landmarks_view_t(
+      std::make_shared< const map_landmark_t >( this->landmarks() ) );
+  }
 };
 
 /// typedef for a landmark shared pointer
@@ -87,6 +98,9 @@ public:
   /// Return a map from integer IDs to landmark shared pointers
   virtual map_landmark_t landmarks() const { return data_; }
 
+  /// Return a read-only view of the map from integer IDs to landmarks
+  virtual landmarks_view_t landmarks_view() const { return landmarks_view_t( data_ ); }
+
 
 protected:
   /// The map from integer IDs to landmark shared pointers
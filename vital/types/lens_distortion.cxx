@@ -0,0 +1,265 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the batch lens distortion functions
+ */
+
+#include "lens_distortion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+/// Number of points distorted or undistorted at once
+const size_t distortion_block_size = 256;
+
+
+/// Distortion of blocks of points with the first N coefficients
+/**
+ * The points are split into arrays of x and y, and each step applies the
+ * scalar functions of lens_distortion<N> across the block in a loop
+ * without branches, which the compiler can vectorize.
+ */
+template < unsigned N >
+class distortion_block
+{
+public:
+  typedef lens_distortion< N > model_t;
+  typedef Eigen::ArrayXd array_t;
+
+  explicit distortion_block( const double* d )
+    : x( distortion_block_size ), y( distortion_block_size ),
+      scale( distortion_block_size ), ox( distortion_block_size ),
+      oy( distortion_block_size )
+  {
+    for ( unsigned k = 0; k < N; ++k )
+    {
+      c[k] = d[k];
+    }
+  }
+
+  /// Load \p m interleaved points into x and y
+  void load( const double* pts, size_t m )
+  {
+    for ( size_t i = 0; i < m; ++i )
+    {
+      x[i] = pts[2 * i];
+      y[i] = pts[2 * i + 1];
+    }
+  }
+
+  /// Compute scale and offset such that distorted = pt * scale + offset
+  void scale_offset( size_t m )
+  {
+    const double* X = x.data();
+    const double* Y = y.data();
+    double* S = scale.data();
+    double* OX = ox.data();
+    double* OY = oy.data();
+    for ( size_t i = 0; i < m; ++i )
+    {
+      model_t::scale_offset( c, X[i], Y[i], S[i], OX[i], OY[i] );
+    }
+  }
+
+  /// Compute the distortion Jacobian, after scale_offset()
+  void jacobian( size_t m, array_t& j00, array_t& j01, array_t& j11 )
+  {
+    const double* X = x.data();
+    const double* Y = y.data();
+    const double* S = scale.data();
+    double* J00 = j00.data();
+    double* J01 = j01.data();
+    double* J11 = j11.data();
+    for ( size_t i = 0; i < m; ++i )
+    {
+      model_t::jacobian( c, X[i], Y[i], S[i], J00[i], J01[i], J11[i] );
+    }
+  }
+
+  array_t x, y, scale, ox, oy;
+  double c[N > 0 ? N : 1];
+};
+
+
+/// Distort \p n interleaved points with the first N coefficients of \p d
+template < unsigned N >
+void
+distort_points_fixed( const double* d,
+                      const double* in, size_t n, double* out )
+{
+  distortion_block< N > blk( d );
+  for ( size_t b = 0; b < n; b += distortion_block_size )
+  {
+    const size_t m = std::min( distortion_block_size, n - b );
+    blk.load( in + 2 * b, m );
+    blk.scale_offset( m );
+    double* dst = out + 2 * b;
+    for ( size_t i = 0; i < m; ++i )
+    {
+      dst[2 * i] = blk.x[i] * blk.scale[i] + blk.ox[i];
+      dst[2 * i + 1] = blk.y[i] * blk.scale[i] + blk.oy[i];
+    }
+  }
+}
+
+
+/// Undistort \p n interleaved points with the first N coefficients of \p d
+/**
+ * This is the Gauss-Newton solver of lens_distortion::undistort()
+ * applied to a block of points at a time.  After each residual check the
+ * converged points are written out and the others are packed to the front
+ * of the block, so later iterations only work on unconverged points.
+ */
+template < unsigned N >
+void
+undistort_points_fixed( const double* d,
+                        const double* in, size_t n, double* out )
+{
+  typedef Eigen::ArrayXd array_t;
+  distortion_block< N > blk( d );
+  array_t tx( distortion_block_size ), ty( distortion_block_size );
+  array_t j00( distortion_block_size ), j01( distortion_block_size ),
+          j11( distortion_block_size );
+  array_t rx( distortion_block_size ), ry( distortion_block_size );
+  std::vector< size_t > index( distortion_block_size );
+
+  for ( size_t b = 0; b < n; b += distortion_block_size )
+  {
+    size_t m = std::min( distortion_block_size, n - b );
+    blk.load( in + 2 * b, m );
+    tx.head( m ) = blk.x.head( m );
+    ty.head( m ) = blk.y.head( m );
+    for ( size_t i = 0; i < m; ++i )
+    {
+      index[i] = b + i;
+    }
+
+    for ( unsigned iter = 0; iter < lens_undistort_max_iterations && m > 0; ++iter )
+    {
+      blk.scale_offset( m );
+      blk.jacobian( m, j00, j01, j11 );
+      rx.head( m ) = blk.x.head( m ) * blk.scale.head( m ) + blk.ox.head( m ) - tx.head( m );
+      ry.head( m ) = blk.y.head( m ) * blk.scale.head( m ) + blk.oy.head( m ) - ty.head( m );
+
+      size_t active = 0;
+      for ( size_t i = 0; i < m; ++i )
+      {
+        if ( std::max( std::abs( rx[i] ), std::abs( ry[i] ) ) < lens_undistort_tolerance )
+        {
+          out[2 * index[i]] = blk.x[i];
+          out[2 * index[i] + 1] = blk.y[i];
+          continue;
+        }
+        // solve the symmetric 2x2 system J * delta = residual
+        const double det = j00[i] * j11[i] - j01[i] * j01[i];
+        blk.x[active] = blk.x[i] - ( j11[i] * rx[i] - j01[i] * ry[i] ) / det;
+        blk.y[active] = blk.y[i] - ( j00[i] * ry[i] - j01[i] * rx[i] ) / det;
+        tx[active] = tx[i];
+        ty[active] = ty[i];
+        index[active] = index[i];
+        ++active;
+      }
+      m = active;
+    }
+
+    // points that did not converge keep their last estimate
+    for ( size_t i = 0; i < m; ++i )
+    {
+      out[2 * index[i]] = blk.x[i];
+      out[2 * index[i] + 1] = blk.y[i];
+    }
+  }
+}
+
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+unsigned
+lens_distortion_terms( size_t num_coeffs )
+{
+  if ( num_coeffs >= 8 ) { return 8; }
+  if ( num_coeffs >= 5 ) { return 5; }
+  if ( num_coeffs >= 4 ) { return 4; }
+  return static_cast< unsigned >( std::min< size_t >( num_coeffs, 2 ) );
+}
+
+
+void
+distort_lens_points( unsigned num_coeffs, const double* coeffs,
+                     const double* norm_pts, size_t n, double* dist_pts )
+{
+  switch ( lens_distortion_terms( num_coeffs ) )
+  {
+    case 8: distort_points_fixed< 8 >( coeffs, norm_pts, n, dist_pts ); break;
+    case 5: distort_points_fixed< 5 >( coeffs, norm_pts, n, dist_pts ); break;
+    case 4: distort_points_fixed< 4 >( coeffs, norm_pts, n, dist_pts ); break;
+    case 2: distort_points_fixed< 2 >( coeffs, norm_pts, n, dist_pts ); break;
+    case 1: distort_points_fixed< 1 >( coeffs, norm_pts, n, dist_pts ); break;
+    default:
+      if ( dist_pts != norm_pts )
+      {
+        std::copy( norm_pts, norm_pts + 2 * n, dist_pts );
+      }
+      break;
+  }
+}
+
+
+void
+undistort_lens_points( unsigned num_coeffs, const double* coeffs,
+                       const double* dist_pts, size_t n, double* norm_pts )
+{
+  switch ( lens_distortion_terms( num_coeffs ) )
+  {
+    case 8: undistort_points_fixed< 8 >( coeffs, dist_pts, n, norm_pts ); break;
+    case 5: undistort_points_fixed< 5 >( coeffs, dist_pts, n, norm_pts ); break;
+    case 4: undistort_points_fixed< 4 >( coeffs, dist_pts, n, norm_pts ); break;
+    case 2: undistort_points_fixed< 2 >( coeffs, dist_pts, n, norm_pts ); break;
+    case 1: undistort_points_fixed< 1 >( coeffs, dist_pts, n, norm_pts ); break;
+    default:
+      if ( norm_pts != dist_pts )
+      {
+        std::copy( dist_pts, dist_pts + 2 * n, norm_pts );
+      }
+      break;
+  }
+}
+
+} } // end namespace
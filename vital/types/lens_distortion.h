@@ -0,0 +1,417 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Compile time lens distortion models and intrinsics using them
+ *
+ * The distortion models use the coefficients k1, k2, p1, p2, k3, k4, k5
+ * and k6 of simple_camera_intrinsics, in that order, where k are radial
+ * and p are tangential terms.  A model with N coefficients uses the first
+ * N of them; simple_camera_intrinsics selects a model at run time from
+ * the number of coefficients it holds, while lens_camera_intrinsics is
+ * fixed to one model at compile time.
+ */
+
+#ifndef VITAL_LENS_DISTORTION_H_
+#define VITAL_LENS_DISTORTION_H_
+
+#include <vital/types/camera_intrinsics.h>
+
+#include <vital/vital_export.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+/// The residual below which iterative undistortion stops
+const double lens_undistort_tolerance = 1e-12;
+/// The maximum number of Gauss-Newton updates of iterative undistortion
+const unsigned lens_undistort_max_iterations = 5;
+
+
+/// Return the number of distortion coefficients in effect
+/**
+ * The coefficients are used in groups: k1, then k2, then p1 and p2, then
+ * k3, then k4, k5 and k6.  Coefficients beyond the last complete group
+ * have no effect, so this is 0, 1, 2, 4, 5 or 8.
+ */
+VITAL_EXPORT unsigned lens_distortion_terms( size_t num_coeffs );
+
+/// Distort many points with the first \a num_coeffs coefficients
+/**
+ * The model is selected once, and blocks of points are distorted with
+ * vectorized arithmetic.
+ *
+ * \param num_coeffs  the number of coefficients in \a coeffs
+ * \param coeffs      the distortion coefficients
+ * \param norm_pts    array of 2 \a n normalized coordinates
+ * \param n           number of points
+ * \param dist_pts    output array of 2 \a n distorted coordinates, which
+ *                    may be the same array as \a norm_pts
+ */
+VITAL_EXPORT void distort_lens_points( unsigned num_coeffs, const double* coeffs,
+                                       const double* norm_pts, size_t n,
+                                       double* dist_pts );
+
+/// Undistort many points with the first \a num_coeffs coefficients
+/**
+ * Each iteration of the Gauss-Newton solver updates a block of points
+ * with vectorized arithmetic, and points leave the block as soon as
+ * their residual is below lens_undistort_tolerance.
+ *
+ * \param num_coeffs  the number of coefficients in \a coeffs
+ * \param coeffs      the distortion coefficients
+ * \param dist_pts    array of 2 \a n distorted coordinates
+ * \param n           number of points
+ * \param norm_pts    output array of 2 \a n normalized coordinates, which
+ *                    may be the same array as \a dist_pts
+ */
+VITAL_EXPORT void undistort_lens_points( unsigned num_coeffs, const double* coeffs,
+                                         const double* dist_pts, size_t n,
+                                         double* norm_pts );
+
+
+// ------------------------------------------------------------------
+/// A lens distortion model with a fixed number of coefficients
+/**
+ * The terms of the model are selected at compile time, so the distortion
+ * of a point has no branches.  The functions are templated on the scalar
+ * type so that they can also be used with automatic differentiation, as
+ * in bundle adjustment cost functions.
+ *
+ * \tparam N  the number of coefficients: 0, 1, 2, 4, 5 or 8
+ */
+template < unsigned N >
+class lens_distortion
+{
+public:
+  static_assert( N == 0 || N == 1 || N == 2 || N == 4 || N == 5 || N == 8,
+                 "lens distortion models have 0, 1, 2, 4, 5 or 8 coefficients" );
+
+  /// The number of coefficients
+  static const unsigned num_coeffs = N;
+
+  /// Compute the scale and offset such that distorted = pt * scale + offset
+  template < typename T, typename C >
+  static void scale_offset( const C* c, const T& x, const T& y,
+                            T& scale, T& offset_x, T& offset_y )
+  {
+    const T r2 = x * x + y * y;
+    if ( N >= 8 )
+    {
+      scale = ( T( 1 ) + r2 * ( c[0] + r2 * ( c[1] + r2 * c[4] ) ) ) /
+              ( T( 1 ) + r2 * ( c[5] + r2 * ( c[6] + r2 * c[7] ) ) );
+    }
+    else if ( N >= 5 )
+    {
+      scale = T( 1 ) + r2 * ( c[0] + r2 * ( c[1] + r2 * c[4] ) );
+    }
+    else if ( N >= 2 )
+    {
+      scale = T( 1 ) + r2 * ( c[0] + r2 * c[1] );
+    }
+    else if ( N >= 1 )
+    {
+      scale = T( 1 ) + r2 * c[0];
+    }
+    else
+    {
+      scale = T( 1 );
+    }
+
+    if ( N >= 4 )
+    {
+      const T two_xy = T( 2 ) * x * y;
+      offset_x = c[2] * two_xy + c[3] * ( r2 + T( 2 ) * x * x );
+      offset_y = c[3] * two_xy + c[2] * ( r2 + T( 2 ) * y * y );
+    }
+    else
+    {
+      offset_x = offset_y = T( 0 );
+    }
+  }
+
+  /// Map normalized image coordinates into distorted coordinates
+  template < typename T, typename C >
+  static Eigen::Matrix< T, 2, 1 > distort( const C* c, const Eigen::Matrix< T, 2, 1 >& pt )
+  {
+    T scale, offset_x, offset_y;
+    scale_offset( c, pt.x(), pt.y(), scale, offset_x, offset_y );
+    return Eigen::Matrix< T, 2, 1 >( pt.x() * scale + offset_x,
+                                     pt.y() * scale + offset_y );
+  }
+
+  /// Compute the Jacobian of distort() with respect to the point
+  /**
+   * \a scale is the scale computed by scale_offset() at the point.  The
+   * Jacobian is symmetric, so only its upper triangle is computed.
+   */
+  template < typename T, typename C >
+  static void jacobian( const C* c, const T& x, const T& y, const T& scale,
+                        T& j00, T& j01, T& j11 )
+  {
+    const T r2 = x * x + y * y;
+
+    // twice the derivative of the scale with respect to r2
+    T ds = T( 0 );
+    if ( N >= 8 )
+    {
+      ds = 2.0 * ( c[0] + r2 * ( 2.0 * c[1] + r2 * 3.0 * c[4] ) -
+                   scale * ( c[5] + r2 * ( 2.0 * c[6] + r2 * 3.0 * c[7] ) ) ) /
+           ( 1.0 + r2 * ( c[5] + r2 * ( c[6] + r2 * c[7] ) ) );
+    }
+    else if ( N >= 5 )
+    {
+      ds = 2.0 * ( c[0] + r2 * ( 2.0 * c[1] + r2 * 3.0 * c[4] ) );
+    }
+    else if ( N >= 2 )
+    {
+      ds = 2.0 * ( c[0] + 2.0 * c[1] * r2 );
+    }
+    else if ( N >= 1 )
+    {
+      ds = T( 2.0 * c[0] );
+    }
+
+    j00 = ds * x * x + scale;
+    j01 = ds * x * y;
+    j11 = ds * y * y + scale;
+    if ( N >= 4 )
+    {
+      j00 += 2.0 * c[2] * y + 6.0 * c[3] * x;
+      j01 += 2.0 * ( c[2] * x + c[3] * y );
+      j11 += 6.0 * c[2] * y + 2.0 * c[3] * x;
+    }
+  }
+
+  /// Compute the Jacobian of distort() with respect to the point
+  static matrix_2x2d jacobian( const double* c, const vector_2d& pt )
+  {
+    double scale, offset_x, offset_y, j00, j01, j11;
+    scale_offset( c, pt.x(), pt.y(), scale, offset_x, offset_y );
+    jacobian( c, pt.x(), pt.y(), scale, j00, j01, j11 );
+
+    matrix_2x2d J;
+    J << j00, j01,
+         j01, j11;
+    return J;
+  }
+
+  /// Unmap distorted normalized coordinates into normalized coordinates
+  /**
+   * This uses Gauss-Newton iterations, stopping when the residual is
+   * below lens_undistort_tolerance.
+   */
+  static vector_2d undistort( const double* c, const vector_2d& dist_pt )
+  {
+    vector_2d pt = dist_pt;
+    if ( N == 0 )
+    {
+      return pt;
+    }
+    for ( unsigned i = 0; i < lens_undistort_max_iterations; ++i )
+    {
+      double scale, offset_x, offset_y;
+      scale_offset( c, pt.x(), pt.y(), scale, offset_x, offset_y );
+      const double rx = pt.x() * scale + offset_x - dist_pt.x();
+      const double ry = pt.y() * scale + offset_y - dist_pt.y();
+      if ( std::max( std::abs( rx ), std::abs( ry ) ) < lens_undistort_tolerance )
+      {
+        break;
+      }
+      // solve the symmetric 2x2 system J * delta = residual
+      double j00, j01, j11;
+      jacobian( c, pt.x(), pt.y(), scale, j00, j01, j11 );
+      const double det = j00 * j11 - j01 * j01;
+      pt.x() -= ( j11 * rx - j01 * ry ) / det;
+      pt.y() -= ( j00 * ry - j01 * rx ) / det;
+    }
+    return pt;
+  }
+
+  /// Distort many points; see distort_lens_points()
+  static void distort_points( const double* c, const double* norm_pts, size_t n,
+                              double* dist_pts )
+  {
+    distort_lens_points( N, c, norm_pts, n, dist_pts );
+  }
+
+  /// Undistort many points; see undistort_lens_points()
+  static void undistort_points( const double* c, const double* dist_pts, size_t n,
+                                double* norm_pts )
+  {
+    undistort_lens_points( N, c, dist_pts, n, norm_pts );
+  }
+};
+
+template < unsigned N >
+const unsigned lens_distortion< N >::num_coeffs;
+
+/// No lens distortion
+typedef lens_distortion< 0 > no_distortion;
+/// Radial distortion with k1 and k2
+typedef lens_distortion< 2 > radial_k2_distortion;
+/// The Brown-Conrady model: radial k1, k2 and k3 and tangential p1 and p2
+typedef lens_distortion< 5 > brown_distortion;
+/// The rational model: the Brown-Conrady model divided by 1 + k4 r^2 + k5 r^4 + k6 r^6
+typedef lens_distortion< 8 > rational_distortion;
+
+
+// ------------------------------------------------------------------
+/// Camera intrinsics with a lens distortion model fixed at compile time
+/**
+ * This implements the camera_intrinsics interface like
+ * simple_camera_intrinsics, but the coefficients are stored in a fixed
+ * size vector and distort() and undistort() are the branch free
+ * functions of \a Model.  Code that knows the model, such as projection
+ * or bundle adjustment for a calibrated camera, can also call the model
+ * directly with get_dist_coeffs().
+ *
+ * \tparam Model  a lens_distortion model, such as brown_distortion
+ */
+template < typename Model >
+class lens_camera_intrinsics
+  : public camera_intrinsics
+{
+public:
+  /// The distortion model
+  typedef Model model_t;
+  /// Fixed size vector of the distortion coefficients
+  typedef Eigen::Matrix< double, Model::num_coeffs, 1, Eigen::DontAlign > coeffs_t;
+
+  /// Default Constructor
+  lens_camera_intrinsics()
+  : focal_length_( 1.0 ),
+    principal_point_( 0.0, 0.0 ),
+    aspect_ratio_( 1.0 ),
+    skew_( 0.0 ),
+    dist_coeffs_( coeffs_t::Zero() )
+  {}
+
+  /// Constructor for camera intrinsics
+  lens_camera_intrinsics( const double focal_length,
+                          const vector_2d& principal_point,
+                          const double aspect_ratio = 1.0,
+                          const double skew = 0.0,
+                          const coeffs_t& dist_coeffs = coeffs_t::Zero() )
+  : focal_length_( focal_length ),
+    principal_point_( principal_point ),
+    aspect_ratio_( aspect_ratio ),
+    skew_( skew ),
+    dist_coeffs_( dist_coeffs )
+  {}
+
+  /// Constructor from the base class
+  /**
+   * Coefficients of \a base beyond those of the model are dropped and
+   * missing coefficients are zero.
+   */
+  explicit lens_camera_intrinsics( const camera_intrinsics& base )
+  : focal_length_( base.focal_length() ),
+    principal_point_( base.principal_point() ),
+    aspect_ratio_( base.aspect_ratio() ),
+    skew_( base.skew() ),
+    dist_coeffs_( coeffs_t::Zero() )
+  {
+    const std::vector< double > dc = base.dist_coeffs();
+    for ( unsigned k = 0; k < Model::num_coeffs && k < dc.size(); ++k )
+    {
+      dist_coeffs_[k] = dc[k];
+    }
+  }
+
+  /// Create a clone of this object
+  virtual camera_intrinsics_sptr clone() const
+  { return camera_intrinsics_sptr( new lens_camera_intrinsics( *this ) ); }
+
+  /// Access the focal length
+  virtual double focal_length() const { return focal_length_; }
+  /// Access the principal point
+  virtual vector_2d principal_point() const { return principal_point_; }
+  /// Access the aspect ratio
+  virtual double aspect_ratio() const { return aspect_ratio_; }
+  /// Access the skew
+  virtual double skew() const { return skew_; }
+  /// Access the distortion coefficients
+  virtual std::vector< double > dist_coeffs() const
+  {
+    return std::vector< double >( dist_coeffs_.data(),
+                                  dist_coeffs_.data() + Model::num_coeffs );
+  }
+
+  /// Access the distortion coefficients
+  const coeffs_t& get_dist_coeffs() const { return dist_coeffs_; }
+  /// Set the focal length
+  void set_focal_length( const double& focal_length ) { focal_length_ = focal_length; }
+  /// Set the principal point
+  void set_principal_point( const vector_2d& pp ) { principal_point_ = pp; }
+  /// Set the aspect_ratio
+  void set_aspect_ratio( const double& aspect_ratio ) { aspect_ratio_ = aspect_ratio; }
+  /// Set the skew
+  void set_skew( const double& skew ) { skew_ = skew; }
+  /// Set the distortion coefficients
+  void set_dist_coeffs( const coeffs_t& d ) { dist_coeffs_ = d; }
+
+  /// Map normalized image coordinates into distorted coordinates
+  virtual vector_2d distort( const vector_2d& norm_pt ) const
+  { return Model::distort( dist_coeffs_.data(), norm_pt ); }
+
+  /// Unmap distorted normalized coordinates into normalized coordinates
+  virtual vector_2d undistort( const vector_2d& dist_pt ) const
+  { return Model::undistort( dist_coeffs_.data(), dist_pt ); }
+
+  /// Map many normalized image points into distorted coordinates
+  virtual void distort_points( const double* norm_pts, size_t n, double* dist_pts ) const
+  { Model::distort_points( dist_coeffs_.data(), norm_pts, n, dist_pts ); }
+
+  /// Unmap many distorted normalized points into normalized coordinates
+  virtual void undistort_points( const double* dist_pts, size_t n, double* norm_pts ) const
+  { Model::undistort_points( dist_coeffs_.data(), dist_pts, n, norm_pts ); }
+
+protected:
+  /// focal length of camera
+  double focal_length_;
+  /// principal point of camera
+  vector_2d principal_point_;
+  /// aspect ratio of camera
+  double aspect_ratio_;
+  /// skew of camera
+  double skew_;
+  /// Lens distortion coefficients
+  coeffs_t dist_coeffs_;
+};
+
+} } // end namespace
+
+#endif // VITAL_LENS_DISTORTION_H_
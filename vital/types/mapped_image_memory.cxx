@@ -0,0 +1,264 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of image memory mapped from a file
+ */
+
+#include "mapped_image_memory.h"
+
+#include <vital/exceptions/io.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+/// The alignment required of the file offset of a mapping
+size_t
+mapping_granularity()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo( &info );
+  return info.dwAllocationGranularity;
+#else
+  return static_cast< size_t >( sysconf( _SC_PAGESIZE ) );
+#endif
+}
+
+
+/// Check that the file holds \a length bytes at \a offset, or set \a length
+/**
+ * A length of zero is set to the rest of the file.
+ */
+void
+check_range( const std::string& filename, size_t file_size,
+             size_t offset, size_t& length )
+{
+  if ( offset > file_size || length > file_size - offset )
+  {
+    std::ostringstream str;
+    str << "file has " << file_size << " bytes, but " << length
+        << " bytes at offset " << offset << " were requested";
+    throw file_not_read_exception( filename, str.str() );
+  }
+  if ( length == 0 )
+  {
+    length = file_size - offset;
+  }
+}
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+mapped_image_memory
+::mapped_image_memory( const std::string& filename, access_mode mode,
+                       size_t offset, size_t length )
+  : filename_( filename ),
+    mode_( mode ),
+    map_base_( 0 ),
+    map_length_( 0 )
+{
+  const size_t granularity = mapping_granularity();
+  const size_t map_offset = offset - offset % granularity;
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+  if ( file == INVALID_HANDLE_VALUE )
+  {
+    throw file_not_found_exception( filename, "could not open the file for mapping" );
+  }
+  LARGE_INTEGER file_size;
+  if ( ! GetFileSizeEx( file, &file_size ) )
+  {
+    CloseHandle( file );
+    throw file_not_read_exception( filename, "could not get the file size" );
+  }
+  try
+  {
+    check_range( filename, static_cast< size_t >( file_size.QuadPart ), offset, length );
+  }
+  catch ( ... )
+  {
+    CloseHandle( file );
+    throw;
+  }
+  if ( length > 0 )
+  {
+    // the view keeps the mapping open after the handles are closed
+    HANDLE mapping = CreateFileMappingA( file, NULL,
+                                         mode == READ_ONLY ? PAGE_READONLY : PAGE_WRITECOPY,
+                                         0, 0, NULL );
+    map_length_ = length + ( offset - map_offset );
+    if ( mapping != NULL )
+    {
+      const unsigned long long o = map_offset;
+      map_base_ = MapViewOfFile( mapping, mode == READ_ONLY ? FILE_MAP_READ : FILE_MAP_COPY,
+                                 static_cast< DWORD >( o >> 32 ),
+                                 static_cast< DWORD >( o & 0xffffffff ), map_length_ );
+      CloseHandle( mapping );
+    }
+    if ( map_base_ == 0 )
+    {
+      CloseHandle( file );
+      throw file_not_read_exception( filename, "could not map the file" );
+    }
+  }
+  CloseHandle( file );
+#else
+  const int fd = open( filename.c_str(), O_RDONLY );
+  if ( fd < 0 )
+  {
+    throw file_not_found_exception( filename, std::strerror( errno ) );
+  }
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 )
+  {
+    const int err = errno;
+    close( fd );
+    throw file_not_read_exception( filename, std::strerror( err ) );
+  }
+  try
+  {
+    check_range( filename, static_cast< size_t >( st.st_size ), offset, length );
+  }
+  catch ( ... )
+  {
+    close( fd );
+    throw;
+  }
+  if ( length > 0 )
+  {
+    // private mappings never write back to the file
+    map_length_ = length + ( offset - map_offset );
+    void* base = mmap( 0, map_length_,
+                       mode == READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE, fd, static_cast< off_t >( map_offset ) );
+    if ( base == MAP_FAILED )
+    {
+      const int err = errno;
+      close( fd );
+      throw file_not_read_exception( filename, std::strerror( err ) );
+    }
+    map_base_ = base;
+  }
+  // the mapping stays valid after the file is closed
+  close( fd );
+#endif
+
+  if ( map_base_ )
+  {
+    data_ = static_cast< char* >( map_base_ ) + ( offset - map_offset );
+  }
+  size_ = length;
+}
+
+
+mapped_image_memory
+::~mapped_image_memory()
+{
+  if ( map_base_ )
+  {
+#if defined(_WIN32)
+    UnmapViewOfFile( map_base_ );
+#else
+    munmap( map_base_, map_length_ );
+#endif
+  }
+  // keep the base class from freeing the mapped memory
+  data_ = 0;
+}
+
+
+void
+mapped_image_memory
+::will_need( size_t offset, size_t n ) const
+{
+#if ! defined(_WIN32) && defined(MADV_WILLNEED)
+  if ( ! map_base_ || offset >= size_ )
+  {
+    return;
+  }
+  n = std::min( n, size_ - offset );
+  // advice ranges must start at a page boundary
+  char* const base = static_cast< char* >( map_base_ );
+  const size_t start = ( static_cast< char* >( data_ ) - base ) + offset;
+  const size_t page_start = start - start % mapping_granularity();
+  madvise( base + page_start, n + ( start - page_start ), MADV_WILLNEED );
+#else
+  (void) offset;
+  (void) n;
+#endif
+}
+
+
+// ------------------------------------------------------------------
+image
+map_raw_image( const std::string& filename,
+               size_t width, size_t height, size_t depth, bool interleave,
+               const image_pixel_traits& pt,
+               mapped_image_memory::access_mode mode, size_t offset )
+{
+  const size_t num_bytes = width * height * depth * pt.num_bytes;
+  if ( num_bytes == 0 )
+  {
+    return image( width, height, depth, interleave, pt );
+  }
+  image_memory_sptr mem = std::make_shared< mapped_image_memory >( filename, mode, offset, num_bytes );
+
+  ptrdiff_t w_step = 1, h_step = width, d_step = width * height;
+  if ( interleave )
+  {
+    d_step = 1;
+    w_step = depth;
+    h_step = depth * width;
+  }
+  return image( mem, mem->data(), width, height, depth, w_step, h_step, d_step, pt );
+}
+
+} } // end namespace
@@ -0,0 +1,160 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface for image memory mapped from a file
+ */
+
+#ifndef VITAL_MAPPED_IMAGE_MEMORY_H_
+#define VITAL_MAPPED_IMAGE_MEMORY_H_
+
+#include <vital/types/image.h>
+
+#include <vital/vital_export.h>
+
+#include <memory>
+#include <string>
+
+namespace kwiver {
+namespace vital {
+
+/// Image memory backed by a memory mapped file of raw pixels
+/**
+ * Mapping a file reserves address space without reading it; pages are
+ * loaded from the file when first accessed and may be dropped again by
+ * the operating system under memory pressure.  This allows images much
+ * larger than the available memory, and many large images at once, to be
+ * opened without an upfront copy.
+ *
+ * The file is mapped either read only, where writing to the pixels is an
+ * error, or copy on write, where written pages become private copies and
+ * the file is never modified.  The mapping is released when the last
+ * image sharing the memory is destroyed.
+ */
+class VITAL_EXPORT mapped_image_memory
+  : public image_memory
+{
+public:
+  /// How the pixels of the file may be accessed
+  enum access_mode
+  {
+    /// The pixels may only be read
+    READ_ONLY,
+    /// The pixels may be written, without modifying the file
+    COPY_ON_WRITE
+  };
+
+  /// Map part of a file
+  /**
+   * \param filename The file to map
+   * \param mode How the pixels may be accessed
+   * \param offset The offset of the mapped bytes in the file; it does
+   *               not need to be a multiple of the page size
+   * \param length The number of bytes to map, or zero for the rest of
+   *               the file
+   *
+   * \throws file_not_found_exception if the file can not be opened
+   * \throws file_not_read_exception if the file is too short or can not
+   *         be mapped
+   */
+  mapped_image_memory( const std::string& filename, access_mode mode = READ_ONLY,
+                       size_t offset = 0, size_t length = 0 );
+
+  /// Destructor, which releases the mapping
+  virtual ~mapped_image_memory();
+
+  /// Hint that the bytes from \a offset to \a offset + \a n will be read soon
+  /**
+   * This asks the operating system to start loading the pages in the
+   * background, for example before processing a tile of a large image.
+   */
+  void will_need( size_t offset, size_t n ) const;
+
+  /// The mapped file
+  const std::string& filename() const { return filename_; }
+
+  /// How the pixels may be accessed
+  access_mode mode() const { return mode_; }
+
+private:
+  // a mapping can not be copied without copying the file
+  mapped_image_memory( const mapped_image_memory& );
+  mapped_image_memory& operator=( const mapped_image_memory& );
+
+  std::string filename_;
+  access_mode mode_;
+  /// Start and length of the mapping, which starts at a page boundary
+  void* map_base_;
+  size_t map_length_;
+};
+
+/// Shared pointer for mapped_image_memory
+typedef std::shared_ptr< mapped_image_memory > mapped_image_memory_sptr;
+
+
+/// Map an image from a file of raw pixels
+/**
+ * The file holds rows of pixels without padding, either with the channels
+ * of each pixel adjacent or with one plane per channel, and with the
+ * native byte order.
+ *
+ * Example:
+\code
+// a 20000 x 20000 RGB orthomosaic, only read where it is accessed
+kwiver::vital::image ortho = kwiver::vital::map_raw_image(
+  "ortho.rgb", 20000, 20000, 3, true );
+kwiver::vital::image tile = ortho.crop( 10000, 5000, 1024, 1024 );
+\endcode
+ *
+ * \param filename The file to map
+ * \param width Number of pixels wide
+ * \param height Number of pixels high
+ * \param depth Number of image channels
+ * \param interleave Set if the channels of each pixel are adjacent
+ * \param pt The type of the pixels
+ * \param mode How the pixels may be accessed
+ * \param offset The offset of the first pixel in the file, for skipping
+ *               a header
+ *
+ * \throws file_not_found_exception if the file can not be opened
+ * \throws file_not_read_exception if the file is too short or can not be
+ *         mapped
+ */
+VITAL_EXPORT image
+map_raw_image( const std::string& filename,
+               size_t width, size_t height, size_t depth, bool interleave,
+               const image_pixel_traits& pt = image_pixel_traits(),
+               mapped_image_memory::access_mode mode = mapped_image_memory::READ_ONLY,
+               size_t offset = 0 );
+
+} } // end namespace
+
+#endif // VITAL_MAPPED_IMAGE_MEMORY_H_
@@ -37,6 +37,7 @@
 #define VITAL_MATCH_SET_H_
 
 #include <vital/vital_config.h>
+#include <vital/util/container_view.h>
 
 #include <vector>
 #include <memory>
@@ -52,6 +53,9 @@ typedef std::pair< unsigned, unsigned > match;
 class match_set
 {
 public:
+  /// typedef for a read-only view of the match vector
+  typedef container_view< std::vector< match > > matches_view_t;
+
   /// Destructor
   virtual ~match_set() VITAL_DEFAULT_DTOR
 
@@ -60,6 +64,13 @@ public:
 
   /// Return a vector of matching indices
   virtual std::vector< match > matches() const = 0;
+
+  /// Return a read-only view of the matching indices; see container_view
+  virtual matches_view_t matches_view() const
+  {
+    return matches_view_t(
+      std::make_shared< const std::vector< match > >( this->matches() ) );
+  }
 };
 
 /// Shared pointer of base match_set type
@@ -85,6 +96,9 @@ public:
   /// Return a vector of match shared pointers
   virtual std::vector< match > matches() const { return data_; }
 
+  /// Return a read-only view of the matching indices
+  virtual matches_view_t matches_view() const { return matches_view_t( data_ ); }
+
 
 protected:
   /// The vector of matches
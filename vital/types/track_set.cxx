@@ -31,13 +31,17 @@
 /**
  * \file
  * \brief Implementation of \link kwiver::vital::track_set track_set \endlink
- *        member functions
+ *        and \link kwiver::vital::indexed_track_set indexed_track_set
+ *        \endlink member functions
  */
 
 #include "track_set.h"
 
 #include <vital/vital_foreach.h>
 
+#include <algorithm>
+#include <unordered_set>
+
 namespace kwiver {
 namespace vital {
 
@@ -46,7 +50,7 @@ size_t
 track_set
 ::size() const
 {
-  return this->tracks().size();
+  return this->tracks_view().size();
 }
 
 
@@ -55,7 +59,17 @@ bool
 track_set
 ::empty() const
 {
-  return this->tracks().empty();
+  return this->tracks_view().empty();
+}
+
+
+/// Return a read-only view of the track shared pointers
+track_set::tracks_view_t
+track_set
+::tracks_view() const
+{
+  return tracks_view_t(
+    std::make_shared< const std::vector<track_sptr> >( this->tracks() ) );
 }
 
 
@@ -65,9 +79,9 @@ track_set
 ::all_frame_ids() const
 {
   std::set<frame_id_t> ids;
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     std::set<frame_id_t> t_ids = t->all_frame_ids();
     ids.insert(t_ids.begin(), t_ids.end());
@@ -83,9 +97,9 @@ track_set
 ::all_track_ids() const
 {
   std::set<track_id_t> ids;
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     ids.insert(t->id());
   }
@@ -100,9 +114,9 @@ track_set
 ::last_frame() const
 {
   frame_id_t last_frame = 0;
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->last_frame() > last_frame )
     {
@@ -120,9 +134,9 @@ track_set
 ::first_frame() const
 {
   frame_id_t first_frame = 0;
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->first_frame() < first_frame )
     {
@@ -139,9 +153,9 @@ track_sptr const
 track_set
 ::get_track(track_id_t tid) const
 {
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->id() == tid )
     {
@@ -158,10 +172,10 @@ track_set
 ::active_tracks(frame_id_t offset)
 {
   frame_id_t frame_number = offset_to_frame(offset);
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
   std::vector<track_sptr> active_tracks;
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->find(frame_number) != t->end() )
     {
@@ -179,10 +193,10 @@ track_set
 ::inactive_tracks(frame_id_t offset)
 {
   frame_id_t frame_number = offset_to_frame(offset);
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
   std::vector<track_sptr> inactive_tracks;
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->find(frame_number) == t->end() )
     {
@@ -200,10 +214,10 @@ track_set
 ::new_tracks(frame_id_t offset)
 {
   frame_id_t frame_number = offset_to_frame(offset);
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
   std::vector<track_sptr> new_tracks;
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->first_frame() == frame_number )
     {
@@ -221,10 +235,10 @@ track_set
 ::terminated_tracks(frame_id_t offset)
 {
   frame_id_t frame_number = offset_to_frame(offset);
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
   std::vector<track_sptr> terminated_tracks;
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->last_frame() == frame_number )
     {
@@ -244,10 +258,10 @@ track_set
   const frame_id_t frame_number1 = offset_to_frame(offset1);
   const frame_id_t frame_number2 = offset_to_frame(offset2);
 
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
   unsigned total_tracks = 0, tracks_both = 0;
 
-  VITAL_FOREACH( track_sptr t , all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     const bool found_on_f1 = t->find(frame_number1) != t->end();
     const bool found_on_f2 = t->find(frame_number2) != t->end();
@@ -271,9 +285,9 @@ track_set
 {
   const frame_id_t last_frame = this->last_frame();
   std::vector<feature_sptr> last_features;
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->last_frame() == last_frame )
     {
@@ -292,9 +306,9 @@ track_set
 {
   const frame_id_t last_frame = this->last_frame();
   std::vector<descriptor_sptr> last_descriptors;
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     if( t->last_frame() == last_frame )
     {
@@ -312,10 +326,10 @@ track_set
 ::frame_features(frame_id_t offset) const
 {
   const frame_id_t frame_number = offset_to_frame(offset);
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
   std::vector<feature_sptr> features;
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     track::history_const_itr itr = t->find(frame_number);
     if( itr != t->end() )
@@ -334,10 +348,10 @@ track_set
 ::frame_descriptors(frame_id_t offset) const
 {
   const frame_id_t frame_number = offset_to_frame(offset);
-  const std::vector<track_sptr> all_tracks = this->tracks();
+  const tracks_view_t all_tracks = this->tracks_view();
   std::vector<descriptor_sptr> descriptors;
 
-  VITAL_FOREACH( track_sptr t, all_tracks)
+  VITAL_FOREACH( track_sptr const& t, all_tracks)
   {
     track::history_const_itr itr = t->find(frame_number);
     if( itr != t->end() )
@@ -369,4 +383,295 @@ track_set
   return frame_number;
 }
 
+
+// ===================================================================
+/// Constructor from a vector of tracks
+indexed_track_set
+::indexed_track_set( const std::vector< track_sptr >& tracks )
+  : first_frame_( 0 ),
+  last_frame_( 0 )
+{
+  data_.reserve( tracks.size() );
+  id_index_.reserve( tracks.size() );
+  VITAL_FOREACH( track_sptr const& t, tracks )
+  {
+    this->insert( t );
+  }
+}
+
+
+/// Return the set of all frame IDs covered by these tracks
+std::set<frame_id_t>
+indexed_track_set
+::all_frame_ids() const
+{
+  std::set<frame_id_t> ids;
+  VITAL_FOREACH( auto const& f, frame_index_ )
+  {
+    ids.insert( ids.end(), f.first );
+  }
+  return ids;
+}
+
+
+/// Return the track in the set with the specified id.
+track_sptr const
+indexed_track_set
+::get_track(track_id_t tid) const
+{
+  auto const itr = id_index_.find(tid);
+  if( itr == id_index_.end() )
+  {
+    return track_sptr();
+  }
+  return itr->second;
+}
+
+
+/// Return all tracks active on a frame.
+track_set_sptr
+indexed_track_set
+::active_tracks(frame_id_t offset)
+{
+  frame_entries const& entries = this->frame_states( offset_to_frame(offset) );
+  std::vector<track_sptr> active_tracks;
+  active_tracks.reserve( entries.size() );
+
+  VITAL_FOREACH( frame_entry const& e, entries )
+  {
+    active_tracks.push_back(e.trk);
+  }
+
+  return track_set_sptr(new simple_track_set(active_tracks));
+}
+
+
+/// Return all tracks inactive on a frame.
+track_set_sptr
+indexed_track_set
+::inactive_tracks(frame_id_t offset)
+{
+  frame_entries const& entries = this->frame_states( offset_to_frame(offset) );
+  std::unordered_set<track const*> active;
+  active.reserve( entries.size() );
+
+  VITAL_FOREACH( frame_entry const& e, entries )
+  {
+    active.insert(e.trk.get());
+  }
+
+  std::vector<track_sptr> inactive_tracks;
+  inactive_tracks.reserve( data_.size() - active.size() );
+  VITAL_FOREACH( track_sptr const& t, data_ )
+  {
+    if( active.find(t.get()) == active.end() )
+    {
+      inactive_tracks.push_back(t);
+    }
+  }
+
+  return track_set_sptr(new simple_track_set(inactive_tracks));
+}
+
+
+/// Return all new tracks on a given frame.
+track_set_sptr
+indexed_track_set
+::new_tracks(frame_id_t offset)
+{
+  frame_entries const& entries = this->frame_states( offset_to_frame(offset) );
+  std::vector<track_sptr> new_tracks;
+
+  VITAL_FOREACH( frame_entry const& e, entries )
+  {
+    if( e.state == 0 )
+    {
+      new_tracks.push_back(e.trk);
+    }
+  }
+
+  return track_set_sptr(new simple_track_set(new_tracks));
+}
+
+
+/// Return all terminated tracks on a given frame.
+track_set_sptr
+indexed_track_set
+::terminated_tracks(frame_id_t offset)
+{
+  frame_entries const& entries = this->frame_states( offset_to_frame(offset) );
+  std::vector<track_sptr> terminated_tracks;
+
+  VITAL_FOREACH( frame_entry const& e, entries )
+  {
+    if( e.state + 1 == e.trk->size() )
+    {
+      terminated_tracks.push_back(e.trk);
+    }
+  }
+
+  return track_set_sptr(new simple_track_set(terminated_tracks));
+}
+
+
+/// Return the percentage of tracks successfully tracked to the next frame.
+double
+indexed_track_set
+::percentage_tracked(frame_id_t offset1, frame_id_t offset2)
+{
+  frame_entries const& entries1 = this->frame_states( offset_to_frame(offset1) );
+  frame_entries const& entries2 = this->frame_states( offset_to_frame(offset2) );
+
+  std::unordered_set<track const*> on_f1;
+  on_f1.reserve( entries1.size() );
+  VITAL_FOREACH( frame_entry const& e, entries1 )
+  {
+    on_f1.insert(e.trk.get());
+  }
+
+  size_t tracks_both = 0;
+  VITAL_FOREACH( frame_entry const& e, entries2 )
+  {
+    tracks_both += on_f1.count(e.trk.get());
+  }
+
+  const size_t total_tracks = on_f1.size() + entries2.size() - tracks_both;
+  if( total_tracks == 0 )
+  {
+    return 0.0;
+  }
+  return static_cast<double>(tracks_both) / total_tracks;
+}
+
+
+/// Return the set of features in tracks on the last frame
+feature_set_sptr
+indexed_track_set
+::last_frame_features() const
+{
+  return this->frame_features( this->last_frame() );
+}
+
+
+/// Return the set of descriptors in tracks on the last frame
+descriptor_set_sptr
+indexed_track_set
+::last_frame_descriptors() const
+{
+  return this->frame_descriptors( this->last_frame() );
+}
+
+
+/// Return the set of features in all tracks for the given frame.
+feature_set_sptr
+indexed_track_set
+::frame_features(frame_id_t offset) const
+{
+  frame_entries const& entries = this->frame_states( offset_to_frame(offset) );
+  std::vector<feature_sptr> features;
+  features.reserve( entries.size() );
+
+  VITAL_FOREACH( frame_entry const& e, entries )
+  {
+    features.push_back(e.get_state().feat);
+  }
+
+  return feature_set_sptr(new simple_feature_set(features));
+}
+
+
+/// Return the set of descriptors in all tracks for the given frame.
+descriptor_set_sptr
+indexed_track_set
+::frame_descriptors(frame_id_t offset) const
+{
+  frame_entries const& entries = this->frame_states( offset_to_frame(offset) );
+  std::vector<descriptor_sptr> descriptors;
+  descriptors.reserve( entries.size() );
+
+  VITAL_FOREACH( frame_entry const& e, entries )
+  {
+    descriptors.push_back(e.get_state().desc);
+  }
+
+  return descriptor_set_sptr(new simple_descriptor_set(descriptors));
+}
+
+
+/// Access the indexed track states on a frame.
+indexed_track_set::frame_entries const&
+indexed_track_set
+::frame_states(frame_id_t frame) const
+{
+  static frame_entries const no_entries;
+
+  auto const itr = frame_index_.find(frame);
+  if( itr == frame_index_.end() )
+  {
+    return no_entries;
+  }
+  return itr->second;
+}
+
+
+/// Add a track to the set and index all of its states.
+void
+indexed_track_set
+::insert(track_sptr const& t)
+{
+  if( ! t )
+  {
+    return;
+  }
+  data_.push_back(t);
+  id_index_.insert( std::make_pair(t->id(), t) );
+  track_ids_.insert(t->id());
+  this->index_states(t, 0);
+}
+
+
+/// Append a track state to a track in this set and index it.
+bool
+indexed_track_set
+::append_state(track_sptr const& t, track::track_state const& state)
+{
+  const size_t first_new = t->size();
+  if( ! t->append(state) )
+  {
+    return false;
+  }
+  this->index_states(t, first_new);
+  return true;
+}
+
+
+/// Add the states of a track starting at the given index to the frame index
+void
+indexed_track_set
+::index_states(track_sptr const& t, size_t first_state)
+{
+  track::history_const_itr itr = t->begin() + first_state;
+  if( itr == t->end() )
+  {
+    return;
+  }
+
+  // states are ordered by frame, so only the end points can move the bounds
+  if( frame_index_.empty() )
+  {
+    first_frame_ = itr->frame_id;
+    last_frame_ = t->last_frame();
+  }
+  else
+  {
+    first_frame_ = std::min( first_frame_, itr->frame_id );
+    last_frame_ = std::max( last_frame_, t->last_frame() );
+  }
+
+  for( size_t s = first_state; itr != t->end(); ++itr, ++s )
+  {
+    frame_index_[itr->frame_id].push_back( frame_entry(t, s) );
+  }
+}
+
 } } // end namespace vital
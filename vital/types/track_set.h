@@ -31,8 +31,9 @@
 /**
  * \file
  * \brief Header file for an abstract \link kwiver::vital::track_set track_set
- *        \endlink and a concrete \link kwiver::vital::simple_track_set
- *        simple_track_set \endlink
+ *        \endlink and concrete \link kwiver::vital::simple_track_set
+ *        simple_track_set \endlink and \link kwiver::vital::indexed_track_set
+ *        indexed_track_set \endlink
  */
 
 #ifndef VITAL_TRACK_SET_H_
@@ -45,10 +46,13 @@
 #include <vital/vital_export.h>
 #include <vital/vital_config.h>
 #include <vital/vital_types.h>
+#include <vital/util/container_view.h>
 
 #include <vector>
 #include <set>
+#include <map>
 #include <memory>
+#include <unordered_map>
 
 namespace kwiver {
 namespace vital {
@@ -61,6 +65,9 @@ typedef std::shared_ptr< track_set > track_set_sptr;
 class VITAL_EXPORT track_set
 {
 public:
+  /// typedef for a read-only view of the track vector
+  typedef container_view< std::vector< track_sptr > > tracks_view_t;
+
   /// Destructor
   virtual ~track_set() VITAL_DEFAULT_DTOR
 
@@ -73,6 +80,9 @@ public:
   /// Return a vector of track shared pointers
   virtual std::vector< track_sptr > tracks() const = 0;
 
+  /// Return a read-only view of the track shared pointers; see container_view
+  virtual tracks_view_t tracks_view() const;
+
   /// Return the set of all frame IDs covered by these tracks
   virtual std::set< frame_id_t > all_frame_ids() const;
 
@@ -220,10 +230,184 @@ public:
   /// Return a vector of track shared pointers
   virtual std::vector< track_sptr > tracks() const { return data_; }
 
+  /// Return a read-only view of the track shared pointers
+  virtual tracks_view_t tracks_view() const { return tracks_view_t( data_ ); }
+
+
+protected:
+  /// The vector of tracks
+  std::vector< track_sptr > data_;
+};
+
+
+/// A track set that maintains a per-frame index of its track states.
+/**
+ * In addition to the vector of tracks, this track set keeps an inverted
+ * index mapping each frame number to the tracks (and the index of the
+ * track state within each track) that are observed on that frame.  Queries
+ * on a single frame, such as active_tracks() or frame_features(), therefore
+ * cost time proportional to the number of tracks on that frame rather than
+ * the total number of tracks in the set.
+ *
+ * Tracks are also indexed by track identifier, and the first and last frame
+ * numbers are cached, so get_track(), first_frame(), last_frame() and the
+ * resolution of relative frame offsets take constant time.
+ *
+ * The indices are built when tracks are added and updated incrementally as
+ * tracks are extended through insert() and append_state().  Tracks held by
+ * this set must not be modified directly (e.g. by calling track::append()
+ * or track::set_id()) since such modifications bypass the indices.
+ */
+class VITAL_EXPORT indexed_track_set :
+  public track_set
+{
+public:
+  /// A reference to a single track state stored in the frame index
+  struct frame_entry
+  {
+    /// Constructor
+    frame_entry( track_sptr const& t, size_t s )
+      : trk( t ),
+      state( s ) { }
+
+    /// Access the referenced track state
+    track::track_state const& get_state() const { return *( trk->begin() + state ); }
+
+    /// The track observed on the frame
+    track_sptr trk;
+    /// The index of the track state on the frame within \a trk
+    size_t state;
+  };
+
+  /// The collection of track states observed on a single frame
+  typedef std::vector< frame_entry > frame_entries;
+
+  /// Default Constructor
+  indexed_track_set()
+    : first_frame_( 0 ),
+    last_frame_( 0 ) { }
+
+  /// Constructor from a vector of tracks
+  explicit indexed_track_set( const std::vector< track_sptr >& tracks );
+
+  /// Return the number of tracks in the set
+  virtual size_t size() const { return data_.size(); }
+
+  /// Return whether or not there are any tracks in the set
+  virtual bool empty() const { return data_.empty(); }
+
+  /// Return a vector of track shared pointers
+  virtual std::vector< track_sptr > tracks() const { return data_; }
+
+  /// Return a read-only view of the track shared pointers
+  virtual tracks_view_t tracks_view() const { return tracks_view_t( data_ ); }
+
+  /// Return the set of all frame IDs covered by these tracks
+  virtual std::set< frame_id_t > all_frame_ids() const;
+
+  /// Return the set of all track IDs in this track set
+  virtual std::set< track_id_t > all_track_ids() const { return track_ids_; }
+
+  /// Return the first (smallest) frame number containing tracks
+  virtual frame_id_t first_frame() const { return first_frame_; }
+
+  /// Return the last (largest) frame number containing tracks
+  virtual frame_id_t last_frame() const { return last_frame_; }
+
+  /// Return the track in this set with the specified id.
+  /**
+   * An empty pointer will be returned if the track cannot be found.  If
+   * several tracks share the same id, the first one added is returned.
+   *
+   * \param [in] tid track identifier for the desired track.
+   *
+   * \returns a pointer to the track with the given id.
+   */
+  virtual track_sptr const get_track( track_id_t tid ) const;
+
+  /// Return all tracks active on a frame.
+  /**
+   * This and the other per-frame track queries below return a
+   * simple_track_set.  The result is not indexed, so building it costs time
+   * proportional to the number of tracks returned rather than to their
+   * lengths.
+   */
+  virtual track_set_sptr active_tracks( frame_id_t offset = -1 );
+
+  /// Return all tracks inactive on a frame.
+  virtual track_set_sptr inactive_tracks( frame_id_t offset = -1 );
+
+  /// Return all tracks newly initialized on the given frame.
+  virtual track_set_sptr new_tracks( frame_id_t offset = -1 );
+
+  /// Return all tracks terminated on the given frame.
+  virtual track_set_sptr terminated_tracks( frame_id_t offset = -1 );
+
+  /// Return the percentage of tracks successfully tracked between the two frames.
+  virtual double percentage_tracked( frame_id_t offset1 = -2, frame_id_t offset2 = -1 );
+
+  /// Return the set of features in tracks on the last frame
+  virtual feature_set_sptr last_frame_features() const;
+
+  /// Return the set of descriptors in tracks on the last frame
+  virtual descriptor_set_sptr last_frame_descriptors() const;
+
+  /// Return the set of features in all tracks for the given frame.
+  virtual feature_set_sptr frame_features( frame_id_t offset = -1 ) const;
+
+  /// Return the set of descriptors in all tracks for the given frame.
+  virtual descriptor_set_sptr frame_descriptors( frame_id_t offset = -1 ) const;
+
+  /// Access the indexed track states on a frame.
+  /**
+   * \param [in] frame the absolute frame number to look up.
+   *
+   * \returns the track states on \a frame, or an empty collection if no
+   *          track is observed on that frame.
+   */
+  frame_entries const& frame_states( frame_id_t frame ) const;
+
+  /// Add a track to the set and index all of its states.
+  /**
+   * \param [in] t the track to add.  Null pointers are ignored.
+   */
+  void insert( track_sptr const& t );
+
+  /// Append a track state to a track in this set and index it.
+  /**
+   * The track state is appended with track::append() and so must have a
+   * frame number greater than the last frame of \a t.  The track must
+   * already belong to this set.
+   *
+   * \param [in] t     the track to extend.
+   * \param [in] state the track state to append to \a t.
+   *
+   * \returns true if successful, false if the state is not correctly ordered
+   */
+  bool append_state( track_sptr const& t, track::track_state const& state );
+
 
 protected:
+  /// Add the states of \a t starting at index \a first_state to the frame index
+  void index_states( track_sptr const& t, size_t first_state );
+
   /// The vector of tracks
   std::vector< track_sptr > data_;
+
+  /// The inverted index from frame number to the track states on that frame
+  std::map< frame_id_t, frame_entries > frame_index_;
+
+  /// The index from track identifier to track
+  std::unordered_map< track_id_t, track_sptr > id_index_;
+
+  /// The ordered set of track identifiers
+  std::set< track_id_t > track_ids_;
+
+  /// The first (smallest) frame number containing tracks
+  frame_id_t first_frame_;
+
+  /// The last (largest) frame number containing tracks
+  frame_id_t last_frame_;
 };
 
 } } // end namespace vital
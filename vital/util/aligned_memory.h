@@ -0,0 +1,116 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Functions for allocating aligned blocks of memory
+ */
+
+#ifndef VITAL_ALIGNED_MEMORY_H_
+#define VITAL_ALIGNED_MEMORY_H_
+
+#include <vital/vital_config.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if VITAL_SYSTEM_WIN_API
+#include <malloc.h>
+#endif
+
+namespace kwiver {
+namespace vital {
+
+/// Default alignment, in bytes, for SIMD friendly buffers (one cache line)
+const std::size_t default_memory_alignment = 64;
+
+/// Allocate a block of memory aligned to a power of two boundary
+/**
+ * Memory allocated with this function must be released with aligned_free().
+ *
+ * \param size       number of bytes to allocate
+ * \param alignment  required alignment in bytes; must be a power of two
+ *                   and a multiple of sizeof(void*)
+ *
+ * \returns a pointer to the allocated memory, or a null pointer if
+ *          \a size is zero.
+ * \throws std::bad_alloc if the allocation fails
+ */
+inline void*
+aligned_malloc( std::size_t size,
+                std::size_t alignment = default_memory_alignment )
+{
+  if ( size == 0 )
+  {
+    return 0;
+  }
+
+#if VITAL_SYSTEM_WIN_API
+  void* ptr = _aligned_malloc( size, alignment );
+#else
+  void* ptr = 0;
+  if ( posix_memalign( &ptr, alignment, size ) != 0 )
+  {
+    ptr = 0;
+  }
+#endif
+
+  if ( ! ptr )
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+
+/// Release memory allocated with aligned_malloc()
+inline void
+aligned_free( void* ptr )
+{
+#if VITAL_SYSTEM_WIN_API
+  _aligned_free( ptr );
+#else
+  std::free( ptr );
+#endif
+}
+
+
+/// Round a size up to the next multiple of \a alignment
+inline std::size_t
+align_size( std::size_t size,
+            std::size_t alignment = default_memory_alignment )
+{
+  return ( size + alignment - 1 ) / alignment * alignment;
+}
+
+} } // end namespace vital
+
+#endif // VITAL_ALIGNED_MEMORY_H_
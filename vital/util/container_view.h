@@ -0,0 +1,106 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Read-only view over a container owned by another object
+ */
+
+#ifndef VITAL_CONTAINER_VIEW_H_
+#define VITAL_CONTAINER_VIEW_H_
+
+#include <memory>
+
+namespace kwiver {
+namespace vital {
+
+/// A lightweight, read-only view of a container.
+/**
+ * A container_view provides const iteration over a container without
+ * copying it.  The view either refers to a container owned elsewhere, in
+ * which case it is only valid as long as the owner is alive and unmodified,
+ * or it shares ownership of a container created for the purpose of the
+ * view.
+ *
+ * The abstract data sets and maps of vital, such as feature_set and
+ * camera_map, return their contents through a virtual \c *_view() method
+ * as well as by copy.  The default implementation returns a view that
+ * owns a copy of the contents.  Derived classes that store the container
+ * override it to return a view of that container, so iterating over
+ * their contents needs no copy or allocation.
+ *
+ * \tparam Container  The type of the viewed container (e.g. a std::vector
+ *                    or std::map).
+ */
+template < typename Container >
+class container_view
+{
+public:
+  typedef Container container_t;
+  typedef typename Container::value_type value_type;
+  typedef typename Container::size_type size_type;
+  typedef typename Container::const_iterator const_iterator;
+  typedef const_iterator iterator;
+
+  /// Construct a view of a container owned elsewhere
+  explicit container_view( Container const& c )
+    : m_container( &c ) { }
+
+  /// Construct a view that shares ownership of a container
+  explicit container_view( std::shared_ptr< Container const > const& c )
+    : m_container( c.get() ),
+      m_owner( c ) { }
+
+  /// Iterator to the first element of the container
+  const_iterator begin() const { return m_container->begin(); }
+
+  /// Iterator past the last element of the container
+  const_iterator end() const { return m_container->end(); }
+
+  /// Return the number of elements in the container
+  size_type size() const { return m_container->size(); }
+
+  /// Return whether or not the container is empty
+  bool empty() const { return m_container->empty(); }
+
+  /// Access an element by index (sequence containers only)
+  value_type const& operator[]( size_type i ) const { return ( *m_container )[i]; }
+
+  /// Access the viewed container
+  Container const& container() const { return *m_container; }
+
+protected:
+  Container const* m_container;
+  std::shared_ptr< Container const > m_owner;
+};
+
+} } // end namespace vital
+
+#endif // VITAL_CONTAINER_VIEW_H_
@@ -0,0 +1,921 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the vectorized distance kernels
+ */
+
+#include "distance_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include <stdint.h>
+
+// The vector kernels use 64-bit lane extracts, so they are x86-64 only
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VITAL_DISTANCE_X86_DISPATCH 1
+#include <immintrin.h>
+#define VITAL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define VITAL_DISTANCE_X86_DISPATCH 0
+#endif
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+// ==================================================================
+// Portable scalar kernels
+
+template < typename T >
+T
+l2_squared_scalar( T const* a, T const* b, size_t n )
+{
+  T sum = 0;
+  for ( size_t i = 0; i < n; ++i )
+  {
+    const T d = a[i] - b[i];
+    sum += d * d;
+  }
+  return sum;
+}
+
+
+template < typename T >
+T
+dot_product_scalar( T const* a, T const* b, size_t n )
+{
+  T sum = 0;
+  for ( size_t i = 0; i < n; ++i )
+  {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+
+/// Count the set bits in a 64-bit word without special instructions
+inline unsigned
+popcount64_swar( uint64_t x )
+{
+  x = x - ( ( x >> 1 ) & 0x5555555555555555ULL );
+  x = ( x & 0x3333333333333333ULL ) + ( ( x >> 2 ) & 0x3333333333333333ULL );
+  x = ( x + ( x >> 4 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast< unsigned >( ( x * 0x0101010101010101ULL ) >> 56 );
+}
+
+
+unsigned
+hamming_distance_scalar( unsigned char const* a, unsigned char const* b, size_t n )
+{
+  unsigned count = 0;
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    uint64_t x, y;
+    std::memcpy( &x, a + i, 8 );
+    std::memcpy( &y, b + i, 8 );
+    count += popcount64_swar( x ^ y );
+  }
+  for ( ; i < n; ++i )
+  {
+    count += popcount64_swar( static_cast< uint64_t >( a[i] ^ b[i] ) );
+  }
+  return count;
+}
+
+
+#if VITAL_DISTANCE_X86_DISPATCH
+
+// ==================================================================
+// SSE4 kernels
+
+VITAL_TARGET("sse4.2")
+inline float
+hsum_sse( __m128 v )
+{
+  v = _mm_hadd_ps( v, v );
+  v = _mm_hadd_ps( v, v );
+  return _mm_cvtss_f32( v );
+}
+
+
+VITAL_TARGET("sse4.2")
+inline double
+hsum_sse( __m128d v )
+{
+  return _mm_cvtsd_f64( _mm_hadd_pd( v, v ) );
+}
+
+
+VITAL_TARGET("sse4.2")
+float
+l2_squared_sse4( float const* a, float const* b, size_t n )
+{
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    const __m128 d0 = _mm_sub_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) );
+    const __m128 d1 = _mm_sub_ps( _mm_loadu_ps( a + i + 4 ), _mm_loadu_ps( b + i + 4 ) );
+    acc0 = _mm_add_ps( acc0, _mm_mul_ps( d0, d0 ) );
+    acc1 = _mm_add_ps( acc1, _mm_mul_ps( d1, d1 ) );
+  }
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    const __m128 d = _mm_sub_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) );
+    acc0 = _mm_add_ps( acc0, _mm_mul_ps( d, d ) );
+  }
+  return hsum_sse( _mm_add_ps( acc0, acc1 ) ) + l2_squared_scalar( a + i, b + i, n - i );
+}
+
+
+VITAL_TARGET("sse4.2")
+double
+l2_squared_sse4( double const* a, double const* b, size_t n )
+{
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  size_t i = 0;
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    const __m128d d0 = _mm_sub_pd( _mm_loadu_pd( a + i ), _mm_loadu_pd( b + i ) );
+    const __m128d d1 = _mm_sub_pd( _mm_loadu_pd( a + i + 2 ), _mm_loadu_pd( b + i + 2 ) );
+    acc0 = _mm_add_pd( acc0, _mm_mul_pd( d0, d0 ) );
+    acc1 = _mm_add_pd( acc1, _mm_mul_pd( d1, d1 ) );
+  }
+  return hsum_sse( _mm_add_pd( acc0, acc1 ) ) + l2_squared_scalar( a + i, b + i, n - i );
+}
+
+
+VITAL_TARGET("sse4.2")
+float
+dot_product_sse4( float const* a, float const* b, size_t n )
+{
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) ) );
+    acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_loadu_ps( a + i + 4 ), _mm_loadu_ps( b + i + 4 ) ) );
+  }
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) ) );
+  }
+  return hsum_sse( _mm_add_ps( acc0, acc1 ) ) + dot_product_scalar( a + i, b + i, n - i );
+}
+
+
+VITAL_TARGET("sse4.2")
+double
+dot_product_sse4( double const* a, double const* b, size_t n )
+{
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  size_t i = 0;
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    acc0 = _mm_add_pd( acc0, _mm_mul_pd( _mm_loadu_pd( a + i ), _mm_loadu_pd( b + i ) ) );
+    acc1 = _mm_add_pd( acc1, _mm_mul_pd( _mm_loadu_pd( a + i + 2 ), _mm_loadu_pd( b + i + 2 ) ) );
+  }
+  return hsum_sse( _mm_add_pd( acc0, acc1 ) ) + dot_product_scalar( a + i, b + i, n - i );
+}
+
+
+VITAL_TARGET("sse4.2,popcnt")
+unsigned
+hamming_distance_sse4( unsigned char const* a, unsigned char const* b, size_t n )
+{
+  unsigned count = 0;
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    uint64_t x, y;
+    std::memcpy( &x, a + i, 8 );
+    std::memcpy( &y, b + i, 8 );
+    count += static_cast< unsigned >( __builtin_popcountll( x ^ y ) );
+  }
+  for ( ; i < n; ++i )
+  {
+    count += static_cast< unsigned >( __builtin_popcount( a[i] ^ b[i] ) );
+  }
+  return count;
+}
+
+
+// ==================================================================
+// AVX2 kernels
+
+VITAL_TARGET("avx2,fma")
+inline float
+hsum_avx( __m256 v )
+{
+  const __m128 s = _mm_add_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+  const __m128 h = _mm_add_ps( s, _mm_movehl_ps( s, s ) );
+  return _mm_cvtss_f32( _mm_add_ss( h, _mm_shuffle_ps( h, h, 1 ) ) );
+}
+
+
+VITAL_TARGET("avx2,fma")
+inline double
+hsum_avx( __m256d v )
+{
+  const __m128d s = _mm_add_pd( _mm256_castpd256_pd128( v ), _mm256_extractf128_pd( v, 1 ) );
+  return _mm_cvtsd_f64( _mm_add_sd( s, _mm_unpackhi_pd( s, s ) ) );
+}
+
+
+VITAL_TARGET("avx2,fma")
+float
+l2_squared_avx2( float const* a, float const* b, size_t n )
+{
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    const __m256 d0 = _mm256_sub_ps( _mm256_loadu_ps( a + i ), _mm256_loadu_ps( b + i ) );
+    const __m256 d1 = _mm256_sub_ps( _mm256_loadu_ps( a + i + 8 ), _mm256_loadu_ps( b + i + 8 ) );
+    acc0 = _mm256_fmadd_ps( d0, d0, acc0 );
+    acc1 = _mm256_fmadd_ps( d1, d1, acc1 );
+  }
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    const __m256 d = _mm256_sub_ps( _mm256_loadu_ps( a + i ), _mm256_loadu_ps( b + i ) );
+    acc0 = _mm256_fmadd_ps( d, d, acc0 );
+  }
+  return hsum_avx( _mm256_add_ps( acc0, acc1 ) ) + l2_squared_scalar( a + i, b + i, n - i );
+}
+
+
+VITAL_TARGET("avx2,fma")
+double
+l2_squared_avx2( double const* a, double const* b, size_t n )
+{
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    const __m256d d0 = _mm256_sub_pd( _mm256_loadu_pd( a + i ), _mm256_loadu_pd( b + i ) );
+    const __m256d d1 = _mm256_sub_pd( _mm256_loadu_pd( a + i + 4 ), _mm256_loadu_pd( b + i + 4 ) );
+    acc0 = _mm256_fmadd_pd( d0, d0, acc0 );
+    acc1 = _mm256_fmadd_pd( d1, d1, acc1 );
+  }
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    const __m256d d = _mm256_sub_pd( _mm256_loadu_pd( a + i ), _mm256_loadu_pd( b + i ) );
+    acc0 = _mm256_fmadd_pd( d, d, acc0 );
+  }
+  return hsum_avx( _mm256_add_pd( acc0, acc1 ) ) + l2_squared_scalar( a + i, b + i, n - i );
+}
+
+
+VITAL_TARGET("avx2,fma")
+float
+dot_product_avx2( float const* a, float const* b, size_t n )
+{
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    acc0 = _mm256_fmadd_ps( _mm256_loadu_ps( a + i ), _mm256_loadu_ps( b + i ), acc0 );
+    acc1 = _mm256_fmadd_ps( _mm256_loadu_ps( a + i + 8 ), _mm256_loadu_ps( b + i + 8 ), acc1 );
+  }
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    acc0 = _mm256_fmadd_ps( _mm256_loadu_ps( a + i ), _mm256_loadu_ps( b + i ), acc0 );
+  }
+  return hsum_avx( _mm256_add_ps( acc0, acc1 ) ) + dot_product_scalar( a + i, b + i, n - i );
+}
+
+
+VITAL_TARGET("avx2,fma")
+double
+dot_product_avx2( double const* a, double const* b, size_t n )
+{
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    acc0 = _mm256_fmadd_pd( _mm256_loadu_pd( a + i ), _mm256_loadu_pd( b + i ), acc0 );
+    acc1 = _mm256_fmadd_pd( _mm256_loadu_pd( a + i + 4 ), _mm256_loadu_pd( b + i + 4 ), acc1 );
+  }
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    acc0 = _mm256_fmadd_pd( _mm256_loadu_pd( a + i ), _mm256_loadu_pd( b + i ), acc0 );
+  }
+  return hsum_avx( _mm256_add_pd( acc0, acc1 ) ) + dot_product_scalar( a + i, b + i, n - i );
+}
+
+
+// Population count of 32 bytes using nibble lookups (Mula's algorithm),
+// summed into four 64-bit lanes
+VITAL_TARGET("avx2,popcnt")
+inline __m256i
+popcount_avx2( __m256i v )
+{
+  const __m256i lookup = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+  const __m256i low_mask = _mm256_set1_epi8( 0x0f );
+  const __m256i lo = _mm256_and_si256( v, low_mask );
+  const __m256i hi = _mm256_and_si256( _mm256_srli_epi16( v, 4 ), low_mask );
+  const __m256i cnt = _mm256_add_epi8( _mm256_shuffle_epi8( lookup, lo ),
+                                       _mm256_shuffle_epi8( lookup, hi ) );
+  return _mm256_sad_epu8( cnt, _mm256_setzero_si256() );
+}
+
+
+VITAL_TARGET("avx2,popcnt")
+unsigned
+hamming_distance_avx2( unsigned char const* a, unsigned char const* b, size_t n )
+{
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for ( ; i + 32 <= n; i += 32 )
+  {
+    const __m256i x = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( a + i ) );
+    const __m256i y = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( b + i ) );
+    acc = _mm256_add_epi64( acc, popcount_avx2( _mm256_xor_si256( x, y ) ) );
+  }
+  const __m128i s = _mm_add_epi64( _mm256_castsi256_si128( acc ),
+                                   _mm256_extracti128_si256( acc, 1 ) );
+  uint64_t count = static_cast< uint64_t >( _mm_cvtsi128_si64( s ) ) +
+                   static_cast< uint64_t >( _mm_extract_epi64( s, 1 ) );
+  return static_cast< unsigned >( count ) + hamming_distance_sse4( a + i, b + i, n - i );
+}
+
+
+// ==================================================================
+// AVX-512 kernels
+
+VITAL_TARGET("avx512f,avx512bw")
+inline __mmask16
+tail_mask16( size_t n )
+{
+  return static_cast< __mmask16 >( ( 1u << n ) - 1 );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+inline __mmask8
+tail_mask8( size_t n )
+{
+  return static_cast< __mmask8 >( ( 1u << n ) - 1 );
+}
+
+
+// Horizontal sums.  The 512-bit casts, unmasked extracts and the
+// _mm512_reduce_add_* helpers pass an undefined register through, which
+// GCC reports as an uninitialized use, so both halves are taken with
+// zero masking.
+VITAL_TARGET("avx512f,avx512bw")
+inline float
+sum_lanes_avx512( __m512 v )
+{
+  const __m512d vd = _mm512_castps_pd( v );
+  const __m256 lo = _mm256_castpd_ps( _mm512_maskz_extractf64x4_pd( 0xff, vd, 0 ) );
+  const __m256 hi = _mm256_castpd_ps( _mm512_maskz_extractf64x4_pd( 0xff, vd, 1 ) );
+  const __m256 s = _mm256_add_ps( lo, hi );
+  const __m128 s4 = _mm_add_ps( _mm256_castps256_ps128( s ), _mm256_extractf128_ps( s, 1 ) );
+  const __m128 s2 = _mm_add_ps( s4, _mm_movehl_ps( s4, s4 ) );
+  return _mm_cvtss_f32( _mm_add_ss( s2, _mm_shuffle_ps( s2, s2, 1 ) ) );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+inline double
+sum_lanes_avx512( __m512d v )
+{
+  const __m256d s = _mm256_add_pd( _mm512_maskz_extractf64x4_pd( 0xff, v, 0 ),
+                                   _mm512_maskz_extractf64x4_pd( 0xff, v, 1 ) );
+  const __m128d s2 = _mm_add_pd( _mm256_castpd256_pd128( s ),
+                                 _mm256_extractf128_pd( s, 1 ) );
+  return _mm_cvtsd_f64( _mm_add_sd( s2, _mm_unpackhi_pd( s2, s2 ) ) );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+inline uint64_t
+sum_lanes_epi64_avx512( __m512i v )
+{
+  const __m256i s = _mm256_add_epi64( _mm512_maskz_extracti64x4_epi64( 0xff, v, 0 ),
+                                      _mm512_maskz_extracti64x4_epi64( 0xff, v, 1 ) );
+  const __m128i s2 = _mm_add_epi64( _mm256_castsi256_si128( s ),
+                                    _mm256_extracti128_si256( s, 1 ) );
+  return static_cast< uint64_t >( _mm_cvtsi128_si64( s2 ) ) +
+         static_cast< uint64_t >( _mm_extract_epi64( s2, 1 ) );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+float
+l2_squared_avx512( float const* a, float const* b, size_t n )
+{
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for ( ; i + 32 <= n; i += 32 )
+  {
+    const __m512 d0 = _mm512_sub_ps( _mm512_loadu_ps( a + i ), _mm512_loadu_ps( b + i ) );
+    const __m512 d1 = _mm512_sub_ps( _mm512_loadu_ps( a + i + 16 ), _mm512_loadu_ps( b + i + 16 ) );
+    acc0 = _mm512_fmadd_ps( d0, d0, acc0 );
+    acc1 = _mm512_fmadd_ps( d1, d1, acc1 );
+  }
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    const __m512 d = _mm512_sub_ps( _mm512_loadu_ps( a + i ), _mm512_loadu_ps( b + i ) );
+    acc0 = _mm512_fmadd_ps( d, d, acc0 );
+  }
+  if ( i < n )
+  {
+    const __mmask16 m = tail_mask16( n - i );
+    const __m512 d = _mm512_sub_ps( _mm512_maskz_loadu_ps( m, a + i ),
+                                    _mm512_maskz_loadu_ps( m, b + i ) );
+    acc1 = _mm512_fmadd_ps( d, d, acc1 );
+  }
+  return sum_lanes_avx512( _mm512_add_ps( acc0, acc1 ) );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+double
+l2_squared_avx512( double const* a, double const* b, size_t n )
+{
+  __m512d acc0 = _mm512_setzero_pd();
+  __m512d acc1 = _mm512_setzero_pd();
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    const __m512d d0 = _mm512_sub_pd( _mm512_loadu_pd( a + i ), _mm512_loadu_pd( b + i ) );
+    const __m512d d1 = _mm512_sub_pd( _mm512_loadu_pd( a + i + 8 ), _mm512_loadu_pd( b + i + 8 ) );
+    acc0 = _mm512_fmadd_pd( d0, d0, acc0 );
+    acc1 = _mm512_fmadd_pd( d1, d1, acc1 );
+  }
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    const __m512d d = _mm512_sub_pd( _mm512_loadu_pd( a + i ), _mm512_loadu_pd( b + i ) );
+    acc0 = _mm512_fmadd_pd( d, d, acc0 );
+  }
+  if ( i < n )
+  {
+    const __mmask8 m = tail_mask8( n - i );
+    const __m512d d = _mm512_sub_pd( _mm512_maskz_loadu_pd( m, a + i ),
+                                     _mm512_maskz_loadu_pd( m, b + i ) );
+    acc1 = _mm512_fmadd_pd( d, d, acc1 );
+  }
+  return sum_lanes_avx512( _mm512_add_pd( acc0, acc1 ) );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+float
+dot_product_avx512( float const* a, float const* b, size_t n )
+{
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for ( ; i + 32 <= n; i += 32 )
+  {
+    acc0 = _mm512_fmadd_ps( _mm512_loadu_ps( a + i ), _mm512_loadu_ps( b + i ), acc0 );
+    acc1 = _mm512_fmadd_ps( _mm512_loadu_ps( a + i + 16 ), _mm512_loadu_ps( b + i + 16 ), acc1 );
+  }
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    acc0 = _mm512_fmadd_ps( _mm512_loadu_ps( a + i ), _mm512_loadu_ps( b + i ), acc0 );
+  }
+  if ( i < n )
+  {
+    const __mmask16 m = tail_mask16( n - i );
+    acc1 = _mm512_fmadd_ps( _mm512_maskz_loadu_ps( m, a + i ),
+                            _mm512_maskz_loadu_ps( m, b + i ), acc1 );
+  }
+  return sum_lanes_avx512( _mm512_add_ps( acc0, acc1 ) );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+double
+dot_product_avx512( double const* a, double const* b, size_t n )
+{
+  __m512d acc0 = _mm512_setzero_pd();
+  __m512d acc1 = _mm512_setzero_pd();
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    acc0 = _mm512_fmadd_pd( _mm512_loadu_pd( a + i ), _mm512_loadu_pd( b + i ), acc0 );
+    acc1 = _mm512_fmadd_pd( _mm512_loadu_pd( a + i + 8 ), _mm512_loadu_pd( b + i + 8 ), acc1 );
+  }
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    acc0 = _mm512_fmadd_pd( _mm512_loadu_pd( a + i ), _mm512_loadu_pd( b + i ), acc0 );
+  }
+  if ( i < n )
+  {
+    const __mmask8 m = tail_mask8( n - i );
+    acc1 = _mm512_fmadd_pd( _mm512_maskz_loadu_pd( m, a + i ),
+                            _mm512_maskz_loadu_pd( m, b + i ), acc1 );
+  }
+  return sum_lanes_avx512( _mm512_add_pd( acc0, acc1 ) );
+}
+
+
+// Population count of 64 bytes using nibble lookups,
+// summed into eight 64-bit lanes
+VITAL_TARGET("avx512f,avx512bw")
+inline __m512i
+popcount_avx512( __m512i v )
+{
+  // bit counts of the nibbles 0 to 15, one byte each, in every 128-bit lane
+  const __m512i lookup = _mm512_set4_epi32( 0x04030302, 0x03020201,
+                                            0x03020201, 0x02010100 );
+  const __m512i low_mask = _mm512_set1_epi8( 0x0f );
+  const __m512i lo = _mm512_and_si512( v, low_mask );
+  const __m512i hi = _mm512_and_si512( _mm512_srli_epi16( v, 4 ), low_mask );
+  const __m512i cnt = _mm512_add_epi8( _mm512_shuffle_epi8( lookup, lo ),
+                                       _mm512_shuffle_epi8( lookup, hi ) );
+  return _mm512_sad_epu8( cnt, _mm512_setzero_si512() );
+}
+
+
+VITAL_TARGET("avx512f,avx512bw")
+unsigned
+hamming_distance_avx512( unsigned char const* a, unsigned char const* b, size_t n )
+{
+  __m512i acc = _mm512_setzero_si512();
+  size_t i = 0;
+  for ( ; i + 64 <= n; i += 64 )
+  {
+    const __m512i x = _mm512_loadu_si512( a + i );
+    const __m512i y = _mm512_loadu_si512( b + i );
+    acc = _mm512_add_epi64( acc, popcount_avx512( _mm512_xor_si512( x, y ) ) );
+  }
+  if ( i < n )
+  {
+    const __mmask64 m = ( n - i == 64 ) ? ~__mmask64( 0 )
+                                        : ( ( __mmask64( 1 ) << ( n - i ) ) - 1 );
+    const __m512i x = _mm512_maskz_loadu_epi8( m, a + i );
+    const __m512i y = _mm512_maskz_loadu_epi8( m, b + i );
+    acc = _mm512_add_epi64( acc, popcount_avx512( _mm512_xor_si512( x, y ) ) );
+  }
+  return static_cast< unsigned >( sum_lanes_epi64_avx512( acc ) );
+}
+
+#endif // VITAL_DISTANCE_X86_DISPATCH
+
+
+// ==================================================================
+// Run time dispatch
+
+/// The set of kernels implementing one instruction set level
+struct kernel_table
+{
+  simd_level_t level;
+  float (*l2_squared_f)( float const*, float const*, size_t );
+  double (*l2_squared_d)( double const*, double const*, size_t );
+  float (*dot_product_f)( float const*, float const*, size_t );
+  double (*dot_product_d)( double const*, double const*, size_t );
+  unsigned (*hamming)( unsigned char const*, unsigned char const*, size_t );
+};
+
+
+kernel_table const scalar_kernels = {
+  SIMD_SCALAR,
+  l2_squared_scalar< float >,
+  l2_squared_scalar< double >,
+  dot_product_scalar< float >,
+  dot_product_scalar< double >,
+  hamming_distance_scalar
+};
+
+#if VITAL_DISTANCE_X86_DISPATCH
+
+kernel_table const sse4_kernels = {
+  SIMD_SSE4,
+  l2_squared_sse4,
+  l2_squared_sse4,
+  dot_product_sse4,
+  dot_product_sse4,
+  hamming_distance_sse4
+};
+
+kernel_table const avx2_kernels = {
+  SIMD_AVX2,
+  l2_squared_avx2,
+  l2_squared_avx2,
+  dot_product_avx2,
+  dot_product_avx2,
+  hamming_distance_avx2
+};
+
+kernel_table const avx512_kernels = {
+  SIMD_AVX512,
+  l2_squared_avx512,
+  l2_squared_avx512,
+  dot_product_avx512,
+  dot_product_avx512,
+  hamming_distance_avx512
+};
+
+#endif
+
+
+simd_level_t
+detect_simd_level()
+{
+#if VITAL_DISTANCE_X86_DISPATCH
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) )
+  {
+    return SIMD_AVX512;
+  }
+  if ( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) &&
+       __builtin_cpu_supports( "popcnt" ) )
+  {
+    return SIMD_AVX2;
+  }
+  if ( __builtin_cpu_supports( "sse4.2" ) && __builtin_cpu_supports( "popcnt" ) )
+  {
+    return SIMD_SSE4;
+  }
+#endif
+  return SIMD_SCALAR;
+}
+
+
+kernel_table const*
+table_for_level( simd_level_t level )
+{
+  switch ( level )
+  {
+#if VITAL_DISTANCE_X86_DISPATCH
+    case SIMD_AVX512: return &avx512_kernels;
+    case SIMD_AVX2:   return &avx2_kernels;
+    case SIMD_SSE4:   return &sse4_kernels;
+#endif
+    default:          return &scalar_kernels;
+  }
+}
+
+
+/// Access the currently selected kernel table pointer
+std::atomic< kernel_table const* >&
+active_table_ptr()
+{
+  static std::atomic< kernel_table const* > table(
+    table_for_level( supported_simd_level() ) );
+  return table;
+}
+
+
+inline kernel_table const&
+kernels()
+{
+  return *active_table_ptr().load( std::memory_order_relaxed );
+}
+
+
+// Number of rows of the second matrix processed per tile in the
+// many-to-many kernels; sized so a tile of 128-element float rows
+// stays in the L2 cache
+const size_t many_to_many_tile_rows = 256;
+
+
+template < typename T, typename R >
+void
+one_to_many( R (*kernel)( T const*, T const*, size_t ),
+             T const* q, T const* rows, size_t num, size_t stride, size_t dim,
+             R* out )
+{
+  for ( size_t j = 0; j < num; ++j, rows += stride )
+  {
+    out[j] = kernel( q, rows, dim );
+  }
+}
+
+
+template < typename T, typename R >
+void
+many_to_many( R (*kernel)( T const*, T const*, size_t ),
+              T const* a, size_t num_a, size_t stride_a,
+              T const* b, size_t num_b, size_t stride_b,
+              size_t dim, R* out )
+{
+  for ( size_t j0 = 0; j0 < num_b; j0 += many_to_many_tile_rows )
+  {
+    const size_t tile = std::min( many_to_many_tile_rows, num_b - j0 );
+    T const* b_tile = b + j0 * stride_b;
+    for ( size_t i = 0; i < num_a; ++i )
+    {
+      one_to_many( kernel, a + i * stride_a, b_tile, tile, stride_b, dim,
+                   out + i * num_b + j0 );
+    }
+  }
+}
+
+} // end anonymous namespace
+
+
+// ==================================================================
+char const*
+simd_level_name( simd_level_t level )
+{
+  switch ( level )
+  {
+    case SIMD_SCALAR: return "scalar";
+    case SIMD_SSE4:   return "SSE4";
+    case SIMD_AVX2:   return "AVX2";
+    case SIMD_AVX512: return "AVX-512";
+  }
+  return "unknown";
+}
+
+
+simd_level_t
+supported_simd_level()
+{
+  static const simd_level_t level = detect_simd_level();
+  return level;
+}
+
+
+simd_level_t
+distance_simd_level()
+{
+  return kernels().level;
+}
+
+
+simd_level_t
+set_distance_simd_level( simd_level_t level )
+{
+  level = std::min( level, supported_simd_level() );
+  active_table_ptr().store( table_for_level( level ) );
+  return level;
+}
+
+
+// ------------------------------------------------------------------
+float
+l2_squared( float const* a, float const* b, size_t n )
+{
+  return kernels().l2_squared_f( a, b, n );
+}
+
+
+double
+l2_squared( double const* a, double const* b, size_t n )
+{
+  return kernels().l2_squared_d( a, b, n );
+}
+
+
+float
+dot_product( float const* a, float const* b, size_t n )
+{
+  return kernels().dot_product_f( a, b, n );
+}
+
+
+double
+dot_product( double const* a, double const* b, size_t n )
+{
+  return kernels().dot_product_d( a, b, n );
+}
+
+
+unsigned
+hamming_distance( unsigned char const* a, unsigned char const* b, size_t n )
+{
+  return kernels().hamming( a, b, n );
+}
+
+
+// ------------------------------------------------------------------
+void
+l2_squared_one_to_many( float const* q, float const* rows,
+                        size_t num, size_t stride, size_t dim, float* out )
+{
+  one_to_many( kernels().l2_squared_f, q, rows, num, stride, dim, out );
+}
+
+
+void
+l2_squared_one_to_many( double const* q, double const* rows,
+                        size_t num, size_t stride, size_t dim, double* out )
+{
+  one_to_many( kernels().l2_squared_d, q, rows, num, stride, dim, out );
+}
+
+
+void
+dot_product_one_to_many( float const* q, float const* rows,
+                         size_t num, size_t stride, size_t dim, float* out )
+{
+  one_to_many( kernels().dot_product_f, q, rows, num, stride, dim, out );
+}
+
+
+void
+dot_product_one_to_many( double const* q, double const* rows,
+                         size_t num, size_t stride, size_t dim, double* out )
+{
+  one_to_many( kernels().dot_product_d, q, rows, num, stride, dim, out );
+}
+
+
+void
+hamming_distance_one_to_many( unsigned char const* q, unsigned char const* rows,
+                              size_t num, size_t stride, size_t dim, unsigned* out )
+{
+  one_to_many( kernels().hamming, q, rows, num, stride, dim, out );
+}
+
+
+// ------------------------------------------------------------------
+void
+l2_squared_many_to_many( float const* a, size_t num_a, size_t stride_a,
+                         float const* b, size_t num_b, size_t stride_b,
+                         size_t dim, float* out )
+{
+  many_to_many( kernels().l2_squared_f, a, num_a, stride_a,
+                b, num_b, stride_b, dim, out );
+}
+
+
+void
+l2_squared_many_to_many( double const* a, size_t num_a, size_t stride_a,
+                         double const* b, size_t num_b, size_t stride_b,
+                         size_t dim, double* out )
+{
+  many_to_many( kernels().l2_squared_d, a, num_a, stride_a,
+                b, num_b, stride_b, dim, out );
+}
+
+
+void
+dot_product_many_to_many( float const* a, size_t num_a, size_t stride_a,
+                          float const* b, size_t num_b, size_t stride_b,
+                          size_t dim, float* out )
+{
+  many_to_many( kernels().dot_product_f, a, num_a, stride_a,
+                b, num_b, stride_b, dim, out );
+}
+
+
+void
+dot_product_many_to_many( double const* a, size_t num_a, size_t stride_a,
+                          double const* b, size_t num_b, size_t stride_b,
+                          size_t dim, double* out )
+{
+  many_to_many( kernels().dot_product_d, a, num_a, stride_a,
+                b, num_b, stride_b, dim, out );
+}
+
+
+void
+hamming_distance_many_to_many( unsigned char const* a, size_t num_a, size_t stride_a,
+                               unsigned char const* b, size_t num_b, size_t stride_b,
+                               size_t dim, unsigned* out )
+{
+  many_to_many( kernels().hamming, a, num_a, stride_a,
+                b, num_b, stride_b, dim, out );
+}
+
+} } // end namespace vital
@@ -0,0 +1,183 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Vectorized distance kernels for descriptor matching
+ *
+ * These functions compute squared Euclidean distances, dot products and
+ * Hamming distances between arrays of descriptor elements.  On x86
+ * processors the implementation is selected at run time from SSE4, AVX2
+ * and AVX-512 versions according to the instruction sets supported by the
+ * CPU, with a portable scalar version used everywhere else.
+ *
+ * The block variants operate on row-major matrices with an arbitrary row
+ * stride, such as the storage of a descriptor_matrix_set.
+ */
+
+#ifndef VITAL_DISTANCE_KERNELS_H_
+#define VITAL_DISTANCE_KERNELS_H_
+
+#include <vital/vital_export.h>
+
+#include <cstddef>
+
+namespace kwiver {
+namespace vital {
+
+/// Instruction set levels used by the distance kernels
+enum simd_level_t
+{
+  SIMD_SCALAR = 0,
+  SIMD_SSE4,
+  SIMD_AVX2,
+  SIMD_AVX512
+};
+
+/// Return the name of an instruction set level
+VITAL_EXPORT char const* simd_level_name( simd_level_t level );
+
+/// Return the highest instruction set level supported by this CPU
+VITAL_EXPORT simd_level_t supported_simd_level();
+
+/// Return the instruction set level currently used by the distance kernels
+VITAL_EXPORT simd_level_t distance_simd_level();
+
+/// Select the instruction set level used by the distance kernels
+/**
+ * By default the highest supported level is used.  This is mainly useful
+ * for testing and benchmarking against the scalar implementation.
+ *
+ * \param level  the requested level; it is reduced to supported_simd_level()
+ *               if the CPU does not support it.
+ *
+ * \returns the level actually selected
+ */
+VITAL_EXPORT simd_level_t set_distance_simd_level( simd_level_t level );
+
+
+// ------------------------------------------------------------------
+/// Squared Euclidean distance between two arrays of \a n elements
+VITAL_EXPORT float l2_squared( float const* a, float const* b, size_t n );
+
+/// Squared Euclidean distance between two arrays of \a n elements
+VITAL_EXPORT double l2_squared( double const* a, double const* b, size_t n );
+
+/// Dot product of two arrays of \a n elements
+VITAL_EXPORT float dot_product( float const* a, float const* b, size_t n );
+
+/// Dot product of two arrays of \a n elements
+VITAL_EXPORT double dot_product( double const* a, double const* b, size_t n );
+
+/// Number of differing bits between two binary descriptors of \a n bytes
+VITAL_EXPORT unsigned hamming_distance( unsigned char const* a,
+                                        unsigned char const* b, size_t n );
+
+
+// ------------------------------------------------------------------
+/// Squared Euclidean distances from one array to each row of a matrix
+/**
+ * \param q       the query array of \a dim elements
+ * \param rows    the first row of a row-major matrix of \a num rows
+ * \param num     the number of rows
+ * \param stride  the number of elements between the starts of rows
+ * \param dim     the number of elements compared in each row
+ * \param out     output array of \a num distances
+ */
+VITAL_EXPORT void l2_squared_one_to_many( float const* q, float const* rows,
+                                          size_t num, size_t stride, size_t dim,
+                                          float* out );
+
+/// Squared Euclidean distances from one array to each row of a matrix
+VITAL_EXPORT void l2_squared_one_to_many( double const* q, double const* rows,
+                                          size_t num, size_t stride, size_t dim,
+                                          double* out );
+
+/// Dot products of one array with each row of a matrix
+VITAL_EXPORT void dot_product_one_to_many( float const* q, float const* rows,
+                                           size_t num, size_t stride, size_t dim,
+                                           float* out );
+
+/// Dot products of one array with each row of a matrix
+VITAL_EXPORT void dot_product_one_to_many( double const* q, double const* rows,
+                                           size_t num, size_t stride, size_t dim,
+                                           double* out );
+
+/// Hamming distances from one binary descriptor to each row of a matrix
+VITAL_EXPORT void hamming_distance_one_to_many( unsigned char const* q,
+                                                unsigned char const* rows,
+                                                size_t num, size_t stride, size_t dim,
+                                                unsigned* out );
+
+
+// ------------------------------------------------------------------
+/// Squared Euclidean distances between all rows of two matrices
+/**
+ * The computation is tiled so that blocks of \a b are reused from cache
+ * across the rows of \a a.
+ *
+ * \param a         the first row of a row-major matrix of \a num_a rows
+ * \param num_a     the number of rows in \a a
+ * \param stride_a  the number of elements between the starts of rows of \a a
+ * \param b         the first row of a row-major matrix of \a num_b rows
+ * \param num_b     the number of rows in \a b
+ * \param stride_b  the number of elements between the starts of rows of \a b
+ * \param dim       the number of elements compared in each row
+ * \param out       output row-major matrix of \a num_a by \a num_b distances
+ */
+VITAL_EXPORT void l2_squared_many_to_many( float const* a, size_t num_a, size_t stride_a,
+                                           float const* b, size_t num_b, size_t stride_b,
+                                           size_t dim, float* out );
+
+/// Squared Euclidean distances between all rows of two matrices
+VITAL_EXPORT void l2_squared_many_to_many( double const* a, size_t num_a, size_t stride_a,
+                                           double const* b, size_t num_b, size_t stride_b,
+                                           size_t dim, double* out );
+
+/// Dot products between all rows of two matrices
+VITAL_EXPORT void dot_product_many_to_many( float const* a, size_t num_a, size_t stride_a,
+                                            float const* b, size_t num_b, size_t stride_b,
+                                            size_t dim, float* out );
+
+/// Dot products between all rows of two matrices
+VITAL_EXPORT void dot_product_many_to_many( double const* a, size_t num_a, size_t stride_a,
+                                            double const* b, size_t num_b, size_t stride_b,
+                                            size_t dim, double* out );
+
+/// Hamming distances between all rows of two binary descriptor matrices
+VITAL_EXPORT void hamming_distance_many_to_many( unsigned char const* a,
+                                                 size_t num_a, size_t stride_a,
+                                                 unsigned char const* b,
+                                                 size_t num_b, size_t stride_b,
+                                                 size_t dim, unsigned* out );
+
+} } // end namespace vital
+
+#endif // VITAL_DISTANCE_KERNELS_H_
@@ -0,0 +1,145 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the repeated video frame detector
+ */
+
+#include "duplicate_frame_detector.h"
+
+#include <algorithm>
+
+namespace kwiver {
+namespace vital {
+
+duplicate_frame_detector
+::duplicate_frame_detector( size_t history, bool verify )
+  : history_( std::max< size_t >( history, 1 ) ),
+    verify_( verify ),
+    frozen_count_( 0 ),
+    last_hash_( 0 )
+{
+}
+
+
+bool
+duplicate_frame_detector
+::is_duplicate( const image& img )
+{
+  const uint64_t hash = hash_content( img );
+  last_hash_ = hash;
+
+  for ( size_t i = 0; i < recent_.size(); ++i )
+  {
+    if ( recent_[i].hash != hash ||
+         ( verify_ && ! equal_content( recent_[i].frame, img ) ) )
+    {
+      continue;
+    }
+    frozen_count_ = ( i == 0 ) ? frozen_count_ + 1 : 0;
+    if ( i != 0 )
+    {
+      // the repeated frame is now the most recent
+      entry e = recent_[i];
+      recent_.erase( recent_.begin() + i );
+      recent_.push_front( e );
+    }
+    return true;
+  }
+
+  entry e;
+  e.hash = hash;
+  if ( verify_ )
+  {
+    // keep a deep copy, since the source may reuse the frame buffer;
+    // the memory of the frame about to be forgotten is reused if it fits
+    if ( recent_.size() >= history_ )
+    {
+      e.frame = recent_.back().frame;
+    }
+    e.frame.copy_from( img );
+  }
+  recent_.push_front( e );
+  if ( recent_.size() > history_ )
+  {
+    recent_.pop_back();
+  }
+  frozen_count_ = 0;
+  return false;
+}
+
+
+bool
+duplicate_frame_detector
+::is_duplicate( const image_container_sptr& img )
+{
+  if ( ! img )
+  {
+    return false;
+  }
+  return is_duplicate( img->get_image() );
+}
+
+
+void
+duplicate_frame_detector
+::reset()
+{
+  recent_.clear();
+  frozen_count_ = 0;
+  last_hash_ = 0;
+}
+
+
+// ------------------------------------------------------------------
+bool
+next_distinct_frame( algo::video_input& video, duplicate_frame_detector& detector,
+                     timestamp& ts, uint32_t timeout, size_t* num_skipped )
+{
+  size_t skipped = 0;
+  bool found = false;
+  while ( video.next_frame( ts, timeout ) )
+  {
+    if ( ! detector.is_duplicate( video.frame_image() ) )
+    {
+      found = true;
+      break;
+    }
+    ++skipped;
+  }
+  if ( num_skipped )
+  {
+    *num_skipped = skipped;
+  }
+  return found;
+}
+
+} } // end namespace
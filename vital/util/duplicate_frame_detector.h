@@ -0,0 +1,151 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface for detecting repeated video frames
+ */
+
+#ifndef VITAL_DUPLICATE_FRAME_DETECTOR_H_
+#define VITAL_DUPLICATE_FRAME_DETECTOR_H_
+
+#include <vital/algo/video_input.h>
+#include <vital/types/image_container.h>
+#include <vital/types/timestamp.h>
+
+#include <vital/vital_export.h>
+
+#include <deque>
+
+#include <stdint.h>
+
+namespace kwiver {
+namespace vital {
+
+// ------------------------------------------------------------------
+/// Detect video frames that repeat recent frames
+/**
+ * Live feeds and some encoders repeat frames, for example when a camera
+ * freezes or a stream stalls.  This class fingerprints each frame with
+ * hash_content() and flags frames whose content equals one of the last
+ * few distinct frames, so that processing can be skipped for them.
+ *
+ * Frames are recognized by their 64-bit hash alone unless verification
+ * is enabled, in which case the recent frames are kept and compared with
+ * equal_content() when the hashes match.  Verification keeps a deep copy
+ * of each recent frame, so a video source or frame pool that reuses its
+ * buffers cannot change the remembered frames.
+ *
+ * Example:
+\code
+kwiver::vital::duplicate_frame_detector frozen;
+kwiver::vital::timestamp ts;
+while ( video->next_frame( ts ) )
+{
+  if ( frozen.is_duplicate( video->frame_image() ) )
+  {
+    continue;
+  }
+  process( video->frame_image() );
+}
+\endcode
+ */
+class VITAL_EXPORT duplicate_frame_detector
+{
+public:
+  /// Constructor
+  /**
+   * \param history The number of recent distinct frames compared with
+   *                each frame; one detects only repeats of the previous
+   *                frame
+   * \param verify Compare the pixels of frames with matching hashes
+   */
+  explicit duplicate_frame_detector( size_t history = 1, bool verify = false );
+
+  /// Check whether a frame repeats a recent frame, and remember it
+  bool is_duplicate( const image& img );
+
+  /// Check whether a frame repeats a recent frame, and remember it
+  /**
+   * A null image is never a duplicate and is not remembered.
+   */
+  bool is_duplicate( const image_container_sptr& img );
+
+  /// The number of consecutive checked frames that repeated the one before
+  /**
+   * This is zero after a new frame, and counts the length of a run of
+   * frozen frames otherwise.
+   */
+  size_t frozen_count() const { return frozen_count_; }
+
+  /// The hash of the last checked frame
+  uint64_t last_hash() const { return last_hash_; }
+
+  /// Forget all frames
+  void reset();
+
+private:
+  struct entry
+  {
+    uint64_t hash;
+    image frame;
+  };
+
+  size_t history_;
+  bool verify_;
+  /// Recent distinct frames, most recent first
+  std::deque< entry > recent_;
+  size_t frozen_count_;
+  uint64_t last_hash_;
+};
+
+
+/// Advance a video to the next frame that is not a duplicate
+/**
+ * This calls video.next_frame() until the detector does not flag the
+ * frame image, so that frame_image() and frame_metadata() return the new
+ * frame.  Metadata of skipped frames is not returned.
+ *
+ * \param video The video to read
+ * \param detector The detector checking each frame
+ * \param[out] ts Time stamp of the new frame
+ * \param timeout Timeout passed to each call of next_frame()
+ * \param[out] num_skipped If not null, set to the number of duplicate
+ *                         frames skipped
+ *
+ * \return \b true if a frame was found, \b false at the end of video.
+ */
+VITAL_EXPORT bool
+next_distinct_frame( algo::video_input& video, duplicate_frame_detector& detector,
+                     timestamp& ts, uint32_t timeout = 0, size_t* num_skipped = 0 );
+
+} } // end namespace
+
+#endif // VITAL_DUPLICATE_FRAME_DETECTOR_H_
@@ -0,0 +1,588 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the vectorized pixel kernels
+ */
+
+#include "pixel_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define VITAL_PIXEL_X86_DISPATCH 1
+#include <immintrin.h>
+#define VITAL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define VITAL_PIXEL_X86_DISPATCH 0
+#endif
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+// ==================================================================
+// Portable scalar kernels
+
+void
+interleave_scalar( unsigned char const* const* planes, size_t depth,
+                   size_t begin, size_t n, unsigned char* dst )
+{
+  for ( size_t i = begin; i < n; ++i )
+  {
+    for ( size_t d = 0; d < depth; ++d )
+    {
+      dst[i * depth + d] = planes[d][i];
+    }
+  }
+}
+
+
+void
+deinterleave_scalar( unsigned char const* src, size_t depth,
+                     size_t begin, size_t n, unsigned char* const* planes )
+{
+  for ( size_t i = begin; i < n; ++i )
+  {
+    for ( size_t d = 0; d < depth; ++d )
+    {
+      planes[d][i] = src[i * depth + d];
+    }
+  }
+}
+
+
+void
+rgb_to_gray_scalar( unsigned char const* r, unsigned char const* g,
+                    unsigned char const* b, size_t begin, size_t n,
+                    unsigned char* dst )
+{
+  for ( size_t i = begin; i < n; ++i )
+  {
+    const unsigned sum = 77u * r[i] + 150u * g[i] + 29u * b[i];
+    dst[i] = static_cast< unsigned char >( ( sum + 128 ) >> 8 );
+  }
+}
+
+
+void
+downsample_box_scalar( unsigned char const* row0, unsigned char const* row1,
+                       size_t begin, size_t n, unsigned char* dst )
+{
+  for ( size_t i = begin; i < n; ++i )
+  {
+    const unsigned sum = row0[2 * i] + row0[2 * i + 1] + row1[2 * i] + row1[2 * i + 1];
+    dst[i] = static_cast< unsigned char >( ( sum + 2 ) >> 2 );
+  }
+}
+
+
+void
+gaussian_filter_row_scalar( unsigned char const* src, size_t width,
+                            size_t begin, size_t n, uint16_t* dst )
+{
+  const ptrdiff_t last = static_cast< ptrdiff_t >( width ) - 1;
+  auto at = [=] ( ptrdiff_t x ) -> unsigned
+  {
+    return src[std::min( std::max< ptrdiff_t >( x, 0 ), last )];
+  };
+  for ( size_t i = begin; i < n; ++i )
+  {
+    const ptrdiff_t c = 2 * static_cast< ptrdiff_t >( i );
+    dst[i] = static_cast< uint16_t >( at( c - 2 ) + 4 * ( at( c - 1 ) + at( c + 1 ) ) +
+                                      6 * at( c ) + at( c + 2 ) );
+  }
+}
+
+
+void
+gaussian_filter_column_scalar( uint16_t const* const* rows,
+                               size_t begin, size_t n, unsigned char* dst )
+{
+  for ( size_t i = begin; i < n; ++i )
+  {
+    const unsigned sum = rows[0][i] + rows[4][i] + 4 * ( rows[1][i] + rows[3][i] ) +
+                         6 * rows[2][i];
+    dst[i] = static_cast< unsigned char >( ( sum + 128 ) >> 8 );
+  }
+}
+
+
+void
+bilinear_interpolate_scalar( unsigned char const* corners,
+                             unsigned char const* fractions,
+                             size_t begin, size_t n, unsigned char* dst )
+{
+  for ( size_t i = begin; i < n; ++i )
+  {
+    unsigned char const* c = corners + 4 * i;
+    const unsigned fx = fractions[2 * i];
+    const unsigned fy = fractions[2 * i + 1];
+    const unsigned top = ( 32 - fx ) * c[0] + fx * c[1];
+    const unsigned bottom = ( 32 - fx ) * c[2] + fx * c[3];
+    dst[i] = static_cast< unsigned char >( ( ( 32 - fy ) * top + fy * bottom + 512 ) >> 10 );
+  }
+}
+
+
+#if VITAL_PIXEL_X86_DISPATCH
+
+// ==================================================================
+// SSE4 kernels
+//
+// Sixteen pixels of D channels occupy D registers in either layout.
+// Each output register is the bitwise or of D byte shuffles, one of
+// each input register, with the bytes coming from other registers
+// zeroed by a mask entry with the high bit set.
+
+/// Byte shuffle masks for converting sixteen pixels of D channels
+template < int D >
+struct shuffle_masks
+{
+  shuffle_masks()
+  {
+    for ( int a = 0; a < D; ++a )
+    {
+      for ( int b = 0; b < D; ++b )
+      {
+        for ( int p = 0; p < 16; ++p )
+        {
+          // plane a, pixel p is taken from interleaved register b
+          const int g = D * p + a;
+          split[a][b][p] = ( g / 16 == b ) ? static_cast< char >( g % 16 ) : char( 0x80 );
+
+          // interleaved register a, byte p is taken from plane b
+          const int h = 16 * a + p;
+          merge[a][b][p] = ( h % D == b ) ? static_cast< char >( h / D ) : char( 0x80 );
+        }
+      }
+    }
+  }
+
+  char split[D][D][16];
+  char merge[D][D][16];
+};
+
+
+template < int D >
+shuffle_masks< D > const&
+masks()
+{
+  static const shuffle_masks< D > m;
+  return m;
+}
+
+
+template < int D >
+VITAL_TARGET("sse4.2")
+void
+interleave_sse4( unsigned char const* const* planes, size_t n, unsigned char* dst )
+{
+  shuffle_masks< D > const& m = masks< D >();
+  __m128i mask[D][D];
+  for ( int a = 0; a < D; ++a )
+  {
+    for ( int b = 0; b < D; ++b )
+    {
+      mask[a][b] = _mm_loadu_si128( reinterpret_cast< __m128i const* >( m.merge[a][b] ) );
+    }
+  }
+
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    __m128i in[D];
+    for ( int b = 0; b < D; ++b )
+    {
+      in[b] = _mm_loadu_si128( reinterpret_cast< __m128i const* >( planes[b] + i ) );
+    }
+    for ( int a = 0; a < D; ++a )
+    {
+      __m128i out = _mm_shuffle_epi8( in[0], mask[a][0] );
+      for ( int b = 1; b < D; ++b )
+      {
+        out = _mm_or_si128( out, _mm_shuffle_epi8( in[b], mask[a][b] ) );
+      }
+      _mm_storeu_si128( reinterpret_cast< __m128i* >( dst + D * i + 16 * a ), out );
+    }
+  }
+  interleave_scalar( planes, D, i, n, dst );
+}
+
+
+template < int D >
+VITAL_TARGET("sse4.2")
+void
+deinterleave_sse4( unsigned char const* src, size_t n, unsigned char* const* planes )
+{
+  shuffle_masks< D > const& m = masks< D >();
+  __m128i mask[D][D];
+  for ( int a = 0; a < D; ++a )
+  {
+    for ( int b = 0; b < D; ++b )
+    {
+      mask[a][b] = _mm_loadu_si128( reinterpret_cast< __m128i const* >( m.split[a][b] ) );
+    }
+  }
+
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    __m128i in[D];
+    for ( int b = 0; b < D; ++b )
+    {
+      in[b] = _mm_loadu_si128( reinterpret_cast< __m128i const* >( src + D * i + 16 * b ) );
+    }
+    for ( int a = 0; a < D; ++a )
+    {
+      __m128i out = _mm_shuffle_epi8( in[0], mask[a][0] );
+      for ( int b = 1; b < D; ++b )
+      {
+        out = _mm_or_si128( out, _mm_shuffle_epi8( in[b], mask[a][b] ) );
+      }
+      _mm_storeu_si128( reinterpret_cast< __m128i* >( planes[a] + i ), out );
+    }
+  }
+  deinterleave_scalar( src, D, i, n, planes );
+}
+
+
+
+VITAL_TARGET("sse4.2")
+void
+rgb_to_gray_sse4( unsigned char const* r, unsigned char const* g,
+                  unsigned char const* b, size_t n, unsigned char* dst )
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wr = _mm_set1_epi16( 77 );
+  const __m128i wg = _mm_set1_epi16( 150 );
+  const __m128i wb = _mm_set1_epi16( 29 );
+  const __m128i half = _mm_set1_epi16( 128 );
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    const __m128i vr = _mm_loadu_si128( reinterpret_cast< __m128i const* >( r + i ) );
+    const __m128i vg = _mm_loadu_si128( reinterpret_cast< __m128i const* >( g + i ) );
+    const __m128i vb = _mm_loadu_si128( reinterpret_cast< __m128i const* >( b + i ) );
+    // at most 256 * 255 + 128, which fits in an unsigned 16-bit lane
+    __m128i lo = _mm_mullo_epi16( _mm_unpacklo_epi8( vr, zero ), wr );
+    __m128i hi = _mm_mullo_epi16( _mm_unpackhi_epi8( vr, zero ), wr );
+    lo = _mm_add_epi16( lo, _mm_mullo_epi16( _mm_unpacklo_epi8( vg, zero ), wg ) );
+    hi = _mm_add_epi16( hi, _mm_mullo_epi16( _mm_unpackhi_epi8( vg, zero ), wg ) );
+    lo = _mm_add_epi16( lo, _mm_mullo_epi16( _mm_unpacklo_epi8( vb, zero ), wb ) );
+    hi = _mm_add_epi16( hi, _mm_mullo_epi16( _mm_unpackhi_epi8( vb, zero ), wb ) );
+    lo = _mm_srli_epi16( _mm_add_epi16( lo, half ), 8 );
+    hi = _mm_srli_epi16( _mm_add_epi16( hi, half ), 8 );
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( dst + i ), _mm_packus_epi16( lo, hi ) );
+  }
+  rgb_to_gray_scalar( r, g, b, i, n, dst );
+}
+
+
+// The downsampling kernels work on 16-bit lanes.  Sums of adjacent
+// bytes come from a multiply-add with ones; the even and odd bytes of
+// a row are split by masking and shifting the 16-bit lanes.
+
+VITAL_TARGET("sse4.2")
+void
+downsample_box_sse4( unsigned char const* row0, unsigned char const* row1,
+                     size_t n, unsigned char* dst )
+{
+  const __m128i ones = _mm_set1_epi8( 1 );
+  const __m128i two = _mm_set1_epi16( 2 );
+  size_t i = 0;
+  for ( ; i + 16 <= n; i += 16 )
+  {
+    const __m128i a0 = _mm_loadu_si128( reinterpret_cast< __m128i const* >( row0 + 2 * i ) );
+    const __m128i a1 = _mm_loadu_si128( reinterpret_cast< __m128i const* >( row0 + 2 * i + 16 ) );
+    const __m128i b0 = _mm_loadu_si128( reinterpret_cast< __m128i const* >( row1 + 2 * i ) );
+    const __m128i b1 = _mm_loadu_si128( reinterpret_cast< __m128i const* >( row1 + 2 * i + 16 ) );
+    __m128i lo = _mm_add_epi16( _mm_maddubs_epi16( a0, ones ), _mm_maddubs_epi16( b0, ones ) );
+    __m128i hi = _mm_add_epi16( _mm_maddubs_epi16( a1, ones ), _mm_maddubs_epi16( b1, ones ) );
+    lo = _mm_srli_epi16( _mm_add_epi16( lo, two ), 2 );
+    hi = _mm_srli_epi16( _mm_add_epi16( hi, two ), 2 );
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( dst + i ), _mm_packus_epi16( lo, hi ) );
+  }
+  downsample_box_scalar( row0, row1, i, n, dst );
+}
+
+
+VITAL_TARGET("sse4.2")
+void
+gaussian_filter_row_sse4( unsigned char const* src, size_t width,
+                          size_t n, uint16_t* dst )
+{
+  // the first output reads before the row, so it is always scalar
+  gaussian_filter_row_scalar( src, width, 0, std::min< size_t >( n, 1 ), dst );
+
+  const __m128i low_bytes = _mm_set1_epi16( 0x00ff );
+  const __m128i six = _mm_set1_epi16( 6 );
+  size_t i = 1;
+  // eight outputs read the bytes from 2i-2 to 2i+17
+  for ( ; i + 8 <= n && 2 * i + 18 <= width; i += 8 )
+  {
+    const __m128i m = _mm_loadu_si128( reinterpret_cast< __m128i const* >( src + 2 * i - 2 ) );
+    const __m128i c = _mm_loadu_si128( reinterpret_cast< __m128i const* >( src + 2 * i ) );
+    const __m128i p = _mm_loadu_si128( reinterpret_cast< __m128i const* >( src + 2 * i + 2 ) );
+    const __m128i odd = _mm_add_epi16( _mm_srli_epi16( m, 8 ), _mm_srli_epi16( c, 8 ) );
+    __m128i sum = _mm_add_epi16( _mm_and_si128( m, low_bytes ), _mm_and_si128( p, low_bytes ) );
+    sum = _mm_add_epi16( sum, _mm_slli_epi16( odd, 2 ) );
+    sum = _mm_add_epi16( sum, _mm_mullo_epi16( _mm_and_si128( c, low_bytes ), six ) );
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( dst + i ), sum );
+  }
+  gaussian_filter_row_scalar( src, width, std::min( i, n ), n, dst );
+}
+
+
+VITAL_TARGET("sse4.2")
+void
+gaussian_filter_column_sse4( uint16_t const* const* rows, size_t n, unsigned char* dst )
+{
+  const __m128i six = _mm_set1_epi16( 6 );
+  const __m128i half = _mm_set1_epi16( 128 );
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    __m128i r[5];
+    for ( int k = 0; k < 5; ++k )
+    {
+      r[k] = _mm_loadu_si128( reinterpret_cast< __m128i const* >( rows[k] + i ) );
+    }
+    // at most 16 * 4080 + 128, which fits in an unsigned 16-bit lane
+    __m128i sum = _mm_add_epi16( r[0], r[4] );
+    sum = _mm_add_epi16( sum, _mm_slli_epi16( _mm_add_epi16( r[1], r[3] ), 2 ) );
+    sum = _mm_add_epi16( sum, _mm_mullo_epi16( r[2], six ) );
+    sum = _mm_srli_epi16( _mm_add_epi16( sum, half ), 8 );
+    _mm_storel_epi64( reinterpret_cast< __m128i* >( dst + i ), _mm_packus_epi16( sum, sum ) );
+  }
+  gaussian_filter_column_scalar( rows, i, n, dst );
+}
+
+
+// The bilinear kernel blends four pixels per register.  The horizontal
+// pass multiplies byte pairs by 5-bit weights into 16-bit lanes and the
+// vertical pass multiplies pairs of those into 32-bit lanes.
+
+VITAL_TARGET("sse4.2")
+void
+bilinear_interpolate_sse4( unsigned char const* corners,
+                           unsigned char const* fractions,
+                           size_t n, unsigned char* dst )
+{
+  const __m128i thirty_two = _mm_set1_epi8( 32 );
+  const __m128i half = _mm_set1_epi32( 512 );
+  // fx of pixel p in all four bytes of pixel p
+  const __m128i spread_fx = _mm_setr_epi8( 0, 0, 0, 0, 2, 2, 2, 2, 4, 4, 4, 4, 6, 6, 6, 6 );
+  // fy of pixel p in both 16-bit lanes of pixel p
+  const __m128i spread_fy = _mm_setr_epi8( 1, -128, 1, -128, 3, -128, 3, -128,
+                                           5, -128, 5, -128, 7, -128, 7, -128 );
+  // selects the weight of the second byte or lane of each pair
+  const __m128i odd_bytes = _mm_set1_epi16( static_cast< short >( 0xff00 ) );
+  size_t i = 0;
+  for ( ; i + 4 <= n; i += 4 )
+  {
+    const __m128i c = _mm_loadu_si128( reinterpret_cast< __m128i const* >( corners + 4 * i ) );
+    const __m128i f = _mm_loadl_epi64( reinterpret_cast< __m128i const* >( fractions + 2 * i ) );
+    const __m128i fx = _mm_shuffle_epi8( f, spread_fx );
+    const __m128i wx = _mm_blendv_epi8( _mm_sub_epi8( thirty_two, fx ), fx, odd_bytes );
+    const __m128i rows = _mm_maddubs_epi16( c, wx );
+    const __m128i fy = _mm_shuffle_epi8( f, spread_fy );
+    const __m128i wy = _mm_blend_epi16( _mm_sub_epi16( _mm_set1_epi16( 32 ), fy ), fy, 0xaa );
+    __m128i v = _mm_madd_epi16( rows, wy );
+    v = _mm_srli_epi32( _mm_add_epi32( v, half ), 10 );
+    v = _mm_packus_epi16( _mm_packs_epi32( v, v ), v );
+    const int32_t packed = _mm_cvtsi128_si32( v );
+    std::memcpy( dst + i, &packed, 4 );
+  }
+  bilinear_interpolate_scalar( corners, fractions, i, n, dst );
+}
+
+#endif
+
+
+/// Access the currently selected instruction set level
+std::atomic< int >&
+active_level()
+{
+  static std::atomic< int > level( supported_simd_level() >= SIMD_SSE4 ? SIMD_SSE4 : SIMD_SCALAR );
+  return level;
+}
+
+} // end anonymous namespace
+
+
+// ==================================================================
+simd_level_t
+pixel_simd_level()
+{
+  return static_cast< simd_level_t >( active_level().load( std::memory_order_relaxed ) );
+}
+
+
+simd_level_t
+set_pixel_simd_level( simd_level_t level )
+{
+  // there are no kernels beyond SSE4
+  level = std::min( std::min( level, supported_simd_level() ), SIMD_SSE4 );
+  active_level().store( level );
+  return level;
+}
+
+
+// ------------------------------------------------------------------
+void
+interleave_pixels( unsigned char const* const* planes, size_t depth, size_t n,
+                   unsigned char* dst )
+{
+  if ( depth == 1 )
+  {
+    std::memcpy( dst, planes[0], n );
+    return;
+  }
+#if VITAL_PIXEL_X86_DISPATCH
+  if ( pixel_simd_level() >= SIMD_SSE4 )
+  {
+    switch ( depth )
+    {
+      case 2: interleave_sse4< 2 >( planes, n, dst ); return;
+      case 3: interleave_sse4< 3 >( planes, n, dst ); return;
+      case 4: interleave_sse4< 4 >( planes, n, dst ); return;
+      default: break;
+    }
+  }
+#endif
+  interleave_scalar( planes, depth, 0, n, dst );
+}
+
+
+void
+deinterleave_pixels( unsigned char const* src, size_t depth, size_t n,
+                     unsigned char* const* planes )
+{
+  if ( depth == 1 )
+  {
+    std::memcpy( planes[0], src, n );
+    return;
+  }
+#if VITAL_PIXEL_X86_DISPATCH
+  if ( pixel_simd_level() >= SIMD_SSE4 )
+  {
+    switch ( depth )
+    {
+      case 2: deinterleave_sse4< 2 >( src, n, planes ); return;
+      case 3: deinterleave_sse4< 3 >( src, n, planes ); return;
+      case 4: deinterleave_sse4< 4 >( src, n, planes ); return;
+      default: break;
+    }
+  }
+#endif
+  deinterleave_scalar( src, depth, 0, n, planes );
+}
+
+
+void
+rgb_to_gray( unsigned char const* r, unsigned char const* g,
+             unsigned char const* b, size_t n, unsigned char* dst )
+{
+#if VITAL_PIXEL_X86_DISPATCH
+  if ( pixel_simd_level() >= SIMD_SSE4 )
+  {
+    rgb_to_gray_sse4( r, g, b, n, dst );
+    return;
+  }
+#endif
+  rgb_to_gray_scalar( r, g, b, 0, n, dst );
+}
+
+
+// ------------------------------------------------------------------
+void
+downsample_box_2x( unsigned char const* row0, unsigned char const* row1,
+                   size_t n, unsigned char* dst )
+{
+#if VITAL_PIXEL_X86_DISPATCH
+  if ( pixel_simd_level() >= SIMD_SSE4 )
+  {
+    downsample_box_sse4( row0, row1, n, dst );
+    return;
+  }
+#endif
+  downsample_box_scalar( row0, row1, 0, n, dst );
+}
+
+
+void
+gaussian_filter_row_2x( unsigned char const* src, size_t width,
+                        size_t n, uint16_t* dst )
+{
+#if VITAL_PIXEL_X86_DISPATCH
+  if ( pixel_simd_level() >= SIMD_SSE4 )
+  {
+    gaussian_filter_row_sse4( src, width, n, dst );
+    return;
+  }
+#endif
+  gaussian_filter_row_scalar( src, width, 0, n, dst );
+}
+
+
+void
+gaussian_filter_column( uint16_t const* const* rows, size_t n, unsigned char* dst )
+{
+#if VITAL_PIXEL_X86_DISPATCH
+  if ( pixel_simd_level() >= SIMD_SSE4 )
+  {
+    gaussian_filter_column_sse4( rows, n, dst );
+    return;
+  }
+#endif
+  gaussian_filter_column_scalar( rows, 0, n, dst );
+}
+
+// ------------------------------------------------------------------
+void
+bilinear_interpolate( unsigned char const* corners, unsigned char const* fractions,
+                      size_t n, unsigned char* dst )
+{
+#if VITAL_PIXEL_X86_DISPATCH
+  if ( pixel_simd_level() >= SIMD_SSE4 )
+  {
+    bilinear_interpolate_sse4( corners, fractions, n, dst );
+    return;
+  }
+#endif
+  bilinear_interpolate_scalar( corners, fractions, 0, n, dst );
+}
+
+} } // end namespace
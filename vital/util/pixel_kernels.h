@@ -0,0 +1,184 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Vectorized kernels for rearranging and resampling image pixels
+ *
+ * These functions convert rows of 8-bit pixels between the planar layout,
+ * where each channel is stored in a separate plane, and the interleaved
+ * layout, where the channels of a pixel are adjacent.  On x86 processors
+ * with SSE4 support, images of two, three and four channels are converted
+ * with byte shuffles, sixteen pixels at a time.  Other channel counts and
+ * other processors use a portable scalar version.
+ *
+ * The downsampling functions halve rows of 8-bit pixels for building
+ * image pyramids, with either a 2x2 box filter or the 5x5 binomial
+ * approximation of a Gaussian, applied as a horizontal pass into 16-bit
+ * sums and a vertical pass combining five of those rows.
+ *
+ * rgb_to_gray() combines three planar rows of 8-bit color channels into
+ * luma with fixed point weights, eight pixels per 16-bit multiply.
+ *
+ * bilinear_interpolate() blends the four neighbours gathered for each
+ * pixel of an image remap, with 5-bit fractional weights as in the fixed
+ * point remap tables.
+ */
+
+#ifndef VITAL_PIXEL_KERNELS_H_
+#define VITAL_PIXEL_KERNELS_H_
+
+#include <vital/util/distance_kernels.h>
+
+#include <cstddef>
+
+#include <stdint.h>
+
+namespace kwiver {
+namespace vital {
+
+/// Return the instruction set level currently used by the pixel kernels
+VITAL_EXPORT simd_level_t pixel_simd_level();
+
+/// Select the instruction set level used by the pixel kernels
+/**
+ * By default the highest supported level is used.  This is mainly useful
+ * for testing against the scalar implementation.
+ *
+ * \param level  the requested level; it is reduced to supported_simd_level()
+ *               if the CPU does not support it.
+ *
+ * \returns the level actually selected
+ */
+VITAL_EXPORT simd_level_t set_pixel_simd_level( simd_level_t level );
+
+
+// ------------------------------------------------------------------
+/// Interleave \a n pixels of \a depth planes into a single row
+/**
+ * \param planes  array of \a depth pointers, each to \a n channel values
+ * \param depth   number of channels
+ * \param n       number of pixels
+ * \param dst     output of \a n * \a depth bytes, channels adjacent
+ */
+VITAL_EXPORT void interleave_pixels( unsigned char const* const* planes,
+                                     size_t depth, size_t n,
+                                     unsigned char* dst );
+
+/// Split a row of \a n interleaved pixels into \a depth planes
+/**
+ * \param src     input of \a n * \a depth bytes, channels adjacent
+ * \param depth   number of channels
+ * \param n       number of pixels
+ * \param planes  array of \a depth pointers, each to room for \a n bytes
+ */
+VITAL_EXPORT void deinterleave_pixels( unsigned char const* src,
+                                       size_t depth, size_t n,
+                                       unsigned char* const* planes );
+
+
+/// Compute the luma of \a n pixels from separate red, green and blue rows
+/**
+ * dst[i] = ( 77 r[i] + 150 g[i] + 29 b[i] + 128 ) / 256, the BT.601
+ * weights 0.299, 0.587 and 0.114 in 8-bit fixed point.  The weights sum
+ * to 256, so gray input is returned unchanged.
+ *
+ * \param r    red channel of \a n bytes
+ * \param g    green channel of \a n bytes
+ * \param b    blue channel of \a n bytes
+ * \param n    number of pixels
+ * \param dst  output of \a n bytes
+ */
+VITAL_EXPORT void rgb_to_gray( unsigned char const* r, unsigned char const* g,
+                               unsigned char const* b, size_t n,
+                               unsigned char* dst );
+
+
+// ------------------------------------------------------------------
+/// Halve a pair of rows by averaging each 2x2 block of pixels
+/**
+ * dst[i] is the rounded mean of row0[2i], row0[2i+1], row1[2i] and
+ * row1[2i+1].
+ *
+ * \param row0  first input row, of at least 2 * \a n bytes
+ * \param row1  second input row, of at least 2 * \a n bytes
+ * \param n     number of output pixels
+ * \param dst   output of \a n bytes
+ */
+VITAL_EXPORT void downsample_box_2x( unsigned char const* row0,
+                                     unsigned char const* row1,
+                                     size_t n, unsigned char* dst );
+
+/// Filter every other pixel of a row with the binomial kernel 1 4 6 4 1
+/**
+ * dst[i] = src[2i-2] + 4 src[2i-1] + 6 src[2i] + 4 src[2i+1] + src[2i+2],
+ * where indices outside the row are clamped to the first or last pixel.
+ *
+ * \param src    input row of \a width bytes
+ * \param width  number of input pixels
+ * \param n      number of output pixels, at most (width + 1) / 2
+ * \param dst    output of \a n sums, sixteen times the filtered value
+ */
+VITAL_EXPORT void gaussian_filter_row_2x( unsigned char const* src, size_t width,
+                                          size_t n, uint16_t* dst );
+
+/// Combine five rows of gaussian_filter_row_2x() sums with the binomial kernel
+/**
+ * dst[i] = ( r0 + 4 r1 + 6 r2 + 4 r3 + r4 + 128 ) / 256, where rK is
+ * rows[K][i], giving the rounded result of the separable 5x5 filter.
+ *
+ * \param rows  array of five pointers, each to \a n sums
+ * \param n     number of pixels
+ * \param dst   output of \a n bytes
+ */
+VITAL_EXPORT void gaussian_filter_column( uint16_t const* const* rows,
+                                          size_t n, unsigned char* dst );
+
+
+// ------------------------------------------------------------------
+/// Interpolate \a n pixels from their four neighbours
+/**
+ * With neighbours a, b (the row below: c, d) and fractions fx, fy in
+ * [0, 32), dst[i] is the rounded value of
+ * ( ( 32 - fx ) a + fx b ) ( 32 - fy ) + ( ( 32 - fx ) c + fx d ) fy,
+ * divided by 1024.
+ *
+ * \param corners    input of 4 \a n bytes: a, b, c and d of each pixel
+ * \param fractions  input of 2 \a n bytes: fx and fy of each pixel
+ * \param n          number of pixels
+ * \param dst        output of \a n bytes
+ */
+VITAL_EXPORT void bilinear_interpolate( unsigned char const* corners,
+                                        unsigned char const* fractions,
+                                        size_t n, unsigned char* dst );
+
+} } // end namespace
+
+#endif // VITAL_PIXEL_KERNELS_H_
@@ -0,0 +1,212 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test the vectorized distance kernels
+ */
+
+#include <test_common.h>
+
+#include <vital/util/distance_kernels.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+using namespace kwiver::vital;
+
+namespace {
+
+// lengths chosen to exercise the full width loops and all tail cases
+const size_t test_lengths[] = { 0, 1, 3, 7, 16, 31, 64, 100, 128, 257 };
+
+
+template < typename T >
+std::vector< T >
+random_vector( size_t n )
+{
+  std::vector< T > v( n );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    v[i] = static_cast< T >( std::rand() ) / RAND_MAX - T( 0.5 );
+  }
+  return v;
+}
+
+
+std::vector< unsigned char >
+random_bytes( size_t n )
+{
+  std::vector< unsigned char > v( n );
+  for ( size_t i = 0; i < n; ++i )
+  {
+    v[i] = static_cast< unsigned char >( std::rand() & 0xff );
+  }
+  return v;
+}
+
+
+unsigned
+reference_hamming( unsigned char const* a, unsigned char const* b, size_t n )
+{
+  unsigned count = 0;
+  for ( size_t i = 0; i < n; ++i )
+  {
+    for ( unsigned x = a[i] ^ b[i]; x; x >>= 1 )
+    {
+      count += x & 1;
+    }
+  }
+  return count;
+}
+
+
+template < typename T >
+void
+check_float_kernels( T tolerance )
+{
+  VITAL_FOREACH( size_t n, test_lengths )
+  {
+    std::vector< T > a = random_vector< T >( n ), b = random_vector< T >( n );
+    double l2 = 0.0, dot = 0.0;
+    for ( size_t i = 0; i < n; ++i )
+    {
+      l2 += ( double( a[i] ) - b[i] ) * ( double( a[i] ) - b[i] );
+      dot += double( a[i] ) * b[i];
+    }
+    T const* pa = a.empty() ? 0 : &a[0];
+    T const* pb = b.empty() ? 0 : &b[0];
+    TEST_NEAR( "l2_squared length " << n, l2_squared( pa, pb, n ), l2, tolerance );
+    TEST_NEAR( "dot_product length " << n, dot_product( pa, pb, n ), dot, tolerance );
+  }
+}
+
+
+void
+check_kernels_at_all_levels( void (*check)() )
+{
+  const simd_level_t supported = supported_simd_level();
+  for ( int l = SIMD_SCALAR; l <= supported; ++l )
+  {
+    const simd_level_t level = set_distance_simd_level( static_cast< simd_level_t >( l ) );
+    std::cout << "Testing " << simd_level_name( level ) << " kernels" << std::endl;
+    TEST_EQUAL( "Selected level", level, l );
+    check();
+  }
+  set_distance_simd_level( supported );
+}
+
+
+void
+check_single()
+{
+  check_float_kernels< float >( 1e-3f );
+  check_float_kernels< double >( 1e-12 );
+
+  VITAL_FOREACH( size_t n, test_lengths )
+  {
+    std::vector< unsigned char > a = random_bytes( n ), b = random_bytes( n );
+    unsigned char const* pa = a.empty() ? 0 : &a[0];
+    unsigned char const* pb = b.empty() ? 0 : &b[0];
+    TEST_EQUAL( "hamming_distance length " << n, hamming_distance( pa, pb, n ),
+                reference_hamming( pa, pb, n ) );
+  }
+}
+
+
+void
+check_block()
+{
+  const size_t dim = 61, stride = 64, num_a = 5, num_b = 300;
+  std::vector< float > a = random_vector< float >( num_a * stride );
+  std::vector< float > b = random_vector< float >( num_b * stride );
+  std::vector< unsigned char > ab = random_bytes( num_a * stride );
+  std::vector< unsigned char > bb = random_bytes( num_b * stride );
+
+  std::vector< float > l2( num_a * num_b ), dot( num_a * num_b );
+  std::vector< unsigned > ham( num_a * num_b );
+  l2_squared_many_to_many( &a[0], num_a, stride, &b[0], num_b, stride, dim, &l2[0] );
+  dot_product_many_to_many( &a[0], num_a, stride, &b[0], num_b, stride, dim, &dot[0] );
+  hamming_distance_many_to_many( &ab[0], num_a, stride, &bb[0], num_b, stride, dim, &ham[0] );
+
+  std::vector< float > l2_row( num_b );
+  l2_squared_one_to_many( &a[stride], &b[0], num_b, stride, dim, &l2_row[0] );
+
+  for ( size_t i = 0; i < num_a; ++i )
+  {
+    for ( size_t j = 0; j < num_b; ++j )
+    {
+      const size_t k = i * num_b + j;
+      TEST_NEAR( "l2_squared_many_to_many", l2[k],
+                 l2_squared( &a[i * stride], &b[j * stride], dim ), 1e-5 );
+      TEST_NEAR( "dot_product_many_to_many", dot[k],
+                 dot_product( &a[i * stride], &b[j * stride], dim ), 1e-5 );
+      TEST_EQUAL( "hamming_distance_many_to_many", ham[k],
+                  reference_hamming( &ab[i * stride], &bb[j * stride], dim ) );
+    }
+  }
+  for ( size_t j = 0; j < num_b; ++j )
+  {
+    TEST_EQUAL( "l2_squared_one_to_many", l2_row[j], l2[num_b + j] );
+  }
+}
+
+} // end namespace
+
+
+// ------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+// ------------------------------------------------------------------
+IMPLEMENT_TEST(single_kernels)
+{
+  check_kernels_at_all_levels( check_single );
+}
+
+
+// ------------------------------------------------------------------
+IMPLEMENT_TEST(block_kernels)
+{
+  check_kernels_at_all_levels( check_block );
+}
@@ -0,0 +1,196 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test the repeated video frame detector
+ */
+
+#include <test_common.h>
+
+#include <vital/util/duplicate_frame_detector.h>
+#include <vital/algo/algorithm.txx>
+
+#include <iostream>
+#include <vector>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+using namespace kwiver::vital;
+
+namespace {
+
+image
+make_frame( unsigned value )
+{
+  image img( 32, 24, 3, true );
+  for ( unsigned j = 0; j < 24; ++j )
+  {
+    for ( unsigned i = 0; i < 32; ++i )
+    {
+      for ( unsigned k = 0; k < 3; ++k )
+      {
+        img( i, j, k ) = static_cast< image::byte >( value * 17 + i + j + k );
+      }
+    }
+  }
+  return img;
+}
+
+
+/// A video of frames given by a list of values
+class list_video_input
+  : public algorithm_impl< list_video_input, algo::video_input >
+{
+public:
+  explicit list_video_input( std::vector< unsigned > const& values = std::vector< unsigned >() )
+    : m_values( values ), m_next( 0 ) { }
+
+  virtual std::string impl_name() const { return "list"; }
+  virtual std::string description() const { return "frames from a list"; }
+  virtual void set_configuration( config_block_sptr ) { }
+  virtual bool check_configuration( config_block_sptr ) const { return true; }
+
+  virtual void open( std::string ) { }
+  virtual void close() { }
+  virtual bool end_of_video() const { return m_next >= m_values.size(); }
+  virtual bool good() const { return true; }
+
+  virtual bool next_frame( timestamp& ts, uint32_t )
+  {
+    if ( end_of_video() )
+    {
+      return false;
+    }
+    // fresh memory for every frame, as a decoder would produce
+    m_frame = std::make_shared< simple_image_container >( make_frame( m_values[m_next] ) );
+    ts = timestamp();
+    ts.set_frame( static_cast< timestamp::frame_t >( ++m_next ) );
+    return true;
+  }
+
+  virtual image_container_sptr frame_image() { return m_frame; }
+  virtual video_metadata_vector frame_metadata() { return video_metadata_vector(); }
+
+private:
+  std::vector< unsigned > m_values;
+  size_t m_next;
+  image_container_sptr m_frame;
+};
+
+} // end anonymous namespace
+
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(frozen_frames)
+{
+  duplicate_frame_detector detector;
+  TEST_EQUAL( "First frame", detector.is_duplicate( make_frame( 1 ) ), false );
+  TEST_EQUAL( "Repeated frame", detector.is_duplicate( make_frame( 1 ) ), true );
+  TEST_EQUAL( "Repeated frame again", detector.is_duplicate( make_frame( 1 ) ), true );
+  TEST_EQUAL( "Frozen count", detector.frozen_count(), 2 );
+  TEST_EQUAL( "New frame", detector.is_duplicate( make_frame( 2 ) ), false );
+  TEST_EQUAL( "Frozen count reset", detector.frozen_count(), 0 );
+  TEST_EQUAL( "Older frame with history of one", detector.is_duplicate( make_frame( 1 ) ), false );
+  TEST_EQUAL( "Null frame", detector.is_duplicate( image_container_sptr() ), false );
+
+  // the same content in another layout is a duplicate
+  image planar( 32, 24, 3 );
+  planar.copy_from( make_frame( 1 ) );
+  TEST_EQUAL( "Other layout", detector.is_duplicate( planar ), true );
+
+  detector.reset();
+  TEST_EQUAL( "Frame after reset", detector.is_duplicate( make_frame( 1 ) ), false );
+}
+
+
+IMPLEMENT_TEST(history)
+{
+  duplicate_frame_detector detector( 2, true );
+  TEST_EQUAL( "Frame 1", detector.is_duplicate( make_frame( 1 ) ), false );
+  TEST_EQUAL( "Frame 2", detector.is_duplicate( make_frame( 2 ) ), false );
+  TEST_EQUAL( "Frame 1 repeated after 2", detector.is_duplicate( make_frame( 1 ) ), true );
+  TEST_EQUAL( "Not frozen", detector.frozen_count(), 0 );
+  TEST_EQUAL( "Frame 3", detector.is_duplicate( make_frame( 3 ) ), false );
+  // frame 1 was refreshed by its repeat, so frame 2 was forgotten
+  TEST_EQUAL( "Frame 2 forgotten", detector.is_duplicate( make_frame( 2 ) ), false );
+  TEST_EQUAL( "Frame 3 remembered", detector.is_duplicate( make_frame( 3 ) ), true );
+}
+
+
+IMPLEMENT_TEST(verify_copies_frames)
+{
+  duplicate_frame_detector detector( 2, true );
+  image frame = make_frame( 1 );
+  const long owners = frame.memory().use_count();
+  TEST_EQUAL( "Frame 1", detector.is_duplicate( frame ), false );
+  TEST_EQUAL( "Frame buffer not retained", frame.memory().use_count(), owners );
+
+  // the source overwrites its buffer with the next frame
+  frame.copy_from( make_frame( 2 ) );
+  TEST_EQUAL( "Reused buffer", detector.is_duplicate( frame ), false );
+  TEST_EQUAL( "Frame 1 remembered", detector.is_duplicate( make_frame( 1 ) ), true );
+  TEST_EQUAL( "Frame 3", detector.is_duplicate( make_frame( 3 ) ), false );
+  TEST_EQUAL( "Frame 2 forgotten", detector.is_duplicate( make_frame( 2 ) ), false );
+}
+
+
+IMPLEMENT_TEST(next_distinct_frame)
+{
+  unsigned const values[] = { 1, 1, 1, 2, 3, 3, 2, 2 };
+  list_video_input video( std::vector< unsigned >( values, values + 8 ) );
+  duplicate_frame_detector detector;
+  timestamp ts;
+  size_t skipped = 0;
+  std::vector< timestamp::frame_t > frames;
+  std::vector< size_t > skips;
+  while ( next_distinct_frame( video, detector, ts, 0, &skipped ) )
+  {
+    frames.push_back( ts.get_frame() );
+    skips.push_back( skipped );
+  }
+  TEST_EQUAL( "Number of distinct frames", frames.size(), 4 );
+  TEST_EQUAL( "Distinct frame 2", frames[1], 4 );
+  TEST_EQUAL( "Skipped before frame 2", skips[1], 2 );
+  TEST_EQUAL( "Distinct frame 4", frames[3], 7 );
+  TEST_EQUAL( "Skipped at end", skipped, 1 );
+}
@@ -0,0 +1,294 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test the vectorized pixel kernels
+ */
+
+#include <test_common.h>
+
+#include <vital/util/pixel_kernels.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+using namespace kwiver::vital;
+
+namespace {
+
+// lengths chosen to exercise the full width loops and all tail cases
+const size_t test_lengths[] = { 0, 1, 15, 16, 17, 33, 100, 257 };
+
+} // end anonymous namespace
+
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(round_trip)
+{
+  std::cout << "Pixel kernels use " << simd_level_name( pixel_simd_level() )
+            << std::endl;
+
+  const simd_level_t levels[] = { SIMD_SCALAR, supported_simd_level() };
+  for ( unsigned l = 0; l < 2; ++l )
+  {
+    set_pixel_simd_level( levels[l] );
+    for ( size_t depth = 1; depth <= 5; ++depth )
+    {
+      VITAL_FOREACH( size_t n, test_lengths )
+      {
+        std::vector< std::vector< unsigned char > > planes( depth );
+        std::vector< unsigned char const* > in_ptrs( depth );
+        for ( size_t d = 0; d < depth; ++d )
+        {
+          planes[d].resize( n + 1 );
+          for ( size_t i = 0; i < n + 1; ++i )
+          {
+            planes[d][i] = static_cast< unsigned char >( std::rand() & 0xff );
+          }
+          in_ptrs[d] = &planes[d][0];
+        }
+
+        // one extra byte to detect writes past the end
+        std::vector< unsigned char > row( n * depth + 1, 0xab );
+        interleave_pixels( &in_ptrs[0], depth, n, &row[0] );
+        size_t num_wrong = 0;
+        for ( size_t i = 0; i < n; ++i )
+        {
+          for ( size_t d = 0; d < depth; ++d )
+          {
+            num_wrong += row[i * depth + d] != planes[d][i] ? 1 : 0;
+          }
+        }
+        num_wrong += row[n * depth] != 0xab ? 1 : 0;
+
+        std::vector< std::vector< unsigned char > > out( depth );
+        std::vector< unsigned char* > out_ptrs( depth );
+        for ( size_t d = 0; d < depth; ++d )
+        {
+          out[d].assign( n + 1, 0xcd );
+          out_ptrs[d] = &out[d][0];
+        }
+        deinterleave_pixels( &row[0], depth, n, &out_ptrs[0] );
+        for ( size_t d = 0; d < depth; ++d )
+        {
+          for ( size_t i = 0; i < n; ++i )
+          {
+            num_wrong += out[d][i] != planes[d][i] ? 1 : 0;
+          }
+          num_wrong += out[d][n] != 0xcd ? 1 : 0;
+        }
+
+        if ( num_wrong != 0 )
+        {
+          TEST_ERROR( simd_level_name( pixel_simd_level() ) << " round trip of "
+                      << n << " pixels of depth " << depth << " has "
+                      << num_wrong << " wrong bytes" );
+        }
+      }
+    }
+  }
+  set_pixel_simd_level( supported_simd_level() );
+}
+
+
+IMPLEMENT_TEST(downsample)
+{
+  const simd_level_t levels[] = { SIMD_SCALAR, supported_simd_level() };
+  VITAL_FOREACH( size_t n, test_lengths )
+  {
+    const size_t width = 2 * n + 1;
+    std::vector< unsigned char > rows[5];
+    for ( unsigned r = 0; r < 5; ++r )
+    {
+      rows[r].resize( width );
+      for ( size_t i = 0; i < width; ++i )
+      {
+        // include the extremes to check for overflow
+        rows[r][i] = ( i % 7 == 0 ) ? 255 : static_cast< unsigned char >( std::rand() & 0xff );
+      }
+    }
+
+    std::vector< unsigned char > box[2];
+    std::vector< unsigned char > gauss[2];
+    for ( unsigned l = 0; l < 2; ++l )
+    {
+      set_pixel_simd_level( levels[l] );
+      box[l].assign( n + 1, 0xab );
+      downsample_box_2x( &rows[0][0], &rows[1][0], n, &box[l][0] );
+
+      std::vector< std::vector< uint16_t > > sums( 5 );
+      std::vector< uint16_t const* > sum_ptrs( 5 );
+      for ( unsigned r = 0; r < 5; ++r )
+      {
+        sums[r].assign( n + 1, 0 );
+        gaussian_filter_row_2x( &rows[r][0], width, n + 1, &sums[r][0] );
+        sum_ptrs[r] = &sums[r][0];
+      }
+      gauss[l].assign( n + 2, 0xab );
+      gaussian_filter_column( &sum_ptrs[0], n + 1, &gauss[l][0] );
+    }
+
+    size_t num_wrong = 0;
+    for ( size_t i = 0; i < n; ++i )
+    {
+      const unsigned sum = rows[0][2 * i] + rows[0][2 * i + 1] +
+                           rows[1][2 * i] + rows[1][2 * i + 1];
+      num_wrong += box[0][i] != ( sum + 2 ) / 4 ? 1 : 0;
+    }
+    num_wrong += box[0][n] != 0xab ? 1 : 0;
+    num_wrong += box[0] != box[1] ? 1 : 0;
+
+    // a constant image is unchanged by the Gaussian filter
+    std::vector< unsigned char > flat( width, 255 );
+    std::vector< uint16_t > flat_sum( n + 1 );
+    gaussian_filter_row_2x( &flat[0], width, n + 1, &flat_sum[0] );
+    uint16_t const* flat_ptrs[5] = { &flat_sum[0], &flat_sum[0], &flat_sum[0],
+                                     &flat_sum[0], &flat_sum[0] };
+    std::vector< unsigned char > flat_out( n + 1 );
+    gaussian_filter_column( flat_ptrs, n + 1, &flat_out[0] );
+    for ( size_t i = 0; i <= n; ++i )
+    {
+      num_wrong += flat_out[i] != 255 ? 1 : 0;
+    }
+    num_wrong += gauss[0][n + 1] != 0xab ? 1 : 0;
+    num_wrong += gauss[0] != gauss[1] ? 1 : 0;
+
+    if ( num_wrong != 0 )
+    {
+      TEST_ERROR( "downsampling " << width << " pixels has " << num_wrong << " errors" );
+    }
+  }
+  set_pixel_simd_level( supported_simd_level() );
+}
+
+
+IMPLEMENT_TEST(gray)
+{
+  const simd_level_t levels[] = { SIMD_SCALAR, supported_simd_level() };
+  VITAL_FOREACH( size_t n, test_lengths )
+  {
+    std::vector< unsigned char > r( n + 1 ), g( n + 1 ), b( n + 1 );
+    for ( size_t i = 0; i < n + 1; ++i )
+    {
+      r[i] = static_cast< unsigned char >( std::rand() & 0xff );
+      g[i] = static_cast< unsigned char >( std::rand() & 0xff );
+      b[i] = static_cast< unsigned char >( std::rand() & 0xff );
+    }
+    // white must stay white despite rounding
+    if ( n > 0 )
+    {
+      r[0] = g[0] = b[0] = 255;
+    }
+
+    for ( unsigned l = 0; l < 2; ++l )
+    {
+      set_pixel_simd_level( levels[l] );
+      std::vector< unsigned char > dst( n + 1, 0xab );
+      rgb_to_gray( &r[0], &g[0], &b[0], n, &dst[0] );
+
+      size_t num_wrong = 0;
+      for ( size_t i = 0; i < n; ++i )
+      {
+        const unsigned expected = ( 77 * r[i] + 150 * g[i] + 29 * b[i] + 128 ) / 256;
+        num_wrong += dst[i] != expected ? 1 : 0;
+      }
+      num_wrong += dst[n] != 0xab ? 1 : 0;
+      if ( n > 0 && dst[0] != 255 )
+      {
+        TEST_ERROR( "White pixel did not convert to white" );
+      }
+      if ( num_wrong != 0 )
+      {
+        TEST_ERROR( simd_level_name( pixel_simd_level() ) << " gray conversion of "
+                    << n << " pixels has " << num_wrong << " wrong bytes" );
+      }
+    }
+  }
+  set_pixel_simd_level( supported_simd_level() );
+}
+
+
+IMPLEMENT_TEST(bilinear)
+{
+  const simd_level_t levels[] = { SIMD_SCALAR, supported_simd_level() };
+  VITAL_FOREACH( size_t n, test_lengths )
+  {
+    std::vector< unsigned char > corners( 4 * n + 1 ), fractions( 2 * n + 1 );
+    for ( size_t i = 0; i < corners.size(); ++i )
+    {
+      corners[i] = static_cast< unsigned char >( std::rand() & 0xff );
+    }
+    for ( size_t i = 0; i < fractions.size(); ++i )
+    {
+      fractions[i] = static_cast< unsigned char >( std::rand() & 0x1f );
+    }
+
+    for ( unsigned l = 0; l < 2; ++l )
+    {
+      set_pixel_simd_level( levels[l] );
+      std::vector< unsigned char > dst( n + 1, 0xab );
+      bilinear_interpolate( &corners[0], &fractions[0], n, &dst[0] );
+
+      size_t num_wrong = 0;
+      for ( size_t i = 0; i < n; ++i )
+      {
+        const unsigned fx = fractions[2 * i];
+        const unsigned fy = fractions[2 * i + 1];
+        const unsigned top = ( 32 - fx ) * corners[4 * i] + fx * corners[4 * i + 1];
+        const unsigned bottom = ( 32 - fx ) * corners[4 * i + 2] + fx * corners[4 * i + 3];
+        const unsigned expected = ( ( 32 - fy ) * top + fy * bottom + 512 ) / 1024;
+        num_wrong += dst[i] != expected ? 1 : 0;
+      }
+      num_wrong += dst[n] != 0xab ? 1 : 0;
+      if ( num_wrong != 0 )
+      {
+        TEST_ERROR( simd_level_name( pixel_simd_level() ) << " bilinear interpolation of "
+                    << n << " pixels has " << num_wrong << " wrong bytes" );
+      }
+    }
+  }
+  set_pixel_simd_level( supported_simd_level() );
+}
@@ -0,0 +1,134 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test util thread_pool class
+ */
+#include <test_common.h>
+
+#include <vital/util/thread_pool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+// ------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+// ------------------------------------------------------------------
+IMPLEMENT_TEST(parallel_for_coverage)
+{
+  kwiver::vital::thread_pool pool( 3 );
+  TEST_EQUAL( "worker count", pool.num_threads(), 3 );
+
+  std::vector< int > hits( 1000, 0 );
+  pool.parallel_for( 0, hits.size(), [&hits] ( size_t b, size_t e )
+  {
+    for ( size_t i = b; i < e; ++i )
+    {
+      ++hits[i];
+    }
+  }, 7 );
+
+  bool all_once = true;
+  for ( size_t i = 0; i < hits.size(); ++i )
+  {
+    all_once = all_once && hits[i] == 1;
+  }
+  TEST_EQUAL( "each index visited once", all_once, true );
+
+  // empty ranges do not call the body
+  bool called = false;
+  pool.parallel_for( 5, 5, [&called] ( size_t, size_t ) { called = true; } );
+  TEST_EQUAL( "empty range", called, false );
+}
+
+
+// ------------------------------------------------------------------
+IMPLEMENT_TEST(parallel_for_nested)
+{
+  kwiver::vital::thread_pool pool( 2 );
+  std::atomic< size_t > sum( 0 );
+
+  // nested calls must not deadlock even when all workers are busy
+  pool.parallel_for( 0, 8, [&] ( size_t b, size_t e )
+  {
+    for ( size_t i = b; i < e; ++i )
+    {
+      pool.parallel_for( 0, 100, [&sum] ( size_t nb, size_t ne )
+      {
+        sum += ne - nb;
+      }, 10 );
+    }
+  }, 1 );
+  TEST_EQUAL( "nested sum", sum.load(), 800 );
+}
+
+
+// ------------------------------------------------------------------
+IMPLEMENT_TEST(parallel_for_exception)
+{
+  kwiver::vital::thread_pool pool( 2 );
+  std::atomic< size_t > count( 0 );
+
+  EXPECT_EXCEPTION( std::runtime_error,
+                    pool.parallel_for( 0, 10, [&count] ( size_t b, size_t )
+                    {
+                      ++count;
+                      if ( b == 3 )
+                      {
+                        throw std::runtime_error( "chunk failed" );
+                      }
+                    }, 1 ),
+                    "a chunk throws" );
+  TEST_EQUAL( "remaining chunks still run", count.load(), 10 );
+
+  // the shared pool is usable as well
+  std::atomic< size_t > total( 0 );
+  kwiver::vital::parallel_for( 0, 50, [&total] ( size_t b, size_t e )
+  {
+    total += e - b;
+  } );
+  TEST_EQUAL( "shared pool total", total.load(), 50 );
+}
@@ -0,0 +1,254 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of the thread pool
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace kwiver {
+namespace vital {
+
+namespace {
+
+// ------------------------------------------------------------------
+// State shared by the threads executing one parallel_for call.  It is
+// reference counted so that helper tasks which start after all chunks
+// have been claimed can still inspect it safely.
+struct parallel_for_state
+{
+  parallel_for_state( size_t b, size_t e, size_t g, size_t n,
+                      std::function< void( size_t, size_t ) > const& f )
+    : begin( b ), end( e ), grain( g ), num_chunks( n ), body( f ),
+    next_chunk( 0 ), done_chunks( 0 ) { }
+
+  /// Claim and execute chunks until none remain
+  void run()
+  {
+    for (;;)
+    {
+      const size_t c = next_chunk.fetch_add( 1 );
+      if ( c >= num_chunks )
+      {
+        return;
+      }
+
+      const size_t b = begin + c * grain;
+      const size_t e = std::min( end, b + grain );
+      try
+      {
+        body( b, e );
+      }
+      catch ( ... )
+      {
+        std::lock_guard< std::mutex > lock( mutex );
+        if ( ! error )
+        {
+          error = std::current_exception();
+        }
+      }
+
+      std::lock_guard< std::mutex > lock( mutex );
+      if ( ++done_chunks == num_chunks )
+      {
+        done.notify_all();
+      }
+    }
+  }
+
+  const size_t begin;
+  const size_t end;
+  const size_t grain;
+  const size_t num_chunks;
+  // only dereferenced while a chunk is outstanding, so the caller's
+  // function outlives every use
+  std::function< void( size_t, size_t ) > const& body;
+
+  std::atomic< size_t > next_chunk;
+  size_t done_chunks;
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable done;
+};
+
+} // end anonymous namespace
+
+
+// ------------------------------------------------------------------
+thread_pool&
+thread_pool
+::instance()
+{
+  static thread_pool pool( std::max( 1u, std::thread::hardware_concurrency() ) - 1 );
+  return pool;
+}
+
+
+// ------------------------------------------------------------------
+thread_pool
+::thread_pool( size_t num_threads )
+  : m_stopping( false )
+{
+  m_workers.reserve( num_threads );
+  for ( size_t i = 0; i < num_threads; ++i )
+  {
+    m_workers.push_back( std::thread( &thread_pool::worker_loop, this ) );
+  }
+}
+
+
+// ------------------------------------------------------------------
+thread_pool
+::~thread_pool()
+{
+  {
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+
+  for ( size_t i = 0; i < m_workers.size(); ++i )
+  {
+    m_workers[i].join();
+  }
+}
+
+
+// ------------------------------------------------------------------
+void
+thread_pool
+::enqueue( std::function< void() > const& task )
+{
+  if ( m_workers.empty() )
+  {
+    task();
+    return;
+  }
+
+  {
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_tasks.push_back( task );
+  }
+  m_condition.notify_one();
+}
+
+
+// ------------------------------------------------------------------
+void
+thread_pool
+::parallel_for( size_t begin, size_t end,
+                std::function< void( size_t, size_t ) > const& body,
+                size_t grain, size_t max_threads )
+{
+  if ( end <= begin )
+  {
+    return;
+  }
+
+  const size_t count = end - begin;
+  size_t helpers = m_workers.size();
+  if ( max_threads > 0 )
+  {
+    helpers = std::min( helpers, max_threads - 1 );
+  }
+  if ( grain == 0 )
+  {
+    // a few chunks per thread balances uneven chunk costs
+    grain = std::max< size_t >( 1, count / ( 4 * ( helpers + 1 ) ) );
+  }
+
+  const size_t num_chunks = ( count + grain - 1 ) / grain;
+  helpers = std::min( helpers, num_chunks - 1 );
+  if ( helpers == 0 )
+  {
+    for ( size_t b = begin; b < end; b += grain )
+    {
+      body( b, std::min( end, b + grain ) );
+    }
+    return;
+  }
+
+  std::shared_ptr< parallel_for_state > state =
+    std::make_shared< parallel_for_state >( begin, end, grain, num_chunks, body );
+  for ( size_t i = 0; i < helpers; ++i )
+  {
+    this->enqueue( [state] () { state->run(); } );
+  }
+  state->run();
+
+  std::unique_lock< std::mutex > lock( state->mutex );
+  state->done.wait( lock, [&state] () { return state->done_chunks == state->num_chunks; } );
+  if ( state->error )
+  {
+    std::rethrow_exception( state->error );
+  }
+}
+
+
+// ------------------------------------------------------------------
+void
+thread_pool
+::worker_loop()
+{
+  for (;;)
+  {
+    std::function< void() > task;
+    {
+      std::unique_lock< std::mutex > lock( m_mutex );
+      m_condition.wait( lock, [this] () { return m_stopping || ! m_tasks.empty(); } );
+      if ( m_tasks.empty() )
+      {
+        return;
+      }
+      task = m_tasks.front();
+      m_tasks.pop_front();
+    }
+    task();
+  }
+}
+
+
+// ------------------------------------------------------------------
+void
+parallel_for( size_t begin, size_t end,
+              std::function< void( size_t, size_t ) > const& body,
+              size_t grain, size_t max_threads )
+{
+  thread_pool::instance().parallel_for( begin, end, body, grain, max_threads );
+}
+
+} } // end namespace vital
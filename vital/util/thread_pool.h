@@ -0,0 +1,193 @@
+/*ckwg +29
+ * Copyright 2016 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Interface to a simple pool of worker threads
+ */
+
+#ifndef VITAL_THREAD_POOL_H_
+#define VITAL_THREAD_POOL_H_
+
+#include <vital/vital_export.h>
+#include <vital/noncopyable.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kwiver {
+namespace vital {
+
+// ------------------------------------------------------------------
+/// A fixed size pool of worker threads executing queued tasks
+/**
+ * Tasks are executed in the order they are queued by whichever worker
+ * becomes available first.  Most code should not queue tasks directly
+ * but use parallel_for(), which splits a range of indices into chunks and
+ * also executes chunks on the calling thread.  Because the caller takes
+ * part in the work, parallel_for() may safely be nested and still makes
+ * progress on a pool with no worker threads.
+ */
+class VITAL_EXPORT thread_pool
+  : private kwiver::vital::noncopyable
+{
+public:
+  /// Access the process wide pool
+  /**
+   * The shared pool has one worker thread fewer than the number of
+   * hardware threads, since the thread calling parallel_for() also
+   * executes work.
+   */
+  static thread_pool& instance();
+
+  /// Constructor
+  /**
+   * \param num_threads the number of worker threads to start
+   */
+  explicit thread_pool( size_t num_threads );
+
+  /// Destructor
+  /**
+   * Waits for all queued tasks to finish before joining the workers.
+   */
+  ~thread_pool();
+
+  /// Return the number of worker threads in the pool
+  size_t num_threads() const { return m_workers.size(); }
+
+  /// Queue a task for execution by a worker thread
+  /**
+   * If the pool has no worker threads the task is executed immediately
+   * on the calling thread.
+   */
+  void enqueue( std::function< void() > const& task );
+
+  /// Execute a function over a range of indices in parallel
+  /**
+   * The range [\a begin, \a end) is split into chunks of \a grain
+   * indices and \a body is called once per chunk with the chunk bounds.
+   * Chunks are executed concurrently by the calling thread and at most
+   * \a max_threads - 1 workers from this pool.  The call returns when all
+   * chunks are complete.  If \a body throws, the remaining chunks are
+   * still executed and the first exception is rethrown to the caller.
+   *
+   * \param begin       the first index of the range
+   * \param end         one past the last index of the range
+   * \param body        function called as body(chunk_begin, chunk_end)
+   * \param grain       the number of indices in each chunk; zero selects
+   *                    a chunk size that gives each thread a few chunks
+   * \param max_threads the maximum number of threads, including the
+   *                    caller, to use; zero uses all workers
+   */
+  void parallel_for( size_t begin, size_t end,
+                     std::function< void( size_t, size_t ) > const& body,
+                     size_t grain = 0, size_t max_threads = 0 );
+
+
+private:
+  void worker_loop();
+
+  std::vector< std::thread > m_workers;
+  std::deque< std::function< void() > > m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopping;
+};
+
+
+/// Execute a function over a range of indices using the shared pool
+/**
+ * This is equivalent to thread_pool::instance().parallel_for().
+ */
+VITAL_EXPORT void
+parallel_for( size_t begin, size_t end,
+              std::function< void( size_t, size_t ) > const& body,
+              size_t grain = 0, size_t max_threads = 0 );
+
+
+/// The amount of work below which parallel_for_work() runs serially
+/**
+ * Work is measured in the units of the caller, usually pixels.  Below
+ * this amount the cost of waking worker threads outweighs the gain.
+ */
+const size_t parallel_work_threshold = 64 * 1024;
+
+
+/// Return whether \a work is enough to split across threads
+inline bool
+use_parallel( size_t work, size_t max_threads )
+{
+  return max_threads != 1 && work >= parallel_work_threshold;
+}
+
+
+/// Execute a function over a range of units, in parallel if worthwhile
+/**
+ * The range [0, \a num_units) is processed by calling \a body with
+ * ranges of units.  If the total work, \a num_units times \a unit_work,
+ * is below parallel_work_threshold, or \a max_threads is one, \a body is
+ * called once with the whole range on the calling thread.  Otherwise
+ * parallel_for() is used with chunks of about \a chunk_work work and at
+ * least \a min_grain units.
+ *
+ * \param num_units   the number of units, such as rows
+ * \param unit_work   the work of one unit, such as the pixels of a row
+ * \param body        function called as body(units_begin, units_end)
+ * \param max_threads the maximum number of threads to use; zero uses
+ *                    all workers of the shared pool
+ * \param chunk_work  the work of each parallel chunk
+ * \param min_grain   the smallest number of units in a chunk
+ */
+template < typename Body >
+void
+parallel_for_work( size_t num_units, size_t unit_work, Body const& body,
+                   size_t max_threads = 0,
+                   size_t chunk_work = parallel_work_threshold,
+                   size_t min_grain = 1 )
+{
+  unit_work = std::max< size_t >( unit_work, 1 );
+  if ( ! use_parallel( num_units * unit_work, max_threads ) )
+  {
+    body( 0, num_units );
+    return;
+  }
+  const size_t grain = std::max( min_grain, chunk_work / unit_work );
+  parallel_for( 0, num_units, body, grain, max_threads );
+}
+
+} } // end namespace vital
+
+#endif // VITAL_THREAD_POOL_H_